@@ -31,6 +31,7 @@
 #include "ns3/tcp-socket-factory.h"
 #include "ns3/boolean.h"
 #include "bulk-send-application.h"
+#include "ns3/packet-census.h"
 
 namespace ns3 {
 
@@ -206,6 +207,7 @@ void BulkSendApplication::StopApplication (void) // Called at time specified by
 void BulkSendApplication::SendData (const Address &from, const Address &to)
 {
   NS_LOG_FUNCTION (this);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
 
   while (m_maxBytes == 0 || m_totBytes < m_maxBytes)
     { // Time to send more
@@ -42,6 +42,7 @@
 #include "ns3/string.h"
 #include "ns3/pointer.h"
 #include "ns3/boolean.h"
+#include "ns3/packet-census.h"
 
 namespace ns3 {
 
@@ -317,6 +318,7 @@ void OnOffApplication::ScheduleStopEvent ()
 void OnOffApplication::SendPacket ()
 {
   NS_LOG_FUNCTION (this);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
 
   NS_ASSERT (m_sendEvent.IsExpired ());
 
@@ -32,6 +32,7 @@
 #include "ns3/udp-socket-factory.h"
 #include "packet-sink.h"
 #include "ns3/boolean.h"
+#include "ns3/packet-census.h"
 
 namespace ns3 {
 
@@ -219,6 +220,7 @@ void
 PacketSink::PacketReceived (const Ptr<Packet> &p, const Address &from,
                             const Address &localAddress)
 {
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
   SeqTsSizeHeader header;
   Ptr<Packet> buffer;
 
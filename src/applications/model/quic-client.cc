@@ -30,6 +30,7 @@
 #include "ns3/uinteger.h"
 #include "quic-client.h"
 #include "seq-ts-header.h"
+#include "ns3/packet-census.h"
 #include <cstdlib>
 #include <cstdio>
 
@@ -182,6 +183,7 @@ void
 QuicClient::Send (void)
 {
   NS_LOG_FUNCTION (this);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
   NS_ASSERT (m_sendEvent.IsExpired ());
   SeqTsHeader seqTs;
   seqTs.SetSeq (m_sent);
@@ -32,6 +32,7 @@
 #include "ns3/trace-source-accessor.h"
 #include "quic-echo-client.h"
 #include "ns3/quic-header.h"
+#include "ns3/packet-census.h"
 
 
 namespace ns3 {
@@ -392,6 +393,7 @@ QuicEchoClient::Send (void)
 {
   NS_LOG_INFO ("##########  QUIC Echo Client SENDING at time " << Simulator::Now ().GetSeconds () << " ##########");
   NS_LOG_FUNCTION (this);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
 
   NS_ASSERT (m_sendEvent.IsExpired ());
 
@@ -20,6 +20,7 @@
  */
 
 #include "three-gpp-http-client.h"
+#include "ns3/packet-census.h"
 
 #include <ns3/log.h>
 #include <ns3/simulator.h>
@@ -446,6 +447,7 @@ void
 ThreeGppHttpClient::RequestMainObject ()
 {
   NS_LOG_FUNCTION (this);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
 
   if (m_state == CONNECTING || m_state == READING)
     {
@@ -488,6 +490,7 @@ void
 ThreeGppHttpClient::RequestEmbeddedObject ()
 {
   NS_LOG_FUNCTION (this);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
 
   if (m_state == CONNECTING || m_state == PARSING_MAIN_OBJECT
       || m_state == EXPECTING_EMBEDDED_OBJECT)
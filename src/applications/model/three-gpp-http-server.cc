@@ -20,6 +20,7 @@
  */
 
 #include "three-gpp-http-server.h"
+#include "ns3/packet-census.h"
 
 #include <ns3/log.h>
 #include <ns3/simulator.h>
@@ -593,6 +594,7 @@ uint32_t
 ThreeGppHttpServer::ServeFromTxBuffer (Ptr<Socket> socket)
 {
   NS_LOG_FUNCTION (this << socket);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
 
   if (m_txBuffer->IsBufferEmpty (socket))
     {
@@ -30,6 +30,7 @@
 #include "ns3/uinteger.h"
 #include "udp-client.h"
 #include "seq-ts-header.h"
+#include "ns3/packet-census.h"
 #include <cstdlib>
 #include <cstdio>
 
@@ -171,6 +172,7 @@ void
 UdpClient::Send (void)
 {
   NS_LOG_FUNCTION (this);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
   NS_ASSERT (m_sendEvent.IsExpired ());
   SeqTsHeader seqTs;
   seqTs.SetSeq (m_sent);
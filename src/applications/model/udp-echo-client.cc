@@ -28,6 +28,7 @@
 #include "ns3/uinteger.h"
 #include "ns3/trace-source-accessor.h"
 #include "udp-echo-client.h"
+#include "ns3/packet-census.h"
 
 namespace ns3 {
 
@@ -306,6 +307,7 @@ void
 UdpEchoClient::Send (void)
 {
   NS_LOG_FUNCTION (this);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
 
   NS_ASSERT (m_sendEvent.IsExpired ());
 
@@ -32,6 +32,7 @@
 #include "ns3/string.h"
 #include "seq-ts-header.h"
 #include "udp-trace-client.h"
+#include "ns3/packet-census.h"
 #include <cstdlib>
 #include <cstdio>
 #include <fstream>
@@ -309,6 +310,7 @@ void
 UdpTraceClient::SendPacket (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
   Ptr<Packet> p;
   uint32_t packetSize;
   if (size>12)
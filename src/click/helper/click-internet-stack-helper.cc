@@ -285,6 +285,7 @@ ClickInternetStackHelper::EnablePcapIpv4Internal (std::string prefix, Ptr<Ipv4>
   // irrespective of how many times we want to trace a particular protocol.
   //
   PcapHelper pcapHelper;
+  pcapHelper.SetFileFormat (GetPcapIpv4FileFormat ());
 
   std::string filename;
   if (explicitFilename)
@@ -296,7 +297,9 @@ ClickInternetStackHelper::EnablePcapIpv4Internal (std::string prefix, Ptr<Ipv4>
       filename = pcapHelper.GetFilenameFromInterfacePair (prefix, ipv4, interface);
     }
 
-  Ptr<PcapFileWrapper> file = pcapHelper.CreateFile (filename, std::ios::out, PcapHelper::DLT_RAW);
+  Ptr<PcapFileWrapper> file = pcapHelper.CreateFile (filename, std::ios::out, PcapHelper::DLT_RAW,
+                                                     std::numeric_limits<uint32_t>::max (), 0,
+                                                     pcapHelper.GetInterfaceNameFromInterfacePair (ipv4, interface));
 
   //
   // However, we only hook the trace source once to avoid multiple trace sink
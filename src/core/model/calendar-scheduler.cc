@@ -298,6 +298,33 @@ CalendarScheduler::Remove (const Event &ev)
   NS_ASSERT (false);
 }
 
+uint32_t
+CalendarScheduler::Compact (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t removed = 0;
+  for (uint32_t bucket = 0; bucket < m_nBuckets; bucket++)
+    {
+      Bucket::iterator i = m_buckets[bucket].begin ();
+      while (i != m_buckets[bucket].end ())
+        {
+          if (i->impl->IsCancelled ())
+            {
+              i->impl->Unref ();
+              i = m_buckets[bucket].erase (i);
+              removed++;
+            }
+          else
+            {
+              ++i;
+            }
+        }
+    }
+  m_qSize -= removed;
+  ResizeDown ();
+  return removed;
+}
+
 void
 CalendarScheduler::ResizeUp (void)
 {
@@ -109,6 +109,7 @@ public:
   virtual Scheduler::Event PeekNext (void) const;
   virtual Scheduler::Event RemoveNext (void);
   virtual void Remove (const Scheduler::Event &ev);
+  virtual uint32_t Compact (void);
 
 private:
   /** Double the number of buckets if necessary. */
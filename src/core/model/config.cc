@@ -25,7 +25,11 @@
 #include "names.h"
 #include "pointer.h"
 #include "log.h"
+#include "trace-source-accessor.h"
 
+#include <algorithm>
+#include <limits>
+#include <map>
 #include <sstream>
 
 /**
@@ -294,6 +298,358 @@ ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
   return !iss.bad () && !iss.fail ();
 }
 
+/**
+ * \ingroup config-impl
+ * A Config path parsed into its elements, with the attributes matched
+ * by each element cached for each type of object it was matched
+ * against.  This is the match state of a Resolver; Config::Set and
+ * Config::Connect build one per call, while a PathHandle keeps one
+ * across its operations.
+ */
+class CompiledPath : public SimpleRefCount<CompiledPath>
+{
+public:
+  /** An attribute of a type, which leads to further objects on the path. */
+  struct Step
+  {
+    /** The attribute name. */
+    std::string name;
+    /** The attribute accessor. */
+    Ptr<const AttributeAccessor> accessor;
+    /** The accessor, if the attribute is a container with the usual accessor. */
+    const ObjectPtrContainerAccessor *container;
+    /** Whether the attribute is an ObjectPtrContainer. */
+    bool isContainer;
+    /** Whether the attribute can be read with its accessor. */
+    bool gettable;
+  };
+
+  /** A range of container indices, inclusive. */
+  typedef std::pair<uint32_t, uint32_t> IndexRange;
+
+  /** A parsed path element. */
+  struct Element
+  {
+    /** The element, as found in the path. */
+    std::string item;
+    /** Whether the element starts with "Names". */
+    bool isNames;
+    /** Whether the element is a \c $ element. */
+    bool isTypeId;
+    /** Whether the TypeId of the \c $ element has been looked up. */
+    bool hasTypeId;
+    /** The TypeId of the \c $ element. */
+    TypeId tid;
+    /**
+     * Whether the element, used as a container index, is a list of
+     * explicit indices and ranges.
+     */
+    bool hasIndices;
+    /** The explicit indices, sorted and merged. */
+    std::vector<IndexRange> indices;
+    /** The attributes matched by this element, by TypeId uid. */
+    std::map<uint16_t, std::vector<Step> > steps;
+  };
+
+  /**
+   * Parse a Config path.
+   *
+   * \param [in] root The Config path of the objects.
+   * \param [in] leaf The attribute or trace source name following
+   *             \pname{root}, or an empty string.
+   */
+  CompiledPath (std::string root, std::string leaf);
+
+  /** \returns The Config path, including its leaf. */
+  std::string GetPath (void) const;
+  /** \returns The Config path without its leaf. */
+  std::string GetRootPath (void) const;
+  /** \returns The last element of the Config path. */
+  std::string GetLeaf (void) const;
+
+  /** \returns The number of elements of the path without its leaf. */
+  std::size_t GetElementN (void) const;
+  /**
+   * \param [in] i The element index.
+   * \returns The element.
+   */
+  Element & GetElement (std::size_t i);
+  /**
+   * Get the attributes of a type matched by an element.
+   *
+   * \param [in] i The element index.
+   * \param [in] tid The type.
+   * \returns The matching attributes.
+   */
+  const std::vector<Step> & GetSteps (std::size_t i, TypeId tid);
+
+  /**
+   * Set the leaf attribute of an object.
+   *
+   * \param [in] object The object.
+   * \param [in] value The value to set.
+   * \returns \c true if the attribute could be set.
+   */
+  bool SetLeaf (Ptr<Object> object, const AttributeValue &value);
+  /**
+   * Find the leaf trace source of an object.
+   *
+   * \param [in] object The object.
+   * \returns The trace source accessor, or 0 if there is none.
+   */
+  Ptr<const TraceSourceAccessor> LookupLeafTraceSource (Ptr<Object> object);
+
+private:
+  /** A leaf attribute of a type. */
+  struct LeafAttribute
+  {
+    /** Whether the attribute exists and can be set. */
+    bool settable;
+    /** The attribute. */
+    struct TypeId::AttributeInformation info;
+  };
+
+  /**
+   * Parse the explicit container indices of an element.
+   *
+   * \param [in,out] element The element.
+   */
+  static void ParseIndices (Element *element);
+
+  /** The Config path without its leaf. */
+  std::string m_root;
+  /** The leaf. */
+  std::string m_leaf;
+  /** The elements of the path without its leaf. */
+  std::vector<Element> m_elements;
+  /** The leaf attributes, by TypeId uid. */
+  std::map<uint16_t, LeafAttribute> m_leafAttributes;
+  /** The leaf trace sources, by TypeId uid. */
+  std::map<uint16_t, Ptr<const TraceSourceAccessor> > m_leafTraceSources;
+
+};  // class CompiledPath
+
+CompiledPath::CompiledPath (std::string root, std::string leaf)
+  : m_root (root),
+    m_leaf (leaf)
+{
+  NS_LOG_FUNCTION (this << root << leaf);
+
+  // ensure that we start and end with a '/'
+  std::string path = root;
+  std::string::size_type tmp = path.find ("/");
+  if (tmp != 0)
+    {
+      // no slash at start
+      path = "/" + path;
+    }
+  tmp = path.find_last_of ("/");
+  if (tmp != (path.size () - 1))
+    {
+      // no slash at end
+      path = path + "/";
+    }
+
+  std::string::size_type cur = 0;
+  std::string::size_type next;
+  while ((next = path.find ("/", cur + 1)) != std::string::npos)
+    {
+      Element element;
+      element.item = path.substr (cur + 1, next - (cur + 1));
+      element.isNames = path.compare (cur, 6, "/Names") == 0;
+      element.isTypeId = element.item.find ("$") == 0;
+      element.hasTypeId = false;
+      ParseIndices (&element);
+      m_elements.push_back (element);
+      cur = next;
+    }
+}
+
+void
+CompiledPath::ParseIndices (Element *element)
+{
+  NS_LOG_FUNCTION (element);
+  // Accept what ArrayMatcher accepts, but only with plain decimal numbers;
+  // anything else is left to ArrayMatcher.
+  element->hasIndices = false;
+  std::vector<IndexRange> ranges;
+  std::string::size_type start = 0;
+  while (true)
+    {
+      std::string::size_type bar = element->item.find ("|", start);
+      std::string term = element->item.substr (start, bar == std::string::npos ? std::string::npos : bar - start);
+      std::string lower = term;
+      std::string upper = term;
+      if (term == "*")
+        {
+          return;
+        }
+      if (term.size () >= 2 && term[0] == '[' && term[term.size () - 1] == ']')
+        {
+          std::string::size_type dash = term.find ("-");
+          if (dash == std::string::npos)
+            {
+              return;
+            }
+          lower = term.substr (1, dash - 1);
+          upper = term.substr (dash + 1, term.size () - 1 - (dash + 1));
+        }
+      uint64_t bounds[2];
+      std::string strings[2] = { lower, upper };
+      for (int j = 0; j < 2; j++)
+        {
+          if (strings[j].empty () || strings[j].size () > 10
+              || strings[j].find_first_not_of ("0123456789") != std::string::npos)
+            {
+              return;
+            }
+          std::istringstream iss (strings[j]);
+          iss >> bounds[j];
+          if (bounds[j] > std::numeric_limits<uint32_t>::max ())
+            {
+              return;
+            }
+        }
+      if (bounds[0] <= bounds[1])
+        {
+          ranges.push_back (IndexRange (bounds[0], bounds[1]));
+        }
+      if (bar == std::string::npos)
+        {
+          break;
+        }
+      start = bar + 1;
+    }
+  std::sort (ranges.begin (), ranges.end ());
+  for (std::vector<IndexRange>::const_iterator j = ranges.begin (); j != ranges.end (); ++j)
+    {
+      if (!element->indices.empty ()
+          && uint64_t (j->first) <= uint64_t (element->indices.back ().second) + 1)
+        {
+          element->indices.back ().second = std::max (element->indices.back ().second, j->second);
+        }
+      else
+        {
+          element->indices.push_back (*j);
+        }
+    }
+  element->hasIndices = true;
+}
+
+std::string
+CompiledPath::GetPath (void) const
+{
+  return m_root + "/" + m_leaf;
+}
+std::string
+CompiledPath::GetRootPath (void) const
+{
+  return m_root;
+}
+std::string
+CompiledPath::GetLeaf (void) const
+{
+  return m_leaf;
+}
+
+std::size_t
+CompiledPath::GetElementN (void) const
+{
+  return m_elements.size ();
+}
+CompiledPath::Element &
+CompiledPath::GetElement (std::size_t i)
+{
+  return m_elements[i];
+}
+
+const std::vector<CompiledPath::Step> &
+CompiledPath::GetSteps (std::size_t i, TypeId instanceTid)
+{
+  Element &element = m_elements[i];
+  std::map<uint16_t, std::vector<Step> >::iterator found = element.steps.find (instanceTid.GetUid ());
+  if (found != element.steps.end ())
+    {
+      return found->second;
+    }
+  std::vector<Step> &steps = element.steps[instanceTid.GetUid ()];
+  TypeId tid;
+  TypeId nextTid = instanceTid;
+  do
+    {
+      tid = nextTid;
+      for (uint32_t j = 0; j < tid.GetAttributeN (); j++)
+        {
+          struct TypeId::AttributeInformation info = tid.GetAttribute (j);
+          if (info.name != element.item && element.item != "*")
+            {
+              continue;
+            }
+          Step step;
+          step.name = info.name;
+          step.accessor = info.accessor;
+          step.gettable = (info.flags & TypeId::ATTR_GET) && info.accessor->HasGetter ();
+          step.container = dynamic_cast<const ObjectPtrContainerAccessor *> (PeekPointer (info.accessor));
+          // attempt to cast to a pointer checker.
+          if (dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              step.isContainer = false;
+              steps.push_back (step);
+            }
+          // attempt to cast to an object vector.
+          if (dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              step.isContainer = true;
+              steps.push_back (step);
+            }
+          // this could be anything else and we don't know what to do with it.
+          // So, we just ignore it.
+        }
+      nextTid = tid.GetParent ();
+    }
+  while (nextTid != tid);
+  return steps;
+}
+
+bool
+CompiledPath::SetLeaf (Ptr<Object> object, const AttributeValue &value)
+{
+  TypeId tid = object->GetInstanceTypeId ();
+  std::map<uint16_t, LeafAttribute>::iterator found = m_leafAttributes.find (tid.GetUid ());
+  if (found == m_leafAttributes.end ())
+    {
+      LeafAttribute leaf;
+      leaf.settable = tid.LookupAttributeByName (m_leaf, &leaf.info)
+        && (leaf.info.flags & TypeId::ATTR_SET)
+        && leaf.info.accessor->HasSetter ();
+      found = m_leafAttributes.insert (std::make_pair (tid.GetUid (), leaf)).first;
+    }
+  const LeafAttribute &leaf = found->second;
+  if (!leaf.settable)
+    {
+      return false;
+    }
+  Ptr<AttributeValue> v = leaf.info.checker->CreateValidValue (value);
+  if (v == 0)
+    {
+      return false;
+    }
+  return leaf.info.accessor->Set (PeekPointer (object), *v);
+}
+
+Ptr<const TraceSourceAccessor>
+CompiledPath::LookupLeafTraceSource (Ptr<Object> object)
+{
+  TypeId tid = object->GetInstanceTypeId ();
+  std::map<uint16_t, Ptr<const TraceSourceAccessor> >::iterator found = m_leafTraceSources.find (tid.GetUid ());
+  if (found == m_leafTraceSources.end ())
+    {
+      Ptr<const TraceSourceAccessor> accessor = tid.LookupTraceSourceByName (m_leaf);
+      found = m_leafTraceSources.insert (std::make_pair (tid.GetUid (), accessor)).first;
+    }
+  return found->second;
+}
+
 /**
  * \ingroup config-impl
  * Abstract class to parse Config paths into object references.
@@ -307,6 +663,15 @@ public:
    * \param [in] path The Config path.
    */
   Resolver (std::string path);
+  /**
+   * Construct from a parsed Config path, whose match state is kept
+   * across resolutions.
+   *
+   * \param [in] path The parsed Config path.
+   * \param [in] withContext Whether to build the matching Config path
+   *             of each object found.
+   */
+  Resolver (Ptr<CompiledPath> path, bool withContext);
   /** Destructor. */
   virtual ~Resolver ();
 
@@ -320,23 +685,30 @@ public:
   void Resolve (Ptr<Object> root);
 
 private:
-  /** Ensure the Config path starts and ends with a '/'. */
-  void Canonicalize (void);
   /**
    * Parse the next element in the Config path.
    *
-   * \param [in] path The remaining portion of the Config path.
+   * \param [in] i The index of the next element.
    * \param [in] root The object corresponding to the current position
    *                  in the Config path.
    */
-  void DoResolve (std::string path, Ptr<Object> root);
+  void DoResolve (std::size_t i, Ptr<Object> root);
   /**
    * Parse an index on the Config path.
    *
-   * \param [in] path The remaining Config path.
-   * \param [in,out] vector The resulting list of matching objects.
+   * \param [in] i The index of the index element.
+   * \param [in] root The object holding the container.
+   * \param [in] step The container attribute.
    */
-  void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  void DoArrayResolve (std::size_t i, Ptr<Object> root, const CompiledPath::Step &step);
+  /**
+   * Descend to the next object on the Config path.
+   *
+   * \param [in] item The Config path token for the object.
+   * \param [in] i The index of the element after the object.
+   * \param [in] object The object.
+   */
+  void Push (const std::string &item, std::size_t i, Ptr<Object> object);
   /**
    * Handle one object found on the path.
    *
@@ -353,45 +725,35 @@ private:
    * Handle one found object.
    *
    * \param [in] object The found object.
-   * \param [in] path The matching Config path context.
+   * \param [in] path The matching Config path context, or an empty
+   *             string if the contexts are not built.
    */
   virtual void DoOne (Ptr<Object> object, std::string path) = 0;
 
   /** Current list of path tokens. */
   std::vector<std::string> m_workStack;
-  /** The Config path. */
-  std::string m_path;
+  /** The parsed Config path. */
+  Ptr<CompiledPath> m_path;
+  /** Whether to build the matching Config paths. */
+  bool m_withContext;
 
 };  // class Resolver
 
 Resolver::Resolver (std::string path)
-  : m_path (path)
+  : m_path (Create<CompiledPath> (path, "")),
+    m_withContext (true)
 {
   NS_LOG_FUNCTION (this << path);
-  Canonicalize ();
 }
-Resolver::~Resolver ()
+Resolver::Resolver (Ptr<CompiledPath> path, bool withContext)
+  : m_path (path),
+    m_withContext (withContext)
 {
-  NS_LOG_FUNCTION (this);
+  NS_LOG_FUNCTION (this << path << withContext);
 }
-void
-Resolver::Canonicalize (void)
+Resolver::~Resolver ()
 {
   NS_LOG_FUNCTION (this);
-
-  // ensure that we start and end with a '/'
-  std::string::size_type tmp = m_path.find ("/");
-  if (tmp != 0)
-    {
-      // no slash at start
-      m_path = "/" + m_path;
-    }
-  tmp = m_path.find_last_of ("/");
-  if (tmp != (m_path.size () - 1))
-    {
-      // no slash at end
-      m_path = m_path + "/";
-    }
 }
 
 void
@@ -399,7 +761,7 @@ Resolver::Resolve (Ptr<Object> root)
 {
   NS_LOG_FUNCTION (this << root);
 
-  DoResolve (m_path, root);
+  DoResolve (0, root);
 }
 
 std::string
@@ -420,18 +782,29 @@ Resolver::DoResolveOne (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
+  if (!m_withContext)
+    {
+      DoOne (object, "");
+      return;
+    }
   NS_LOG_DEBUG ("resolved=" << GetResolvedPath ());
   DoOne (object, GetResolvedPath ());
 }
 
 void
-Resolver::DoResolve (std::string path, Ptr<Object> root)
+Resolver::Push (const std::string &item, std::size_t i, Ptr<Object> object)
+{
+  m_workStack.push_back (item);
+  DoResolve (i, object);
+  m_workStack.pop_back ();
+}
+
+void
+Resolver::DoResolve (std::size_t i, Ptr<Object> root)
 {
-  NS_LOG_FUNCTION (this << path << root);
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
+  NS_LOG_FUNCTION (this << i << root);
 
-  if (next == std::string::npos)
+  if (i == m_path->GetElementN ())
     {
       //
       // If root is zero, we're beginning to see if we can use the object name
@@ -447,8 +820,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
         }
       return;
     }
-  std::string item = path.substr (1, next - 1);
-  std::string pathLeft = path.substr (next, path.size () - next);
+  CompiledPath::Element &element = m_path->GetElement (i);
 
   //
   // If root is zero, we're beginning to see if we can use the object name
@@ -457,16 +829,10 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   // the root of the "/Names" namespace, so we just ignore it and move on to
   // the next segment.
   //
-  if (root == 0)
+  if (root == 0 && element.isNames)
     {
-      std::string::size_type offset = path.find ("/Names");
-      if (offset == 0)
-        {
-          m_workStack.push_back (item);
-          DoResolve (pathLeft, root);
-          m_workStack.pop_back ();
-          return;
-        }
+      Push (element.item, i + 1, root);
+      return;
     }
 
   //
@@ -475,13 +841,11 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   // zero, this means to look in the root of the "/Names" name space, otherwise
   // it refers to a name space context (level).
   //
-  Ptr<Object> namedObject = Names::Find<Object> (root, item);
+  Ptr<Object> namedObject = Names::Find<Object> (root, element.item);
   if (namedObject)
     {
-      NS_LOG_DEBUG ("Name system resolved item = " << item << " to " << namedObject);
-      m_workStack.push_back (item);
-      DoResolve (pathLeft, namedObject);
-      m_workStack.pop_back ();
+      NS_LOG_DEBUG ("Name system resolved item = " << element.item << " to " << namedObject);
+      Push (element.item, i + 1, namedObject);
       return;
     }
 
@@ -496,120 +860,164 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       return;
     }
-  std::string::size_type dollarPos = item.find ("$");
-  if (dollarPos == 0)
+  if (element.isTypeId)
     {
       // This is a call to GetObject
-      std::string tidString = item.substr (1, item.size () - 1);
-      NS_LOG_DEBUG ("GetObject=" << tidString << " on path=" << GetResolvedPath ());
-      TypeId tid = TypeId::LookupByName (tidString);
-      Ptr<Object> object = root->GetObject<Object> (tid);
+      if (!element.hasTypeId)
+        {
+          element.tid = TypeId::LookupByName (element.item.substr (1, element.item.size () - 1));
+          element.hasTypeId = true;
+        }
+      NS_LOG_DEBUG ("GetObject=" << element.tid.GetName () << " on path=" << GetResolvedPath ());
+      Ptr<Object> object = root->GetObject<Object> (element.tid);
       if (object == 0)
         {
-          NS_LOG_DEBUG ("GetObject (" << tidString << ") failed on path=" << GetResolvedPath ());
+          NS_LOG_DEBUG ("GetObject (" << element.tid.GetName () << ") failed on path=" << GetResolvedPath ());
           return;
         }
-      m_workStack.push_back (item);
-      DoResolve (pathLeft, object);
-      m_workStack.pop_back ();
+      Push (element.item, i + 1, object);
+      return;
     }
-  else
-    {
-      // this is a normal attribute.
-      TypeId tid;
-      TypeId nextTid = root->GetInstanceTypeId ();
-      bool foundMatch = false;
 
-      do
+  // this is a normal attribute.
+  const std::vector<CompiledPath::Step> &steps = m_path->GetSteps (i, root->GetInstanceTypeId ());
+  for (std::vector<CompiledPath::Step>::const_iterator step = steps.begin (); step != steps.end (); ++step)
+    {
+      if (!step->isContainer)
         {
-          tid = nextTid;
-
-          for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+          NS_LOG_DEBUG ("GetAttribute(ptr)=" << step->name << " on path=" << GetResolvedPath ());
+          PointerValue pValue;
+          if (!step->gettable || !step->accessor->Get (PeekPointer (root), pValue))
             {
-              struct TypeId::AttributeInformation info;
-              info = tid.GetAttribute (i);
-              if (info.name != item && item != "*")
-                {
-                  continue;
-                }
-              // attempt to cast to a pointer checker.
-              const PointerChecker *pChecker = dynamic_cast<const PointerChecker *> (PeekPointer (info.checker));
-              if (pChecker != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(ptr)=" << info.name << " on path=" << GetResolvedPath ());
-                  PointerValue pValue;
-                  root->GetAttribute (info.name, pValue);
-                  Ptr<Object> object = pValue.Get<Object> ();
-                  if (object == 0)
-                    {
-                      NS_LOG_ERROR ("Requested object name=\"" << item <<
-                                    "\" exists on path=\"" << GetResolvedPath () << "\""
-                                    " but is null.");
-                      continue;
-                    }
-                  foundMatch = true;
-                  m_workStack.push_back (info.name);
-                  DoResolve (pathLeft, object);
-                  m_workStack.pop_back ();
-                }
-              // attempt to cast to an object vector.
-              const ObjectPtrContainerChecker *vectorChecker =
-                dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
-              if (vectorChecker != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(vector)=" << info.name << " on path=" << GetResolvedPath () << pathLeft);
-                  foundMatch = true;
-                  ObjectPtrContainerValue vector;
-                  root->GetAttribute (info.name, vector);
-                  m_workStack.push_back (info.name);
-                  DoArrayResolve (pathLeft, vector);
-                  m_workStack.pop_back ();
-                }
-              // this could be anything else and we don't know what to do with it.
-              // So, we just ignore it.
+              // let ObjectBase::GetAttribute raise any errors
+              root->GetAttribute (step->name, pValue);
             }
-
-          nextTid = tid.GetParent ();
+          Ptr<Object> object = pValue.Get<Object> ();
+          if (object == 0)
+            {
+              NS_LOG_ERROR ("Requested object name=\"" << element.item <<
+                            "\" exists on path=\"" << GetResolvedPath () << "\""
+                            " but is null.");
+              continue;
+            }
+          Push (step->name, i + 1, object);
         }
-      while (nextTid != tid);
-
-      if (!foundMatch)
+      else
         {
-          NS_LOG_DEBUG ("Requested item=" << item << " does not exist on path=" << GetResolvedPath ());
-          return;
+          NS_LOG_DEBUG ("GetAttribute(vector)=" << step->name << " on path=" << GetResolvedPath ());
+          m_workStack.push_back (step->name);
+          DoArrayResolve (i + 1, root, *step);
+          m_workStack.pop_back ();
         }
     }
+  if (steps.empty ())
+    {
+      NS_LOG_DEBUG ("Requested item=" << element.item << " does not exist on path=" << GetResolvedPath ());
+    }
 }
 
 void
-Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &container)
+Resolver::DoArrayResolve (std::size_t i, Ptr<Object> root, const CompiledPath::Step &step)
 {
-  NS_LOG_FUNCTION (this << path << &container);
-  NS_ASSERT (path != "");
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
-  if (next == std::string::npos)
+  NS_LOG_FUNCTION (this << i << root << step.name);
+  if (i == m_path->GetElementN ())
     {
       return;
     }
-  std::string item = path.substr (1, next - 1);
-  std::string pathLeft = path.substr (next, path.size () - next);
+  const CompiledPath::Element &element = m_path->GetElement (i);
+
+  if (element.hasIndices && step.gettable && step.container != 0)
+    {
+      // Fetch explicit indices directly when the container position of
+      // each item is its index, as for an ObjectVector.
+      std::size_t n;
+      if (!step.container->GetItemN (PeekPointer (root), &n))
+        {
+          return;
+        }
+      std::vector<std::pair<std::size_t, Ptr<Object> > > items;
+      bool direct = true;
+      for (std::vector<CompiledPath::IndexRange>::const_iterator range = element.indices.begin ();
+           direct && range != element.indices.end () && range->first < n; ++range)
+        {
+          for (std::size_t k = range->first; k <= range->second && k < n; k++)
+            {
+              std::size_t index;
+              Ptr<Object> object = step.container->GetItem (PeekPointer (root), k, &index);
+              if (index != k)
+                {
+                  direct = false;
+                  break;
+                }
+              items.push_back (std::make_pair (index, object));
+            }
+        }
+      if (direct)
+        {
+          for (std::size_t j = 0; j < items.size (); j++)
+            {
+              std::ostringstream oss;
+              oss << items[j].first;
+              Push (oss.str (), i + 1, items[j].second);
+            }
+          return;
+        }
+    }
 
-  ArrayMatcher matcher = ArrayMatcher (item);
-  ObjectPtrContainerValue::Iterator it;
-  for (it = container.Begin (); it != container.End (); ++it)
+  ObjectPtrContainerValue container;
+  if (!step.gettable || !step.accessor->Get (PeekPointer (root), container))
+    {
+      root->GetAttribute (step.name, container);
+    }
+  ArrayMatcher matcher = ArrayMatcher (element.item);
+  for (ObjectPtrContainerValue::Iterator it = container.Begin (); it != container.End (); ++it)
     {
       if (matcher.Matches ((*it).first))
         {
           std::ostringstream oss;
           oss << (*it).first;
-          m_workStack.push_back (oss.str ());
-          DoResolve (pathLeft, (*it).second);
-          m_workStack.pop_back ();
+          Push (oss.str (), i + 1, (*it).second);
         }
     }
 }
 
+/**
+ * \ingroup config-impl
+ * Resolver which collects the objects found and their Config paths.
+ */
+class LookupMatchesResolver : public Resolver
+{
+public:
+  /**
+   * Construct from a base Config path.
+   *
+   * \param [in] path The Config path.
+   */
+  LookupMatchesResolver (std::string path)
+    : Resolver (path)
+  {}
+  /**
+   * Construct from a parsed Config path.
+   *
+   * \param [in] path The parsed Config path.
+   * \param [in] withContext Whether to collect the Config paths.
+   */
+  LookupMatchesResolver (Ptr<CompiledPath> path, bool withContext)
+    : Resolver (path, withContext)
+  {}
+  /** The objects found. */
+  std::vector<Ptr<Object> > m_objects;
+  /** The Config paths of the objects found. */
+  std::vector<std::string> m_contexts;
+
+private:
+  virtual void DoOne (Ptr<Object> object, std::string path)
+  {
+    m_objects.push_back (object);
+    m_contexts.push_back (path);
+  }
+};  // class LookupMatchesResolver
+
 /**
  * \ingroup config-impl
  * Config system implementation class.
@@ -633,6 +1041,14 @@ public:
   void Disconnect (std::string path, const CallbackBase &cb);
   /** \copydoc Config::LookupMatches() */
   MatchContainer LookupMatches (std::string path);
+  /**
+   * Find the objects matched by a parsed Config path.
+   *
+   * \param [in] path The parsed Config path.
+   * \param [in] withContext Whether to build the matched paths.
+   * \returns The matching objects.
+   */
+  MatchContainer LookupMatches (Ptr<CompiledPath> path, bool withContext);
 
   /** \copydoc Config::RegisterRootNamespaceObject() */
   void RegisterRootNamespaceObject (Ptr<Object> obj);
@@ -653,6 +1069,13 @@ private:
    * \param [in,out] leaf The trailing part of the \pname{path}.
    */
   void ParsePath (std::string path, std::string *root, std::string *leaf) const;
+  /**
+   * Resolve a Config path from the root namespace objects and the
+   * "/Names" namespace.
+   *
+   * \param [in,out] resolver The resolver of the Config path.
+   */
+  void Resolve (Resolver &resolver) const;
 
   /** Container type to hold the root Config path tokens. */
   typedef std::vector<Ptr<Object> > Roots;
@@ -747,25 +1170,10 @@ ConfigImpl::Disconnect (std::string path, const CallbackBase &cb)
   container.Disconnect (leaf, cb);
 }
 
-MatchContainer
-ConfigImpl::LookupMatches (std::string path)
+void
+ConfigImpl::Resolve (Resolver &resolver) const
 {
-  NS_LOG_FUNCTION (this << path);
-  class LookupMatchesResolver : public Resolver
-  {
-public:
-    LookupMatchesResolver (std::string path)
-      : Resolver (path)
-    {
-    }
-    virtual void DoOne (Ptr<Object> object, std::string path)
-    {
-      m_objects.push_back (object);
-      m_contexts.push_back (path);
-    }
-    std::vector<Ptr<Object> > m_objects;
-    std::vector<std::string> m_contexts;
-  } resolver = LookupMatchesResolver (path);
+  NS_LOG_FUNCTION (this << &resolver);
   for (Roots::const_iterator i = m_roots.begin (); i != m_roots.end (); i++)
     {
       resolver.Resolve (*i);
@@ -777,10 +1185,26 @@ public:
   // looking at the root of the "/Names" namespace during this go.
   //
   resolver.Resolve (0);
+}
 
+MatchContainer
+ConfigImpl::LookupMatches (std::string path)
+{
+  NS_LOG_FUNCTION (this << path);
+  LookupMatchesResolver resolver (path);
+  Resolve (resolver);
   return MatchContainer (resolver.m_objects, resolver.m_contexts, path);
 }
 
+MatchContainer
+ConfigImpl::LookupMatches (Ptr<CompiledPath> path, bool withContext)
+{
+  NS_LOG_FUNCTION (this << path << withContext);
+  LookupMatchesResolver resolver (path, withContext);
+  Resolve (resolver);
+  return MatchContainer (resolver.m_objects, resolver.m_contexts, path->GetRootPath ());
+}
+
 void
 ConfigImpl::RegisterRootNamespaceObject (Ptr<Object> obj)
 {
@@ -817,6 +1241,191 @@ ConfigImpl::GetRootNamespaceObject (std::size_t i) const
 }
 
 
+PathHandle::PathHandle ()
+  : m_path (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+PathHandle::PathHandle (std::string path)
+{
+  NS_LOG_FUNCTION (this << path);
+  std::string::size_type slash = path.find_last_of ("/");
+  NS_ASSERT (slash != std::string::npos);
+  m_path = Create<CompiledPath> (path.substr (0, slash),
+                                 path.substr (slash + 1, path.size () - (slash + 1)));
+}
+PathHandle::PathHandle (const PathHandle &o)
+  : m_path (o.m_path)
+{
+  NS_LOG_FUNCTION (this << &o);
+}
+PathHandle &
+PathHandle::operator = (const PathHandle &o)
+{
+  NS_LOG_FUNCTION (this << &o);
+  m_path = o.m_path;
+  return *this;
+}
+PathHandle::~PathHandle ()
+{
+  NS_LOG_FUNCTION (this);
+}
+std::string
+PathHandle::GetPath (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_path == 0 ? "" : m_path->GetPath ();
+}
+MatchContainer
+PathHandle::LookupMatches (void) const
+{
+  NS_LOG_FUNCTION (this);
+  if (m_path == 0)
+    {
+      return MatchContainer ();
+    }
+  return ConfigImpl::Get ()->LookupMatches (m_path, true);
+}
+void
+PathHandle::Set (const AttributeValue &value) const
+{
+  NS_LOG_FUNCTION (this << &value);
+  if (m_path == 0)
+    {
+      return;
+    }
+  MatchContainer container = ConfigImpl::Get ()->LookupMatches (m_path, false);
+  for (MatchContainer::Iterator i = container.Begin (); i != container.End (); ++i)
+    {
+      if (!m_path->SetLeaf (*i, value))
+        {
+          // Let ObjectBase::SetAttribute raise any errors
+          (*i)->SetAttribute (m_path->GetLeaf (), value);
+        }
+    }
+}
+bool
+PathHandle::SetFailSafe (const AttributeValue &value) const
+{
+  NS_LOG_FUNCTION (this << &value);
+  if (m_path == 0)
+    {
+      return false;
+    }
+  MatchContainer container = ConfigImpl::Get ()->LookupMatches (m_path, false);
+  bool ok = false;
+  for (MatchContainer::Iterator i = container.Begin (); i != container.End (); ++i)
+    {
+      ok |= m_path->SetLeaf (*i, value);
+    }
+  return ok;
+}
+void
+PathHandle::Connect (const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << &cb);
+  if (!ConnectFailSafe (cb))
+    {
+      NS_FATAL_ERROR ("Could not connect callback to " << GetPath ());
+    }
+}
+bool
+PathHandle::ConnectFailSafe (const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << &cb);
+  if (m_path == 0)
+    {
+      return false;
+    }
+  MatchContainer container = ConfigImpl::Get ()->LookupMatches (m_path, true);
+  bool ok = false;
+  for (std::size_t i = 0; i < container.GetN (); ++i)
+    {
+      Ptr<Object> object = container.Get (i);
+      Ptr<const TraceSourceAccessor> accessor = m_path->LookupLeafTraceSource (object);
+      if (accessor != 0)
+        {
+          ok |= accessor->Connect (PeekPointer (object), container.GetMatchedPath (i) + m_path->GetLeaf (), cb);
+        }
+    }
+  return ok;
+}
+void
+PathHandle::ConnectWithoutContext (const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << &cb);
+  if (!ConnectWithoutContextFailSafe (cb))
+    {
+      NS_FATAL_ERROR ("Could not connect callback to " << GetPath ());
+    }
+}
+bool
+PathHandle::ConnectWithoutContextFailSafe (const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << &cb);
+  if (m_path == 0)
+    {
+      return false;
+    }
+  MatchContainer container = ConfigImpl::Get ()->LookupMatches (m_path, false);
+  bool ok = false;
+  for (MatchContainer::Iterator i = container.Begin (); i != container.End (); ++i)
+    {
+      Ptr<const TraceSourceAccessor> accessor = m_path->LookupLeafTraceSource (*i);
+      if (accessor != 0)
+        {
+          ok |= accessor->ConnectWithoutContext (PeekPointer (*i), cb);
+        }
+    }
+  return ok;
+}
+void
+PathHandle::Disconnect (const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << &cb);
+  if (m_path == 0)
+    {
+      return;
+    }
+  MatchContainer container = ConfigImpl::Get ()->LookupMatches (m_path, true);
+  if (container.GetN () == 0)
+    {
+      NS_LOG_WARN ("Failed to disconnect from " << GetPath () << ", no object matches the path");
+    }
+  for (std::size_t i = 0; i < container.GetN (); ++i)
+    {
+      Ptr<Object> object = container.Get (i);
+      Ptr<const TraceSourceAccessor> accessor = m_path->LookupLeafTraceSource (object);
+      if (accessor != 0)
+        {
+          accessor->Disconnect (PeekPointer (object), container.GetMatchedPath (i) + m_path->GetLeaf (), cb);
+        }
+    }
+}
+void
+PathHandle::DisconnectWithoutContext (const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << &cb);
+  if (m_path == 0)
+    {
+      return;
+    }
+  MatchContainer container = ConfigImpl::Get ()->LookupMatches (m_path, false);
+  if (container.GetN () == 0)
+    {
+      NS_LOG_WARN ("Failed to disconnect from " << GetPath () << ", no object matches the path");
+    }
+  for (MatchContainer::Iterator i = container.Begin (); i != container.End (); ++i)
+    {
+      Ptr<const TraceSourceAccessor> accessor = m_path->LookupLeafTraceSource (*i);
+      if (accessor != 0)
+        {
+          accessor->DisconnectWithoutContext (PeekPointer (*i), cb);
+        }
+    }
+}
+
+
 void Reset (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -306,6 +306,121 @@ private:
   std::string m_path;
 };
 
+/** The parsed path of a PathHandle and its lookup caches. */
+class CompiledPath;
+
+/**
+ * \ingroup config
+ * \brief a Config path parsed once, for repeated Set and Connect operations.
+ *
+ * Config::Set and Config::Connect parse their path on each call, and
+ * look up the attributes named by each path element on each object
+ * they traverse.  A PathHandle parses the path once: it looks up the
+ * TypeId of the \c $ elements and parses the index matchers of the
+ * container elements at construction, and caches the attributes
+ * matched by each element, as well as the attribute or trace source
+ * of the last element, for each type of object it meets.  The path is
+ * resolved by the same code as Config::Set, so the handle matches the
+ * same objects.
+ *
+ * Each operation still resolves the path against the current object
+ * graph, in a single traversal from the root namespace objects, so
+ * that a handle remains valid when nodes or devices are added.
+ * Handles are cheap to copy, and copies share their caches.
+ *
+ * \code
+ *   Config::PathHandle cwnd ("/NodeList/[0-99]/$ns3::TcpL4Protocol/SocketList/0/CongestionWindow");
+ *   for (...)
+ *     {
+ *       cwnd.ConnectWithoutContext (MakeCallback (&CwndChange));
+ *     }
+ * \endcode
+ */
+class PathHandle
+{
+public:
+  /** Create an empty handle, which matches no object. */
+  PathHandle ();
+  /**
+   * Parse a Config path.
+   *
+   * \param [in] path The path, whose last element is the name of an
+   *             attribute or trace source, as for Config::Set and
+   *             Config::Connect.
+   */
+  PathHandle (std::string path);
+  /**
+   * Copy constructor.
+   * \param [in] o The handle to copy.
+   */
+  PathHandle (const PathHandle &o);
+  /**
+   * Assignment.
+   * \param [in] o The handle to copy.
+   * \returns This handle.
+   */
+  PathHandle &operator = (const PathHandle &o);
+  /** Destructor. */
+  ~PathHandle ();
+
+  /**
+   * \returns The path of this handle.
+   */
+  std::string GetPath (void) const;
+  /**
+   * \returns The objects matched by the path without its last element.
+   */
+  MatchContainer LookupMatches (void) const;
+
+  /**
+   * \param [in] value The value to set in all matching attributes.
+   * \sa Config::Set
+   */
+  void Set (const AttributeValue &value) const;
+  /**
+   * \param [in] value The value to set in all matching attributes.
+   * \returns \c true if any matching attributes could be set.
+   * \sa Config::SetFailSafe
+   */
+  bool SetFailSafe (const AttributeValue &value) const;
+  /**
+   * \param [in] cb The callback to connect to the matching trace sources.
+   * \sa Config::Connect
+   */
+  void Connect (const CallbackBase &cb) const;
+  /**
+   * \param [in] cb The callback to connect to the matching trace sources.
+   * \returns \c true if any trace sources could be connected.
+   * \sa Config::ConnectFailSafe
+   */
+  bool ConnectFailSafe (const CallbackBase &cb) const;
+  /**
+   * \param [in] cb The callback to connect to the matching trace sources.
+   * \sa Config::ConnectWithoutContext
+   */
+  void ConnectWithoutContext (const CallbackBase &cb) const;
+  /**
+   * \param [in] cb The callback to connect to the matching trace sources.
+   * \returns \c true if any trace sources could be connected.
+   * \sa Config::ConnectWithoutContextFailSafe
+   */
+  bool ConnectWithoutContextFailSafe (const CallbackBase &cb) const;
+  /**
+   * \param [in] cb The callback to disconnect from the matching trace sources.
+   * \sa Config::Disconnect
+   */
+  void Disconnect (const CallbackBase &cb) const;
+  /**
+   * \param [in] cb The callback to disconnect from the matching trace sources.
+   * \sa Config::DisconnectWithoutContext
+   */
+  void DisconnectWithoutContext (const CallbackBase &cb) const;
+
+private:
+  /** The parsed path, shared by the copies of this handle. */
+  Ptr<CompiledPath> m_path;
+};
+
 /**
  * \ingroup config
  * \param [in] path The path to perform a match against
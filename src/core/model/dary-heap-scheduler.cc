@@ -0,0 +1,295 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "dary-heap-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+
+#include <cstring>
+#include <new>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::DaryHeapScheduler class.
+ */
+
+#if defined (__GNUC__)
+/** Prefetch a cache line for reading. */
+#define DARY_HEAP_PREFETCH(addr) __builtin_prefetch (addr)
+#else
+#define DARY_HEAP_PREFETCH(addr)
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DaryHeapScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (DaryHeapScheduler);
+
+namespace {
+
+/** Number of children of each node. */
+const std::size_t ARITY = 4;
+/**
+ * Index of the root: with the root at ARITY - 1, the children of any
+ * node start at a multiple of ARITY.
+ */
+const std::size_t ROOT = ARITY - 1;
+/** Alignment of the key array: one cache line holds ARITY keys. */
+const std::size_t ALIGNMENT = 64;
+/** Initial capacity of the arrays. */
+const std::size_t INITIAL_CAPACITY = 64;
+
+} // unnamed namespace
+
+TypeId
+DaryHeapScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DaryHeapScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<DaryHeapScheduler> ()
+  ;
+  return tid;
+}
+
+DaryHeapScheduler::DaryHeapScheduler ()
+  : m_keys (0),
+    m_impls (0),
+    m_keysBuffer (0),
+    m_capacity (0),
+    m_end (ROOT)
+{
+  NS_LOG_FUNCTION (this);
+  Grow ();
+}
+
+DaryHeapScheduler::~DaryHeapScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+  ::operator delete (m_keysBuffer);
+  delete [] m_impls;
+}
+
+void
+DaryHeapScheduler::Grow (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::size_t capacity = m_capacity == 0 ? INITIAL_CAPACITY : 2 * m_capacity;
+  void *buffer = ::operator new (capacity * sizeof (EventKey) + ALIGNMENT);
+  uintptr_t address = reinterpret_cast<uintptr_t> (buffer);
+  address = (address + ALIGNMENT - 1) & ~(uintptr_t (ALIGNMENT) - 1);
+  EventKey *keys = reinterpret_cast<EventKey *> (address);
+  EventImpl **impls = new EventImpl *[capacity];
+  if (m_capacity != 0)
+    {
+      std::memcpy (keys, m_keys, m_end * sizeof (EventKey));
+      std::memcpy (impls, m_impls, m_end * sizeof (EventImpl *));
+      ::operator delete (m_keysBuffer);
+      delete [] m_impls;
+    }
+  m_keysBuffer = buffer;
+  m_keys = keys;
+  m_impls = impls;
+  m_capacity = capacity;
+}
+
+bool
+DaryHeapScheduler::IsLess (const EventKey &a, const EventKey &b)
+{
+  return a.m_ts < b.m_ts || (a.m_ts == b.m_ts && a.m_uid < b.m_uid);
+}
+
+std::size_t
+DaryHeapScheduler::Parent (std::size_t id)
+{
+  return id / ARITY + ROOT - 1;
+}
+
+std::size_t
+DaryHeapScheduler::FirstChild (std::size_t id)
+{
+  return ARITY * (id - ROOT + 1);
+}
+
+void
+DaryHeapScheduler::SiftUp (std::size_t id, const EventKey &key, EventImpl *impl)
+{
+  while (id > ROOT)
+    {
+      std::size_t parent = Parent (id);
+      if (!IsLess (key, m_keys[parent]))
+        {
+          break;
+        }
+      m_keys[id] = m_keys[parent];
+      m_impls[id] = m_impls[parent];
+      id = parent;
+    }
+  m_keys[id] = key;
+  m_impls[id] = impl;
+}
+
+void
+DaryHeapScheduler::SiftDown (std::size_t id, const EventKey &key, EventImpl *impl)
+{
+  while (true)
+    {
+      std::size_t first = FirstChild (id);
+      if (first >= m_end)
+        {
+          break;
+        }
+      std::size_t last = first + ARITY < m_end ? first + ARITY : m_end;
+      // The children of the next level are four cache lines, one of
+      // which will be needed: start loading them now.
+      std::size_t next = FirstChild (first);
+      for (std::size_t i = 0; i < ARITY && next + i * ARITY < m_end; ++i)
+        {
+          DARY_HEAP_PREFETCH (&m_keys[next + i * ARITY]);
+        }
+      std::size_t best = first;
+      for (std::size_t child = first + 1; child < last; ++child)
+        {
+          if (IsLess (m_keys[child], m_keys[best]))
+            {
+              best = child;
+            }
+        }
+      if (!IsLess (m_keys[best], key))
+        {
+          break;
+        }
+      m_keys[id] = m_keys[best];
+      m_impls[id] = m_impls[best];
+      id = best;
+    }
+  m_keys[id] = key;
+  m_impls[id] = impl;
+}
+
+void
+DaryHeapScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  if (m_end == m_capacity)
+    {
+      Grow ();
+    }
+  m_end++;
+  SiftUp (m_end - 1, ev.key, ev.impl);
+}
+
+bool
+DaryHeapScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_end == ROOT;
+}
+
+Scheduler::Event
+DaryHeapScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  Scheduler::Event ev;
+  ev.impl = m_impls[ROOT];
+  ev.key = m_keys[ROOT];
+  return ev;
+}
+
+Scheduler::Event
+DaryHeapScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  Scheduler::Event ev;
+  ev.impl = m_impls[ROOT];
+  ev.key = m_keys[ROOT];
+  m_end--;
+  if (m_end > ROOT)
+    {
+      SiftDown (ROOT, m_keys[m_end], m_impls[m_end]);
+    }
+  return ev;
+}
+
+void
+DaryHeapScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  for (std::size_t i = ROOT; i < m_end; ++i)
+    {
+      if (m_keys[i].m_uid == ev.key.m_uid)
+        {
+          NS_ASSERT (m_impls[i] == ev.impl);
+          m_end--;
+          if (i == m_end)
+            {
+              return;
+            }
+          // move the last item into the hole, up or down
+          EventKey key = m_keys[m_end];
+          EventImpl *impl = m_impls[m_end];
+          if (i > ROOT && IsLess (key, m_keys[Parent (i)]))
+            {
+              SiftUp (i, key, impl);
+            }
+          else
+            {
+              SiftDown (i, key, impl);
+            }
+          return;
+        }
+    }
+  NS_ASSERT (false);
+}
+
+uint32_t
+DaryHeapScheduler::Compact (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::size_t last = ROOT;
+  for (std::size_t i = ROOT; i < m_end; ++i)
+    {
+      if (m_impls[i]->IsCancelled ())
+        {
+          m_impls[i]->Unref ();
+        }
+      else
+        {
+          m_keys[last] = m_keys[i];
+          m_impls[last] = m_impls[i];
+          last++;
+        }
+    }
+  uint32_t removed = m_end - last;
+  m_end = last;
+  if (m_end > ROOT + 1)
+    {
+      // rebuild the heap from the lowest parents up
+      for (std::size_t i = Parent (m_end - 1) + 1; i-- > ROOT; )
+        {
+          EventKey key = m_keys[i];
+          SiftDown (i, key, m_impls[i]);
+        }
+    }
+  return removed;
+}
+
+} // namespace ns3
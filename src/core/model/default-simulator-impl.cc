@@ -25,10 +25,19 @@
 
 #include "ptr.h"
 #include "pointer.h"
+#include "uinteger.h"
+#include "double.h"
+#include "boolean.h"
+#include "string.h"
+#include "abort.h"
 #include "assert.h"
 #include "log.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <fstream>
+#include <iostream>
 
 
 /**
@@ -46,6 +55,23 @@ NS_LOG_COMPONENT_DEFINE ("DefaultSimulatorImpl");
 
 NS_OBJECT_ENSURE_REGISTERED (DefaultSimulatorImpl);
 
+/**
+ * \ingroup simulator
+ * Per-thread cache of the injection counters, valid for the
+ * DefaultSimulatorImpl instance with the same serial number.
+ */
+struct InjectionCountersCache
+{
+  uint64_t serial;   //!< Serial number of the owning instance.
+  void *counters;    //!< The counters of the thread in this instance.
+};
+
+/** The injection counters of the calling thread. */
+static thread_local InjectionCountersCache g_injectionCounters = {0, 0};
+
+/** Serial number of the last DefaultSimulatorImpl instance created. */
+static std::atomic<uint64_t> g_defaultSimulatorImplSerial (0);
+
 TypeId
 DefaultSimulatorImpl::GetTypeId (void)
 {
@@ -53,6 +79,45 @@ DefaultSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Core")
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("InjectionQueueSize",
+                   "Capacity of the lock-free ring of the events scheduled "
+                   "from other threads (rounded up to a power of two); "
+                   "events which do not fit, and the later events of the "
+                   "same thread until they are consumed, go through a "
+                   "locked list.",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&DefaultSimulatorImpl::SetInjectionQueueSize,
+                                         &DefaultSimulatorImpl::GetInjectionQueueSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("CompactionThreshold",
+                   "Fraction of cancelled events in the event list above "
+                   "which they are removed from it; 1 disables the compaction.",
+                   DoubleValue (0.5),
+                   MakeDoubleAccessor (&DefaultSimulatorImpl::m_compactionThreshold),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("CompactionMinimum",
+                   "Smallest number of cancelled events for which the event "
+                   "list is compacted.",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&DefaultSimulatorImpl::m_compactionMinimum),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Profile",
+                   "Measure the wall clock time of each event, and print the "
+                   "hot spots by event target and context at Simulator::Destroy.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&DefaultSimulatorImpl::SetProfile,
+                                        &DefaultSimulatorImpl::GetProfile),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ProfileFile",
+                   "The file of the profile report; the standard output if empty.",
+                   StringValue (""),
+                   MakeStringAccessor (&DefaultSimulatorImpl::m_profileFile),
+                   MakeStringChecker ())
+    .AddAttribute ("ProfileRows",
+                   "Maximum number of rows of each table of the profile report.",
+                   UintegerValue (20),
+                   MakeUintegerAccessor (&DefaultSimulatorImpl::m_profileRows),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
@@ -71,14 +136,25 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentTs = 0;
   m_currentContext = Simulator::NO_CONTEXT;
   m_unscheduledEvents = 0;
+  m_cancelledEvents = 0;
+  m_compactionThreshold = 0.5;
+  m_compactionMinimum = 1024;
+  m_profiler = 0;
+  m_profileRows = 20;
   m_eventCount = 0;
   m_eventsWithContextEmpty = true;
+  m_injectionMask = 0;
+  m_injectionTail = 0;
+  m_injectionHead = 0;
+  m_serial = ++g_defaultSimulatorImplSerial;
+  SetInjectionQueueSize (1024);
   m_main = SystemThread::Self ();
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl ()
 {
   NS_LOG_FUNCTION (this);
+  delete m_profiler;
 }
 
 void
@@ -109,6 +185,54 @@ DefaultSimulatorImpl::Destroy ()
           ev->Invoke ();
         }
     }
+  if (m_profiler != 0)
+    {
+      PrintProfile ();
+    }
+}
+
+void
+DefaultSimulatorImpl::SetProfile (bool profile)
+{
+  NS_LOG_FUNCTION (this << profile);
+  if (profile && m_profiler == 0)
+    {
+      m_profiler = new EventProfiler ();
+    }
+  else if (!profile)
+    {
+      delete m_profiler;
+      m_profiler = 0;
+    }
+}
+
+bool
+DefaultSimulatorImpl::GetProfile (void) const
+{
+  return m_profiler != 0;
+}
+
+const EventProfiler *
+DefaultSimulatorImpl::GetProfiler (void) const
+{
+  return m_profiler;
+}
+
+void
+DefaultSimulatorImpl::PrintProfile (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_profileFile.empty ())
+    {
+      m_profiler->Print (std::cout, m_profileRows);
+    }
+  else
+    {
+      std::ofstream os (m_profileFile.c_str ());
+      NS_ABORT_MSG_UNLESS (os.is_open (), "Cannot open the profile file " << m_profileFile);
+      m_profiler->Print (os, m_profileRows);
+    }
+  m_profiler->Clear ();
 }
 
 void
@@ -143,12 +267,29 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   NS_ASSERT (next.key.m_ts >= m_currentTs);
   m_unscheduledEvents--;
   m_eventCount++;
+  if (m_cancelledEvents > 0 && next.impl->IsCancelled ())
+    {
+      m_cancelledEvents--;
+    }
 
   NS_LOG_LOGIC ("handle " << next.key.m_ts);
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (m_profiler == 0 || next.impl->IsCancelled ())
+    {
+      next.impl->Invoke ();
+    }
+  else
+    {
+      // the event may destroy its object, so find its function first
+      const void *function = next.impl->GetFunction ();
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+      next.impl->Invoke ();
+      std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now () - start;
+      m_profiler->Record (function, typeid (*next.impl), next.key.m_context,
+                          std::chrono::duration_cast<std::chrono::nanoseconds> (elapsed).count ());
+    }
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
@@ -160,15 +301,77 @@ DefaultSimulatorImpl::IsFinished (void) const
   return m_events->IsEmpty () || m_stop;
 }
 
+void
+DefaultSimulatorImpl::SetInjectionQueueSize (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  if (m_events != 0)
+    {
+      ProcessEventsWithContext ();
+    }
+  uint64_t capacity = 1;
+  while (capacity < size)
+    {
+      capacity <<= 1;
+    }
+  std::vector<InjectionSlot> ring (capacity);
+  for (uint64_t i = 0; i < capacity; ++i)
+    {
+      ring[i].sequence.store (i, std::memory_order_relaxed);
+    }
+  m_injection.swap (ring);
+  m_injectionMask = capacity - 1;
+  m_injectionTail.store (0, std::memory_order_release);
+  m_injectionHead = 0;
+}
+
+uint32_t
+DefaultSimulatorImpl::GetInjectionQueueSize (void) const
+{
+  return m_injection.size ();
+}
+
 void
 DefaultSimulatorImpl::ProcessEventsWithContext (void)
 {
-  if (m_eventsWithContextEmpty)
+  // Consume the filled slots of the ring, in reservation order.  A
+  // slot reserved but not yet filled by its producer stops the
+  // loop; it will be consumed at the next call.
+  while (true)
+    {
+      InjectionSlot &slot = m_injection[m_injectionHead & m_injectionMask];
+      if (slot.sequence.load (std::memory_order_acquire) != m_injectionHead + 1)
+        {
+          break;
+        }
+      EventWithContext event = slot.event;
+      slot.sequence.store (m_injectionHead + m_injectionMask + 1, std::memory_order_release);
+      m_injectionHead++;
+
+      Scheduler::Event ev;
+      ev.impl = event.event;
+      ev.key.m_ts = m_currentTs + event.timestamp;
+      ev.key.m_context = event.context;
+      ev.key.m_uid = m_uid;
+      m_uid++;
+      m_unscheduledEvents++;
+      m_events->Insert (ev);
+    }
+
+  if (m_eventsWithContextEmpty.load (std::memory_order_acquire))
+    {
+      return;
+    }
+  // A producer may have overflowed after filling a slot which is
+  // still behind a reserved but unfilled one: keep the overflow list
+  // for the next call, so that its events get a higher uid.
+  if (m_injectionTail.load (std::memory_order_acquire) != m_injectionHead)
     {
       return;
     }
 
-  // swap queues
+  // swap queues.  Producers use the ring again only once the flag is
+  // set, so the events queued after an overflow follow it.
   EventsWithContext eventsWithContext;
   {
     CriticalSection cs (m_eventsWithContextMutex);
@@ -190,6 +393,40 @@ DefaultSimulatorImpl::ProcessEventsWithContext (void)
     }
 }
 
+DefaultSimulatorImpl::InjectionCounters *
+DefaultSimulatorImpl::GetInjectionCounters (void)
+{
+  if (g_injectionCounters.serial != m_serial)
+    {
+      CriticalSection cs (m_eventsWithContextMutex);
+      m_injectionCounters.emplace_back ();
+      InjectionCounters &counters = m_injectionCounters.back ();
+      counters.thread = SystemThread::Self ();
+      counters.events.store (0, std::memory_order_relaxed);
+      counters.overflows.store (0, std::memory_order_relaxed);
+      g_injectionCounters.serial = m_serial;
+      g_injectionCounters.counters = &counters;
+    }
+  return static_cast<InjectionCounters *> (g_injectionCounters.counters);
+}
+
+std::vector<DefaultSimulatorImpl::InjectionStats>
+DefaultSimulatorImpl::GetInjectionStats (void) const
+{
+  std::vector<InjectionStats> stats;
+  CriticalSection cs (const_cast<SystemMutex &> (m_eventsWithContextMutex));
+  for (std::list<InjectionCounters>::const_iterator i = m_injectionCounters.begin ();
+       i != m_injectionCounters.end (); ++i)
+    {
+      InjectionStats s;
+      s.thread = i->thread;
+      s.events = i->events.load (std::memory_order_relaxed);
+      s.overflows = i->overflows.load (std::memory_order_relaxed);
+      stats.push_back (s);
+    }
+  return stats;
+}
+
 void
 DefaultSimulatorImpl::Run (void)
 {
@@ -270,6 +507,43 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
       // Current time added in ProcessEventsWithContext()
       ev.timestamp = delay.GetTimeStep ();
       ev.event = event;
+
+      // Each counter is only written by its own thread.
+      InjectionCounters *counters = GetInjectionCounters ();
+      counters->events.store (counters->events.load (std::memory_order_relaxed) + 1,
+                              std::memory_order_relaxed);
+
+      // Reserve a slot of the ring: a slot is free for the sequence
+      // number pos when its own sequence number equals pos.  While
+      // the overflow list is not empty, append to it instead, lest an
+      // event overtakes the events of the same thread queued there.
+      uint64_t pos = m_injectionTail.load (std::memory_order_relaxed);
+      while (m_eventsWithContextEmpty.load (std::memory_order_acquire))
+        {
+          InjectionSlot &slot = m_injection[pos & m_injectionMask];
+          uint64_t sequence = slot.sequence.load (std::memory_order_acquire);
+          if (sequence == pos)
+            {
+              if (m_injectionTail.compare_exchange_weak (pos, pos + 1, std::memory_order_relaxed))
+                {
+                  slot.event = ev;
+                  slot.sequence.store (pos + 1, std::memory_order_release);
+                  return;
+                }
+            }
+          else if (sequence < pos)
+            {
+              // The ring is full.
+              break;
+            }
+          else
+            {
+              pos = m_injectionTail.load (std::memory_order_relaxed);
+            }
+        }
+
+      counters->overflows.store (counters->overflows.load (std::memory_order_relaxed) + 1,
+                                 std::memory_order_relaxed);
       {
         CriticalSection cs (m_eventsWithContextMutex);
         m_eventsWithContext.push_back (ev);
@@ -364,9 +638,29 @@ DefaultSimulatorImpl::Cancel (const EventId &id)
   if (!IsExpired (id))
     {
       id.PeekEventImpl ()->Cancel ();
+      if (id.GetUid () != 2)
+        {
+          m_cancelledEvents++;
+          if (m_compactionThreshold < 1
+              && m_cancelledEvents >= m_compactionMinimum
+              && m_cancelledEvents > m_compactionThreshold * m_unscheduledEvents)
+            {
+              Compact ();
+            }
+        }
     }
 }
 
+void
+DefaultSimulatorImpl::Compact (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t removed = m_events->Compact ();
+  NS_LOG_LOGIC ("removed " << removed << " of " << m_unscheduledEvents << " events");
+  m_unscheduledEvents -= removed;
+  m_cancelledEvents -= std::min<uint64_t> (removed, m_cancelledEvents);
+}
+
 bool
 DefaultSimulatorImpl::IsExpired (const EventId &id) const
 {
@@ -418,4 +712,16 @@ DefaultSimulatorImpl::GetEventCount (void) const
   return m_eventCount;
 }
 
+uint64_t
+DefaultSimulatorImpl::GetLiveEventCount (void) const
+{
+  return m_unscheduledEvents - m_cancelledEvents;
+}
+
+uint64_t
+DefaultSimulatorImpl::GetCancelledEventCount (void) const
+{
+  return m_cancelledEvents;
+}
+
 } // namespace ns3
@@ -24,12 +24,16 @@
 #include "simulator-impl.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "event-profiler.h"
 #include "system-thread.h"
 #include "system-mutex.h"
 
 #include "ptr.h"
 
+#include <atomic>
 #include <list>
+#include <string>
+#include <vector>
 
 /**
  * \file
@@ -78,6 +82,38 @@ public:
   virtual uint32_t GetSystemId (void) const;
   virtual uint32_t GetContext (void) const;
   virtual uint64_t GetEventCount (void) const;
+  virtual uint64_t GetLiveEventCount (void) const;
+  virtual uint64_t GetCancelledEventCount (void) const;
+
+  /**
+   * Get the event profiler, which accumulates the wall clock time of
+   * the events when the \c Profile attribute is set.
+   *
+   * \return The profiler, or 0 if profiling is disabled.
+   */
+  const EventProfiler * GetProfiler (void) const;
+
+  /** Statistics of the events scheduled from one foreign thread. */
+  struct InjectionStats
+  {
+    /** The thread which called ScheduleWithContext. */
+    SystemThread::ThreadId thread;
+    /** Number of events scheduled by this thread. */
+    uint64_t events;
+    /**
+     * Number of those events which went through the locked overflow
+     * list, because the injection ring was full or the list was not
+     * empty yet.
+     */
+    uint64_t overflows;
+  };
+  /**
+   * Get the number of events injected by each thread other than the
+   * main simulation thread through ScheduleWithContext.
+   *
+   * \return The statistics of each thread which injected at least one event.
+   */
+  std::vector<InjectionStats> GetInjectionStats (void) const;
 
 private:
   virtual void DoDispose (void);
@@ -86,6 +122,29 @@ private:
   void ProcessOneEvent (void);
   /** Move events from a different context into the main event queue. */
   void ProcessEventsWithContext (void);
+  /** Remove the cancelled events from the event list. */
+  void Compact (void);
+  /**
+   * Enable or disable the event profiler.
+   *
+   * \param [in] profile \c true to enable the profiler.
+   */
+  void SetProfile (bool profile);
+  /**
+   * \return \c true if the event profiler is enabled.
+   */
+  bool GetProfile (void) const;
+  /** Print the profile report and clear the profiler. */
+  void PrintProfile (void);
+
+  /**
+   * Set the capacity of the ring of events from a different thread.
+   * Must not be called while other threads schedule events.
+   * \param [in] size The capacity, rounded up to a power of two.
+   */
+  void SetInjectionQueueSize (uint32_t size);
+  /** \return The capacity of the ring of events from a different thread. */
+  uint32_t GetInjectionQueueSize (void) const;
 
   /** Wrap an event with its execution context. */
   struct EventWithContext
@@ -97,17 +156,60 @@ private:
     /** The event implementation. */
     EventImpl *event;
   };
+  /**
+   * Slot of the ring of events from a different context.
+   *
+   * The sequence number tells the producers when the slot is free and
+   * the consumer when it has been filled.
+   */
+  struct InjectionSlot
+  {
+    /** Sequence number of the slot. */
+    std::atomic<uint64_t> sequence;
+    /** The event. */
+    EventWithContext event;
+  };
+  /** Counters of one thread injecting events. */
+  struct InjectionCounters
+  {
+    /** The thread. */
+    SystemThread::ThreadId thread;
+    /** Number of events injected. */
+    std::atomic<uint64_t> events;
+    /** Number of events which went through the overflow list. */
+    std::atomic<uint64_t> overflows;
+  };
+  /** \return The counters of the calling thread. */
+  InjectionCounters * GetInjectionCounters (void);
+
+  /**
+   * Bounded multi-producer single-consumer ring of the events
+   * scheduled from other threads; producers reserve a slot with a
+   * compare-and-swap on the tail and never take a lock.
+   */
+  std::vector<InjectionSlot> m_injection;
+  /** Mask to map a sequence number to a slot of the ring. */
+  uint64_t m_injectionMask;
+  /** Next slot to be reserved by a producer. */
+  std::atomic<uint64_t> m_injectionTail;
+  /** Next slot to be read by the main thread. */
+  uint64_t m_injectionHead;
+
   /** Container type for the events from a different context. */
   typedef std::list<struct EventWithContext> EventsWithContext;
-  /** The container of events from a different context. */
+  /** Events which did not fit in the ring. */
   EventsWithContext m_eventsWithContext;
   /**
-   * Flag \c true if all events with context have been moved to the
-   * primary event queue.
+   * Flag \c true if all events which did not fit in the ring have
+   * been moved to the primary event queue.
    */
-  bool m_eventsWithContextEmpty;
-  /** Mutex to control access to the list of events with context. */
+  std::atomic<bool> m_eventsWithContextEmpty;
+  /** Mutex to control access to the overflow list and to the counters. */
   SystemMutex m_eventsWithContextMutex;
+  /** The counters of each thread injecting events. */
+  std::list<InjectionCounters> m_injectionCounters;
+  /** Unique serial number of this instance, to validate thread-local caches. */
+  uint64_t m_serial;
 
   /** Container type for the events to run at Simulator::Destroy() */
   typedef std::list<EventId> DestroyEvents;
@@ -133,6 +235,18 @@ private:
    *  not counting the Destroy events; this is used for validation
    */
   int m_unscheduledEvents;
+  /** Number of cancelled events still in the event list. */
+  uint64_t m_cancelledEvents;
+  /** Fraction of cancelled events which triggers a compaction. */
+  double m_compactionThreshold;
+  /** Smallest number of cancelled events which triggers a compaction. */
+  uint32_t m_compactionMinimum;
+  /** The event profiler, 0 unless profiling is enabled. */
+  EventProfiler *m_profiler;
+  /** The file of the profile report, empty for the standard output. */
+  std::string m_profileFile;
+  /** Maximum number of rows of each table of the profile report. */
+  uint32_t m_profileRows;
 
   /** Main execution thread. */
   SystemThread::ThreadId m_main;
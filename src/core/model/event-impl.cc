@@ -21,6 +21,9 @@
 #include "event-impl.h"
 #include "log.h"
 
+#include <atomic>
+#include <new>
+
 /**
  * \file
  * \ingroup events
@@ -31,6 +34,124 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+namespace {
+
+/** Granularity, in bytes, of the event size classes. */
+const std::size_t EVENT_POOL_GRANULARITY = 16;
+/** Number of size classes; larger events use the global allocator. */
+const std::size_t EVENT_POOL_CLASSES = 8;
+/** Maximum number of blocks kept by each free list of a thread. */
+const uint32_t EVENT_POOL_MAX_BLOCKS = 1 << 16;
+
+/** A free memory block. */
+struct EventPoolBlock
+{
+  EventPoolBlock *next;  //!< Next free block of the same size class.
+};
+
+/**
+ * The free lists of a thread.  This type is trivially destructible,
+ * so that events released during static destruction never use a
+ * destroyed free list.
+ */
+struct EventPool
+{
+  EventPoolBlock *head[EVENT_POOL_CLASSES];   //!< Free list of each size class.
+  uint32_t length[EVENT_POOL_CLASSES];        //!< Length of each free list.
+  bool registered;                            //!< EventPoolReleaser constructed.
+  bool released;                              //!< The thread is exiting.
+};
+
+/** The free lists of the calling thread. */
+thread_local EventPool g_eventPool;
+
+/** Return the free blocks of a thread to the global allocator when it exits. */
+struct EventPoolReleaser
+{
+  ~EventPoolReleaser ()
+  {
+    g_eventPool.released = true;
+    for (std::size_t c = 0; c < EVENT_POOL_CLASSES; ++c)
+      {
+        while (g_eventPool.head[c] != 0)
+          {
+            EventPoolBlock *block = g_eventPool.head[c];
+            g_eventPool.head[c] = block->next;
+            ::operator delete (block);
+          }
+        g_eventPool.length[c] = 0;
+      }
+  }
+};
+
+/** Releases the free lists of the calling thread at exit. */
+thread_local EventPoolReleaser g_eventPoolReleaser;
+
+/** \c true if the free lists are in use. */
+std::atomic<bool> g_eventPoolEnabled (true);
+
+} // unnamed namespace
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  std::size_t c = (size - 1) / EVENT_POOL_GRANULARITY;
+  if (c >= EVENT_POOL_CLASSES)
+    {
+      return ::operator new (size);
+    }
+  EventPool &pool = g_eventPool;
+  EventPoolBlock *block = pool.head[c];
+  if (block != 0 && g_eventPoolEnabled.load (std::memory_order_relaxed))
+    {
+      pool.head[c] = block->next;
+      pool.length[c]--;
+      return block;
+    }
+  // Always allocate the full size class, so that the block can be
+  // recycled even if it was allocated while the pool was disabled.
+  return ::operator new ((c + 1) * EVENT_POOL_GRANULARITY);
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  std::size_t c = (size - 1) / EVENT_POOL_GRANULARITY;
+  EventPool &pool = g_eventPool;
+  if (c >= EVENT_POOL_CLASSES
+      || pool.released
+      || pool.length[c] >= EVENT_POOL_MAX_BLOCKS
+      || !g_eventPoolEnabled.load (std::memory_order_relaxed))
+    {
+      ::operator delete (p);
+      return;
+    }
+  if (!pool.registered)
+    {
+      pool.registered = true;
+      // Construct the releaser of this thread.
+      (void) &g_eventPoolReleaser;
+    }
+  EventPoolBlock *block = static_cast<EventPoolBlock *> (p);
+  block->next = pool.head[c];
+  pool.head[c] = block;
+  pool.length[c]++;
+}
+
+void
+EventImpl::EnablePool (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_eventPoolEnabled.store (true, std::memory_order_relaxed);
+}
+
+void
+EventImpl::DisablePool (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_eventPoolEnabled.store (false, std::memory_order_relaxed);
+}
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
@@ -66,4 +187,11 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+const void *
+EventImpl::GetFunction (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return 0;
+}
+
 } // namespace ns3
@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 /**
@@ -40,6 +41,13 @@ namespace ns3 {
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * The memory of the events is recycled through per-thread free
+ * lists, one per size class, so that scheduling an event in steady
+ * state does not call the global allocator.  The arguments bound by
+ * MakeEvent() are stored inline in the event object, so an event
+ * takes a single block.  The free lists can be bypassed with
+ * DisablePool(), e.g. to compare the performance of both allocators.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
@@ -65,6 +73,33 @@ public:
    * Checked by the simulation engine before calling Invoke().
    */
   bool IsCancelled (void);
+  /**
+   * Get the address of the code invoked by this event, used by the
+   * event profiler to tell the events apart.
+   *
+   * \returns The address of the function, or of the class method as
+   *          resolved on the object, or 0 if it is not known.
+   */
+  virtual const void * GetFunction (void) const;
+
+  /**
+   * Allocate the memory of an event, from the free list of the
+   * calling thread for its size class if possible.
+   * \param [in] size The size of the event object.
+   * \returns The memory block.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Release the memory of an event to the free list of the calling
+   * thread for its size class.
+   * \param [in] p The memory block.
+   * \param [in] size The size of the event object.
+   */
+  static void operator delete (void *p, std::size_t size);
+  /** Recycle the memory of the events through the free lists (the default). */
+  static void EnablePool (void);
+  /** Allocate every event with the global allocator. */
+  static void DisablePool (void);
 
 protected:
   /**
@@ -0,0 +1,256 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+#include "simulator.h"
+#include "log.h"
+#include "ns3/core-config.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <utility>
+
+#if (__GNUC__ >= 3)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+#ifdef HAVE_DLFCN_H
+#include <dlfcn.h>
+#endif
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventProfiler");
+
+EventProfiler::EventProfiler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+EventProfiler::Record (const void *function, const std::type_info &type, uint32_t context, int64_t time)
+{
+  Key key = {function, std::type_index (function == 0 ? type : typeid (void)), context};
+  Stats &stats = m_stats[key];
+  stats.count++;
+  stats.time += time;
+  stats.type = &type;
+}
+
+std::string
+EventProfiler::Demangle (const char *name)
+{
+  std::string result = name;
+#if (__GNUC__ >= 3)
+  int status;
+  char *demangled = abi::__cxa_demangle (name, NULL, NULL, &status);
+  if (status == 0)
+    {
+      result = demangled;
+    }
+  std::free (demangled);
+#endif
+  return result;
+}
+
+std::string
+EventProfiler::GetTarget (const void *function, const std::type_info &type)
+{
+#ifdef HAVE_DLFCN_H
+  // dladdr gives the nearest symbol below the address: only trust it
+  // if it starts at the address.
+  Dl_info info;
+  if (function != 0 && dladdr (function, &info) != 0
+      && info.dli_sname != 0 && info.dli_saddr == function)
+    {
+      return Demangle (info.dli_sname);
+    }
+#endif
+  std::string name = Demangle (type.name ());
+  // "ns3::MakeEvent<ARGS>(...)::EventMemberImpl1": keep ARGS, the
+  // types of the function and of its object and arguments
+  std::string prefix = "ns3::MakeEvent<";
+  std::size_t start = name.find (prefix);
+  if (start != std::string::npos)
+    {
+      start += prefix.size ();
+      int depth = 1;
+      for (std::size_t i = start; i < name.size (); ++i)
+        {
+          if (name[i] == '<')
+            {
+              depth++;
+            }
+          else if (name[i] == '>' && --depth == 0)
+            {
+              name = name.substr (start, i - start);
+              break;
+            }
+        }
+    }
+  if (function != 0)
+    {
+      std::ostringstream oss;
+      oss << name << " at " << function;
+      name = oss.str ();
+    }
+  return name;
+}
+
+void
+EventProfiler::Sort (std::vector<Entry> &entries)
+{
+  std::sort (entries.begin (), entries.end (),
+             [] (const Entry &a, const Entry &b)
+             {
+               return a.time > b.time;
+             });
+}
+
+std::vector<EventProfiler::Entry>
+EventProfiler::GetEntries (void) const
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<Entry> entries;
+  for (std::unordered_map<Key, Stats, KeyHash>::const_iterator i = m_stats.begin (); i != m_stats.end (); ++i)
+    {
+      Entry entry;
+      entry.target = GetTarget (i->first.function, *i->second.type);
+      entry.context = i->first.context;
+      entry.count = i->second.count;
+      entry.time = i->second.time;
+      entries.push_back (entry);
+    }
+  Sort (entries);
+  return entries;
+}
+
+std::vector<EventProfiler::Entry>
+EventProfiler::GetTargets (void) const
+{
+  NS_LOG_FUNCTION (this);
+  typedef std::pair<const void *, std::type_index> Target;
+  std::map<Target, Stats> targets;
+  for (std::unordered_map<Key, Stats, KeyHash>::const_iterator i = m_stats.begin (); i != m_stats.end (); ++i)
+    {
+      Target target (i->first.function, i->first.type);
+      std::map<Target, Stats>::iterator t = targets.insert (std::make_pair (target, Stats {0, 0, i->second.type})).first;
+      t->second.count += i->second.count;
+      t->second.time += i->second.time;
+    }
+  std::vector<Entry> entries;
+  for (std::map<Target, Stats>::const_iterator i = targets.begin (); i != targets.end (); ++i)
+    {
+      Entry entry;
+      entry.target = GetTarget (i->first.first, *i->second.type);
+      entry.context = Simulator::NO_CONTEXT;
+      entry.count = i->second.count;
+      entry.time = i->second.time;
+      entries.push_back (entry);
+    }
+  Sort (entries);
+  return entries;
+}
+
+std::vector<EventProfiler::Entry>
+EventProfiler::GetContexts (void) const
+{
+  NS_LOG_FUNCTION (this);
+  std::map<uint32_t, Stats> contexts;
+  for (std::unordered_map<Key, Stats, KeyHash>::const_iterator i = m_stats.begin (); i != m_stats.end (); ++i)
+    {
+      std::map<uint32_t, Stats>::iterator c = contexts.insert (std::make_pair (i->first.context, Stats {0, 0, 0})).first;
+      c->second.count += i->second.count;
+      c->second.time += i->second.time;
+    }
+  std::vector<Entry> entries;
+  for (std::map<uint32_t, Stats>::const_iterator i = contexts.begin (); i != contexts.end (); ++i)
+    {
+      Entry entry;
+      entry.context = i->first;
+      entry.count = i->second.count;
+      entry.time = i->second.time;
+      entries.push_back (entry);
+    }
+  Sort (entries);
+  return entries;
+}
+
+void
+EventProfiler::Print (std::ostream &os, uint32_t rows) const
+{
+  NS_LOG_FUNCTION (this << rows);
+  std::vector<Entry> targets = GetTargets ();
+  uint64_t count = 0;
+  int64_t time = 0;
+  for (std::vector<Entry>::const_iterator i = targets.begin (); i != targets.end (); ++i)
+    {
+      count += i->count;
+      time += i->time;
+    }
+  std::ios_base::fmtflags flags = os.flags ();
+  std::streamsize precision = os.precision ();
+  os << std::fixed << std::right;
+  os << "Event profile: " << count << " events, "
+     << std::setprecision (3) << time / 1e6 << " ms" << std::endl;
+
+  std::vector<Entry> tables[3] = {targets, GetEntries (), GetContexts ()};
+  const char *titles[3] = {"by target", "by target and context", "by context"};
+  for (uint32_t t = 0; t < 3; ++t)
+    {
+      os << std::endl << "Hot spots " << titles[t] << ":" << std::endl;
+      os << std::setw (12) << "time (ms)" << std::setw (8) << "%"
+         << std::setw (12) << "count" << std::setw (12) << "mean (ns)"
+         << std::setw (10) << "context" << "  target" << std::endl;
+      for (uint32_t i = 0; i < tables[t].size () && i < rows; ++i)
+        {
+          const Entry &entry = tables[t][i];
+          os << std::setw (12) << std::setprecision (3) << entry.time / 1e6
+             << std::setw (8) << std::setprecision (1) << (time > 0 ? 100.0 * entry.time / time : 0.0)
+             << std::setw (12) << entry.count
+             << std::setw (12) << std::setprecision (0) << double (entry.time) / entry.count
+             << std::setw (10);
+          if (entry.context == Simulator::NO_CONTEXT)
+            {
+              os << "-";
+            }
+          else
+            {
+              os << entry.context;
+            }
+          os << "  " << entry.target << std::endl;
+        }
+    }
+  os.flags (flags);
+  os.precision (precision);
+}
+
+void
+EventProfiler::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_stats.clear ();
+}
+
+} // namespace ns3
@@ -0,0 +1,182 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include <stdint.h>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Wall clock time and count of the events, per event target
+ * and context.
+ *
+ * DefaultSimulatorImpl measures the wall clock time of each event
+ * when its \c Profile attribute is set, and records it here under the
+ * address of the function or member function the event invokes, as
+ * given by EventImpl::GetFunction, and the context of the event.  A
+ * virtual member function is resolved on the object of the event, so
+ * that e.g. the retransmission, delayed ack and persist timeouts of a
+ * TCP socket, or the expiries of different Timers, are told apart.
+ * The target is the demangled symbol of that address, found with
+ * dladdr; the events whose function is unknown, or whose symbol is not
+ * exported, are named after the type of their EventImpl.  Together
+ * with the context, which is the node id for the events scheduled by
+ * the models, this tells which protocol object takes the time.
+ *
+ * The report, sorted by decreasing total time, is printed at
+ * Simulator::Destroy.
+ */
+class EventProfiler
+{
+public:
+  /** The statistics of a set of events. */
+  struct Entry
+  {
+    /** The demangled event target, empty for the context totals. */
+    std::string target;
+    /** The context, or Simulator::NO_CONTEXT for the target totals. */
+    uint32_t context;
+    /** Number of events executed. */
+    uint64_t count;
+    /** Wall clock time spent in the events, in nanoseconds. */
+    int64_t time;
+  };
+
+  EventProfiler ();
+
+  /**
+   * Record the execution of one event.
+   *
+   * The function must be read with EventImpl::GetFunction before the
+   * event is invoked, since the event may destroy its object.
+   *
+   * \param [in] function The function invoked by the event, or 0.
+   * \param [in] type The type of the event.
+   * \param [in] context The context of the event.
+   * \param [in] time The wall clock time it took, in nanoseconds.
+   */
+  void Record (const void *function, const std::type_info &type, uint32_t context, int64_t time);
+  /**
+   * \return The statistics of each target and context, by decreasing time.
+   */
+  std::vector<Entry> GetEntries (void) const;
+  /**
+   * \return The statistics of each target, over all the contexts,
+   *         by decreasing time.
+   */
+  std::vector<Entry> GetTargets (void) const;
+  /**
+   * \return The statistics of each context, by decreasing time.
+   */
+  std::vector<Entry> GetContexts (void) const;
+  /**
+   * Print the hot spot tables.
+   *
+   * \param [in,out] os The output stream.
+   * \param [in] rows The maximum number of rows of each table.
+   */
+  void Print (std::ostream &os, uint32_t rows) const;
+  /** Forget all the statistics. */
+  void Clear (void);
+
+private:
+  /**
+   * The key of the statistics: the function invoked, or the event
+   * type if it is not known, and the context.
+   */
+  struct Key
+  {
+    const void *function;   //!< The code invoked, or 0.
+    std::type_index type;   //!< The EventImpl dynamic type if function is 0.
+    uint32_t context;       //!< The event context.
+    /**
+     * \param [in] other The other key.
+     * \return \c true if both keys are equal.
+     */
+    bool operator == (const Key &other) const
+    {
+      return function == other.function && type == other.type && context == other.context;
+    }
+  };
+  /** Hash function of the keys. */
+  struct KeyHash
+  {
+    /**
+     * \param [in] key The key.
+     * \return The hash of the key.
+     */
+    std::size_t operator () (const Key &key) const
+    {
+      return (std::hash<const void *> () (key.function) ^ key.type.hash_code ()) * 31 + key.context;
+    }
+  };
+  /** The statistics of one key. */
+  struct Stats
+  {
+    uint64_t count;                //!< Number of events.
+    int64_t time;                  //!< Total time, in nanoseconds.
+    const std::type_info *type;    //!< The EventImpl dynamic type of the last event.
+  };
+
+  /**
+   * Demangle a symbol or type name.
+   *
+   * \param [in] name The mangled name.
+   * \return The demangled name, or name if it cannot be demangled.
+   */
+  static std::string Demangle (const char *name);
+  /**
+   * Get the printable name of an event target.
+   *
+   * \param [in] function The code invoked by the events, or 0.
+   * \param [in] type The EventImpl dynamic type.
+   * \return The demangled symbol of function if it is exported, or
+   *         else the demangled name of the type, reduced to the
+   *         MakeEvent template arguments for the events created by
+   *         MakeEvent, followed by the address of function.
+   */
+  static std::string GetTarget (const void *function, const std::type_info &type);
+  /**
+   * Sort entries by decreasing time.
+   *
+   * \param [in,out] entries The entries.
+   */
+  static void Sort (std::vector<Entry> &entries);
+
+  /** The statistics. */
+  std::unordered_map<Key, Stats, KeyHash> m_stats;
+};
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
@@ -236,6 +236,13 @@ HeapScheduler::Remove (const Event &ev)
           NS_ASSERT (m_heap[i].impl == ev.impl);
           Exch (i, Last ());
           m_heap.pop_back ();
+          // the former last item may belong above or below i
+          while (!IsRoot (i) && !IsBottom (i)
+                 && IsLessStrictly (i, Parent (i)))
+            {
+              Exch (i, Parent (i));
+              i = Parent (i);
+            }
           TopDown (i);
           return;
         }
@@ -243,5 +250,32 @@ HeapScheduler::Remove (const Event &ev)
   NS_ASSERT (false);
 }
 
+uint32_t
+HeapScheduler::Compact (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::size_t last = Root ();
+  for (std::size_t i = Root (); i < m_heap.size (); i++)
+    {
+      if (m_heap[i].impl->IsCancelled ())
+        {
+          m_heap[i].impl->Unref ();
+        }
+      else
+        {
+          m_heap[last] = m_heap[i];
+          last++;
+        }
+    }
+  uint32_t removed = m_heap.size () - last;
+  m_heap.resize (last);
+  // rebuild the heap from the lowest parents up
+  for (std::size_t i = Parent (Last ()); i >= Root (); i--)
+    {
+      TopDown (i);
+    }
+  return removed;
+}
+
 } // namespace ns3
 
@@ -89,6 +89,7 @@ public:
   virtual Scheduler::Event PeekNext (void) const;
   virtual Scheduler::Event RemoveNext (void);
   virtual void Remove (const Scheduler::Event &ev);
+  virtual uint32_t Compact (void);
 
 private:
   /** Event list type:  vector of Events, managed as a heap. */
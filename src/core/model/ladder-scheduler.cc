@@ -0,0 +1,368 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "uinteger.h"
+#include "assert.h"
+#include "log.h"
+
+#include <algorithm>
+#include <limits>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::LadderScheduler class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+    .AddAttribute ("Threshold",
+                   "Largest number of events of a bucket sorted directly "
+                   "instead of being spread over a new rung.",
+                   UintegerValue (50),
+                   MakeUintegerAccessor (&LadderScheduler::m_threshold),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MaxRungs",
+                   "Maximum number of rungs of the ladder.",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&LadderScheduler::m_maxRungs),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topMin (std::numeric_limits<uint64_t>::max ()),
+    m_topMax (0),
+    m_topStart (0),
+    m_nRungs (0),
+    m_bottomHead (0),
+    m_count (0),
+    m_threshold (50),
+    m_maxRungs (8)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+LadderScheduler::CurrentStart (const Rung &rung) const
+{
+  return rung.start + rung.current * rung.width;
+}
+
+std::size_t
+LadderScheduler::FindRung (uint64_t ts) const
+{
+  std::size_t r = 0;
+  while (r < m_nRungs && ts < CurrentStart (m_rungs[r]))
+    {
+      r++;
+    }
+  return r;
+}
+
+void
+LadderScheduler::AddRung (uint64_t start, uint64_t end, Events &events)
+{
+  NS_LOG_FUNCTION (this << start << end << events.size ());
+  NS_ASSERT (end > start && !events.empty ());
+  uint64_t range = end - start;
+  uint64_t n = events.size ();
+  uint64_t width = range / n + (range % n != 0 ? 1 : 0);
+  uint64_t nBuckets = range / width + (range % width != 0 ? 1 : 0);
+
+  if (m_nRungs == m_rungs.size ())
+    {
+      m_rungs.push_back (Rung ());
+    }
+  Rung &rung = m_rungs[m_nRungs];
+  m_nRungs++;
+  rung.start = start;
+  rung.width = width;
+  rung.current = 0;
+  rung.count = n;
+  rung.nBuckets = nBuckets;
+  if (rung.buckets.size () < nBuckets)
+    {
+      rung.buckets.resize (nBuckets);
+    }
+  for (Events::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      NS_ASSERT (i->key.m_ts >= start && i->key.m_ts < end);
+      rung.buckets[(i->key.m_ts - start) / width].push_back (*i);
+    }
+  events.clear ();
+}
+
+void
+LadderScheduler::InsertBottom (const Scheduler::Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  if (m_bottomHead > 0 && m_bottomHead >= m_bottom.size () / 2)
+    {
+      // drop the events already removed
+      m_bottom.erase (m_bottom.begin (), m_bottom.begin () + m_bottomHead);
+      m_bottomHead = 0;
+    }
+  // New events usually have the largest uid of their timestamp, so
+  // this is most often close to the end of Bottom.
+  m_bottom.insert (std::upper_bound (m_bottom.begin () + m_bottomHead, m_bottom.end (), ev),
+                   ev);
+  if (m_bottom.size () - m_bottomHead > m_threshold
+      && m_nRungs < m_maxRungs
+      && m_bottom[m_bottomHead].key.m_ts != m_bottom.back ().key.m_ts)
+    {
+      // Bottom is too long for sorted insertion: spread it over a new
+      // rung covering the range up to the lowest rung.
+      uint64_t start = m_bottom[m_bottomHead].key.m_ts;
+      uint64_t end = m_nRungs > 0 ? CurrentStart (m_rungs[m_nRungs - 1]) : m_topStart;
+      Events events (m_bottom.begin () + m_bottomHead, m_bottom.end ());
+      m_bottom.clear ();
+      m_bottomHead = 0;
+      AddRung (start, end, events);
+    }
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  uint64_t ts = ev.key.m_ts;
+  if (m_count == 0)
+    {
+      // Start afresh, with all the events in Top.
+      m_nRungs = 0;
+      m_bottom.clear ();
+      m_bottomHead = 0;
+      m_topStart = 0;
+      m_topMin = std::numeric_limits<uint64_t>::max ();
+      m_topMax = 0;
+    }
+  m_count++;
+
+  if (ts >= m_topStart)
+    {
+      m_top.push_back (ev);
+      m_topMin = std::min (m_topMin, ts);
+      m_topMax = std::max (m_topMax, ts);
+      return;
+    }
+  std::size_t r = FindRung (ts);
+  if (r < m_nRungs)
+    {
+      Rung &rung = m_rungs[r];
+      rung.buckets[(ts - rung.start) / rung.width].push_back (ev);
+      rung.count++;
+      return;
+    }
+  InsertBottom (ev);
+}
+
+void
+LadderScheduler::Refill (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_bottomHead == m_bottom.size ())
+    {
+      m_bottom.clear ();
+      m_bottomHead = 0;
+    }
+  while (m_bottom.empty ())
+    {
+      if (m_nRungs == 0)
+        {
+          NS_ASSERT (!m_top.empty ());
+          m_topStart = m_topMax + 1;
+          AddRung (m_topMin, m_topStart, m_top);
+          m_topMin = std::numeric_limits<uint64_t>::max ();
+          m_topMax = 0;
+        }
+      Rung &rung = m_rungs[m_nRungs - 1];
+      if (rung.count == 0)
+        {
+          m_nRungs--;
+          continue;
+        }
+      while (rung.buckets[rung.current].empty ())
+        {
+          rung.current++;
+        }
+      NS_ASSERT (rung.current < rung.nBuckets);
+      Events &bucket = rung.buckets[rung.current];
+      uint64_t bucketStart = CurrentStart (rung);
+      uint64_t width = rung.width;
+      rung.current++;
+      rung.count -= bucket.size ();
+      if (bucket.size () > m_threshold && width > 1 && m_nRungs < m_maxRungs)
+        {
+          NS_LOG_LOGIC ("spread " << bucket.size () << " events over rung " << m_nRungs);
+          Events events;
+          events.swap (bucket);
+          AddRung (bucketStart, bucketStart + width, events);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("sort " << bucket.size () << " events into bottom");
+          m_bottom.swap (bucket);
+          std::sort (m_bottom.begin (), m_bottom.end ());
+        }
+    }
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_count == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  // Refilling Bottom only moves events between the tiers.
+  const_cast<LadderScheduler *> (this)->Refill ();
+  return m_bottom[m_bottomHead];
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  Refill ();
+  Scheduler::Event ev = m_bottom[m_bottomHead];
+  m_bottomHead++;
+  m_count--;
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (!IsEmpty ());
+  uint64_t ts = ev.key.m_ts;
+  Events *events;
+  Rung *rung = 0;
+  if (ts >= m_topStart)
+    {
+      events = &m_top;
+    }
+  else
+    {
+      std::size_t r = FindRung (ts);
+      if (r < m_nRungs)
+        {
+          rung = &m_rungs[r];
+          events = &rung->buckets[(ts - rung->start) / rung->width];
+        }
+      else
+        {
+          events = &m_bottom;
+        }
+    }
+  Events::iterator begin = events->begin ();
+  if (events == &m_bottom)
+    {
+      begin += m_bottomHead;
+    }
+  for (Events::iterator i = begin; i != events->end (); ++i)
+    {
+      if (i->key.m_uid == ev.key.m_uid)
+        {
+          NS_ASSERT (ev.impl == i->impl);
+          if (events == &m_bottom)
+            {
+              // keep Bottom sorted
+              m_bottom.erase (i);
+            }
+          else
+            {
+              *i = events->back ();
+              events->pop_back ();
+            }
+          if (rung != 0)
+            {
+              rung->count--;
+            }
+          m_count--;
+          return;
+        }
+    }
+  NS_ASSERT (false);
+}
+
+uint32_t
+LadderScheduler::RemoveCancelled (Events &events, std::size_t first)
+{
+  Events::iterator last = events.begin () + first;
+  for (Events::iterator i = last; i != events.end (); ++i)
+    {
+      if (i->impl->IsCancelled ())
+        {
+          i->impl->Unref ();
+        }
+      else
+        {
+          *last++ = *i;
+        }
+    }
+  uint32_t removed = events.end () - last;
+  events.erase (last, events.end ());
+  return removed;
+}
+
+uint32_t
+LadderScheduler::Compact (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t removed = RemoveCancelled (m_top, 0);
+  for (std::size_t r = 0; r < m_nRungs; ++r)
+    {
+      Rung &rung = m_rungs[r];
+      for (std::size_t b = rung.current; b < rung.nBuckets; ++b)
+        {
+          uint32_t n = RemoveCancelled (rung.buckets[b], 0);
+          rung.count -= n;
+          removed += n;
+        }
+    }
+  removed += RemoveCancelled (m_bottom, m_bottomHead);
+  m_count -= removed;
+  return removed;
+}
+
+} // namespace ns3
@@ -0,0 +1,195 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This is an implementation of the Ladder Queue of W. T. Tang,
+ * R. S. M. Goh and I. L.-J. Thng, "Ladder Queue: An O(1) Priority
+ * Queue Structure for Large-Scale Discrete Event Simulation",
+ * ACM TOMACS 15(3), 2005.
+ *
+ * The events are stored in three tiers:
+ *  - Top: an unsorted list of the events beyond the range covered
+ *    by the ladder.  Far-future events (typically timers) are simply
+ *    appended to it.
+ *  - Ladder: a stack of rungs, each an array of unsorted buckets of
+ *    equal width.  Each rung covers the range of a single bucket of
+ *    the rung above it, with narrower buckets.
+ *  - Bottom: a small sorted list of the events of the bucket being
+ *    consumed.
+ *
+ * When Bottom is empty, the next non-empty bucket of the lowest rung
+ * is either sorted into Bottom, if it holds at most \c Threshold
+ * events, or spread over a new, finer rung.  When the ladder is empty
+ * the whole Top list is spread over a new first rung, whose bucket
+ * width is derived from the range and number of events in Top.  The
+ * bucket width thus adapts to the event distribution without ever
+ * resizing and reinserting the whole event set, unlike the
+ * CalendarScheduler.
+ *
+ * Events inserted within the range of Bottom are inserted in sorted
+ * order; if Bottom grows beyond \c Threshold events it is spread over
+ * a new rung, as in the original algorithm.  Bottom is stored in
+ * increasing order, so that the common case of an event scheduled at
+ * or just after the current time is appended near its end.
+ *
+ * \par Time Complexity
+ *
+ * Operation    | Amortized %Time | Reason
+ * :----------- | :-------------- | :-----
+ * Insert()     | Constant        | Appended to Top or to a bucket
+ * IsEmpty()    | Constant        | Explicit queue size
+ * PeekNext()   | Constant        | Bottom kept sorted
+ * Remove()     | Linear in bucket size | Search within the tier
+ * RemoveNext() | Constant        | Each event is moved a bounded number of times
+ *
+ * \par Memory Complexity
+ *
+ * Category  | Memory                           | Reason
+ * :-------- | :------------------------------- | :-----
+ * Overhead  | 3 x `sizeof (*)` per bucket      | `std::vector` per bucket
+ * Per Event | 0                                | Events stored in `std::vector` directly
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+  virtual uint32_t Compact (void);
+
+private:
+  /** A list of events, unsorted except for Bottom. */
+  typedef std::vector<Scheduler::Event> Events;
+
+  /** A rung of the ladder. */
+  struct Rung
+  {
+    /** Timestamp of the start of the first bucket. */
+    uint64_t start;
+    /** Width of each bucket. */
+    uint64_t width;
+    /** Index of the bucket being consumed. */
+    std::size_t current;
+    /** Number of events in the buckets. */
+    std::size_t count;
+    /** The buckets; only the first \c nBuckets are in use. */
+    std::vector<Events> buckets;
+    /** Number of buckets in use. */
+    std::size_t nBuckets;
+  };
+
+  /**
+   * Spread a list of events over a new rung below the existing ones.
+   *
+   * \param [in] start The start of the range covered by the new rung.
+   * \param [in] end The end (exclusive) of the range.
+   * \param [in,out] events The events, all in [\pname{start}, \pname{end}),
+   *                 emptied on return.
+   */
+  void AddRung (uint64_t start, uint64_t end, Events &events);
+  /**
+   * \param [in] rung The rung.
+   * \return The start of the bucket being consumed in the rung: events
+   *         earlier than this belong to a lower rung or to Bottom.
+   */
+  uint64_t CurrentStart (const Rung &rung) const;
+  /**
+   * Find the rung which covers a timestamp.
+   *
+   * \param [in] ts The timestamp, earlier than the start of Top.
+   * \return The rung index, or the number of rungs for Bottom.
+   */
+  std::size_t FindRung (uint64_t ts) const;
+  /**
+   * Insert an event in Bottom, keeping it sorted.
+   *
+   * \param [in] ev The event.
+   */
+  void InsertBottom (const Scheduler::Event &ev);
+  /** Refill Bottom from the ladder and from Top, if it is empty. */
+  void Refill (void);
+  /**
+   * Remove the cancelled events from a list, keeping the order of the
+   * others.
+   *
+   * \param [in,out] events The events.
+   * \param [in] first The index of the first event to consider.
+   * \return The number of events removed.
+   */
+  uint32_t RemoveCancelled (Events &events, std::size_t first);
+
+  /** The Top events. */
+  Events m_top;
+  /** Smallest timestamp in Top. */
+  uint64_t m_topMin;
+  /** Largest timestamp in Top. */
+  uint64_t m_topMax;
+  /** Events at or after this timestamp belong to Top. */
+  uint64_t m_topStart;
+  /** The rungs; only the first \c m_nRungs are in use. */
+  std::vector<Rung> m_rungs;
+  /** Number of rungs in use. */
+  std::size_t m_nRungs;
+  /**
+   * The Bottom events, sorted in increasing order; the events before
+   * \c m_bottomHead have already been removed.
+   */
+  Events m_bottom;
+  /** Index of the first event of Bottom. */
+  std::size_t m_bottomHead;
+  /** Total number of events. */
+  std::size_t m_count;
+  /** Largest bucket sorted into Bottom without creating a new rung. */
+  uint32_t m_threshold;
+  /** Maximum number of rungs. */
+  uint32_t m_maxRungs;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
@@ -20,10 +20,13 @@
 #include "make-event.h"
 #include "log.h"
 
+#include <cstring>
+
 /**
  * \file
  * \ingroup events
- * ns3::MakeEvent(void(*f)(void)) implementation.
+ * ns3::MakeEvent(void(*f)(void)) and
+ * ns3::GetMemberFunctionAddress() implementation.
  */
 
 namespace ns3 {
@@ -51,6 +54,10 @@ EventImpl * MakeEvent (void (*f)(void))
     {
       (*m_function)();
     }
+    virtual const void * GetFunction (void) const
+    {
+      return reinterpret_cast<const void *> (m_function);
+    }
 
   private:
     F m_function;
@@ -58,4 +65,41 @@ EventImpl * MakeEvent (void (*f)(void))
   return ev;
 }
 
+const void *
+GetMemberFunctionAddress (const void *object, const void *mem_ptr, std::size_t size)
+{
+  NS_LOG_FUNCTION (object << mem_ptr << size);
+#if defined (__GXX_ABI_VERSION)
+  // A method pointer is a pair {ptr, adj}: adj is the adjustment of
+  // the object pointer and ptr the address of a non-virtual method or,
+  // for a virtual method, one plus the offset of its vtable entry.  On
+  // ARM, the virtual flag is the lowest bit of adj instead.
+  std::ptrdiff_t ptr;
+  std::ptrdiff_t adj;
+  if (size != sizeof (ptr) + sizeof (adj))
+    {
+      return 0;
+    }
+  std::memcpy (&ptr, mem_ptr, sizeof (ptr));
+  std::memcpy (&adj, static_cast<const char *> (mem_ptr) + sizeof (ptr), sizeof (adj));
+#if defined (__arm__) || defined (__aarch64__)
+  bool isVirtual = adj & 1;
+  std::ptrdiff_t offset = ptr;
+  adj >>= 1;
+#else
+  bool isVirtual = ptr & 1;
+  std::ptrdiff_t offset = ptr - 1;
+#endif
+  if (!isVirtual)
+    {
+      return reinterpret_cast<const void *> (ptr);
+    }
+  const char *self = static_cast<const char *> (object) + adj;
+  const char *vtable = *reinterpret_cast<const char * const *> (self);
+  return *reinterpret_cast<const void * const *> (vtable + offset);
+#else
+  return 0;
+#endif
+}
+
 } // namespace ns3
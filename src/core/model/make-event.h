@@ -317,6 +317,8 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3,U4,U5,U6), T1 a1, T2 a2, T3 a3, T4 a4,
 #include "event-impl.h"
 #include "type-traits.h"
 
+#include <cstddef>
+
 namespace ns3 {
 
 /**
@@ -355,6 +357,99 @@ struct EventMemberImplObjTraits<T *>
   }
 };
 
+/**
+ * \ingroup makeeventmemptr
+ * Helper for the MakeEvent functions which take a class method.
+ *
+ * This helper gives the class which declares the method.
+ *
+ * This is the generic template declaration (with empty body).
+ *
+ * \tparam MEM \explicit The class method function signature.
+ */
+template <typename MEM>
+struct EventMemberImplClassTraits;
+
+/**
+ * \ingroup makeeventmemptr
+ * Helper for the MakeEvent functions which take a class method.
+ *
+ * This is the specialization for the data members holding a functor,
+ * such as a Callback; their address is not resolved.
+ *
+ * \tparam R \deduced The type of the data member.
+ * \tparam C \deduced The class which declares the data member.
+ */
+template <typename R, typename C>
+struct EventMemberImplClassTraits<R C::*>
+{
+  typedef C Class;  //!< The class which declares the data member.
+};
+
+/**
+ * \ingroup makeeventmemptr
+ * Helper for the MakeEvent functions which take a class method.
+ *
+ * This is the specialization for non-const methods.
+ *
+ * \tparam R \deduced The return type of the method.
+ * \tparam C \deduced The class which declares the method.
+ * \tparam Args \deduced The types of the arguments of the method.
+ */
+template <typename R, typename C, typename... Args>
+struct EventMemberImplClassTraits<R (C::*)(Args...)>
+{
+  typedef C Class;  //!< The class which declares the method.
+};
+
+/**
+ * \ingroup makeeventmemptr
+ * Helper for the MakeEvent functions which take a class method.
+ *
+ * This is the specialization for const methods.
+ *
+ * \tparam R \deduced The return type of the method.
+ * \tparam C \deduced The class which declares the method.
+ * \tparam Args \deduced The types of the arguments of the method.
+ */
+template <typename R, typename C, typename... Args>
+struct EventMemberImplClassTraits<R (C::*)(Args...) const>
+{
+  typedef const C Class;  //!< The class which declares the method.
+};
+
+/**
+ * \ingroup makeeventmemptr
+ * Resolve a pointer to a class method into the address of the code
+ * it invokes on an object, following the vtable of the object for a
+ * virtual method.  Only the Itanium C++ ABI (and its ARM variant)
+ * representation of the method pointers is supported.
+ *
+ * \param [in] object The object, converted to the class which
+ *            declares the method.
+ * \param [in] mem_ptr The address of the method pointer.
+ * \param [in] size The size of the method pointer.
+ * \returns The address of the code, or 0 if it cannot be resolved.
+ */
+const void * GetMemberFunctionAddress (const void *object, const void *mem_ptr, std::size_t size);
+
+/**
+ * \ingroup makeeventmemptr
+ * Get the address of the code a class method invokes on an object.
+ *
+ * \tparam MEM \deduced The class method function signature.
+ * \tparam OBJ \deduced The class type holding the method.
+ * \param [in] mem_ptr Class method member pointer.
+ * \param [in] obj Class instance.
+ * \returns The address of the code, or 0 if it cannot be resolved.
+ */
+template <typename MEM, typename OBJ>
+const void * GetMemberFunctionAddress (MEM mem_ptr, const OBJ &obj)
+{
+  typename EventMemberImplClassTraits<MEM>::Class *object = &EventMemberImplObjTraits<OBJ>::GetReference (obj);
+  return GetMemberFunctionAddress (object, &mem_ptr, sizeof (mem_ptr));
+}
+
 template <typename MEM, typename OBJ>
 EventImpl * MakeEvent (MEM mem_ptr, OBJ obj)
 {
@@ -374,6 +469,10 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj)
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)();
     }
+    virtual const void * GetFunction (void) const
+    {
+      return GetMemberFunctionAddress (m_function, m_obj);
+    }
     OBJ m_obj;
     MEM m_function;
   } *ev = new EventMemberImpl0 (obj, mem_ptr);
@@ -404,6 +503,10 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj, T1 a1)
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1);
     }
+    virtual const void * GetFunction (void) const
+    {
+      return GetMemberFunctionAddress (m_function, m_obj);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -435,6 +538,10 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj, T1 a1, T2 a2)
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2);
     }
+    virtual const void * GetFunction (void) const
+    {
+      return GetMemberFunctionAddress (m_function, m_obj);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -468,6 +575,10 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3)
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3);
     }
+    virtual const void * GetFunction (void) const
+    {
+      return GetMemberFunctionAddress (m_function, m_obj);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -503,6 +614,10 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3, T4 a4)
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4);
     }
+    virtual const void * GetFunction (void) const
+    {
+      return GetMemberFunctionAddress (m_function, m_obj);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -541,6 +656,10 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj,
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5);
     }
+    virtual const void * GetFunction (void) const
+    {
+      return GetMemberFunctionAddress (m_function, m_obj);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -581,6 +700,10 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj,
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
     }
+    virtual const void * GetFunction (void) const
+    {
+      return GetMemberFunctionAddress (m_function, m_obj);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -616,6 +739,10 @@ EventImpl * MakeEvent (void (*f)(U1), T1 a1)
     {
       (*m_function)(m_a1);
     }
+    virtual const void * GetFunction (void) const
+    {
+      return reinterpret_cast<const void *> (m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
   } *ev = new EventFunctionImpl1 (f, a1);
@@ -646,6 +773,10 @@ EventImpl * MakeEvent (void (*f)(U1,U2), T1 a1, T2 a2)
     {
       (*m_function)(m_a1, m_a2);
     }
+    virtual const void * GetFunction (void) const
+    {
+      return reinterpret_cast<const void *> (m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -679,6 +810,10 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3), T1 a1, T2 a2, T3 a3)
     {
       (*m_function)(m_a1, m_a2, m_a3);
     }
+    virtual const void * GetFunction (void) const
+    {
+      return reinterpret_cast<const void *> (m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -714,6 +849,10 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3,U4), T1 a1, T2 a2, T3 a3, T4 a4)
     {
       (*m_function)(m_a1, m_a2, m_a3, m_a4);
     }
+    virtual const void * GetFunction (void) const
+    {
+      return reinterpret_cast<const void *> (m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -751,6 +890,10 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3,U4,U5), T1 a1, T2 a2, T3 a3, T4 a4, T5
     {
       (*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5);
     }
+    virtual const void * GetFunction (void) const
+    {
+      return reinterpret_cast<const void *> (m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -790,6 +933,10 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3,U4,U5,U6), T1 a1, T2 a2, T3 a3, T4 a4,
     {
       (*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
     }
+    virtual const void * GetFunction (void) const
+    {
+      return reinterpret_cast<const void *> (m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
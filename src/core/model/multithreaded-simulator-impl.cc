@@ -0,0 +1,831 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "simulator.h"
+#include "multithreaded-simulator-impl.h"
+#include "scheduler.h"
+#include "event-impl.h"
+
+#include "ptr.h"
+#include "uinteger.h"
+#include "double.h"
+#include "assert.h"
+#include "abort.h"
+#include "log.h"
+
+#include <algorithm>
+#include <thread>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::MultithreadedSimulatorImpl implementation.
+ */
+
+namespace ns3 {
+
+// Note:  Logging in this file is largely avoided due to the
+// number of calls that are made to these functions and the possibility
+// of causing recursions leading to stack overflow
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+thread_local MultithreadedSimulatorImpl::Partition *MultithreadedSimulatorImpl::m_current = 0;
+
+/** Timestamp used for "no pending event" and "no stop requested". */
+static const uint64_t MAX_TS = 0x7fffffffffffffffULL;
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Core")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("MaxThreads",
+                   "The maximum number of threads used to process the partitions "
+                   "(0 for one thread per hardware thread).",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MultithreadedSimulatorImpl::m_maxThreads),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("CompactionThreshold",
+                   "Fraction of cancelled events in the event list of a partition "
+                   "above which they are removed from it; 1 disables the compaction.",
+                   DoubleValue (0.5),
+                   MakeDoubleAccessor (&MultithreadedSimulatorImpl::m_compactionThreshold),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("CompactionMinimum",
+                   "Smallest number of cancelled events for which the event "
+                   "list of a partition is compacted.",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&MultithreadedSimulatorImpl::m_compactionMinimum),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::Barrier::Barrier (uint32_t count)
+  : m_count (count),
+    m_remaining (count),
+    m_generation (0)
+{}
+
+void
+MultithreadedSimulatorImpl::Barrier::Wait (void)
+{
+  uint32_t generation = m_generation.load (std::memory_order_acquire);
+  if (m_remaining.fetch_sub (1, std::memory_order_acq_rel) == 1)
+    {
+      m_remaining.store (m_count, std::memory_order_relaxed);
+      m_generation.fetch_add (1, std::memory_order_release);
+    }
+  else
+    {
+      while (m_generation.load (std::memory_order_acquire) == generation)
+        {
+          std::this_thread::yield ();
+        }
+    }
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+  m_repartition = false;
+  m_lookAhead = Seconds (0);
+  m_maxThreads = 0;
+  m_compactionThreshold = 0.5;
+  m_compactionMinimum = 1024;
+  m_threadCount = 0;
+  m_barrier = 0;
+  m_running = false;
+  m_currentTs = 0;
+  // uids are allocated from 4.
+  // uid 0 is "invalid" events
+  // uid 1 is "now" events
+  // uid 2 is "destroy" events
+  m_uid = 4;
+  m_main = SystemThread::Self ();
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      Partition *p = *i;
+      Message *m = p->inbox.exchange (0);
+      while (m != 0)
+        {
+          Message *next = m->next;
+          m->event->Unref ();
+          delete m;
+          m = next;
+        }
+      while (!p->events->IsEmpty ())
+        {
+          Scheduler::Event next = p->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      p->events = 0;
+      delete p;
+    }
+  m_partitions.clear ();
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  NS_ASSERT_MSG (!m_running, "Cannot change the scheduler while running");
+  m_schedulerFactory = schedulerFactory;
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      while (!(*i)->events->IsEmpty ())
+        {
+          scheduler->Insert ((*i)->events->RemoveNext ());
+        }
+      (*i)->events = scheduler;
+    }
+  GetPartition (0);
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetPartition (uint32_t index)
+{
+  while (m_partitions.size () <= index)
+    {
+      Partition *p = new Partition;
+      p->events = m_schedulerFactory.Create<Scheduler> ();
+      p->inbox.store (0);
+      p->index = m_partitions.size ();
+      p->uid = 0;
+      p->packetUid = 0;
+      p->currentUid = 0;
+      p->currentTs = m_currentTs;
+      p->currentContext = Simulator::NO_CONTEXT;
+      p->eventCount = 0;
+      p->unscheduledEvents = 0;
+      p->cancelledEvents = 0;
+      p->sent = 0;
+      p->stop = false;
+      p->stopTs = MAX_TS;
+      p->nextTs = MAX_TS;
+      p->stopSnapshot = false;
+      p->stopTsSnapshot = MAX_TS;
+      m_partitions.push_back (p);
+    }
+  return m_partitions[index];
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::FindPartition (uint32_t context) const
+{
+  if (context < m_contextPartition.size ())
+    {
+      return m_partitions[m_contextPartition[context]];
+    }
+  return m_partitions[0];
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::CurrentPartition (void) const
+{
+  return m_current;
+}
+
+void
+MultithreadedSimulatorImpl::SetContextPartition (uint32_t context, uint32_t partition)
+{
+  NS_LOG_FUNCTION (this << context << partition);
+  NS_ASSERT_MSG (!m_running, "Cannot change the partition of a context while running");
+  NS_ASSERT_MSG (context != Simulator::NO_CONTEXT, "Events without context always belong to partition 0");
+  if (m_contextPartition.size () <= context)
+    {
+      m_contextPartition.resize (context + 1, 0);
+    }
+  GetPartition (partition);
+  if (m_contextPartition[context] != partition)
+    {
+      m_contextPartition[context] = partition;
+      m_repartition = true;
+    }
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContextPartition (uint32_t context) const
+{
+  return FindPartition (context)->index;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartitionCount (void) const
+{
+  return m_partitions.size ();
+}
+
+void
+MultithreadedSimulatorImpl::SetLookAhead (const Time &lookAhead)
+{
+  NS_LOG_FUNCTION (this << lookAhead);
+  NS_ASSERT_MSG (!m_running, "Cannot change the lookahead while running");
+  m_lookAhead = lookAhead;
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookAhead (void) const
+{
+  return m_lookAhead;
+}
+
+// System ID for non-distributed simulation is always zero
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return 0;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::AllocatePacketUid (void)
+{
+  Partition *p = m_current;
+  if (p == 0)
+    {
+      // outside of Run, or between two windows
+      return AllocateSharedPacketUid ();
+    }
+  uint32_t uid = p->packetUid;
+  p->packetUid += m_partitions.size ();
+  return uid;
+}
+
+Scheduler::EventKey
+MultithreadedSimulatorImpl::Insert (Partition *p, uint64_t ts, uint32_t context, EventImpl *event)
+{
+  NS_ASSERT (ts >= p->currentTs);
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  if (m_running)
+    {
+      ev.key.m_uid = p->uid;
+      p->uid += m_partitions.size ();
+    }
+  else
+    {
+      ev.key.m_uid = m_uid;
+      m_uid++;
+    }
+  p->unscheduledEvents++;
+  p->events->Insert (ev);
+  return ev.key;
+}
+
+void
+MultithreadedSimulatorImpl::Repartition (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<Scheduler::Event> events;
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      while (!(*i)->events->IsEmpty ())
+        {
+          events.push_back ((*i)->events->RemoveNext ());
+          (*i)->unscheduledEvents--;
+        }
+      (*i)->cancelledEvents = 0;
+    }
+  for (std::vector<Scheduler::Event>::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      Partition *p = FindPartition (i->key.m_context);
+      p->unscheduledEvents++;
+      if (i->impl->IsCancelled ())
+        {
+          p->cancelledEvents++;
+        }
+      p->events->Insert (*i);
+    }
+  m_repartition = false;
+}
+
+bool
+MultithreadedSimulatorImpl::MessageLess (const Message *a, const Message *b)
+{
+  if (a->ts != b->ts)
+    {
+      return a->ts < b->ts;
+    }
+  if (a->source != b->source)
+    {
+      return a->source < b->source;
+    }
+  return a->sequence < b->sequence;
+}
+
+void
+MultithreadedSimulatorImpl::ProcessMessages (Partition *p)
+{
+  Message *m = p->inbox.exchange (0, std::memory_order_acquire);
+  if (m != 0)
+    {
+      std::vector<Message *> messages;
+      while (m != 0)
+        {
+          messages.push_back (m);
+          m = m->next;
+        }
+      std::sort (messages.begin (), messages.end (), &MultithreadedSimulatorImpl::MessageLess);
+      for (std::vector<Message *>::const_iterator i = messages.begin (); i != messages.end (); ++i)
+        {
+          Insert (p, (*i)->ts, (*i)->context, (*i)->event);
+          delete *i;
+        }
+    }
+  p->nextTs = p->events->IsEmpty () ? MAX_TS : p->events->PeekNext ().key.m_ts;
+  p->stopSnapshot = p->stop;
+  p->stopTsSnapshot = p->stopTs;
+}
+
+void
+MultithreadedSimulatorImpl::ProcessWindow (Partition *p, uint64_t granted)
+{
+  m_current = p;
+  while (!p->stop && !p->events->IsEmpty ())
+    {
+      if (p->events->PeekNext ().key.m_ts >= granted)
+        {
+          break;
+        }
+      Scheduler::Event next = p->events->RemoveNext ();
+
+      NS_ASSERT (next.key.m_ts >= p->currentTs);
+      p->unscheduledEvents--;
+      p->eventCount++;
+      if (p->cancelledEvents > 0 && next.impl->IsCancelled ())
+        {
+          p->cancelledEvents--;
+        }
+
+      p->currentTs = next.key.m_ts;
+      p->currentContext = next.key.m_context;
+      p->currentUid = next.key.m_uid;
+      next.impl->Invoke ();
+      next.impl->Unref ();
+    }
+  m_current = 0;
+}
+
+void
+MultithreadedSimulatorImpl::RunThread (uint32_t thread)
+{
+  uint32_t n = m_partitions.size ();
+  uint64_t lookAhead = n > 1 ? m_lookAhead.GetTimeStep () : MAX_TS;
+  while (true)
+    {
+      for (uint32_t i = thread; i < n; i += m_threadCount)
+        {
+          ProcessMessages (m_partitions[i]);
+        }
+      m_barrier->Wait ();
+
+      // Every thread computes the same window from the snapshots
+      // taken above, which are not modified before the next barrier.
+      uint64_t next = MAX_TS;
+      uint64_t stopTs = MAX_TS;
+      bool stop = false;
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          const Partition *p = m_partitions[i];
+          next = std::min (next, p->nextTs);
+          stopTs = std::min (stopTs, p->stopTsSnapshot);
+          stop = stop || p->stopSnapshot;
+        }
+      if (stop || next == MAX_TS || next > stopTs)
+        {
+          break;
+        }
+      uint64_t granted = next > MAX_TS - lookAhead ? MAX_TS : next + lookAhead;
+      if (stopTs != MAX_TS)
+        {
+          granted = std::min (granted, stopTs + 1);
+        }
+
+      for (uint32_t i = thread; i < n; i += m_threadCount)
+        {
+          ProcessWindow (m_partitions[i], granted);
+        }
+      m_barrier->Wait ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ThreadEntry (std::pair<MultithreadedSimulatorImpl *, uint32_t> context)
+{
+  context.first->RunThread (context.second);
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_main = SystemThread::Self ();
+  if (m_repartition)
+    {
+      Repartition ();
+    }
+  uint32_t n = m_partitions.size ();
+  NS_ABORT_MSG_IF (n > 1 && !m_lookAhead.IsStrictlyPositive (),
+                   "MultithreadedSimulatorImpl requires a strictly positive lookahead "
+                   "to run " << n << " partitions");
+
+  m_threadCount = m_maxThreads;
+  if (m_threadCount == 0)
+    {
+      m_threadCount = std::max (std::thread::hardware_concurrency (), 1U);
+    }
+  m_threadCount = std::min (m_threadCount, n);
+  NS_LOG_LOGIC ("running " << n << " partitions on " << m_threadCount << " threads");
+
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      (*i)->stop = false;
+      // Each partition allocates the uids congruent to its index so
+      // that uids stay unique without any synchronization.
+      (*i)->uid = m_uid + (*i)->index;
+      (*i)->packetUid = m_sharedPacketUid.load () + (*i)->index;
+    }
+
+  m_barrier = new Barrier (m_threadCount);
+  m_running = true;
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t t = 1; t < m_threadCount; ++t)
+    {
+      threads.push_back (Create<SystemThread> (MakeBoundCallback (&MultithreadedSimulatorImpl::ThreadEntry,
+                                                                  std::make_pair (this, t))));
+      threads.back ()->Start ();
+    }
+  RunThread (0);
+  for (std::vector<Ptr<SystemThread> >::iterator i = threads.begin (); i != threads.end (); ++i)
+    {
+      (*i)->Join ();
+    }
+  m_running = false;
+  delete m_barrier;
+  m_barrier = 0;
+
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      Partition *p = *i;
+      m_currentTs = std::max (m_currentTs, p->currentTs);
+      m_uid = std::max (m_uid, p->uid);
+      if (p->packetUid > m_sharedPacketUid.load ())
+        {
+          m_sharedPacketUid.store (p->packetUid);
+        }
+      if (p->stopTs <= p->currentTs)
+        {
+          p->stopTs = MAX_TS;
+        }
+      // If the simulator stopped naturally by lack of events, make a
+      // consistency test to check that we didn't lose any events along the way.
+      NS_ASSERT (!p->events->IsEmpty () || p->unscheduledEvents == 0);
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      if ((*i)->stop)
+        {
+          return true;
+        }
+    }
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      if (!(*i)->events->IsEmpty () || (*i)->inbox.load () != 0)
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  Partition *p = CurrentPartition ();
+  if (p != 0)
+    {
+      p->stop = true;
+      if (p->stopTs <= p->currentTs)
+        {
+          p->stopTs = MAX_TS;
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  Partition *p = CurrentPartition ();
+  uint64_t now = p != 0 ? p->currentTs : m_currentTs;
+  if (p == 0)
+    {
+      p = FindPartition (Simulator::NO_CONTEXT);
+    }
+  // The other partitions must not run past the stop time.
+  p->stopTs = std::min (p->stopTs, now + delay.GetTimeStep ());
+  Simulator::Schedule (delay, &Simulator::Stop);
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep () << event);
+  NS_ASSERT_MSG (delay.IsPositive (), "MultithreadedSimulatorImpl::Schedule(): Negative delay");
+
+  Partition *p = CurrentPartition ();
+  Scheduler::EventKey key;
+  if (p != 0)
+    {
+      key = Insert (p, p->currentTs + delay.GetTimeStep (), p->currentContext, event);
+    }
+  else
+    {
+      NS_ASSERT_MSG (!m_running && SystemThread::Equals (m_main), "Simulator::Schedule Thread-unsafe invocation!");
+      key = Insert (FindPartition (Simulator::NO_CONTEXT), m_currentTs + delay.GetTimeStep (),
+                    Simulator::NO_CONTEXT, event);
+    }
+  return EventId (event, key.m_ts, key.m_context, key.m_uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << event);
+
+  Partition *p = CurrentPartition ();
+  Partition *target = FindPartition (context);
+  if (p == 0)
+    {
+      NS_ASSERT_MSG (!m_running, "Simulator::ScheduleWithContext from a foreign thread is not supported "
+                     "by MultithreadedSimulatorImpl");
+      Insert (target, m_currentTs + delay.GetTimeStep (), context, event);
+    }
+  else if (p == target)
+    {
+      Insert (p, p->currentTs + delay.GetTimeStep (), context, event);
+    }
+  else
+    {
+      NS_ABORT_MSG_IF (delay < m_lookAhead,
+                       "Event scheduled from partition " << p->index << " to partition " <<
+                       target->index << " with delay " << delay.As (Time::S) <<
+                       " smaller than the lookahead " << m_lookAhead.As (Time::S));
+      Message *m = new Message;
+      m->ts = p->currentTs + delay.GetTimeStep ();
+      m->context = context;
+      m->source = p->index;
+      m->sequence = p->sent++;
+      m->event = event;
+      m->next = target->inbox.load (std::memory_order_relaxed);
+      while (!target->inbox.compare_exchange_weak (m->next, m,
+                                                   std::memory_order_release,
+                                                   std::memory_order_relaxed))
+        {
+        }
+    }
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  return Schedule (TimeStep (0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  NS_ASSERT_MSG (!m_running && SystemThread::Equals (m_main), "Simulator::ScheduleDestroy Thread-unsafe invocation!");
+
+  EventId id (Ptr<EventImpl> (event, false), m_currentTs, 0xffffffff, 2);
+  m_destroyEvents.push_back (id);
+  m_uid++;
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  // Do not add function logging here, to avoid stack overflow
+  Partition *p = CurrentPartition ();
+  return TimeStep (p != 0 ? p->currentTs : m_currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs ()) - Now ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition *p = FindPartition (id.GetContext ());
+  NS_ASSERT_MSG (!m_running || p == CurrentPartition (),
+                 "Simulator::Remove of an event owned by another partition");
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  p->events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  p->unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+      if (id.GetUid () == 2)
+        {
+          return;
+        }
+      // The event list of another partition cannot be touched while
+      // running: its cancelled event is only dropped at expiry.
+      Partition *p = FindPartition (id.GetContext ());
+      if (m_running && p != CurrentPartition ())
+        {
+          return;
+        }
+      p->cancelledEvents++;
+      if (m_compactionThreshold < 1
+          && p->cancelledEvents >= m_compactionMinimum
+          && p->cancelledEvents > m_compactionThreshold * p->unscheduledEvents)
+        {
+          uint32_t removed = p->events->Compact ();
+          NS_LOG_LOGIC ("removed " << removed << " of " << p->unscheduledEvents
+                                   << " events of partition " << p->index);
+          p->unscheduledEvents -= removed;
+          p->cancelledEvents -= std::min<uint64_t> (removed, p->cancelledEvents);
+        }
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0
+          || id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  const Partition *p = FindPartition (id.GetContext ());
+  if (id.PeekEventImpl () == 0
+      || id.GetTs () < p->currentTs
+      || (id.GetTs () == p->currentTs && id.GetUid () <= p->currentUid)
+      || id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  Partition *p = CurrentPartition ();
+  return p != 0 ? p->currentContext : Simulator::NO_CONTEXT;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetEventCount (void) const
+{
+  uint64_t count = 0;
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      count += (*i)->eventCount;
+    }
+  return count;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetLiveEventCount (void) const
+{
+  uint64_t count = 0;
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      count += (*i)->unscheduledEvents - (*i)->cancelledEvents;
+    }
+  return count;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetCancelledEventCount (void) const
+{
+  uint64_t count = 0;
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      count += (*i)->cancelledEvents;
+    }
+  return count;
+}
+
+} // namespace ns3
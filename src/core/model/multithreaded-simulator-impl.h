@@ -0,0 +1,324 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTITHREADED_SIMULATOR_IMPL_H
+#define MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "simulator-impl.h"
+#include "scheduler.h"
+#include "event-impl.h"
+#include "system-thread.h"
+#include "nstime.h"
+
+#include "ptr.h"
+
+#include <atomic>
+#include <list>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::MultithreadedSimulatorImpl declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Conservative parallel simulator running partitions on threads.
+ *
+ * Every event context (usually a node id) is mapped to a partition
+ * with SetContextPartition.  Each partition owns its own Scheduler
+ * and its own notion of the current time; the partitions are
+ * processed by a pool of threads within the same process.
+ *
+ * The partitions advance in lock-step time windows, in the same way
+ * as the granted-time-window algorithm of the MPI based
+ * DistributedSimulatorImpl: at the start of each window the smallest
+ * pending timestamp over all partitions is computed, and every
+ * partition may then execute all of its events strictly earlier than
+ * that timestamp plus the lookahead.  The lookahead must therefore
+ * be a lower bound of the delay of every ScheduleWithContext call
+ * which crosses a partition boundary (typically the smallest delay of
+ * the channels connecting two partitions).
+ *
+ * Events sent to another partition are pushed on a lock-free
+ * multi-producer queue owned by the receiving partition and are
+ * moved into its Scheduler at the next window boundary, in an order
+ * which only depends on the simulated time and the sending partition.
+ * The packet uids are also allocated per partition, from the uids
+ * congruent to the partition index.  The output of a simulation is
+ * therefore independent of the number of threads used to run it (but
+ * not of the number of partitions).
+ *
+ * Models which share state between nodes mapped to different
+ * partitions (outside of the events exchanged through
+ * ScheduleWithContext) are not safe to run with this implementation.
+ * Events scheduled without a context (Simulator::NO_CONTEXT) are
+ * executed by partition 0.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  MultithreadedSimulatorImpl ();
+  /** Destructor. */
+  ~MultithreadedSimulatorImpl ();
+
+  // Inherited
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (const Time &delay);
+  virtual EventId Schedule (const Time &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+  virtual uint64_t GetLiveEventCount (void) const;
+  virtual uint64_t GetCancelledEventCount (void) const;
+  virtual uint32_t AllocatePacketUid (void);
+
+  /**
+   * Map an event context to a partition.
+   *
+   * Contexts which were never mapped belong to partition 0.
+   * The mapping can only be changed while the simulator is not
+   * running; pending events are moved to their new partition at
+   * the start of the next Run.
+   *
+   * \param [in] context The event context (node id).
+   * \param [in] partition The partition index.
+   */
+  void SetContextPartition (uint32_t context, uint32_t partition);
+  /**
+   * \param [in] context The event context (node id).
+   * \return The partition which executes the events of this context.
+   */
+  uint32_t GetContextPartition (uint32_t context) const;
+  /** \return The number of partitions. */
+  uint32_t GetPartitionCount (void) const;
+  /**
+   * Set the lookahead, the smallest delay of any event scheduled
+   * from one partition to another.
+   *
+   * \param [in] lookAhead The lookahead, which must be strictly positive
+   *             if more than one partition is in use.
+   */
+  void SetLookAhead (const Time &lookAhead);
+  /** \return The lookahead. */
+  Time GetLookAhead (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  /** An event sent to a partition by another partition. */
+  struct Message
+  {
+    /** Next message in the queue. */
+    Message *next;
+    /** Absolute timestamp of the event. */
+    uint64_t ts;
+    /** The event context. */
+    uint32_t context;
+    /** The sending partition. */
+    uint32_t source;
+    /** Sequence number of the message in the sending partition. */
+    uint64_t sequence;
+    /** The event implementation. */
+    EventImpl *event;
+  };
+
+  /** The state of one partition. */
+  struct Partition
+  {
+    /** The event priority queue. */
+    Ptr<Scheduler> events;
+    /**
+     * Head of the lock-free stack of events received from other
+     * partitions, drained at each window boundary.
+     */
+    std::atomic<Message *> inbox;
+    /** Index of this partition. */
+    uint32_t index;
+    /** Next event unique id (incremented by the number of partitions). */
+    uint32_t uid;
+    /** Next packet unique id (incremented by the number of partitions). */
+    uint32_t packetUid;
+    /** Unique id of the current event. */
+    uint32_t currentUid;
+    /** Timestamp of the current event. */
+    uint64_t currentTs;
+    /** Execution context of the current event. */
+    uint32_t currentContext;
+    /** The event count. */
+    uint64_t eventCount;
+    /** Number of events inserted but not yet executed. */
+    int unscheduledEvents;
+    /** Number of cancelled events still in the event list. */
+    uint64_t cancelledEvents;
+    /** Number of messages sent to other partitions. */
+    uint64_t sent;
+    /** Flag set by Simulator::Stop within this partition. */
+    bool stop;
+    /** Earliest time requested with Simulator::Stop (delay). */
+    uint64_t stopTs;
+    /** Timestamp of the next pending event, at the last window boundary. */
+    uint64_t nextTs;
+    /** Value of stop at the last window boundary. */
+    bool stopSnapshot;
+    /** Value of stopTs at the last window boundary. */
+    uint64_t stopTsSnapshot;
+  };
+
+  /** A reusable spinning barrier shared by the worker threads. */
+  class Barrier
+  {
+  public:
+    /**
+     * Constructor.
+     * \param [in] count The number of threads to synchronize.
+     */
+    Barrier (uint32_t count);
+    /** Block until all threads have called Wait. */
+    void Wait (void);
+  private:
+    /** The number of threads to synchronize. */
+    uint32_t m_count;
+    /** The number of threads still expected in the current round. */
+    std::atomic<uint32_t> m_remaining;
+    /** The current round. */
+    std::atomic<uint32_t> m_generation;
+  };
+
+  /**
+   * Get a partition, creating it if needed.
+   * \param [in] index The partition index.
+   * \return The partition.
+   */
+  Partition * GetPartition (uint32_t index);
+  /**
+   * \param [in] context The event context.
+   * \return The partition which executes the events of this context.
+   */
+  Partition * FindPartition (uint32_t context) const;
+  /**
+   * \return The partition executing on the calling thread, or the
+   * partition 0 outside of Run.
+   */
+  Partition * CurrentPartition (void) const;
+  /**
+   * Insert an event in a partition.
+   * \param [in] p The partition.
+   * \param [in] ts The absolute timestamp.
+   * \param [in] context The event context.
+   * \param [in] event The event implementation.
+   * \return The key of the inserted event.
+   */
+  Scheduler::EventKey Insert (Partition *p, uint64_t ts, uint32_t context, EventImpl *event);
+  /**
+   * Order the events received by a partition independently of the
+   * order in which the sending threads pushed them.
+   * \param [in] a The first message.
+   * \param [in] b The second message.
+   * \return \c true if \p a must be inserted before \p b.
+   */
+  static bool MessageLess (const Message *a, const Message *b);
+  /** Move pending events to the partition of their context. */
+  void Repartition (void);
+  /**
+   * Move the events received from other partitions into the
+   * scheduler of a partition, and take the window boundary snapshot.
+   * \param [in] p The partition.
+   */
+  void ProcessMessages (Partition *p);
+  /**
+   * Execute the events of a partition earlier than a granted time.
+   * \param [in] p The partition.
+   * \param [in] granted The end of the current window (exclusive).
+   */
+  void ProcessWindow (Partition *p, uint64_t granted);
+  /**
+   * Thread entry point: process the partitions assigned to a thread
+   * until the simulation ends.
+   * \param [in] thread The thread index.
+   */
+  void RunThread (uint32_t thread);
+  /**
+   * SystemThread entry point.
+   * \param [in] context The simulator and the thread index.
+   */
+  static void ThreadEntry (std::pair<MultithreadedSimulatorImpl *, uint32_t> context);
+
+  /** The partitions. */
+  std::vector<Partition *> m_partitions;
+  /** The partition index of each context. */
+  std::vector<uint32_t> m_contextPartition;
+  /** \c true if the context map changed since the last Run. */
+  bool m_repartition;
+  /** The factory used to create the scheduler of each partition. */
+  ObjectFactory m_schedulerFactory;
+
+  /** Container type for the events to run at Simulator::Destroy() */
+  typedef std::list<EventId> DestroyEvents;
+  /** The container of events to run at Destroy. */
+  DestroyEvents m_destroyEvents;
+
+  /** The lookahead. */
+  Time m_lookAhead;
+  /** Maximum number of threads, 0 for one per hardware thread. */
+  uint32_t m_maxThreads;
+  /** Fraction of cancelled events which triggers a compaction. */
+  double m_compactionThreshold;
+  /** Smallest number of cancelled events which triggers a compaction. */
+  uint32_t m_compactionMinimum;
+  /** The number of threads of the current Run. */
+  uint32_t m_threadCount;
+  /** The barrier of the current Run. */
+  Barrier *m_barrier;
+  /** \c true while Run executes. */
+  bool m_running;
+  /** Current time outside of Run, the latest partition time. */
+  uint64_t m_currentTs;
+  /** Next event unique id, used outside of Run. */
+  uint32_t m_uid;
+  /** Main execution thread. */
+  SystemThread::ThreadId m_main;
+  /** The partition being processed by the calling thread, if any. */
+  static thread_local Partition *m_current;
+};
+
+} // namespace ns3
+
+#endif /* MULTITHREADED_SIMULATOR_IMPL_H */
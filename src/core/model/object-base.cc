@@ -26,6 +26,7 @@
 
 #include <cstdlib>  // getenv
 #include <cstring>  // strlen
+#include <vector>
 
 /**
  * \file
@@ -81,6 +82,30 @@ ObjectBase::ConstructSelf (const AttributeConstructionList &attributes)
 {
   // loop over the inheritance tree back to the Object base class.
   NS_LOG_FUNCTION (this << &attributes);
+
+  // Parse the env var once, rather than for each attribute.
+  std::vector<std::pair<std::string, std::string> > envDefaults;
+  const char *envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
+  if (envVar != 0 && std::strlen (envVar) > 0)
+    {
+      std::string env = envVar;
+      std::string::size_type cur = 0;
+      std::string::size_type next = 0;
+      while (next != std::string::npos)
+        {
+          next = env.find (";", cur);
+          std::string tmp = std::string (env, cur, next - cur);
+          std::string::size_type equal = tmp.find ("=");
+          if (equal != std::string::npos)
+            {
+              std::string name = tmp.substr (0, equal);
+              std::string envval = tmp.substr (equal + 1, tmp.size () - equal - 1);
+              envDefaults.push_back (std::make_pair (name, envval));
+            }
+          cur = next + 1;
+        }
+    }
+
   TypeId tid = GetInstanceTypeId ();
   do
     {
@@ -126,32 +151,21 @@ ObjectBase::ConstructSelf (const AttributeConstructionList &attributes)
             }
 
           // No matching attribute value so we try to look at the env var.
-          const char *envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
-          if (envVar != 0 && std::strlen (envVar) > 0)
+          if (!envDefaults.empty ())
             {
-              std::string env = envVar;
-              std::string::size_type cur = 0;
-              std::string::size_type next = 0;
-              while (next != std::string::npos)
+              std::string fullName = tid.GetAttributeFullName (i);
+              for (std::vector<std::pair<std::string, std::string> >::const_iterator k = envDefaults.begin ();
+                   k != envDefaults.end (); ++k)
                 {
-                  next = env.find (";", cur);
-                  std::string tmp = std::string (env, cur, next - cur);
-                  std::string::size_type equal = tmp.find ("=");
-                  if (equal != std::string::npos)
+                  if (k->first == fullName)
                     {
-                      std::string name = tmp.substr (0, equal);
-                      std::string envval = tmp.substr (equal + 1, tmp.size () - equal - 1);
-                      if (name == tid.GetAttributeFullName (i))
+                      if (DoSet (info.accessor, info.checker, StringValue (k->second)))
                         {
-                          if (DoSet (info.accessor, info.checker, StringValue (envval)))
-                            {
-                              NS_LOG_DEBUG ("construct \"" << tid.GetName () << "::" <<
-                                            info.name << "\" from env var");
-                              break;
-                            }
+                          NS_LOG_DEBUG ("construct \"" << tid.GetName () << "::" <<
+                                        info.name << "\" from env var");
+                          break;
                         }
                     }
-                  cur = next + 1;
                 }
             }
 
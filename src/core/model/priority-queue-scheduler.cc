@@ -111,4 +111,32 @@ PriorityQueueScheduler::Remove (const Scheduler::Event &ev)
   m_queue.remove (ev);
 }
 
+uint32_t
+PriorityQueueScheduler::EventPriorityQueue::compact(void)
+{
+  auto last = this->c.begin();
+  for (auto it = this->c.begin(); it != this->c.end(); ++it)
+    {
+      if (it->impl->IsCancelled())
+        {
+          it->impl->Unref();
+        }
+      else
+        {
+          *last++ = *it;
+        }
+    }
+  uint32_t removed = this->c.end() - last;
+  this->c.erase(last, this->c.end());
+  std::make_heap(this->c.begin(), this->c.end(), this->comp);
+  return removed;
+}
+
+uint32_t
+PriorityQueueScheduler::Compact (void)
+{
+  NS_LOG_FUNCTION (this);
+  return m_queue.compact ();
+}
+
 } // namespace ns3
@@ -81,6 +81,7 @@ public:
   virtual Scheduler::Event PeekNext (void) const;
   virtual Scheduler::Event RemoveNext (void);
   virtual void Remove (const Scheduler::Event &ev);
+  virtual uint32_t Compact (void);
 
 private:
 
@@ -100,6 +101,11 @@ private:
      * \returns \c true if the event was found, false otherwise.
      */
     bool remove(const Scheduler::Event &ev);
+
+    /**
+     * \copydoc PriorityQueueScheduler::Compact()
+     */
+    uint32_t compact(void);
     
   };  // class EventPriorityQueue
 
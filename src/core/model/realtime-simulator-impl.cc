@@ -31,8 +31,11 @@
 #include "system-mutex.h"
 #include "boolean.h"
 #include "enum.h"
+#include "double.h"
+#include "uinteger.h"
 
 
+#include <algorithm>
 #include <cmath>
 
 
@@ -69,6 +72,18 @@ RealtimeSimulatorImpl::GetTypeId (void)
                    TimeValue (Seconds (0.1)),
                    MakeTimeAccessor (&RealtimeSimulatorImpl::m_hardLimit),
                    MakeTimeChecker ())
+    .AddAttribute ("CompactionThreshold",
+                   "Fraction of cancelled events in the event list above "
+                   "which they are removed from it; 1 disables the compaction.",
+                   DoubleValue (0.5),
+                   MakeDoubleAccessor (&RealtimeSimulatorImpl::m_compactionThreshold),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("CompactionMinimum",
+                   "Smallest number of cancelled events for which the event "
+                   "list is compacted.",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&RealtimeSimulatorImpl::m_compactionMinimum),
+                   MakeUintegerChecker<uint32_t> (1))
   ;
   return tid;
 }
@@ -91,6 +106,9 @@ RealtimeSimulatorImpl::RealtimeSimulatorImpl ()
   m_currentContext = Simulator::NO_CONTEXT;
   m_unscheduledEvents = 0;
   m_eventCount = 0;
+  m_cancelledEvents = 0;
+  m_compactionThreshold = 0.5;
+  m_compactionMinimum = 1024;
 
   m_main = SystemThread::Self ();
 
@@ -332,6 +350,10 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
     next = m_events->RemoveNext ();
     m_unscheduledEvents--;
     m_eventCount++;
+    if (m_cancelledEvents > 0 && next.impl->IsCancelled ())
+      {
+        m_cancelledEvents--;
+      }
 
     //
     // We cannot make any assumption that "next" is the same event we originally waited
@@ -754,6 +776,20 @@ RealtimeSimulatorImpl::Cancel (const EventId &id)
   if (IsExpired (id) == false)
     {
       id.PeekEventImpl ()->Cancel ();
+      if (id.GetUid () != 2)
+        {
+          CriticalSection cs (m_mutex);
+          m_cancelledEvents++;
+          if (m_compactionThreshold < 1
+              && m_cancelledEvents >= m_compactionMinimum
+              && m_cancelledEvents > m_compactionThreshold * m_unscheduledEvents)
+            {
+              uint32_t removed = m_events->Compact ();
+              NS_LOG_LOGIC ("removed " << removed << " of " << m_unscheduledEvents << " events");
+              m_unscheduledEvents -= removed;
+              m_cancelledEvents -= std::min<uint64_t> (removed, m_cancelledEvents);
+            }
+        }
     }
 }
 
@@ -825,6 +861,18 @@ RealtimeSimulatorImpl::GetEventCount (void) const
   return m_eventCount;
 }
 
+uint64_t
+RealtimeSimulatorImpl::GetLiveEventCount (void) const
+{
+  return m_unscheduledEvents - m_cancelledEvents;
+}
+
+uint64_t
+RealtimeSimulatorImpl::GetCancelledEventCount (void) const
+{
+  return m_cancelledEvents;
+}
+
 void
 RealtimeSimulatorImpl::SetSynchronizationMode (enum SynchronizationMode mode)
 {
@@ -109,6 +109,8 @@ public:
   virtual uint32_t GetSystemId (void) const;
   virtual uint32_t GetContext (void) const;
   virtual uint64_t GetEventCount (void) const;
+  virtual uint64_t GetLiveEventCount (void) const;
+  virtual uint64_t GetCancelledEventCount (void) const;
 
   /** \copydoc ScheduleWithContext(uint32_t,const Time&,EventImpl*) */
   void ScheduleRealtimeWithContext (uint32_t context, const Time &delay, EventImpl *event);
@@ -206,6 +208,12 @@ private:
   uint32_t m_currentContext;
   /** The event count. */
   uint64_t m_eventCount;
+  /** Number of cancelled events still in the event list. */
+  uint64_t m_cancelledEvents;
+  /** Fraction of cancelled events which triggers a compaction. */
+  double m_compactionThreshold;
+  /** Smallest number of cancelled events which triggers a compaction. */
+  uint32_t m_compactionMinimum;
   /**@}*/
 
   /** Mutex to control access to key state. */
@@ -19,9 +19,12 @@
  */
 
 #include "scheduler.h"
+#include "event-impl.h"
 #include "assert.h"
 #include "log.h"
 
+#include <vector>
+
 /**
  * \file
  * \ingroup scheduler
@@ -49,4 +52,30 @@ Scheduler::GetTypeId (void)
   return tid;
 }
 
+uint32_t
+Scheduler::Compact (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<Event> live;
+  uint32_t removed = 0;
+  while (!IsEmpty ())
+    {
+      Event ev = RemoveNext ();
+      if (ev.impl->IsCancelled ())
+        {
+          ev.impl->Unref ();
+          removed++;
+        }
+      else
+        {
+          live.push_back (ev);
+        }
+    }
+  for (std::vector<Event>::const_iterator i = live.begin (); i != live.end (); ++i)
+    {
+      Insert (*i);
+    }
+  return removed;
+}
+
 } // namespace ns3
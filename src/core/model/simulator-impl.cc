@@ -42,4 +42,18 @@ SimulatorImpl::GetTypeId (void)
   return tid;
 }
 
+std::atomic<uint32_t> SimulatorImpl::m_sharedPacketUid (0);
+
+uint32_t
+SimulatorImpl::AllocatePacketUid (void)
+{
+  return AllocateSharedPacketUid ();
+}
+
+uint32_t
+SimulatorImpl::AllocateSharedPacketUid (void)
+{
+  return m_sharedPacketUid.fetch_add (1, std::memory_order_relaxed);
+}
+
 } // namespace ns3
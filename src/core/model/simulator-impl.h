@@ -28,6 +28,8 @@
 #include "object-factory.h"
 #include "ptr.h"
 
+#include <atomic>
+
 /**
  * \file
  * \ingroup simulator
@@ -101,6 +103,28 @@ public:
   virtual uint32_t GetContext (void) const = 0;
   /** \copydoc Simulator::GetEventCount */
   virtual uint64_t GetEventCount (void) const = 0;
+  /** \copydoc Simulator::GetLiveEventCount */
+  virtual uint64_t GetLiveEventCount (void) const = 0;
+  /** \copydoc Simulator::GetCancelledEventCount */
+  virtual uint64_t GetCancelledEventCount (void) const = 0;
+  /**
+   * \copydoc Simulator::AllocatePacketUid
+   *
+   * The default implementation calls AllocateSharedPacketUid.
+   */
+  virtual uint32_t AllocatePacketUid (void);
+
+  /**
+   * Allocate a packet uid from the counter shared by all the threads,
+   * which is also used before any simulator implementation is created.
+   *
+   * \return The packet uid.
+   */
+  static uint32_t AllocateSharedPacketUid (void);
+
+protected:
+  /** The counter of AllocateSharedPacketUid. */
+  static std::atomic<uint32_t> m_sharedPacketUid;
 
 };
 
@@ -308,6 +308,18 @@ Simulator::GetEventCount (void)
   return GetImpl ()->GetEventCount ();
 }
 
+uint64_t
+Simulator::GetLiveEventCount (void)
+{
+  return GetImpl ()->GetLiveEventCount ();
+}
+
+uint64_t
+Simulator::GetCancelledEventCount (void)
+{
+  return GetImpl ()->GetCancelledEventCount ();
+}
+
 uint32_t
 Simulator::GetSystemId (void)
 {
@@ -323,6 +335,17 @@ Simulator::GetSystemId (void)
     }
 }
 
+uint32_t
+Simulator::AllocatePacketUid (void)
+{
+  SimulatorImpl *impl = *PeekImpl ();
+  if (impl != 0)
+    {
+      return impl->AllocatePacketUid ();
+    }
+  return SimulatorImpl::AllocateSharedPacketUid ();
+}
+
 void
 Simulator::SetImplementation (Ptr<SimulatorImpl> impl)
 {
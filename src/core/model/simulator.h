@@ -205,6 +205,22 @@ public:
    */
   static uint64_t GetEventCount (void);
 
+  /**
+   * Get the number of events waiting to be executed, excluding the
+   * cancelled ones.
+   * \returns The number of live pending events.
+   */
+  static uint64_t GetLiveEventCount (void);
+
+  /**
+   * Get the number of cancelled events still held by the event list.
+   *
+   * A cancelled event stays in the event list until its expiry time,
+   * unless the simulator implementation compacts the event list first.
+   * \returns The number of cancelled pending events.
+   */
+  static uint64_t GetCancelledEventCount (void);
+
 
   /**
    * @name Schedule events (in the same context) to run at a future time.
@@ -494,6 +510,16 @@ public:
    */
   static uint32_t GetSystemId (void);
 
+  /**
+   * Allocate the unique id of a new packet.
+   *
+   * The simulator implementation decides how the uids are allocated:
+   * the MultithreadedSimulatorImpl allocates them per partition, so
+   * that they do not depend on the number of threads.
+   * @return The packet uid, which Packet combines with the system id.
+   */
+  static uint32_t AllocatePacketUid (void);
+
 private:
   /** Default constructor. */
   Simulator ();
@@ -21,7 +21,7 @@
 #ifndef TRACED_CALLBACK_H
 #define TRACED_CALLBACK_H
 
-#include <list>
+#include <vector>
 #include "callback.h"
 
 /**
@@ -46,6 +46,18 @@ namespace ns3 {
  * calling the \c operator() form with the appropriate
  * number of arguments.
  *
+ * Most trace sources have no Callback connected, and those which do
+ * rarely have more than one.  The first Callback of the chain is
+ * therefore stored inline, and the following ones in a contiguous
+ * vector, so that invoking a trace source without Callback only tests
+ * a pointer, inline, and invoking a single Callback does not chase
+ * list nodes.
+ *
+ * When ns-3 is configured with \c --disable-tracing, which defines
+ * \c NS3_TRACING_DISABLE, the trace sources are compiled out: the
+ * TracedCallback is an empty class, the Callbacks connected to it are
+ * dropped and invoking it does nothing.
+ *
  * \tparam Ts \explicit Types of the functor arguments.
  */
 template<typename... Ts>
@@ -89,6 +101,10 @@ public:
    * \param [in] args The arguments to the functor
    */
   void operator() (Ts... args) const;
+  /**
+   * \return \c true if no Callback is connected.
+   */
+  bool IsEmpty (void) const;
 
   /**
    *  TracedCallback signature for POD.
@@ -101,15 +117,32 @@ public:
   typedef void (* Uint32Callback)(const uint32_t value);
   /**@}*/
 
+#ifndef NS3_TRACING_DISABLE
 private:
   /**
-   * Container type for holding the chain of Callbacks.
+   * Append a Callback to the chain.
+   *
+   * \param [in] callback The Callback.
+   */
+  void Append (const Callback<void,Ts...> &callback);
+  /**
+   * Invoke the Callbacks following the first one.
+   *
+   * \param [in] args The arguments to the functor
+   */
+  void InvokeOthers (Ts... args) const;
+
+  /**
+   * Container type for holding the Callbacks following the first one.
    *
    * \tparam Ts \deduced Types of the functor arguments.
    */
-  typedef std::list<Callback<void,Ts...> > CallbackList;
-  /** The chain of Callbacks. */
+  typedef std::vector<Callback<void,Ts...> > CallbackList;
+  /** The first Callback of the chain, null if the chain is empty. */
+  Callback<void,Ts...> m_first;
+  /** The rest of the chain of Callbacks. */
   CallbackList m_callbackList;
+#endif /* NS3_TRACING_DISABLE */
 };
 
 } // namespace ns3
@@ -121,12 +154,28 @@ private:
 
 namespace ns3 {
 
+#ifndef NS3_TRACING_DISABLE
+
 template<typename... Ts>
 TracedCallback<Ts...>::TracedCallback ()
-  : m_callbackList ()
+  : m_first (),
+    m_callbackList ()
 {}
 template<typename... Ts>
 void
+TracedCallback<Ts...>::Append (const Callback<void,Ts...> &callback)
+{
+  if (m_first.IsNull ())
+    {
+      m_first = callback;
+    }
+  else
+    {
+      m_callbackList.push_back (callback);
+    }
+}
+template<typename... Ts>
+void
 TracedCallback<Ts...>::ConnectWithoutContext (const CallbackBase & callback)
 {
   Callback<void,Ts...> cb;
@@ -134,7 +183,7 @@ TracedCallback<Ts...>::ConnectWithoutContext (const CallbackBase & callback)
     {
       NS_FATAL_ERROR_NO_MSG ();
     }
-  m_callbackList.push_back (cb);
+  Append (cb);
 }
 template<typename... Ts>
 void
@@ -146,7 +195,7 @@ TracedCallback<Ts...>::Connect (const CallbackBase & callback, std::string path)
       NS_FATAL_ERROR ("when connecting to " << path);
     }
   Callback<void,Ts...> realCb = cb.Bind (path);
-  m_callbackList.push_back (realCb);
+  Append (realCb);
 }
 template<typename... Ts>
 void
@@ -164,6 +213,19 @@ TracedCallback<Ts...>::DisconnectWithoutContext (const CallbackBase & callback)
           i++;
         }
     }
+  if (!m_first.IsNull () && m_first.IsEqual (callback))
+    {
+      // keep the chain order: the second Callback becomes the first
+      if (m_callbackList.empty ())
+        {
+          m_first = Callback<void,Ts...> ();
+        }
+      else
+        {
+          m_first = m_callbackList.front ();
+          m_callbackList.erase (m_callbackList.begin ());
+        }
+    }
 }
 template<typename... Ts>
 void
@@ -178,15 +240,70 @@ TracedCallback<Ts...>::Disconnect (const CallbackBase & callback, std::string pa
   DisconnectWithoutContext (realCb);
 }
 template<typename... Ts>
-void
+inline void
 TracedCallback<Ts...>::operator() (Ts... args) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull ())
+    {
+      return;
+    }
+  m_first (args...);
+  if (!m_callbackList.empty ())
+    {
+      InvokeOthers (args...);
+    }
+}
+template<typename... Ts>
+void
+TracedCallback<Ts...>::InvokeOthers (Ts... args) const
+{
+  // A Callback may connect another one to this trace source, which
+  // can reallocate the vector: iterate by index.
+  for (std::size_t i = 0; i < m_callbackList.size (); i++)
     {
-      (*i)(args...);
+      m_callbackList[i] (args...);
     }
 }
+template<typename... Ts>
+inline bool
+TracedCallback<Ts...>::IsEmpty (void) const
+{
+  return m_first.IsNull ();
+}
+
+#else /* NS3_TRACING_DISABLE */
+
+template<typename... Ts>
+TracedCallback<Ts...>::TracedCallback ()
+{}
+template<typename... Ts>
+void
+TracedCallback<Ts...>::ConnectWithoutContext (const CallbackBase & callback)
+{}
+template<typename... Ts>
+void
+TracedCallback<Ts...>::Connect (const CallbackBase & callback, std::string path)
+{}
+template<typename... Ts>
+void
+TracedCallback<Ts...>::DisconnectWithoutContext (const CallbackBase & callback)
+{}
+template<typename... Ts>
+void
+TracedCallback<Ts...>::Disconnect (const CallbackBase & callback, std::string path)
+{}
+template<typename... Ts>
+inline void
+TracedCallback<Ts...>::operator() (Ts... args) const
+{}
+template<typename... Ts>
+inline bool
+TracedCallback<Ts...>::IsEmpty (void) const
+{
+  return true;
+}
+
+#endif /* NS3_TRACING_DISABLE */
 
 } // namespace ns3
 
@@ -216,11 +216,15 @@ public:
    */
   void Set (const T &v)
   {
+#ifndef NS3_TRACING_DISABLE
     if (m_v != v)
       {
         m_cb (m_v, v);
         m_v = v;
       }
+#else
+    m_v = v;
+#endif
   }
   /**
    * Get the underlying value.
@@ -22,8 +22,10 @@
 #include "type-id.h"
 #include "singleton.h"
 #include "trace-source-accessor.h"
+#include "system-mutex.h"
 
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <sstream>
 #include <iomanip>
@@ -53,6 +55,11 @@ NS_LOG_COMPONENT_DEFINE ("TypeId");
  * Information records are stored in a vector.  Name and hash lookup
  * are performed by maps to the vector index.
  *
+ * Each record also has hashed indices of the Attributes and TraceSources
+ * of the type, including the inherited ones, built on the first lookup.
+ * Adding an Attribute, a TraceSource or a parent to any type increments
+ * a generation counter, which invalidates all the indices built before.
+ *
  * \internal
  * <b>Hash Chaining</b>
  *
@@ -78,6 +85,8 @@ NS_LOG_COMPONENT_DEFINE ("TypeId");
 class IidManager : public Singleton<IidManager>
 {
 public:
+  /** Constructor. */
+  IidManager ();
   /**
    * Create a new unique type id.
    * \param [in] name The name of this type id.
@@ -228,7 +237,17 @@ public:
    * \param [in] i Index into attribute array
    * \returns The information associated to attribute whose index is \pname{i}.
    */
-  struct TypeId::AttributeInformation GetAttribute (uint16_t uid, std::size_t i) const;
+  const struct TypeId::AttributeInformation & GetAttribute (uint16_t uid, std::size_t i) const;
+  /**
+   * Find an Attribute by name in a type id or its parents.
+   * \param [in] uid The id.
+   * \param [in] name The Attribute name.
+   * \param [out] owner The id of the type which declares the Attribute.
+   * \param [out] index The index of the Attribute in \pname{owner}.
+   * \returns \c true if the Attribute was found.
+   */
+  bool LookupAttribute (uint16_t uid, const std::string &name,
+                        uint16_t *owner, std::size_t *index) const;
   /**
    * Record a new TraceSource.
    * \param [in] uid The id.
@@ -263,7 +282,17 @@ public:
    * \param [in] i Index into trace source array.
    * \returns Detailed information about the requested trace source.
    */
-  struct TypeId::TraceSourceInformation GetTraceSource (uint16_t uid, std::size_t i) const;
+  const struct TypeId::TraceSourceInformation & GetTraceSource (uint16_t uid, std::size_t i) const;
+  /**
+   * Find a TraceSource by name in a type id or its parents.
+   * \param [in] uid The id.
+   * \param [in] name The TraceSource name.
+   * \param [out] owner The id of the type which declares the TraceSource.
+   * \param [out] index The index of the TraceSource in \pname{owner}.
+   * \returns \c true if the TraceSource was found.
+   */
+  bool LookupTraceSource (uint16_t uid, const std::string &name,
+                          uint16_t *owner, std::size_t *index) const;
   /**
    * Check if this TypeId should not be listed in documentation.
    * \param [in] uid The id.
@@ -293,6 +322,13 @@ private:
    */
   static TypeId::hash_t Hasher (const std::string name);
 
+  /**
+   * Location of an Attribute or TraceSource: the id of the type
+   * which declares it, and its index there.
+   */
+  typedef std::pair<uint16_t, std::size_t> IndexEntry;
+  /** Type of the by-name indices of Attributes and TraceSources. */
+  typedef std::unordered_map<std::string, IndexEntry> NameIndex;
   /** The information record about a single type id. */
   struct IidInformation
   {
@@ -320,6 +356,12 @@ private:
     TypeId::SupportLevel supportLevel;
     /** Support message. */
     std::string supportMsg;
+    /** The by-name index of the Attributes, including inherited ones. */
+    NameIndex attributeIndex;
+    /** The by-name index of the TraceSources, including inherited ones. */
+    NameIndex traceSourceIndex;
+    /** The generation of the indices, or 0 if they are not built. */
+    uint32_t indexGeneration;
   };
   /** Iterator type. */
   typedef std::vector<struct IidInformation>::const_iterator Iterator;
@@ -330,6 +372,14 @@ private:
    * \returns The information record.
    */
   struct IidManager::IidInformation * LookupInformation (uint16_t uid) const;
+  /**
+   * Get the information record for a type, with up to date indices.
+   *
+   * The caller must hold m_indexMutex.
+   * \param [in] uid The id.
+   * \returns The information record.
+   */
+  struct IidManager::IidInformation * LookupIndexedInformation (uint16_t uid) const;
 
   /** The container of all type id records. */
   std::vector<struct IidInformation> m_information;
@@ -344,6 +394,11 @@ private:
   /** The by-hash index. */
   hashmap_t m_hashmap;
 
+  /** The current generation of the Attribute and TraceSource indices. */
+  uint32_t m_indexGeneration;
+  /** Mutex protecting the lazy construction of the indices. */
+  mutable SystemMutex m_indexMutex;
+
 
   /** IidManager constants. */
   enum
@@ -380,6 +435,12 @@ IidManager::Hasher (const std::string name)
  */
 #define IIDL IID << ": "
 
+IidManager::IidManager ()
+  : m_indexGeneration (1)
+{
+  NS_LOG_FUNCTION (IID);
+}
+
 uint16_t
 IidManager::AllocateUid (std::string name)
 {
@@ -443,6 +504,7 @@ IidManager::AllocateUid (std::string name)
   information.hasConstructor = false;
   information.mustHideFromDocumentation = false;
   information.supportLevel = TypeId::SUPPORTED;
+  information.indexGeneration = 0;
   m_information.push_back (information);
   std::size_t tuid = m_information.size ();
   NS_ASSERT (tuid <= 0xffff);
@@ -471,6 +533,8 @@ IidManager::SetParent (uint16_t uid, uint16_t parent)
   NS_ASSERT (parent <= m_information.size ());
   struct IidInformation *information = LookupInformation (uid);
   information->parent = parent;
+  CriticalSection critical (m_indexMutex);
+  m_indexGeneration++;
 }
 void
 IidManager::SetGroupName (uint16_t uid, std::string groupName)
@@ -681,6 +745,8 @@ IidManager::AddAttribute (uint16_t uid,
   info.supportLevel = supportLevel;
   info.supportMsg = supportMsg;
   information->attributes.push_back (info);
+  CriticalSection critical (m_indexMutex);
+  m_indexGeneration++;
   NS_LOG_LOGIC (IIDL << information->attributes.size () - 1);
 }
 void
@@ -705,7 +771,7 @@ IidManager::GetAttributeN (uint16_t uid) const
   NS_LOG_LOGIC (IIDL << size);
   return size;
 }
-struct TypeId::AttributeInformation
+const struct TypeId::AttributeInformation &
 IidManager::GetAttribute (uint16_t uid, std::size_t i) const
 {
   NS_LOG_FUNCTION (IID << uid << i);
@@ -715,6 +781,65 @@ IidManager::GetAttribute (uint16_t uid, std::size_t i) const
   return information->attributes[i];
 }
 
+struct IidManager::IidInformation *
+IidManager::LookupIndexedInformation (uint16_t uid) const
+{
+  NS_LOG_FUNCTION (IID << uid);
+  struct IidInformation *information = LookupInformation (uid);
+  if (information->indexGeneration == m_indexGeneration)
+    {
+      return information;
+    }
+  NS_LOG_LOGIC (IIDL << "indexing " << information->name);
+  information->attributeIndex.clear ();
+  information->traceSourceIndex.clear ();
+  // Walk up the inheritance tree: the first entry found for a name,
+  // in the most derived type, is the one which the linear search of
+  // the parents would find.
+  uint16_t cur = uid;
+  while (true)
+    {
+      struct IidInformation *ancestor = LookupInformation (cur);
+      for (std::size_t i = 0; i < ancestor->attributes.size (); i++)
+        {
+          information->attributeIndex.insert (std::make_pair (ancestor->attributes[i].name,
+                                                              IndexEntry (cur, i)));
+        }
+      for (std::size_t i = 0; i < ancestor->traceSources.size (); i++)
+        {
+          information->traceSourceIndex.insert (std::make_pair (ancestor->traceSources[i].name,
+                                                                IndexEntry (cur, i)));
+        }
+      if (ancestor->parent == cur || ancestor->parent == 0)
+        {
+          // top of inheritance tree
+          break;
+        }
+      cur = ancestor->parent;
+    }
+  information->indexGeneration = m_indexGeneration;
+  return information;
+}
+
+bool
+IidManager::LookupAttribute (uint16_t uid, const std::string &name,
+                             uint16_t *owner, std::size_t *index) const
+{
+  NS_LOG_FUNCTION (IID << uid << name);
+  CriticalSection critical (m_indexMutex);
+  struct IidInformation *information = LookupIndexedInformation (uid);
+  NameIndex::const_iterator found = information->attributeIndex.find (name);
+  if (found == information->attributeIndex.end ())
+    {
+      NS_LOG_LOGIC (IIDL << false);
+      return false;
+    }
+  *owner = found->second.first;
+  *index = found->second.second;
+  NS_LOG_LOGIC (IIDL << *owner << " " << *index);
+  return true;
+}
+
 bool
 IidManager::HasTraceSource (uint16_t uid,
                             std::string name)
@@ -773,6 +898,8 @@ IidManager::AddTraceSource (uint16_t uid,
   source.supportLevel = supportLevel;
   source.supportMsg = supportMsg;
   information->traceSources.push_back (source);
+  CriticalSection critical (m_indexMutex);
+  m_indexGeneration++;
   NS_LOG_LOGIC (IIDL << information->traceSources.size () - 1);
 }
 std::size_t
@@ -784,7 +911,7 @@ IidManager::GetTraceSourceN (uint16_t uid) const
   NS_LOG_LOGIC (IIDL << size);
   return size;
 }
-struct TypeId::TraceSourceInformation
+const struct TypeId::TraceSourceInformation &
 IidManager::GetTraceSource (uint16_t uid, std::size_t i) const
 {
   NS_LOG_FUNCTION (IID << uid << i);
@@ -794,6 +921,24 @@ IidManager::GetTraceSource (uint16_t uid, std::size_t i) const
   return information->traceSources[i];
 }
 bool
+IidManager::LookupTraceSource (uint16_t uid, const std::string &name,
+                               uint16_t *owner, std::size_t *index) const
+{
+  NS_LOG_FUNCTION (IID << uid << name);
+  CriticalSection critical (m_indexMutex);
+  struct IidInformation *information = LookupIndexedInformation (uid);
+  NameIndex::const_iterator found = information->traceSourceIndex.find (name);
+  if (found == information->traceSourceIndex.end ())
+    {
+      NS_LOG_LOGIC (IIDL << false);
+      return false;
+    }
+  *owner = found->second.first;
+  *index = found->second.second;
+  NS_LOG_LOGIC (IIDL << *owner << " " << *index);
+  return true;
+}
+bool
 IidManager::MustHideFromDocumentation (uint16_t uid) const
 {
   NS_LOG_FUNCTION (IID << uid);
@@ -883,40 +1028,39 @@ bool
 TypeId::LookupAttributeByName (std::string name, struct TypeId::AttributeInformation *info) const
 {
   NS_LOG_FUNCTION (this << name << info);
-  TypeId tid;
-  TypeId nextTid = *this;
-  do
+  TypeId owner;
+  std::size_t index;
+  if (!LookupAttributeIndexByName (name, &owner, &index))
     {
-      tid = nextTid;
-      for (std::size_t i = 0; i < tid.GetAttributeN (); i++)
-        {
-          struct TypeId::AttributeInformation tmp = tid.GetAttribute (i);
-          if (tmp.name == name)
-            {
-              if (tmp.supportLevel == TypeId::SUPPORTED)
-                {
-                  *info = tmp;
-                  return true;
-                }
-              else if (tmp.supportLevel == TypeId::DEPRECATED)
-                {
-                  std::cerr << "Attribute '" << name << "' is deprecated: "
-                            << tmp.supportMsg << std::endl;
-                  *info = tmp;
-                  return true;
-                }
-              else if (tmp.supportLevel == TypeId::OBSOLETE)
-                {
-                  NS_FATAL_ERROR ("Attribute '" << name <<
-                                  "' is obsolete, with no fallback: " <<
-                                  tmp.supportMsg);
-                }
-            }
-        }
-      nextTid = tid.GetParent ();
+      return false;
     }
-  while (nextTid != tid);
-  return false;
+  *info = IidManager::Get ()->GetAttribute (owner.m_tid, index);
+  return true;
+}
+
+bool
+TypeId::LookupAttributeIndexByName (std::string name, TypeId *owner, std::size_t *index) const
+{
+  NS_LOG_FUNCTION (this << name << owner << index);
+  uint16_t uid;
+  if (!IidManager::Get ()->LookupAttribute (m_tid, name, &uid, index))
+    {
+      return false;
+    }
+  owner->m_tid = uid;
+  const struct TypeId::AttributeInformation &tmp = IidManager::Get ()->GetAttribute (uid, *index);
+  if (tmp.supportLevel == TypeId::DEPRECATED)
+    {
+      std::cerr << "Attribute '" << name << "' is deprecated: "
+                << tmp.supportMsg << std::endl;
+    }
+  else if (tmp.supportLevel == TypeId::OBSOLETE)
+    {
+      NS_FATAL_ERROR ("Attribute '" << name <<
+                      "' is obsolete, with no fallback: " <<
+                      tmp.supportMsg);
+    }
+  return true;
 }
 
 TypeId
@@ -1137,41 +1281,39 @@ TypeId::LookupTraceSourceByName (std::string name,
                                  struct TraceSourceInformation *info) const
 {
   NS_LOG_FUNCTION (this << name);
-  TypeId tid;
-  TypeId nextTid = *this;
-  struct TypeId::TraceSourceInformation tmp;
-  do
+  TypeId owner;
+  std::size_t index;
+  if (!LookupTraceSourceIndexByName (name, &owner, &index))
     {
-      tid = nextTid;
-      for (std::size_t i = 0; i < tid.GetTraceSourceN (); i++)
-        {
-          tmp = tid.GetTraceSource (i);
-          if (tmp.name == name)
-            {
-              if (tmp.supportLevel == TypeId::SUPPORTED)
-                {
-                  *info = tmp;
-                  return tmp.accessor;
-                }
-              else if (tmp.supportLevel == TypeId::DEPRECATED)
-                {
-                  std::cerr << "TraceSource '" << name << "' is deprecated: "
-                            << tmp.supportMsg << std::endl;
-                  *info = tmp;
-                  return tmp.accessor;
-                }
-              else if (tmp.supportLevel == TypeId::OBSOLETE)
-                {
-                  NS_FATAL_ERROR ("TraceSource '" << name <<
-                                  "' is obsolete, with no fallback: " <<
-                                  tmp.supportMsg);
-                }
-            }
-        }
-      nextTid = tid.GetParent ();
+      return 0;
     }
-  while (nextTid != tid);
-  return 0;
+  *info = IidManager::Get ()->GetTraceSource (owner.m_tid, index);
+  return info->accessor;
+}
+
+bool
+TypeId::LookupTraceSourceIndexByName (std::string name, TypeId *owner, std::size_t *index) const
+{
+  NS_LOG_FUNCTION (this << name << owner << index);
+  uint16_t uid;
+  if (!IidManager::Get ()->LookupTraceSource (m_tid, name, &uid, index))
+    {
+      return false;
+    }
+  owner->m_tid = uid;
+  const struct TypeId::TraceSourceInformation &tmp = IidManager::Get ()->GetTraceSource (uid, *index);
+  if (tmp.supportLevel == TypeId::DEPRECATED)
+    {
+      std::cerr << "TraceSource '" << name << "' is deprecated: "
+                << tmp.supportMsg << std::endl;
+    }
+  else if (tmp.supportLevel == TypeId::OBSOLETE)
+    {
+      NS_FATAL_ERROR ("TraceSource '" << name <<
+                      "' is obsolete, with no fallback: " <<
+                      tmp.supportMsg);
+    }
+  return true;
 }
 
 Ptr<const TraceSourceAccessor>
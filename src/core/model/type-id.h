@@ -472,6 +472,22 @@ public:
    * \returns \c true if the requested attribute could be found.
    */
   bool LookupAttributeByName (std::string name, struct AttributeInformation *info) const;
+  /**
+   * Find an Attribute by name, retrieving the TypeId which declares it
+   * and its index there.
+   *
+   * The Attributes of this TypeId and of its parents are searched
+   * through a hashed index, so the cost does not depend on their
+   * number.  Attributes are never removed from a TypeId, so the
+   * result can be kept and used with \c owner.GetAttribute (index)
+   * to access the Attribute again without any lookup.
+   *
+   * \param [in]  name The name of the requested attribute
+   * \param [out] owner The TypeId which declares the attribute.
+   * \param [out] index The index of the attribute in \pname{owner}.
+   * \returns \c true if the requested attribute could be found.
+   */
+  bool LookupAttributeIndexByName (std::string name, TypeId *owner, std::size_t *index) const;
   /**
    * Find a TraceSource by name.
    *
@@ -495,6 +511,18 @@ public:
    *  an object instance.
    */
   Ptr<const TraceSourceAccessor> LookupTraceSourceByName (std::string name, struct TraceSourceInformation *info) const;
+  /**
+   * Find a TraceSource by name, retrieving the TypeId which declares it
+   * and its index there.
+   *
+   * \see LookupAttributeIndexByName
+   *
+   * \param [in]  name The name of the requested trace source.
+   * \param [out] owner The TypeId which declares the trace source.
+   * \param [out] index The index of the trace source in \pname{owner}.
+   * \returns \c true if the requested trace source could be found.
+   */
+  bool LookupTraceSourceIndexByName (std::string name, TypeId *owner, std::size_t *index) const;
 
   /**
    * Get the internal id of this TypeId.
@@ -840,6 +840,148 @@ SearchAttributesOfParentObjectsTestCase::DoRun (void)
 
 }
 
+/**
+ * \ingroup config-tests
+ * Test for Config::PathHandle.
+ */
+class PathHandleConfigTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  PathHandleConfigTestCase ();
+  /** Destructor. */
+  virtual ~PathHandleConfigTestCase ()
+  {}
+
+  /**
+   * Trace callback with context path.
+   * \param path The context path.
+   * \param old The old value.
+   * \param newValue The new value.
+   */
+  void TraceWithPath (std::string path, int16_t old, int16_t newValue)
+  {
+    NS_UNUSED (old);
+    m_newValue = newValue;
+    m_path = path;
+  }
+
+private:
+  virtual void DoRun (void);
+
+  int16_t m_newValue; //!< Flag to detect tracing result.
+  std::string m_path; //!< The context path.
+};
+
+PathHandleConfigTestCase::PathHandleConfigTestCase ()
+  : TestCase ("Check that a Config::PathHandle matches the objects of the Config path it was built from")
+{}
+
+void
+PathHandleConfigTestCase::DoRun (void)
+{
+  IntegerValue iv;
+
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Config::RegisterRootNamespaceObject (root);
+  Ptr<ConfigTestObject> a = CreateObject<ConfigTestObject> ();
+  root->SetNodeA (a);
+  Ptr<ConfigTestObject> b = CreateObject<ConfigTestObject> ();
+  a->SetNodeB (b);
+  std::vector<Ptr<ConfigTestObject> > objs;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      objs.push_back (CreateObject<ConfigTestObject> ());
+      b->AddNodeB (objs[i]);
+    }
+
+  //
+  // The handle matches the same objects, with the same contexts, as the
+  // Config path, for explicit indices and for wildcards.
+  //
+  const char *paths[] = { "/NodeA/NodeB/NodesB/[0-1]|3", "/NodeA/NodeB/NodesB/3|[0-1]|1",
+                          "/NodeA/NodeB/NodesB/*", "/NodeA/NodeB/NodesB/[2-9]",
+                          "/NodeA/*/NodesB/0", "/NodeA/NodeB/NodesB/x" };
+  for (uint32_t i = 0; i < sizeof (paths) / sizeof (paths[0]); i++)
+    {
+      Config::MatchContainer expected = Config::LookupMatches (paths[i]);
+      Config::MatchContainer matches = Config::PathHandle (std::string (paths[i]) + "/A").LookupMatches ();
+      NS_TEST_ASSERT_MSG_EQ (matches.GetN (), expected.GetN (), "Wrong number of matches for " << paths[i]);
+      for (std::size_t j = 0; j < matches.GetN (); j++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (matches.Get (j), expected.Get (j), "Wrong match for " << paths[i]);
+          NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (j), expected.GetMatchedPath (j), "Wrong context for " << paths[i]);
+        }
+    }
+
+  //
+  // Set through the handle, repeatedly.
+  //
+  Config::PathHandle handle ("/NodeA/NodeB/NodesB/[0-1]|3/A");
+  NS_TEST_ASSERT_MSG_EQ (handle.GetPath (), "/NodeA/NodeB/NodesB/[0-1]|3/A", "Wrong path");
+  for (int8_t v = -10; v > -13; v--)
+    {
+      handle.Set (IntegerValue (v));
+      objs[0]->GetAttribute ("A", iv);
+      NS_TEST_ASSERT_MSG_EQ (iv.Get (), v, "Object Attribute \"A\" not set as expected");
+      objs[1]->GetAttribute ("A", iv);
+      NS_TEST_ASSERT_MSG_EQ (iv.Get (), v, "Object Attribute \"A\" not set as expected");
+      objs[2]->GetAttribute ("A", iv);
+      NS_TEST_ASSERT_MSG_EQ (iv.Get (), 10, "Object Attribute \"A\" unexpectedly set");
+      objs[3]->GetAttribute ("A", iv);
+      NS_TEST_ASSERT_MSG_EQ (iv.Get (), v, "Object Attribute \"A\" not set as expected");
+    }
+  NS_TEST_ASSERT_MSG_EQ (Config::PathHandle ("/NodeA/NodeB/NodesB/*/Missing").SetFailSafe (IntegerValue (1)),
+                         false, "Set an attribute which does not exist");
+  NS_TEST_ASSERT_MSG_EQ (Config::PathHandle ().SetFailSafe (IntegerValue (1)),
+                         false, "Set an attribute through an empty handle");
+
+  //
+  // The handle sees objects added after it was built.
+  //
+  Config::PathHandle all ("/NodeA/NodeB/NodesB/*/B");
+  all.Set (IntegerValue (1));
+  objs.push_back (CreateObject<ConfigTestObject> ());
+  b->AddNodeB (objs[4]);
+  all.Set (IntegerValue (2));
+  for (uint32_t i = 0; i < objs.size (); i++)
+    {
+      objs[i]->GetAttribute ("B", iv);
+      NS_TEST_ASSERT_MSG_EQ (iv.Get (), 2, "Object Attribute \"B\" not set as expected");
+    }
+
+  //
+  // Connect through the handle, with the same context as Config::Connect.
+  //
+  Config::PathHandle source ("/NodeA/NodeB/NodesB/4/Source");
+  source.Connect (MakeCallback (&PathHandleConfigTestCase::TraceWithPath, this));
+  m_newValue = 0;
+  m_path = "";
+  objs[4]->SetAttribute ("Source", IntegerValue (-5));
+  NS_TEST_ASSERT_MSG_EQ (m_newValue, -5, "Trace 4 did not fire as expected");
+  NS_TEST_ASSERT_MSG_EQ (m_path, "/NodeA/NodeB/NodesB/4/Source", "Trace 4 did not provide expected context");
+  source.Disconnect (MakeCallback (&PathHandleConfigTestCase::TraceWithPath, this));
+  m_newValue = 0;
+  objs[4]->SetAttribute ("Source", IntegerValue (-6));
+  NS_TEST_ASSERT_MSG_EQ (m_newValue, 0, "Trace 4 fired after disconnection");
+
+  //
+  // Names and aggregated objects.
+  //
+  Names::Add ("PathHandleNode", objs[2]);
+  Ptr<DerivedConfigObject> derived = CreateObject<DerivedConfigObject> ();
+  objs[2]->AggregateObject (derived);
+  Config::PathHandle named ("/Names/PathHandleNode/$DerivedConfigObject/X");
+  named.Set (IntegerValue (42));
+  derived->GetAttribute ("X", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 42, "Object Attribute \"X\" not set through a name");
+  Config::PathHandle aggregated ("/NodeA/NodeB/NodesB/*/$DerivedConfigObject/X");
+  NS_TEST_ASSERT_MSG_EQ (aggregated.LookupMatches ().GetN (), 1, "Wrong number of aggregated objects");
+
+  Names::Clear ();
+  Config::UnregisterRootNamespaceObject (root);
+}
+
 /**
  * \ingroup config-tests
  * The Test Suite that glues all of the Test Cases together.
@@ -858,6 +1000,7 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new UnderRootNamespaceConfigTestCase);
   AddTestCase (new ObjectVectorConfigTestCase);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase);
+  AddTestCase (new PathHandleConfigTestCase);
 }
 
 /**
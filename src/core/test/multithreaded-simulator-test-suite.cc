@@ -0,0 +1,226 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup core-tests
+ *
+ * Exchange events between contexts mapped to different partitions
+ * and check time ordering, lookahead, cancellation and stop handling,
+ * as well as independence of the results from the thread count.
+ */
+class MultithreadedSimulatorTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] threads The number of threads to compare with a single thread run.
+   */
+  MultithreadedSimulatorTestCase (uint32_t threads);
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /** A received event. */
+  struct Record
+  {
+    int64_t rx;    //!< Reception time.
+    int64_t tx;    //!< Transmission time.
+    uint32_t from; //!< Sending context.
+  };
+
+  /**
+   * Run one simulation.
+   * \param [in] threads The maximum number of threads.
+   * \return The events received by each context.
+   */
+  std::vector<std::vector<Record> > RunOnce (uint32_t threads);
+  /**
+   * First event of a context.
+   * \param [in] context The context.
+   */
+  void Start (uint32_t context);
+  /**
+   * Periodic event of a context.
+   * \param [in] context The context.
+   */
+  void Tick (uint32_t context);
+  /**
+   * Reception of an event sent by another context.
+   * \param [in] context The receiving context.
+   * \param [in] from The sending context.
+   * \param [in] tx The transmission time.
+   */
+  void Receive (uint32_t context, uint32_t from, int64_t tx);
+  /**
+   * Event which is always cancelled before it expires.
+   * \param [in] context The context.
+   */
+  void Timeout (uint32_t context);
+
+  uint32_t m_threads;                        //!< Threads of the compared run.
+  std::vector<std::vector<Record> > m_log;   //!< Received events, per context.
+  std::vector<EventId> m_timeouts;           //!< Timeout event, per context.
+  std::vector<int> m_timedOut;               //!< Timeout expiry, per context.
+};
+
+/** Number of contexts. */
+static const uint32_t N_CONTEXTS = 8;
+/** Number of partitions. */
+static const uint32_t N_PARTITIONS = 4;
+
+MultithreadedSimulatorTestCase::MultithreadedSimulatorTestCase (uint32_t threads)
+  : TestCase ("Check multithreaded simulator with " + std::to_string (threads) + " threads"),
+    m_threads (threads)
+{}
+
+void
+MultithreadedSimulatorTestCase::Start (uint32_t context)
+{
+  m_timeouts[context] = Simulator::Schedule (Seconds (1), &MultithreadedSimulatorTestCase::Timeout, this, context);
+  Tick (context);
+}
+
+void
+MultithreadedSimulatorTestCase::Tick (uint32_t context)
+{
+  NS_TEST_ASSERT_MSG_EQ (Simulator::GetContext (), context, "Wrong context");
+  Simulator::ScheduleWithContext ((context + 1) % N_CONTEXTS, MilliSeconds (1),
+                                  &MultithreadedSimulatorTestCase::Receive, this,
+                                  (context + 1) % N_CONTEXTS, context,
+                                  Simulator::Now ().GetTimeStep ());
+  Simulator::Schedule (MicroSeconds (100 + 10 * context), &MultithreadedSimulatorTestCase::Tick, this, context);
+}
+
+void
+MultithreadedSimulatorTestCase::Receive (uint32_t context, uint32_t from, int64_t tx)
+{
+  NS_TEST_ASSERT_MSG_EQ (Simulator::GetContext (), context, "Wrong context");
+  if (!m_log[context].empty ())
+    {
+      NS_TEST_ASSERT_MSG_GT_OR_EQ (Simulator::Now ().GetTimeStep (), m_log[context].back ().rx, "Time went backwards");
+    }
+  Record r;
+  r.rx = Simulator::Now ().GetTimeStep ();
+  r.tx = tx;
+  r.from = from;
+  m_log[context].push_back (r);
+  if (!Simulator::IsExpired (m_timeouts[context]))
+    {
+      Simulator::Cancel (m_timeouts[context]);
+    }
+}
+
+void
+MultithreadedSimulatorTestCase::Timeout (uint32_t context)
+{
+  m_timedOut[context] = 1;
+}
+
+std::vector<std::vector<MultithreadedSimulatorTestCase::Record> >
+MultithreadedSimulatorTestCase::RunOnce (uint32_t threads)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::MultithreadedSimulatorImpl"));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::MaxThreads", UintegerValue (threads));
+
+  m_log.assign (N_CONTEXTS, std::vector<Record> ());
+  m_timeouts.assign (N_CONTEXTS, EventId ());
+  m_timedOut.assign (N_CONTEXTS, 0);
+  for (uint32_t c = 0; c < N_CONTEXTS; ++c)
+    {
+      Simulator::ScheduleWithContext (c, MicroSeconds (c), &MultithreadedSimulatorTestCase::Start, this, c);
+    }
+
+  Ptr<MultithreadedSimulatorImpl> impl = DynamicCast<MultithreadedSimulatorImpl> (Simulator::GetImplementation ());
+  NS_TEST_EXPECT_MSG_NE (impl, 0, "Wrong simulator implementation");
+  for (uint32_t c = 0; c < N_CONTEXTS; ++c)
+    {
+      impl->SetContextPartition (c, c % N_PARTITIONS);
+    }
+  impl->SetLookAhead (MilliSeconds (1));
+  NS_TEST_EXPECT_MSG_EQ (impl->GetPartitionCount (), N_PARTITIONS, "Wrong partition count");
+  NS_TEST_EXPECT_MSG_EQ (impl->GetContextPartition (5), 1, "Wrong partition");
+  NS_TEST_EXPECT_MSG_EQ (impl->GetContextPartition (Simulator::NO_CONTEXT), 0, "Wrong partition");
+
+  Simulator::Stop (MilliSeconds (20));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), MilliSeconds (20), "Simulation did not stop at the stop time");
+  NS_TEST_EXPECT_MSG_GT (Simulator::GetEventCount (), 0, "No event was executed");
+  Simulator::Destroy ();
+  return m_log;
+}
+
+void
+MultithreadedSimulatorTestCase::DoRun (void)
+{
+  std::vector<std::vector<Record> > reference = RunOnce (1);
+  std::vector<std::vector<Record> > log = RunOnce (m_threads);
+
+  for (uint32_t c = 0; c < N_CONTEXTS; ++c)
+    {
+      NS_TEST_EXPECT_MSG_GT (reference[c].size (), 0, "Context " << c << " received no event");
+      NS_TEST_EXPECT_MSG_EQ (m_timedOut[c], 0, "Cancelled event expired");
+      for (std::vector<Record>::const_iterator i = reference[c].begin (); i != reference[c].end (); ++i)
+        {
+          NS_TEST_EXPECT_MSG_EQ (i->rx, i->tx + MilliSeconds (1).GetTimeStep (), "Wrong reception time");
+          NS_TEST_EXPECT_MSG_LT_OR_EQ (i->rx, MilliSeconds (20).GetTimeStep (), "Event after the stop time");
+          NS_TEST_EXPECT_MSG_EQ (i->from, (c + N_CONTEXTS - 1) % N_CONTEXTS, "Wrong sender");
+        }
+      NS_TEST_ASSERT_MSG_EQ (log[c].size (), reference[c].size (), "Results depend on the thread count");
+      for (uint32_t i = 0; i < log[c].size (); ++i)
+        {
+          NS_TEST_EXPECT_MSG_EQ (log[c][i].rx, reference[c][i].rx, "Results depend on the thread count");
+          NS_TEST_EXPECT_MSG_EQ (log[c][i].tx, reference[c][i].tx, "Results depend on the thread count");
+        }
+    }
+}
+
+void
+MultithreadedSimulatorTestCase::DoTeardown (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  Config::Reset ();
+}
+
+/**
+ * \ingroup core-tests
+ *
+ * The multithreaded simulator TestSuite.
+ */
+class MultithreadedSimulatorTestSuite : public TestSuite
+{
+public:
+  MultithreadedSimulatorTestSuite ()
+    : TestSuite ("multithreaded-simulator")
+  {
+    AddTestCase (new MultithreadedSimulatorTestCase (2), TestCase::QUICK);
+    AddTestCase (new MultithreadedSimulatorTestCase (4), TestCase::QUICK);
+  }
+};
+
+static MultithreadedSimulatorTestSuite g_multithreadedSimulatorTestSuite; //!< Static variable for test initialization
@@ -24,6 +24,22 @@
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
 #include "ns3/priority-queue-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/dary-heap-scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/make-event.h"
+#include "ns3/config.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/uinteger.h"
+
+#include <fstream>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
 
 using namespace ns3;
 
@@ -465,6 +481,597 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup core-tests
+ *
+ * Check that the memory of the events is recycled, and that events
+ * of every size are executed with their bound arguments whether or
+ * not the event pool is enabled.
+ */
+class SimulatorEventPoolTestCase : public TestCase
+{
+public:
+  SimulatorEventPoolTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /** An argument too large for the event size classes. */
+  struct Large
+  {
+    uint64_t value[32]; //!< The payload.
+  };
+
+  /**
+   * Small event.
+   * \param [in] a The value to add.
+   */
+  void Small (int a);
+  /**
+   * Event with an argument larger than the biggest size class.
+   * \param [in] large The argument, whose last element is added.
+   */
+  void Big (Large large);
+  /**
+   * Schedule and run events of both sizes.
+   * \param [in] n The number of events of each size.
+   */
+  void RunEvents (int n);
+
+  int64_t m_sum; //!< Sum of the values received.
+};
+
+SimulatorEventPoolTestCase::SimulatorEventPoolTestCase ()
+  : TestCase ("Check recycling of the event memory")
+{}
+
+void
+SimulatorEventPoolTestCase::Small (int a)
+{
+  m_sum += a;
+}
+
+void
+SimulatorEventPoolTestCase::Big (Large large)
+{
+  m_sum += large.value[31];
+}
+
+void
+SimulatorEventPoolTestCase::RunEvents (int n)
+{
+  m_sum = 0;
+  Large large;
+  for (int i = 0; i < n; ++i)
+    {
+      large.value[31] = 2 * i;
+      Simulator::Schedule (NanoSeconds (i % 7), &SimulatorEventPoolTestCase::Small, this, i);
+      Simulator::Schedule (NanoSeconds (i % 5), &SimulatorEventPoolTestCase::Big, this, large);
+    }
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_sum, 3 * (int64_t) n * (n - 1) / 2, "Wrong event arguments");
+}
+
+void
+SimulatorEventPoolTestCase::DoRun (void)
+{
+  EventImpl *first = MakeEvent (&SimulatorEventPoolTestCase::Small, this, 1);
+  EventImpl *address = first;
+  first->Unref ();
+  EventImpl *second = MakeEvent (&SimulatorEventPoolTestCase::Small, this, 2);
+  NS_TEST_EXPECT_MSG_EQ (second, address, "Event memory was not recycled");
+  m_sum = 0;
+  second->Invoke ();
+  second->Unref ();
+  NS_TEST_EXPECT_MSG_EQ (m_sum, 2, "Recycled event invoked the wrong function");
+
+  RunEvents (1000);
+  EventImpl::DisablePool ();
+  RunEvents (1000);
+  EventImpl::EnablePool ();
+  RunEvents (1000);
+  Simulator::Destroy ();
+}
+
+void
+SimulatorEventPoolTestCase::DoTeardown (void)
+{
+  EventImpl::EnablePool ();
+}
+
+/**
+ * \ingroup core-tests
+ *
+ * Drive a scheduler directly with a hold model mixing near-future and
+ * heavy-tailed far-future events, with random removals, and check the
+ * order of the events against a reference ordered set.
+ */
+class SchedulerOrderTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] schedulerFactory The scheduler to check.
+   */
+  SchedulerOrderTestCase (ObjectFactory schedulerFactory);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * A small deterministic pseudo-random generator, so that every
+   * scheduler sees the same sequence of operations.
+   * \return The next pseudo-random value.
+   */
+  uint64_t Random (void);
+  /**
+   * Insert an event in the scheduler and in the reference set.
+   * \param [in] ts The event timestamp.
+   */
+  void Insert (uint64_t ts);
+
+  ObjectFactory m_schedulerFactory;                     //!< The scheduler to check.
+  Ptr<Scheduler> m_scheduler;                           //!< The scheduler.
+  std::set<std::pair<uint64_t, uint32_t> > m_reference; //!< Pending (ts, uid) keys.
+  std::vector<std::pair<uint64_t, uint32_t> > m_pending; //!< Candidates for removal.
+  uint32_t m_uid;                                       //!< Next event uid.
+  uint64_t m_random;                                    //!< Generator state.
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check event order under a hold model with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory),
+    m_uid (0),
+    m_random (1)
+{}
+
+uint64_t
+SchedulerOrderTestCase::Random (void)
+{
+  m_random = m_random * 6364136223846793005ULL + 1442695040888963407ULL;
+  return m_random >> 33;
+}
+
+void
+SchedulerOrderTestCase::Insert (uint64_t ts)
+{
+  Scheduler::Event ev;
+  ev.impl = 0;
+  ev.key.m_ts = ts;
+  ev.key.m_uid = m_uid++;
+  ev.key.m_context = 0;
+  m_scheduler->Insert (ev);
+  m_reference.insert (std::make_pair (ts, ev.key.m_uid));
+  m_pending.push_back (std::make_pair (ts, ev.key.m_uid));
+}
+
+void
+SchedulerOrderTestCase::DoRun (void)
+{
+  m_scheduler = m_schedulerFactory.Create<Scheduler> ();
+  uint64_t now = 0;
+  for (uint32_t i = 0; i < 2000; ++i)
+    {
+      Insert (Random () % 1000);
+    }
+  for (uint32_t step = 0; step < 20000; ++step)
+    {
+      if (step % 7 == 0 && !m_pending.empty ())
+        {
+          // remove a random pending event, if it is still pending
+          std::size_t i = Random () % m_pending.size ();
+          std::pair<uint64_t, uint32_t> key = m_pending[i];
+          m_pending[i] = m_pending.back ();
+          m_pending.pop_back ();
+          if (m_reference.erase (key) == 1)
+            {
+              Scheduler::Event ev;
+              ev.impl = 0;
+              ev.key.m_ts = key.first;
+              ev.key.m_uid = key.second;
+              ev.key.m_context = 0;
+              m_scheduler->Remove (ev);
+            }
+        }
+      NS_TEST_ASSERT_MSG_EQ (m_scheduler->IsEmpty (), m_reference.empty (), "Wrong emptiness");
+      if (m_reference.empty ())
+        {
+          break;
+        }
+      Scheduler::Event next = m_scheduler->PeekNext ();
+      Scheduler::Event ev = m_scheduler->RemoveNext ();
+      NS_TEST_ASSERT_MSG_EQ (next.key.m_uid, ev.key.m_uid, "PeekNext and RemoveNext disagree");
+      NS_TEST_ASSERT_MSG_EQ (ev.key.m_ts, m_reference.begin ()->first, "Wrong event time");
+      NS_TEST_ASSERT_MSG_EQ (ev.key.m_uid, m_reference.begin ()->second, "Wrong event order");
+      m_reference.erase (m_reference.begin ());
+      now = ev.key.m_ts;
+
+      // hold model: mostly near-future events, some heavy-tailed timers
+      uint64_t r = Random ();
+      if (r % 10 < 8)
+        {
+          Insert (now + r % 100);
+        }
+      else
+        {
+          Insert (now + (uint64_t (1) << (r % 30)) + r % 1000);
+        }
+      if (r % 3 == 0)
+        {
+          Insert (now);
+        }
+    }
+  while (!m_reference.empty ())
+    {
+      Scheduler::Event ev = m_scheduler->RemoveNext ();
+      NS_TEST_ASSERT_MSG_EQ (ev.key.m_uid, m_reference.begin ()->second, "Wrong event order");
+      m_reference.erase (m_reference.begin ());
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_scheduler->IsEmpty (), true, "Scheduler not empty");
+  m_scheduler = 0;
+}
+
+/**
+ * \ingroup core-tests
+ *
+ * Cancel part of the events held by a scheduler, some of which have
+ * already moved within its internal structures, and check that
+ * Scheduler::Compact removes exactly the cancelled events and keeps
+ * the order of the others.
+ */
+class SchedulerCompactTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] schedulerFactory The scheduler to check.
+   */
+  SchedulerCompactTestCase (ObjectFactory schedulerFactory);
+
+private:
+  virtual void DoRun (void);
+
+  /** Event function, never invoked. */
+  static void Nothing (void);
+
+  ObjectFactory m_schedulerFactory; //!< The scheduler to check.
+};
+
+SchedulerCompactTestCase::SchedulerCompactTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check compaction of the cancelled events with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{}
+
+void
+SchedulerCompactTestCase::Nothing (void)
+{}
+
+void
+SchedulerCompactTestCase::DoRun (void)
+{
+  Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+  std::map<std::pair<uint64_t, uint32_t>, EventImpl *> events;
+  uint32_t uid = 0;
+  for (uint32_t i = 0; i < 1000; ++i)
+    {
+      Scheduler::Event ev;
+      ev.impl = MakeEvent (&SchedulerCompactTestCase::Nothing);
+      ev.key.m_ts = (i * 7919) % 1000;
+      ev.key.m_uid = uid++;
+      ev.key.m_context = 0;
+      scheduler->Insert (ev);
+      events[std::make_pair (ev.key.m_ts, ev.key.m_uid)] = ev.impl;
+    }
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      Scheduler::Event ev = scheduler->RemoveNext ();
+      NS_TEST_ASSERT_MSG_EQ (ev.key.m_uid, events.begin ()->first.second, "Wrong event order");
+      ev.impl->Unref ();
+      events.erase (events.begin ());
+    }
+
+  uint32_t cancelled = 0;
+  std::map<std::pair<uint64_t, uint32_t>, EventImpl *>::iterator i = events.begin ();
+  while (i != events.end ())
+    {
+      if (i->first.second % 3 == 0)
+        {
+          i->second->Cancel ();
+          events.erase (i++);
+          cancelled++;
+        }
+      else
+        {
+          ++i;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (scheduler->Compact (), cancelled, "Wrong number of events removed");
+  NS_TEST_EXPECT_MSG_EQ (scheduler->Compact (), 0, "Events removed twice");
+
+  for (uint32_t j = 0; j < 100; ++j)
+    {
+      Scheduler::Event ev;
+      ev.impl = MakeEvent (&SchedulerCompactTestCase::Nothing);
+      ev.key.m_ts = 100 + (j * 37) % 2000;
+      ev.key.m_uid = uid++;
+      ev.key.m_context = 0;
+      scheduler->Insert (ev);
+      events[std::make_pair (ev.key.m_ts, ev.key.m_uid)] = ev.impl;
+    }
+  while (!events.empty ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), false, "Live event removed");
+      Scheduler::Event ev = scheduler->RemoveNext ();
+      NS_TEST_ASSERT_MSG_EQ (ev.key.m_uid, events.begin ()->first.second, "Wrong event order");
+      NS_TEST_EXPECT_MSG_EQ (ev.impl, events.begin ()->second, "Wrong event");
+      ev.impl->Unref ();
+      events.erase (events.begin ());
+    }
+  NS_TEST_EXPECT_MSG_EQ (scheduler->IsEmpty (), true, "Scheduler not empty");
+}
+
+/**
+ * \ingroup core-tests
+ *
+ * Check the live and cancelled event counts, and the compaction of
+ * the event list by DefaultSimulatorImpl when the cancelled events
+ * pass the threshold.
+ */
+class SimulatorCompactionTestCase : public TestCase
+{
+public:
+  SimulatorCompactionTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /** Event function, counting its invocations. */
+  void Count (void);
+
+  uint32_t m_count; //!< Number of events executed.
+};
+
+SimulatorCompactionTestCase::SimulatorCompactionTestCase ()
+  : TestCase ("Check the compaction of cancelled events")
+{}
+
+void
+SimulatorCompactionTestCase::Count (void)
+{
+  m_count++;
+}
+
+void
+SimulatorCompactionTestCase::DoRun (void)
+{
+  Simulator::Destroy ();
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::CompactionMinimum", UintegerValue (50));
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::CompactionThreshold", DoubleValue (0.5));
+  m_count = 0;
+  std::vector<EventId> ids;
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      ids.push_back (Simulator::Schedule (MilliSeconds (i + 1), &SimulatorCompactionTestCase::Count, this));
+    }
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetLiveEventCount (), 100, "Wrong live event count");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetCancelledEventCount (), 0, "Wrong cancelled event count");
+
+  for (uint32_t i = 0; i < 50; ++i)
+    {
+      Simulator::Cancel (ids[i]);
+    }
+  // cancelling twice does not count
+  Simulator::Cancel (ids[0]);
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetLiveEventCount (), 50, "Wrong live event count");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetCancelledEventCount (), 50, "Wrong cancelled event count");
+
+  // more than half of the events are now cancelled
+  Simulator::Cancel (ids[50]);
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetLiveEventCount (), 49, "Wrong live event count");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetCancelledEventCount (), 0, "Event list not compacted");
+
+  for (uint32_t i = 51; i < 60; ++i)
+    {
+      Simulator::Cancel (ids[i]);
+    }
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetLiveEventCount (), 40, "Wrong live event count");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetCancelledEventCount (), 9, "Wrong cancelled event count");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::IsExpired (ids[10]), true, "Compacted event not expired");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::IsExpired (ids[70]), false, "Live event expired");
+
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_count, 40, "Wrong number of events executed");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetLiveEventCount (), 0, "Wrong live event count");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetCancelledEventCount (), 0, "Wrong cancelled event count");
+  Simulator::Destroy ();
+}
+
+void
+SimulatorCompactionTestCase::DoTeardown (void)
+{
+  Config::Reset ();
+}
+
+/**
+ * \ingroup core-tests
+ *
+ * Base class of the virtual event target of SimulatorProfileTestCase.
+ */
+class SimulatorProfileBase
+{
+public:
+  virtual ~SimulatorProfileBase ();
+  /** Virtual event. */
+  virtual void Fire (void);
+};
+
+SimulatorProfileBase::~SimulatorProfileBase ()
+{}
+
+void
+SimulatorProfileBase::Fire (void)
+{}
+
+/**
+ * \ingroup core-tests
+ *
+ * Derived class of the virtual event target of SimulatorProfileTestCase.
+ */
+class SimulatorProfileDerived : public SimulatorProfileBase
+{
+public:
+  virtual void Fire (void);
+};
+
+void
+SimulatorProfileDerived::Fire (void)
+{}
+
+/**
+ * \ingroup core-tests
+ *
+ * Virtual event target of SimulatorProfileTestCase which destroys
+ * itself in its event.
+ */
+class SimulatorProfileSelfDestroying : public SimulatorProfileBase
+{
+public:
+  virtual void Fire (void);
+};
+
+void
+SimulatorProfileSelfDestroying::Fire (void)
+{
+  delete this;
+}
+
+/**
+ * \ingroup core-tests
+ *
+ * Check that the event profiler of DefaultSimulatorImpl attributes the
+ * events to the function they invoke and to their context, and writes
+ * its report at Simulator::Destroy.
+ */
+class SimulatorProfileTestCase : public TestCase
+{
+public:
+  SimulatorProfileTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /**
+   * Event with an integer argument.
+   * \param [in] a The argument.
+   */
+  void EventInt (int a);
+  /**
+   * Another event with an integer argument.
+   * \param [in] a The argument.
+   */
+  void EventOtherInt (int a);
+  /**
+   * Event with a double argument.
+   * \param [in] d The argument.
+   */
+  void EventDouble (double d);
+};
+
+SimulatorProfileTestCase::SimulatorProfileTestCase ()
+  : TestCase ("Check the event profiler")
+{}
+
+void
+SimulatorProfileTestCase::EventInt (int a)
+{}
+
+void
+SimulatorProfileTestCase::EventOtherInt (int a)
+{}
+
+void
+SimulatorProfileTestCase::EventDouble (double d)
+{}
+
+void
+SimulatorProfileTestCase::DoRun (void)
+{
+  Simulator::Destroy ();
+  std::string filename = CreateTempDirFilename ("profile.txt");
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::Profile", BooleanValue (true));
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::ProfileFile", StringValue (filename));
+  for (int i = 0; i < 10; ++i)
+    {
+      Simulator::ScheduleWithContext (7, Seconds (i), &SimulatorProfileTestCase::EventInt, this, i);
+    }
+  for (int i = 0; i < 5; ++i)
+    {
+      Simulator::ScheduleWithContext (3, Seconds (i), &SimulatorProfileTestCase::EventDouble, this, i);
+    }
+  for (int i = 0; i < 4; ++i)
+    {
+      Simulator::ScheduleWithContext (5, Seconds (i), &SimulatorProfileTestCase::EventOtherInt, this, i);
+    }
+  SimulatorProfileDerived derived;
+  for (int i = 0; i < 2; ++i)
+    {
+      Simulator::ScheduleWithContext (9, Seconds (i), &SimulatorProfileBase::Fire,
+                                      static_cast<SimulatorProfileBase *> (&derived));
+    }
+  // the profiler must not look at the object after the event
+  Simulator::ScheduleWithContext (11, Seconds (1), &SimulatorProfileBase::Fire,
+                                  static_cast<SimulatorProfileBase *> (new SimulatorProfileSelfDestroying ()));
+  EventId cancelled = Simulator::Schedule (Seconds (1), &SimulatorProfileTestCase::EventInt, this, 0);
+  Simulator::Cancel (cancelled);
+  Simulator::Run ();
+
+  Ptr<DefaultSimulatorImpl> impl = DynamicCast<DefaultSimulatorImpl> (Simulator::GetImplementation ());
+  NS_TEST_ASSERT_MSG_NE (impl, 0, "Wrong simulator implementation");
+  const EventProfiler *profiler = impl->GetProfiler ();
+  NS_TEST_ASSERT_MSG_NE (profiler, 0, "Profiler not enabled");
+  std::vector<EventProfiler::Entry> entries = profiler->GetEntries ();
+  NS_TEST_ASSERT_MSG_EQ (entries.size (), 5, "Wrong number of targets");
+  std::map<uint32_t, EventProfiler::Entry> byContext;
+  for (std::vector<EventProfiler::Entry>::const_iterator i = entries.begin (); i != entries.end (); ++i)
+    {
+      byContext[i->context] = *i;
+      NS_TEST_EXPECT_MSG_GT_OR_EQ (i->time, 0, "Negative time");
+    }
+  NS_TEST_EXPECT_MSG_EQ (byContext[7].count, 10, "Wrong event count");
+  NS_TEST_EXPECT_MSG_EQ (byContext[3].count, 5, "Wrong event count");
+  NS_TEST_EXPECT_MSG_EQ (byContext[5].count, 4, "Wrong event count");
+  NS_TEST_EXPECT_MSG_EQ (byContext[9].count, 2, "Wrong event count");
+  NS_TEST_EXPECT_MSG_EQ (byContext[11].count, 1, "Wrong event count");
+  NS_TEST_EXPECT_MSG_NE (byContext[7].target.find ("SimulatorProfileTestCase::EventInt"), std::string::npos,
+                         "Target does not name the function: " << byContext[7].target);
+  NS_TEST_EXPECT_MSG_NE (byContext[5].target.find ("SimulatorProfileTestCase::EventOtherInt"), std::string::npos,
+                         "Target does not name the function: " << byContext[5].target);
+  NS_TEST_EXPECT_MSG_NE (byContext[9].target.find ("SimulatorProfileDerived::Fire"), std::string::npos,
+                         "Virtual target not resolved on the object: " << byContext[9].target);
+  NS_TEST_EXPECT_MSG_NE (byContext[11].target.find ("SimulatorProfileSelfDestroying::Fire"), std::string::npos,
+                         "Virtual target not resolved on the object: " << byContext[11].target);
+  NS_TEST_EXPECT_MSG_NE (byContext[7].target, byContext[3].target, "Targets not distinguished");
+  NS_TEST_EXPECT_MSG_EQ (profiler->GetTargets ().size (), 5, "Wrong number of targets");
+  NS_TEST_EXPECT_MSG_EQ (profiler->GetContexts ().size (), 5, "Wrong number of contexts");
+
+  Simulator::Destroy ();
+  std::ifstream report (filename.c_str ());
+  std::string line;
+  std::getline (report, line);
+  NS_TEST_EXPECT_MSG_EQ (line.find ("Event profile: 22 events"), 0, "Wrong report: " << line);
+}
+
+void
+SimulatorProfileTestCase::DoTeardown (void)
+{
+  Config::Reset ();
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -483,5 +1090,40 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (PriorityQueueScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (DaryHeapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+
+    std::string schedulerTypes[] = {
+      "ns3::MapScheduler",
+      "ns3::HeapScheduler",
+      "ns3::CalendarScheduler",
+      "ns3::PriorityQueueScheduler",
+      "ns3::LadderScheduler",
+      "ns3::DaryHeapScheduler"
+    };
+    for (unsigned int i = 0; i < (sizeof(schedulerTypes) / sizeof(schedulerTypes[0])); ++i)
+      {
+        factory.SetTypeId (schedulerTypes[i]);
+        AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+      }
+    std::string compactTypes[] = {
+      "ns3::ListScheduler",
+      "ns3::MapScheduler",
+      "ns3::HeapScheduler",
+      "ns3::CalendarScheduler",
+      "ns3::PriorityQueueScheduler",
+      "ns3::LadderScheduler",
+      "ns3::DaryHeapScheduler"
+    };
+    for (unsigned int i = 0; i < (sizeof(compactTypes) / sizeof(compactTypes[0])); ++i)
+      {
+        factory.SetTypeId (compactTypes[i]);
+        AddTestCase (new SchedulerCompactTestCase (factory), TestCase::QUICK);
+      }
+    AddTestCase (new SimulatorCompactionTestCase (), TestCase::QUICK);
+    AddTestCase (new SimulatorProfileTestCase (), TestCase::QUICK);
+    AddTestCase (new SimulatorEventPoolTestCase (), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
@@ -26,12 +26,15 @@
 #include "ns3/config.h"
 #include "ns3/string.h"
 #include "ns3/system-thread.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/uinteger.h"
 
 #include <chrono>  // seconds, milliseconds
 #include <ctime>
 #include <list>
 #include <thread>  // sleep_for
 #include <utility>
+#include <vector>
 
 using namespace ns3;
 
@@ -225,6 +228,148 @@ ThreadedSimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_a, m_d, "Bad scheduling");
 }
 
+/**
+ * \ingroup core-tests
+ *
+ * Inject events from several threads into a DefaultSimulatorImpl with
+ * a tiny injection ring, so that both the lock-free ring and the
+ * overflow list are used, and check that every event is executed
+ * exactly once, in the order in which its thread scheduled it, and
+ * accounted to its thread.
+ */
+class ThreadedInjectionTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] threads The number of injecting threads.
+   * \param [in] queueSize The capacity of the injection ring.
+   */
+  ThreadedInjectionTestCase (uint32_t threads, uint32_t queueSize);
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /** Start the injecting threads. */
+  void Start (void);
+  /** Wait for all the injected events to be executed. */
+  void Poll (void);
+  /**
+   * Injected event.
+   * \param [in] thread The injecting thread.
+   * \param [in] index The index of the event in its thread.
+   */
+  void Receive (uint32_t thread, uint32_t index);
+  /**
+   * Injecting thread body.
+   * \param [in] context The test case and the thread index.
+   */
+  static void InjectingThread (std::pair<ThreadedInjectionTestCase *, uint32_t> context);
+
+  uint32_t m_threads;                          //!< Number of injecting threads.
+  uint32_t m_queueSize;                        //!< Capacity of the injection ring.
+  std::vector<uint32_t> m_received;            //!< Events received, per thread.
+  uint32_t m_total;                            //!< Events received.
+  std::vector<Ptr<SystemThread> > m_threadlist; //!< The injecting threads.
+};
+
+/** Number of events injected by each thread. */
+static const uint32_t N_INJECTED = 500;
+
+ThreadedInjectionTestCase::ThreadedInjectionTestCase (uint32_t threads, uint32_t queueSize)
+  : TestCase ("Check injection of events from " + std::to_string (threads) +
+              " threads through a ring of " + std::to_string (queueSize) + " slots"),
+    m_threads (threads),
+    m_queueSize (queueSize),
+    m_total (0)
+{}
+
+void
+ThreadedInjectionTestCase::InjectingThread (std::pair<ThreadedInjectionTestCase *, uint32_t> context)
+{
+  for (uint32_t i = 0; i < N_INJECTED; ++i)
+    {
+      Simulator::ScheduleWithContext (context.second, MicroSeconds (1),
+                                      &ThreadedInjectionTestCase::Receive, context.first,
+                                      context.second, i);
+    }
+}
+
+void
+ThreadedInjectionTestCase::Receive (uint32_t thread, uint32_t index)
+{
+  NS_TEST_ASSERT_MSG_EQ (Simulator::GetContext (), thread, "Wrong context");
+  NS_TEST_EXPECT_MSG_EQ (index, m_received[thread], "Events of thread " << thread << " reordered");
+  m_received[thread]++;
+  m_total++;
+}
+
+void
+ThreadedInjectionTestCase::Start (void)
+{
+  for (uint32_t i = 0; i < m_threads; ++i)
+    {
+      m_threadlist.push_back (
+        Create<SystemThread> (MakeBoundCallback (
+                                &ThreadedInjectionTestCase::InjectingThread,
+                                std::pair<ThreadedInjectionTestCase *, uint32_t> (this, i))));
+      m_threadlist.back ()->Start ();
+    }
+  Poll ();
+}
+
+void
+ThreadedInjectionTestCase::Poll (void)
+{
+  if (m_total < m_threads * N_INJECTED)
+    {
+      Simulator::Schedule (MicroSeconds (1), &ThreadedInjectionTestCase::Poll, this);
+    }
+}
+
+void
+ThreadedInjectionTestCase::DoRun (void)
+{
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::InjectionQueueSize", UintegerValue (m_queueSize));
+  m_received.assign (m_threads, 0);
+  m_total = 0;
+
+  Simulator::Schedule (MicroSeconds (1), &ThreadedInjectionTestCase::Start, this);
+  Simulator::Stop (Seconds (1000));
+  Simulator::Run ();
+  for (std::vector<Ptr<SystemThread> >::iterator it = m_threadlist.begin (); it != m_threadlist.end (); ++it)
+    {
+      (*it)->Join ();
+    }
+  // Execute any event still in flight to catch duplicates.
+  Simulator::Stop (MicroSeconds (10));
+  Simulator::Run ();
+
+  for (uint32_t i = 0; i < m_threads; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_received[i], N_INJECTED, "Lost or duplicated events of thread " << i);
+    }
+
+  Ptr<DefaultSimulatorImpl> impl = DynamicCast<DefaultSimulatorImpl> (Simulator::GetImplementation ());
+  NS_TEST_ASSERT_MSG_NE (impl, 0, "Wrong simulator implementation");
+  std::vector<DefaultSimulatorImpl::InjectionStats> stats = impl->GetInjectionStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats.size (), m_threads, "Wrong number of injecting threads");
+  for (std::vector<DefaultSimulatorImpl::InjectionStats>::const_iterator i = stats.begin (); i != stats.end (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (i->events, N_INJECTED, "Wrong injected event count");
+      NS_TEST_EXPECT_MSG_LT_OR_EQ (i->overflows, i->events, "Wrong overflow count");
+    }
+  Simulator::Destroy ();
+}
+
+void
+ThreadedInjectionTestCase::DoTeardown (void)
+{
+  m_threadlist.clear ();
+  Config::Reset ();
+}
+
 class ThreadedSimulatorTestSuite : public TestSuite
 {
 public:
@@ -241,7 +386,9 @@ public:
       "ns3::ListScheduler",
       "ns3::HeapScheduler",
       "ns3::MapScheduler",
-      "ns3::CalendarScheduler"
+      "ns3::CalendarScheduler",
+      "ns3::LadderScheduler",
+      "ns3::DaryHeapScheduler"
     };
     unsigned int threadcounts[] = {
       0,
@@ -262,5 +409,8 @@ public:
               }
           }
       }
+    AddTestCase (new ThreadedInjectionTestCase (1, 4), TestCase::QUICK);
+    AddTestCase (new ThreadedInjectionTestCase (4, 4), TestCase::QUICK);
+    AddTestCase (new ThreadedInjectionTestCase (4, 1024), TestCase::QUICK);
   }
 } g_threadedSimulatorTestSuite;
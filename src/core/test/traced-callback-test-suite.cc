@@ -20,6 +20,9 @@
 #include "ns3/traced-callback.h"
 #include "ns3/unused.h"
 
+#include <string>
+#include <vector>
+
 using namespace ns3;
 
 class BasicTracedCallbackTestCase : public TestCase
@@ -113,6 +116,97 @@ BasicTracedCallbackTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_two, true, "Callback CbTwo not called");
 }
 
+class ChainTracedCallbackTestCase : public TestCase
+{
+public:
+  ChainTracedCallbackTestCase ();
+  virtual ~ChainTracedCallbackTestCase ()
+  {}
+
+private:
+  virtual void DoRun (void);
+
+  void Cb (std::string context, int a);
+  void CbConnect (int a);
+
+  std::vector<std::string> m_calls;
+  TracedCallback<int> m_trace;
+};
+
+ChainTracedCallbackTestCase::ChainTracedCallbackTestCase ()
+  : TestCase ("Check the order of a chain of TracedCallback")
+{}
+
+void
+ChainTracedCallbackTestCase::Cb (std::string context, int a)
+{
+  NS_UNUSED (a);
+  m_calls.push_back (context);
+}
+
+void
+ChainTracedCallbackTestCase::CbConnect (int a)
+{
+  NS_UNUSED (a);
+  m_calls.push_back ("connect");
+  m_trace.Connect (MakeCallback (&ChainTracedCallbackTestCase::Cb, this), "late");
+}
+
+void
+ChainTracedCallbackTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), true, "New trace not empty");
+  m_trace (0);
+  NS_TEST_ASSERT_MSG_EQ (m_calls.size (), 0, "Callback called on empty trace");
+
+  //
+  // The Callbacks are called in the order they were connected, whether
+  // they are stored inline or in the vector.
+  //
+  const char *names[4] = {"a", "b", "c", "d"};
+  for (int i = 0; i < 4; i++)
+    {
+      m_trace.Connect (MakeCallback (&ChainTracedCallbackTestCase::Cb, this), names[i]);
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), false, "Trace empty");
+  m_trace (0);
+  NS_TEST_ASSERT_MSG_EQ (m_calls.size (), 4, "Wrong number of calls");
+  for (int i = 0; i < 4; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_calls[i], names[i], "Wrong order");
+    }
+
+  //
+  // Disconnecting the first Callback promotes the second one, and
+  // keeps the order of the others.
+  //
+  m_trace.Disconnect (MakeCallback (&ChainTracedCallbackTestCase::Cb, this), "a");
+  m_trace.Disconnect (MakeCallback (&ChainTracedCallbackTestCase::Cb, this), "c");
+  m_calls.clear ();
+  m_trace (0);
+  NS_TEST_ASSERT_MSG_EQ (m_calls.size (), 2, "Wrong number of calls");
+  NS_TEST_EXPECT_MSG_EQ (m_calls[0], "b", "Wrong order");
+  NS_TEST_EXPECT_MSG_EQ (m_calls[1], "d", "Wrong order");
+
+  m_trace.Disconnect (MakeCallback (&ChainTracedCallbackTestCase::Cb, this), "b");
+  m_trace.Disconnect (MakeCallback (&ChainTracedCallbackTestCase::Cb, this), "d");
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), true, "Trace not empty");
+
+  //
+  // A Callback may connect other Callbacks while the trace is invoked:
+  // they are called in the same invocation.
+  //
+  m_trace.ConnectWithoutContext (MakeCallback (&ChainTracedCallbackTestCase::CbConnect, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&ChainTracedCallbackTestCase::CbConnect, this));
+  m_calls.clear ();
+  m_trace (0);
+  NS_TEST_ASSERT_MSG_EQ (m_calls.size (), 4, "Wrong number of calls");
+  NS_TEST_EXPECT_MSG_EQ (m_calls[0], "connect", "Wrong order");
+  NS_TEST_EXPECT_MSG_EQ (m_calls[1], "connect", "Wrong order");
+  NS_TEST_EXPECT_MSG_EQ (m_calls[2], "late", "Wrong order");
+  NS_TEST_EXPECT_MSG_EQ (m_calls[3], "late", "Wrong order");
+}
+
 class TracedCallbackTestSuite : public TestSuite
 {
 public:
@@ -123,6 +217,7 @@ TracedCallbackTestSuite::TracedCallbackTestSuite ()
   : TestSuite ("traced-callback", UNIT)
 {
   AddTestCase (new BasicTracedCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new ChainTracedCallbackTestCase, TestCase::QUICK);
 }
 
 static TracedCallbackTestSuite tracedCallbackTestSuite;
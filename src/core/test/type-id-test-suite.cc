@@ -334,6 +334,83 @@ DeprecatedAttributeTestCase::DoRun (void)
 }
 
 
+//----------------------------
+//
+// Attribute index test
+
+class AttributeIndexTestCase : public TestCase
+{
+public:
+  AttributeIndexTestCase ();
+  virtual ~AttributeIndexTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+};
+
+AttributeIndexTestCase::AttributeIndexTestCase ()
+  : TestCase ("Check indexed lookup of inherited Attributes and TraceSources")
+{}
+
+AttributeIndexTestCase::~AttributeIndexTestCase ()
+{}
+
+void
+AttributeIndexTestCase::DoRun (void)
+{
+  TypeId base = TypeId ("AttributeIndexBase")
+    .SetParent<Object> ()
+    .AddAttribute ("a", "", EmptyAttributeValue (),
+                   MakeEmptyAttributeAccessor (), MakeEmptyAttributeChecker ())
+    .AddAttribute ("b", "", EmptyAttributeValue (),
+                   MakeEmptyAttributeAccessor (), MakeEmptyAttributeChecker ())
+    .AddTraceSource ("t", "", MakeEmptyTraceSourceAccessor (),
+                     "ns3::TracedValueCallback::Void");
+  TypeId derived = TypeId ("AttributeIndexDerived")
+    .SetParent (base)
+    .AddAttribute ("c", "", EmptyAttributeValue (),
+                   MakeEmptyAttributeAccessor (), MakeEmptyAttributeChecker ());
+
+  TypeId owner;
+  std::size_t index;
+  NS_TEST_ASSERT_MSG_EQ (derived.LookupAttributeIndexByName ("b", &owner, &index), true,
+                         "lookup inherited attribute");
+  NS_TEST_ASSERT_MSG_EQ (owner, base, "inherited attribute owner");
+  NS_TEST_ASSERT_MSG_EQ (index, 1, "inherited attribute index");
+  NS_TEST_ASSERT_MSG_EQ (owner.GetAttribute (index).name, "b", "inherited attribute name");
+
+  NS_TEST_ASSERT_MSG_EQ (derived.LookupAttributeIndexByName ("c", &owner, &index), true,
+                         "lookup own attribute");
+  NS_TEST_ASSERT_MSG_EQ (owner, derived, "own attribute owner");
+  NS_TEST_ASSERT_MSG_EQ (index, 0, "own attribute index");
+
+  NS_TEST_ASSERT_MSG_EQ (base.LookupAttributeIndexByName ("c", &owner, &index), false,
+                         "lookup derived attribute from the parent");
+  NS_TEST_ASSERT_MSG_EQ (derived.LookupAttributeIndexByName ("Missing", &owner, &index), false,
+                         "lookup missing attribute");
+  struct TypeId::AttributeInformation ainfo;
+  NS_TEST_ASSERT_MSG_EQ (derived.LookupAttributeByName ("a", &ainfo), true,
+                         "lookup inherited attribute information");
+  NS_TEST_ASSERT_MSG_EQ (ainfo.name, "a", "inherited attribute information");
+
+  NS_TEST_ASSERT_MSG_EQ (derived.LookupTraceSourceIndexByName ("t", &owner, &index), true,
+                         "lookup inherited trace source");
+  NS_TEST_ASSERT_MSG_EQ (owner, base, "inherited trace source owner");
+  NS_TEST_ASSERT_MSG_EQ (index, 0, "inherited trace source index");
+  NS_TEST_ASSERT_MSG_EQ (derived.LookupTraceSourceByName ("Missing"), 0,
+                         "lookup missing trace source");
+
+  // Attributes added to a parent after a lookup are found.
+  base.AddAttribute ("d", "", EmptyAttributeValue (),
+                     MakeEmptyAttributeAccessor (), MakeEmptyAttributeChecker ());
+  NS_TEST_ASSERT_MSG_EQ (derived.LookupAttributeIndexByName ("d", &owner, &index), true,
+                         "lookup attribute added after indexing");
+  NS_TEST_ASSERT_MSG_EQ (owner, base, "late attribute owner");
+  NS_TEST_ASSERT_MSG_EQ (index, 2, "late attribute index");
+}
+
+
 //----------------------------
 //
 // Performance test
@@ -447,6 +524,7 @@ TypeIdTestSuite::TypeIdTestSuite ()
   AddTestCase (new UniqueTypeIdTestCase, QUICK);
   AddTestCase (new CollisionTestCase, QUICK);
   AddTestCase (new DeprecatedAttributeTestCase, QUICK);
+  AddTestCase (new AttributeIndexTestCase, QUICK);
 }
 
 static TypeIdTestSuite g_TypeIdTestSuite;
@@ -90,6 +90,7 @@ CsmaHelper::EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, bool prom
     }
 
   PcapHelper pcapHelper;
+  pcapHelper.SetFileFormat (GetPcapFileFormat ());
 
   std::string filename;
   if (explicitFilename)
@@ -101,8 +102,9 @@ CsmaHelper::EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, bool prom
       filename = pcapHelper.GetFilenameFromDevice (prefix, device);
     }
 
-  Ptr<PcapFileWrapper> file = pcapHelper.CreateFile (filename, std::ios::out, 
-                                                     PcapHelper::DLT_EN10MB);
+  Ptr<PcapFileWrapper> file = pcapHelper.CreateFile (filename, std::ios::out, PcapHelper::DLT_EN10MB,
+                                                     std::numeric_limits<uint32_t>::max (), 0,
+                                                     pcapHelper.GetInterfaceNameFromDevice (device));
   if (promiscuous)
     {
       pcapHelper.HookDefaultSink<CsmaNetDevice> (device, "PromiscSniffer", file);
@@ -963,7 +963,43 @@ CsmaNetDevice::SendFrom (Ptr<Packet> packet, const Address& src, const Address&
 
   Mac48Address destination = Mac48Address::ConvertFrom (dest);
   Mac48Address source = Mac48Address::ConvertFrom (src);
-  AddHeader (packet, source, destination, protocolNumber);
+  return DoSend (packet, source, destination, protocolNumber);
+}
+
+uint32_t
+CsmaNetDevice::SendBatch (const std::vector<Ptr<Packet> > &packets, const Address& dest, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (packets.size () << dest << protocolNumber);
+
+  NS_ASSERT (IsLinkUp ());
+
+  if (IsSendEnabled () == false)
+    {
+      for (std::vector<Ptr<Packet> >::const_iterator i = packets.begin (); i != packets.end (); ++i)
+        {
+          m_macTxDropTrace (*i);
+        }
+      return 0;
+    }
+
+  Mac48Address destination = Mac48Address::ConvertFrom (dest);
+  uint32_t sent = 0;
+  for (std::vector<Ptr<Packet> >::const_iterator i = packets.begin (); i != packets.end (); ++i)
+    {
+      if (DoSend (*i, m_address, destination, protocolNumber))
+        {
+          sent++;
+        }
+    }
+  return sent;
+}
+
+bool
+CsmaNetDevice::DoSend (Ptr<Packet> packet, Mac48Address source, Mac48Address dest, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (packet << source << dest << protocolNumber);
+
+  AddHeader (packet, source, dest, protocolNumber);
 
   m_macTxTrace (packet);
 
@@ -987,7 +1023,7 @@ CsmaNetDevice::SendFrom (Ptr<Packet> packet, const Address& src, const Address&
       if (m_queue->IsEmpty () == false)
         {
           Ptr<Packet> packet = m_queue->Dequeue ();
-          NS_ASSERT_MSG (packet != 0, "CsmaNetDevice::SendFrom(): IsEmpty false but no Packet on queue?");
+          NS_ASSERT_MSG (packet != 0, "CsmaNetDevice::DoSend(): IsEmpty false but no Packet on queue?");
           m_currentPkt = packet;
           m_promiscSnifferTrace (m_currentPkt);
           m_snifferTrace (m_currentPkt);
@@ -273,6 +273,17 @@ public:
   virtual bool Send (Ptr<Packet> packet, const Address& dest, 
                      uint16_t protocolNumber);
 
+  /**
+   * Start sending several packets down the channel, checking whether the
+   * device may send and converting the addresses only once.
+   * \param packets packets to send, in transmission order
+   * \param dest layer 2 destination address of all the packets
+   * \param protocolNumber protocol number of all the packets
+   * \return the number of packets successfully enqueued
+   */
+  virtual uint32_t SendBatch (const std::vector<Ptr<Packet> > &packets, const Address& dest,
+                              uint16_t protocolNumber);
+
   /**
    * Start sending a packet down the channel, with MAC spoofing
    * \param packet packet to send
@@ -380,6 +391,17 @@ private:
    */
   void Init (bool sendEnable, bool receiveEnable);
 
+  /**
+   * Add the Ethernet header to a packet, enqueue it and start transmitting
+   * it if the device is idle. Sending must be enabled.
+   * \param packet packet to send
+   * \param source layer 2 source address
+   * \param dest layer 2 destination address
+   * \param protocolNumber protocol number
+   * \return true if the packet was enqueued, false otherwise
+   */
+  bool DoSend (Ptr<Packet> packet, Mac48Address source, Mac48Address dest, uint16_t protocolNumber);
+
   /**
    * Start Sending a Packet Down the Wire.
    *
@@ -71,6 +71,7 @@ FdNetDeviceHelper::EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, bo
     }
 
   PcapHelper pcapHelper;
+  pcapHelper.SetFileFormat (GetPcapFileFormat ());
 
   std::string filename;
   if (explicitFilename)
@@ -82,7 +83,9 @@ FdNetDeviceHelper::EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, bo
       filename = pcapHelper.GetFilenameFromDevice (prefix, device);
     }
 
-  Ptr<PcapFileWrapper> file = pcapHelper.CreateFile (filename, std::ios::out, PcapHelper::DLT_EN10MB);
+  Ptr<PcapFileWrapper> file = pcapHelper.CreateFile (filename, std::ios::out, PcapHelper::DLT_EN10MB,
+                                                     std::numeric_limits<uint32_t>::max (), 0,
+                                                     pcapHelper.GetInterfaceNameFromDevice (device));
   if (promiscuous)
     {
       pcapHelper.HookDefaultSink<FdNetDevice> (device, "PromiscSniffer", file);
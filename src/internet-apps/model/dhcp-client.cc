@@ -32,6 +32,7 @@
 #include "ns3/ipv4-routing-table-entry.h"
 #include "dhcp-client.h"
 #include "dhcp-header.h"
+#include "ns3/packet-census.h"
 
 namespace ns3 {
 
@@ -325,6 +326,7 @@ void DhcpClient::NetHandler (Ptr<Socket> socket)
 void DhcpClient::Boot (void)
 {
   NS_LOG_FUNCTION (this);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
 
   DhcpHeader header;
   Ptr<Packet> packet;
@@ -390,6 +392,7 @@ void DhcpClient::Select (void)
 void DhcpClient::Request (void)
 {
   NS_LOG_FUNCTION (this);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
 
   DhcpHeader header;
   Ptr<Packet> packet;
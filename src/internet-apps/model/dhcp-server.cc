@@ -33,6 +33,7 @@
 #include "ns3/ipv4.h"
 #include "dhcp-server.h"
 #include "dhcp-header.h"
+#include "ns3/packet-census.h"
 
 namespace ns3 {
 
@@ -242,6 +243,7 @@ void DhcpServer::NetHandler (Ptr<Socket> socket)
 void DhcpServer::SendOffer (Ptr<NetDevice> iDev, DhcpHeader header, InetSocketAddress from)
 {
   NS_LOG_FUNCTION (this << iDev << header << from);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
 
   DhcpHeader newDhcpHeader;
   Address sourceChaddr = header.GetChaddr ();
@@ -326,6 +328,7 @@ void DhcpServer::SendOffer (Ptr<NetDevice> iDev, DhcpHeader header, InetSocketAd
 void DhcpServer::SendAck (Ptr<NetDevice> iDev, DhcpHeader header, InetSocketAddress from)
 {
   NS_LOG_FUNCTION (this << iDev << header << from);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
 
   DhcpHeader newDhcpHeader;
   Address sourceChaddr = header.GetChaddr ();
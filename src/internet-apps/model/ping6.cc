@@ -32,6 +32,7 @@
 #include "ns3/ipv6-raw-socket-factory.h"
 #include "ns3/ipv6-header.h"
 #include "ns3/ipv6-extension-header.h"
+#include "ns3/packet-census.h"
 
 
 namespace ns3 
@@ -159,6 +160,7 @@ void Ping6::SetRouters (std::vector<Ipv6Address> routers)
 void Ping6::Send ()
 {
   NS_LOG_FUNCTION (this);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
   NS_ASSERT (m_sendEvent.IsExpired ());
 
   Ipv6Address src;
@@ -41,6 +41,7 @@
 #include "ns3/pointer.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/socket.h"
+#include "ns3/packet-census.h"
 
 
 namespace ns3
@@ -176,6 +177,7 @@ Radvd:: AssignStreams (int64_t stream)
 void Radvd::Send (Ptr<RadvdInterface> config, Ipv6Address dst, bool reschedule)
 {
   NS_LOG_FUNCTION (this << dst << reschedule);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
 
   if (reschedule == true)
     {
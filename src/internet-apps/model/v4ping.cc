@@ -25,6 +25,7 @@
 #include "ns3/inet-socket-address.h"
 #include "ns3/packet.h"
 #include "ns3/trace-source-accessor.h"
+#include "ns3/packet-census.h"
 
 namespace ns3 {
 
@@ -197,6 +198,7 @@ void
 V4Ping::Send ()
 {
   NS_LOG_FUNCTION (this);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
 
   NS_LOG_INFO ("m_seq=" << m_seq);
   Ptr<Packet> p = Create<Packet> ();
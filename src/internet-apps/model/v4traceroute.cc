@@ -36,6 +36,7 @@
 #include "ns3/inet-socket-address.h"
 #include "ns3/packet.h"
 #include "ns3/trace-source-accessor.h"
+#include "ns3/packet-census.h"
 
 
 namespace ns3 {
@@ -365,6 +366,7 @@ V4TraceRoute::Receive (Ptr<Socket> socket)
 void
 V4TraceRoute::Send ()
 {
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
   NS_LOG_INFO ("m_seq=" << m_seq);
   Ptr<Packet> p = Create<Packet> ();
   Icmpv4Echo echo;
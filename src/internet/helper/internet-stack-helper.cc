@@ -428,6 +428,7 @@ InternetStackHelper::EnablePcapIpv4Internal (std::string prefix, Ptr<Ipv4> ipv4,
   // irrespective of how many times we want to trace a particular protocol.
   //
   PcapHelper pcapHelper;
+  pcapHelper.SetFileFormat (GetPcapIpv4FileFormat ());
 
   std::string filename;
   if (explicitFilename)
@@ -439,7 +440,9 @@ InternetStackHelper::EnablePcapIpv4Internal (std::string prefix, Ptr<Ipv4> ipv4,
       filename = pcapHelper.GetFilenameFromInterfacePair (prefix, ipv4, interface);
     }
 
-  Ptr<PcapFileWrapper> file = pcapHelper.CreateFile (filename, std::ios::out, PcapHelper::DLT_RAW);
+  Ptr<PcapFileWrapper> file = pcapHelper.CreateFile (filename, std::ios::out, PcapHelper::DLT_RAW,
+                                                     std::numeric_limits<uint32_t>::max (), 0,
+                                                     pcapHelper.GetInterfaceNameFromInterfacePair (ipv4, interface));
 
   //
   // However, we only hook the trace source once to avoid multiple trace sink
@@ -526,6 +529,7 @@ InternetStackHelper::EnablePcapIpv6Internal (std::string prefix, Ptr<Ipv6> ipv6,
   // irrespective of how many times we want to trace a particular protocol.
   //
   PcapHelper pcapHelper;
+  pcapHelper.SetFileFormat (GetPcapIpv6FileFormat ());
 
   std::string filename;
   if (explicitFilename)
@@ -537,7 +541,9 @@ InternetStackHelper::EnablePcapIpv6Internal (std::string prefix, Ptr<Ipv6> ipv6,
       filename = pcapHelper.GetFilenameFromInterfacePair (prefix, ipv6, interface);
     }
 
-  Ptr<PcapFileWrapper> file = pcapHelper.CreateFile (filename, std::ios::out, PcapHelper::DLT_RAW);
+  Ptr<PcapFileWrapper> file = pcapHelper.CreateFile (filename, std::ios::out, PcapHelper::DLT_RAW,
+                                                     std::numeric_limits<uint32_t>::max (), 0,
+                                                     pcapHelper.GetInterfaceNameFromInterfacePair (ipv6, interface));
 
   //
   // However, we only hook the trace source once to avoid multiple trace sink
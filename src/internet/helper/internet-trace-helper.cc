@@ -35,6 +35,18 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("InternetTraceHelper");
 
+void
+PcapHelperForIpv4::SetPcapIpv4FileFormat (PcapHelper::FileFormat format)
+{
+  m_pcapFileFormat = format;
+}
+
+PcapHelper::FileFormat
+PcapHelperForIpv4::GetPcapIpv4FileFormat (void) const
+{
+  return m_pcapFileFormat;
+}
+
 void 
 PcapHelperForIpv4::EnablePcapIpv4 (std::string prefix, Ptr<Ipv4> ipv4, uint32_t interface, bool explicitFilename)
 {
@@ -298,6 +310,18 @@ AsciiTraceHelperForIpv4::EnableAsciiIpv4Impl (
     }
 }
 
+void
+PcapHelperForIpv6::SetPcapIpv6FileFormat (PcapHelper::FileFormat format)
+{
+  m_pcapFileFormat = format;
+}
+
+PcapHelper::FileFormat
+PcapHelperForIpv6::GetPcapIpv6FileFormat (void) const
+{
+  return m_pcapFileFormat;
+}
+
 void 
 PcapHelperForIpv6::EnablePcapIpv6 (std::string prefix, Ptr<Ipv6> ipv6, uint32_t interface, bool explicitFilename)
 {
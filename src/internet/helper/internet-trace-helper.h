@@ -40,13 +40,32 @@ public:
   /**
    * @brief Construct a PcapHelperForIpv4.
    */
-  PcapHelperForIpv4 () {}
+  PcapHelperForIpv4 () : m_pcapFileFormat (PcapHelper::PCAP) {}
 
   /**
    * @brief Destroy a PcapHelperForIpv4.
    */
   virtual ~PcapHelperForIpv4 () {}
 
+  /**
+   * @brief Set the format of the pcap files of this helper.
+   *
+   * In PCAPNG mode, the traces of the interfaces of a node enabled with the
+   * same prefix share a single pcapng file, with an interface per Ipv4
+   * interface (see PcapHelper::GetInterfaceNameFromInterfacePair).
+   * Set the format before enabling the traces.
+   *
+   * @param format the file format
+   */
+  void SetPcapIpv4FileFormat (PcapHelper::FileFormat format);
+
+  /**
+   * @brief Get the format of the pcap files of this helper.
+   *
+   * @returns the file format
+   */
+  PcapHelper::FileFormat GetPcapIpv4FileFormat (void) const;
+
   /**
    * @brief Enable pcap output the indicated Ipv4 and interface pair.
    *
@@ -119,6 +138,8 @@ public:
    */
   void EnablePcapIpv4All (std::string prefix);
 
+private:
+  PcapHelper::FileFormat m_pcapFileFormat; //!< The format of the pcap files
 };
 
 /**
@@ -400,13 +421,32 @@ public:
   /**
    * @brief Construct a PcapHelperForIpv6.
    */
-  PcapHelperForIpv6 () {}
+  PcapHelperForIpv6 () : m_pcapFileFormat (PcapHelper::PCAP) {}
 
   /**
    * @brief Destroy a PcapHelperForIpv6
    */
   virtual ~PcapHelperForIpv6 () {}
 
+  /**
+   * @brief Set the format of the pcap files of this helper.
+   *
+   * In PCAPNG mode, the traces of the interfaces of a node enabled with the
+   * same prefix share a single pcapng file, with an interface per Ipv6
+   * interface (see PcapHelper::GetInterfaceNameFromInterfacePair).
+   * Set the format before enabling the traces.
+   *
+   * @param format the file format
+   */
+  void SetPcapIpv6FileFormat (PcapHelper::FileFormat format);
+
+  /**
+   * @brief Get the format of the pcap files of this helper.
+   *
+   * @returns the file format
+   */
+  PcapHelper::FileFormat GetPcapIpv6FileFormat (void) const;
+
   /**
    * @brief Enable pcap output the indicated Ipv6 and interface pair.
    *
@@ -478,6 +518,8 @@ public:
    * @param prefix Filename prefix to use for pcap files.
    */
   void EnablePcapIpv6All (std::string prefix);
+private:
+  PcapHelper::FileFormat m_pcapFileFormat; //!< The format of the pcap files
 };
 
 /**
@@ -84,6 +84,18 @@ public:
    *
    */
   static void RecomputeRoutingTables (void);
+  /**
+   * \brief Update the routing tables after a change of the topology, such
+   * as a link going down or a change of the metric of an interface.
+   *
+   * This yields the same routes as RecomputeRoutingTables(), but only the
+   * routes of the nodes whose shortest paths may go through a changed
+   * router, network or link are recomputed; the routes of the other nodes
+   * are left untouched, including routes added by hand.
+   * Users must first call PopulateRoutingTables() and then may subsequently
+   * call UpdateRoutingTables() at any later time in the simulation.
+   */
+  static void UpdateRoutingTables (void);
 private:
   /**
    * \brief Assignment operator declared private and not implemented to disallow
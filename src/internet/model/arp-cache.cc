@@ -19,6 +19,7 @@
  */
 #include "ns3/assert.h"
 #include "ns3/packet.h"
+#include "ns3/packet-census.h"
 #include "ns3/simulator.h"
 #include "ns3/uinteger.h"
 #include "ns3/log.h"
@@ -434,6 +435,7 @@ ArpCache::Entry::UpdateWaitReply (Ipv4PayloadHeaderPair waiting)
       return false;
     }
   m_pending.push_back (waiting);
+  PacketCensus::Hold (waiting.first, ArpCache::GetTypeId ());
   return true;
 }
 void 
@@ -446,6 +448,7 @@ ArpCache::Entry::MarkWaitReply (Ipv4PayloadHeaderPair waiting)
 
   m_state = WAIT_REPLY;
   m_pending.push_back (waiting);
+  PacketCensus::Hold (waiting.first, ArpCache::GetTypeId ());
   UpdateSeen ();
   m_arp->StartWaitReplyTimer ();
 }
@@ -519,6 +522,7 @@ ArpCache::Entry::DequeuePending (void)
     {
       Ipv4PayloadHeaderPair p = m_pending.front ();
       m_pending.pop_front ();
+      PacketCensus::Release (p.first);
       return p;
     }
 }
@@ -526,6 +530,10 @@ void
 ArpCache::Entry::ClearPendingPacket (void)
 {
   NS_LOG_FUNCTION (this);
+  for (std::list<Ipv4PayloadHeaderPair>::const_iterator i = m_pending.begin (); i != m_pending.end (); ++i)
+    {
+      PacketCensus::Release (i->first);
+    }
   m_pending.clear ();
 }
 void 
@@ -33,6 +33,7 @@
 #include "arp-queue-disc-item.h"
 #include "ipv4-interface.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/packet-census.h"
 
 namespace ns3 {
 
@@ -365,6 +366,7 @@ void
 ArpL3Protocol::SendArpRequest (Ptr<const ArpCache> cache, Ipv4Address to)
 {
   NS_LOG_FUNCTION (this << cache << to);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
   ArpHeader arp;
   // need to pick a source address; use routing implementation to select
   Ptr<Ipv4L3Protocol> ipv4 = m_node->GetObject<Ipv4L3Protocol> ();
@@ -384,6 +386,7 @@ void
 ArpL3Protocol::SendArpReply (Ptr<const ArpCache> cache, Ipv4Address myIp, Ipv4Address toIp, Address toMac)
 {
   NS_LOG_FUNCTION (this << cache << myIp << toIp << toMac);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
   ArpHeader arp;
   NS_LOG_LOGIC ("ARP: sending reply from node "<<m_node->GetId ()<<
                 "|| src: " << cache->GetDevice ()->GetAddress () <<
@@ -51,7 +51,8 @@ operator<< (std::ostream& os, const CandidateQueue& q)
 {
   typedef CandidateQueue::CandidateList_t List_t;
   typedef List_t::const_iterator CIter_t;
-  const CandidateQueue::CandidateList_t& list = q.m_candidates;
+  CandidateQueue::CandidateList_t list = q.m_candidates;
+  std::sort (list.begin (), list.end (), &CandidateQueue::IsBefore);
 
   os << "*** CandidateQueue Begin (<id, distance, LSA-type>) ***" << std::endl;
   for (CIter_t iter = list.begin (); iter != list.end (); iter++)
@@ -66,7 +67,9 @@ operator<< (std::ostream& os, const CandidateQueue& q)
 }
 
 CandidateQueue::CandidateQueue()
-  : m_candidates ()
+  : m_candidates (),
+    m_index (),
+    m_order (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -94,11 +97,12 @@ CandidateQueue::Push (SPFVertex *vNew)
 {
   NS_LOG_FUNCTION (this << vNew);
 
-  CandidateList_t::iterator i = std::upper_bound (
-      m_candidates.begin (), m_candidates.end (), vNew,
-      &CandidateQueue::CompareSPFVertex
-      );
-  m_candidates.insert (i, vNew);
+  vNew->m_candidateOrder = m_order++;
+  m_candidates.push_back (vNew);
+  Place (m_candidates.size () - 1, vNew);
+  SiftUp (m_candidates.size () - 1);
+  // Find () returns the first vertex pushed with a given ID
+  m_index.insert (std::make_pair (vNew->GetVertexId (), vNew));
 }
 
 SPFVertex *
@@ -111,7 +115,19 @@ CandidateQueue::Pop (void)
     }
 
   SPFVertex *v = m_candidates.front ();
-  m_candidates.pop_front ();
+  SPFVertex *last = m_candidates.back ();
+  m_candidates.pop_back ();
+  if (!m_candidates.empty ())
+    {
+      Place (0, last);
+      SiftDown (0);
+    }
+  std::unordered_map<Ipv4Address, SPFVertex*, Ipv4AddressHash>::iterator i =
+    m_index.find (v->GetVertexId ());
+  if (i != m_index.end () && i->second == v)
+    {
+      m_index.erase (i);
+    }
   return v;
 }
 
@@ -145,30 +161,90 @@ SPFVertex *
 CandidateQueue::Find (const Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this);
-  CandidateList_t::const_iterator i = m_candidates.begin ();
-
-  for (; i != m_candidates.end (); i++)
+  std::unordered_map<Ipv4Address, SPFVertex*, Ipv4AddressHash>::const_iterator i =
+    m_index.find (addr);
+  if (i != m_index.end ())
     {
-      SPFVertex *v = *i;
-      if (v->GetVertexId () == addr)
-        {
-          return v;
-        }
+      return i->second;
     }
 
   return 0;
 }
 
+void
+CandidateQueue::Update (SPFVertex *v)
+{
+  NS_LOG_FUNCTION (this << v);
+  NS_ASSERT_MSG (v->m_candidateIndex < m_candidates.size ()
+                 && m_candidates[v->m_candidateIndex] == v,
+                 "CandidateQueue::Update (): Vertex not in the queue");
+
+  v->m_candidateOrder = m_order++;
+  SiftUp (v->m_candidateIndex);
+}
+
 void
 CandidateQueue::Reorder (void)
 {
   NS_LOG_FUNCTION (this);
 
-  m_candidates.sort (&CandidateQueue::CompareSPFVertex);
+  std::make_heap (m_candidates.begin (), m_candidates.end (),
+                  [] (const SPFVertex* v1, const SPFVertex* v2)
+                  { return IsBefore (v2, v1); });
+  for (uint32_t i = 0; i < m_candidates.size (); i++)
+    {
+      m_candidates[i]->m_candidateIndex = i;
+    }
   NS_LOG_LOGIC ("After reordering the CandidateQueue");
   NS_LOG_LOGIC (*this);
 }
 
+void
+CandidateQueue::Place (uint32_t index, SPFVertex *v)
+{
+  m_candidates[index] = v;
+  v->m_candidateIndex = index;
+}
+
+void
+CandidateQueue::SiftUp (uint32_t index)
+{
+  SPFVertex *v = m_candidates[index];
+  while (index > 0)
+    {
+      uint32_t parent = (index - 1) / 2;
+      if (!IsBefore (v, m_candidates[parent]))
+        {
+          break;
+        }
+      Place (index, m_candidates[parent]);
+      index = parent;
+    }
+  Place (index, v);
+}
+
+void
+CandidateQueue::SiftDown (uint32_t index)
+{
+  SPFVertex *v = m_candidates[index];
+  uint32_t size = m_candidates.size ();
+  while (2 * index + 1 < size)
+    {
+      uint32_t child = 2 * index + 1;
+      if (child + 1 < size && IsBefore (m_candidates[child + 1], m_candidates[child]))
+        {
+          child++;
+        }
+      if (!IsBefore (m_candidates[child], v))
+        {
+          break;
+        }
+      Place (index, m_candidates[child]);
+      index = child;
+    }
+  Place (index, v);
+}
+
 /*
  * In this implementation, SPFVertex follows the ordering where
  * a vertex is ranked first if its GetDistanceFromRoot () is smaller;
@@ -197,4 +273,22 @@ CandidateQueue::CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2)
   return result;
 }
 
+/*
+ * Pushing a vertex, or updating it when its distance decreases, ranks it
+ * after the vertices of the same distance and type already in the queue.
+ */
+bool
+CandidateQueue::IsBefore (const SPFVertex* v1, const SPFVertex* v2)
+{
+  if (CompareSPFVertex (v1, v2))
+    {
+      return true;
+    }
+  if (CompareSPFVertex (v2, v1))
+    {
+      return false;
+    }
+  return v1->m_candidateOrder < v2->m_candidateOrder;
+}
+
 } // namespace ns3
@@ -22,7 +22,8 @@
 #define CANDIDATE_QUEUE_H
 
 #include <stdint.h>
-#include <list>
+#include <unordered_map>
+#include <vector>
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -45,8 +46,13 @@ class SPFVertex;
  *
  * Although a STL priority_queue almost does what we want, the requirement
  * for a Find () operation, the dynamic nature of the data and the derived
- * requirement for a Reorder () operation led us to implement this simple 
+ * requirement for an Update () operation led us to implement this simple 
  * enhanced priority queue.
+ *
+ * The queue is a binary heap, indexed by vertex ID: Push (), Pop () and
+ * Update () take O(log n) steps, and Find () constant time.  Vertices at
+ * the same distance are popped networks first, then in the order in which
+ * they were pushed or updated.
  */
 class CandidateQueue
 {
@@ -139,6 +145,17 @@ public:
  */
   SPFVertex* Find (const Ipv4Address addr) const;
 
+/**
+ * @brief Restore the order of the Candidate Queue after the distance of a
+ * vertex decreased.
+ *
+ * The vertex is then popped after the other vertices at the same distance.
+ *
+ * @see SPFVertex
+ * @param v The Shortest Path First Vertex whose m_distanceFromRoot decreased.
+ */
+  void Update (SPFVertex *v);
+
 /**
  * @brief Reorders the Candidate Queue according to the priority scheme.
  * 
@@ -148,7 +165,8 @@ public:
  * increasing distance.
  *
  * This method is provided in case the values of m_distanceFromRoot change
- * during the routing calculations.
+ * during the routing calculations.  Update () is faster when the distance
+ * of a single vertex decreased.
  *
  * @see SPFVertex
  */
@@ -184,8 +202,40 @@ private:
  */
   static bool CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2);
 
-  typedef std::list<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
-  CandidateList_t m_candidates;  //!< SPFVertex candidates
+/**
+ * \brief return true if v1 should be popped before v2, including the
+ * order in which they were pushed or updated.
+ *
+ * \param v1 first operand
+ * \param v2 second operand
+ * \return True if v1 should be popped before v2; false otherwise
+ */
+  static bool IsBefore (const SPFVertex* v1, const SPFVertex* v2);
+
+/**
+ * \brief Move a vertex towards the top of the heap.
+ * \param index The position of the vertex in the heap.
+ */
+  void SiftUp (uint32_t index);
+
+/**
+ * \brief Move a vertex towards the bottom of the heap.
+ * \param index The position of the vertex in the heap.
+ */
+  void SiftDown (uint32_t index);
+
+/**
+ * \brief Store a vertex at a position of the heap.
+ * \param index The position in the heap.
+ * \param v The vertex.
+ */
+  void Place (uint32_t index, SPFVertex *v);
+
+  typedef std::vector<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
+  CandidateList_t m_candidates;  //!< SPFVertex candidates, as a binary heap
+  /// SPFVertex candidates, indexed by vertex ID
+  std::unordered_map<Ipv4Address, SPFVertex*, Ipv4AddressHash> m_index;
+  uint64_t m_order;  //!< Count of the vertices pushed or updated
 
   /**
    * \brief Stream insertion operator.
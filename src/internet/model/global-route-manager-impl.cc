@@ -26,10 +26,19 @@
 #include <vector>
 #include <queue>
 #include <algorithm>
+#include <atomic>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <thread>
+#include <unordered_map>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include "ns3/system-thread.h"
 #include "ns3/node-list.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
@@ -93,7 +102,9 @@ SPFVertex::SPFVertex () :
   m_nextHop ("0.0.0.0"),
   m_parents (),
   m_children (),
-  m_vertexProcessed (false)
+  m_vertexProcessed (false),
+  m_candidateIndex (0),
+  m_candidateOrder (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -106,7 +117,9 @@ SPFVertex::SPFVertex (GlobalRoutingLSA* lsa) :
   m_nextHop ("0.0.0.0"),
   m_parents (),
   m_children (),
-  m_vertexProcessed (false)
+  m_vertexProcessed (false),
+  m_candidateIndex (0),
+  m_candidateOrder (0)
 {
   NS_LOG_FUNCTION (this << lsa);
 
@@ -422,6 +435,8 @@ SPFVertex::ClearVertexProcessed (void)
 GlobalRouteManagerLSDB::GlobalRouteManagerLSDB ()
   :
     m_database (),
+    m_lsas (),
+    m_linkData (),
     m_extdatabase ()
 {
   NS_LOG_FUNCTION (this);
@@ -469,7 +484,32 @@ GlobalRouteManagerLSDB::Insert (Ipv4Address addr, GlobalRoutingLSA* lsa)
     } 
   else
     {
-      m_database.insert (LSDBPair_t (addr, lsa));
+      std::pair<LSDBMap_t::iterator, bool> inserted =
+        m_database.insert (LSDBPair_t (addr, lsa));
+      if (!inserted.second)
+        {
+          return;
+        }
+      m_lsas.push_back (lsa);
+//
+// Index the LSA by the link data of its TransitNetwork link records.  When
+// several LSAs share a link data, GetLSAByLinkData () returns the one with
+// the lowest link state ID.
+//
+      for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+          if (lr->GetLinkType () != GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              continue;
+            }
+          std::pair<LinkDataMap_t::iterator, bool> result =
+            m_linkData.insert (std::make_pair (lr->GetLinkData (), inserted.first));
+          if (!result.second && addr < result.first->second->first)
+            {
+              result.first->second = inserted.first;
+            }
+        }
     }
 }
 
@@ -494,13 +534,10 @@ GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 //
 // Look up an LSA by its address.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LSDBMap_t::const_iterator i = m_database.find (addr);
+  if (i != m_database.end ())
     {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
+      return i->second;
     }
   return 0;
 }
@@ -510,35 +547,339 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this << addr);
 //
-// Look up an LSA by its address.
+// Look up an LSA by the link data of its TransitNetwork link records.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LinkDataMap_t::const_iterator i = m_linkData.find (addr);
+  if (i != m_linkData.end ())
     {
-      GlobalRoutingLSA* temp = i->second;
-// Iterate among temp's Link Records
-      for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
-        {
-          GlobalRoutingLinkRecord *lr = temp->GetLinkRecord (j);
-          if ( lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork &&
-               lr->GetLinkData () == addr)
-            {
-              return temp;
-            }
-        }
+      return i->second->second;
     }
   return 0;
 }
 
+uint32_t
+GlobalRouteManagerLSDB::GetNumLSAs () const
+{
+  NS_LOG_FUNCTION (this);
+  return m_lsas.size ();
+}
+
+GlobalRoutingLSA*
+GlobalRouteManagerLSDB::GetLSAByIndex (uint32_t index) const
+{
+  NS_LOG_FUNCTION (this << index);
+  return m_lsas.at (index);
+}
+
 // ---------------------------------------------------------------------------
 //
 // GlobalRouteManagerImpl Implementation
 //
 // ---------------------------------------------------------------------------
 
+/**
+ * \brief The number of threads running the SPF calculations.
+ */
+static GlobalValue g_spfThreads ("GlobalRoutingSpfThreads",
+                                 "The number of threads running the SPF calculations "
+                                 "of the global routing (0 for one thread per hardware thread).",
+                                 UintegerValue (1),
+                                 MakeUintegerChecker<uint32_t> ());
+
+struct GlobalRouteManagerImpl::SPFContext
+{
+  SPFContext ()
+    : root (0),
+      hasNodes (false)
+  {
+  }
+  /**
+   * \param lsa an LSA of the database
+   * \returns the status of the LSA in this calculation
+   */
+  GlobalRoutingLSA::SPFStatus GetStatus (const GlobalRoutingLSA* lsa) const
+  {
+    std::unordered_map<const GlobalRoutingLSA*, GlobalRoutingLSA::SPFStatus>::const_iterator i =
+      status.find (lsa);
+    return i == status.end () ? GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED : i->second;
+  }
+  Ipv4Address rootId;              //!< the router ID of the root
+  SPFVertex* root;                 //!< the root vertex of the SPF tree
+  Ptr<Node> node;                  //!< the root node, or 0 if not found
+  Ptr<Ipv4> ipv4;                  //!< the IPv4 of the root node, or 0 if not found
+  Ptr<Ipv4GlobalRouting> routing;  //!< the routing protocol of the root node, or 0 if not found
+  bool hasNodes;                   //!< whether the NodeList was non-empty when the calculation was set up
+  /// the status of the LSAs, rather than the status stored in the shared LSAs
+  std::unordered_map<const GlobalRoutingLSA*, GlobalRoutingLSA::SPFStatus> status;
+};
+
+struct GlobalRouteManagerImpl::SPFBatch
+{
+  GlobalRouteManagerImpl* impl;        //!< the route manager
+  std::vector<SPFContext>* contexts;   //!< the SPF calculations
+  std::atomic<uint32_t> next;          //!< the next SPF calculation to run
+};
+
+namespace {
+
+/**
+ * \ingroup globalrouting
+ *
+ * \brief The graph followed by the SPF calculations on a Link State
+ * Database.
+ *
+ * The vertices are the router and network LSAs, and the edges are the
+ * links GlobalRouteManagerImpl::SPFNext () examines, weighted by the
+ * distance they add.
+ */
+class SPFGraph
+{
+public:
+  /** An edge of the graph. */
+  struct Edge
+  {
+    uint32_t vertex;  //!< the other end of the edge
+    uint32_t metric;  //!< the distance added by the edge
+  };
+
+  /**
+   * \param lsdb the database
+   */
+  SPFGraph (const GlobalRouteManagerLSDB* lsdb);
+
+  /**
+   * \returns the number of vertices
+   */
+  uint32_t GetN (void) const;
+  /**
+   * \param v a vertex
+   * \returns the LSA of the vertex
+   */
+  GlobalRoutingLSA* GetLSA (uint32_t v) const;
+  /**
+   * \param id a link state ID
+   * \returns the vertex of the LSA with this ID, or -1 if there is none
+   */
+  int32_t Find (Ipv4Address id) const;
+  /**
+   * \param v a vertex
+   * \returns the edges from the vertex, in the order SPFNext () examines them
+   */
+  const std::vector<Edge>& GetEdges (uint32_t v) const;
+  /**
+   * \brief Mark the vertices from which some vertices can be reached.
+   *
+   * \param targets the vertices to reach
+   * \param marked the marks of the vertices, set to true for the vertices
+   * reaching a target, including the targets themselves
+   */
+  void MarkReaching (const std::vector<uint32_t>& targets, std::vector<bool>& marked) const;
+  /**
+   * \brief Calculate the distances from every vertex to a vertex.
+   *
+   * \param target the vertex
+   * \param distances the distances, or the maximum value for the vertices
+   * which cannot reach the target
+   */
+  void GetDistancesTo (uint32_t target, std::vector<uint64_t>& distances) const;
+
+private:
+  std::vector<GlobalRoutingLSA*> m_lsas;        //!< the LSA of each vertex
+  std::map<Ipv4Address, uint32_t> m_vertices;   //!< the vertices by link state ID
+  std::vector<std::vector<Edge> > m_edges;      //!< the edges from each vertex
+  std::vector<std::vector<Edge> > m_reverse;    //!< the edges to each vertex
+};
+
+SPFGraph::SPFGraph (const GlobalRouteManagerLSDB* lsdb)
+{
+  for (uint32_t i = 0; i < lsdb->GetNumLSAs (); i++)
+    {
+      m_lsas.push_back (lsdb->GetLSAByIndex (i));
+      m_vertices[m_lsas.back ()->GetLinkStateId ()] = i;
+    }
+  m_edges.resize (m_lsas.size ());
+  m_reverse.resize (m_lsas.size ());
+  for (uint32_t v = 0; v < m_lsas.size (); v++)
+    {
+      GlobalRoutingLSA* lsa = m_lsas[v];
+      if (lsa->GetLSType () == GlobalRoutingLSA::RouterLSA)
+        {
+          for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+            {
+              GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (j);
+              int32_t w = -1;
+              if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint
+                  || l->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+                {
+                  w = Find (l->GetLinkId ());
+                }
+              if (w >= 0)
+                {
+                  Edge edge = { static_cast<uint32_t> (w), l->GetMetric () };
+                  m_edges[v].push_back (edge);
+                }
+            }
+        }
+      else if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+        {
+          for (uint32_t j = 0; j < lsa->GetNAttachedRouters (); j++)
+            {
+              GlobalRoutingLSA* w_lsa = lsdb->GetLSAByLinkData (lsa->GetAttachedRouter (j));
+              int32_t w = w_lsa ? Find (w_lsa->GetLinkStateId ()) : -1;
+              if (w >= 0)
+                {
+                  Edge edge = { static_cast<uint32_t> (w), 0 };
+                  m_edges[v].push_back (edge);
+                }
+            }
+        }
+      for (uint32_t j = 0; j < m_edges[v].size (); j++)
+        {
+          Edge edge = { v, m_edges[v][j].metric };
+          m_reverse[m_edges[v][j].vertex].push_back (edge);
+        }
+    }
+}
+
+uint32_t
+SPFGraph::GetN (void) const
+{
+  return m_lsas.size ();
+}
+
+GlobalRoutingLSA*
+SPFGraph::GetLSA (uint32_t v) const
+{
+  return m_lsas[v];
+}
+
+int32_t
+SPFGraph::Find (Ipv4Address id) const
+{
+  std::map<Ipv4Address, uint32_t>::const_iterator i = m_vertices.find (id);
+  return i == m_vertices.end () ? -1 : static_cast<int32_t> (i->second);
+}
+
+const std::vector<SPFGraph::Edge>&
+SPFGraph::GetEdges (uint32_t v) const
+{
+  return m_edges[v];
+}
+
+void
+SPFGraph::MarkReaching (const std::vector<uint32_t>& targets, std::vector<bool>& marked) const
+{
+  marked.resize (m_lsas.size (), false);
+  std::vector<uint32_t> pending;
+  for (uint32_t i = 0; i < targets.size (); i++)
+    {
+      if (!marked[targets[i]])
+        {
+          marked[targets[i]] = true;
+          pending.push_back (targets[i]);
+        }
+    }
+  while (!pending.empty ())
+    {
+      uint32_t w = pending.back ();
+      pending.pop_back ();
+      for (uint32_t j = 0; j < m_reverse[w].size (); j++)
+        {
+          uint32_t v = m_reverse[w][j].vertex;
+          if (!marked[v])
+            {
+              marked[v] = true;
+              pending.push_back (v);
+            }
+        }
+    }
+}
+
+void
+SPFGraph::GetDistancesTo (uint32_t target, std::vector<uint64_t>& distances) const
+{
+  typedef std::pair<uint64_t, uint32_t> Item;
+  distances.assign (m_lsas.size (), std::numeric_limits<uint64_t>::max ());
+  std::priority_queue<Item, std::vector<Item>, std::greater<Item> > queue;
+  distances[target] = 0;
+  queue.push (Item (0, target));
+  while (!queue.empty ())
+    {
+      Item item = queue.top ();
+      queue.pop ();
+      if (item.first > distances[item.second])
+        {
+          continue;
+        }
+      const std::vector<Edge>& edges = m_reverse[item.second];
+      for (uint32_t j = 0; j < edges.size (); j++)
+        {
+          uint64_t distance = item.first + edges[j].metric;
+          if (distance < distances[edges[j].vertex])
+            {
+              distances[edges[j].vertex] = distance;
+              queue.push (Item (distance, edges[j].vertex));
+            }
+        }
+    }
+}
+
+/** How an LSA differs from another. */
+enum LSAChange
+{
+  LSA_SAME,     //!< the LSAs are identical
+  LSA_METRICS,  //!< only the metrics of the links differ
+  LSA_CHANGED   //!< the LSAs differ otherwise
+};
+
+/**
+ * \brief Compare two LSAs, except for their SPF status.
+ *
+ * \param a an LSA
+ * \param b an LSA
+ * \returns how the LSAs differ
+ */
+LSAChange
+CompareLSAs (const GlobalRoutingLSA* a, const GlobalRoutingLSA* b)
+{
+  if (a->GetLSType () != b->GetLSType ()
+      || a->GetLinkStateId () != b->GetLinkStateId ()
+      || a->GetAdvertisingRouter () != b->GetAdvertisingRouter ()
+      || a->GetNetworkLSANetworkMask () != b->GetNetworkLSANetworkMask ()
+      || a->GetNLinkRecords () != b->GetNLinkRecords ()
+      || a->GetNAttachedRouters () != b->GetNAttachedRouters ())
+    {
+      return LSA_CHANGED;
+    }
+  for (uint32_t j = 0; j < a->GetNAttachedRouters (); j++)
+    {
+      if (a->GetAttachedRouter (j) != b->GetAttachedRouter (j))
+        {
+          return LSA_CHANGED;
+        }
+    }
+  LSAChange change = LSA_SAME;
+  for (uint32_t j = 0; j < a->GetNLinkRecords (); j++)
+    {
+      GlobalRoutingLinkRecord *la = a->GetLinkRecord (j);
+      GlobalRoutingLinkRecord *lb = b->GetLinkRecord (j);
+      if (la->GetLinkType () != lb->GetLinkType ()
+          || la->GetLinkId () != lb->GetLinkId ()
+          || la->GetLinkData () != lb->GetLinkData ())
+        {
+          return LSA_CHANGED;
+        }
+      if (la->GetMetric () != lb->GetMetric ())
+        {
+          change = LSA_METRICS;
+        }
+    }
+  return change;
+}
+
+} // unnamed namespace
+
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
-  :
-    m_spfroot (0)
 {
   NS_LOG_FUNCTION (this);
   m_lsdb = new GlobalRouteManagerLSDB ();
@@ -571,25 +912,7 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
-      Ptr<Node> node = *i;
-      Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-      if (router == 0)
-        {
-          continue;
-        }
-      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-      uint32_t j = 0;
-      uint32_t nRoutes = gr->GetNRoutes ();
-      NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
-      // Each time we delete route 0, the route index shifts downward
-      // We can delete all routes if we delete the route numbered 0
-      // nRoutes times
-      for (j = 0; j < nRoutes; j++)
-        {
-          NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
-          gr->RemoveRoute (0);
-        }
-      NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+      DeleteRoutes (*i);
     }
   if (m_lsdb)
     {
@@ -599,6 +922,30 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
     }
 }
 
+void
+GlobalRouteManagerImpl::DeleteRoutes (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (this << node);
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  if (router == 0)
+    {
+      return;
+    }
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  uint32_t j = 0;
+  uint32_t nRoutes = gr->GetNRoutes ();
+  NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
+  // Each time we delete route 0, the route index shifts downward
+  // We can delete all routes if we delete the route numbered 0
+  // nRoutes times
+  for (j = 0; j < nRoutes; j++)
+    {
+      NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
+      gr->RemoveRoute (0);
+    }
+  NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+}
+
 //
 // In order to build the routing database, we need to walk the list of nodes
 // in the system and look for those that support the GlobalRouter interface.
@@ -699,6 +1046,7 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 // Walk the list of nodes in the system.
 //
   NS_LOG_INFO ("About to start SPF calculation");
+  std::vector<Ptr<Node> > roots;
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
@@ -723,12 +1071,273 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 //
       if (rtr && rtr->GetNumLSAs () )
         {
-          SPFCalculate (rtr->GetRouterId ());
+          roots.push_back (node);
         }
     }
+  SPFCalculate (roots);
   NS_LOG_INFO ("Finished SPF calculation");
 }
 
+//
+// Rather than deleting all the routes and computing them again, only the
+// routers whose shortest path trees may have changed are recomputed.  Their
+// routes are deleted, and computed as InitializeRoutes () would, so that the
+// routing tables end up exactly as after a full computation.
+//
+void
+GlobalRouteManagerImpl::UpdateRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+  GlobalRouteManagerLSDB* oldLsdb = m_lsdb;
+  m_lsdb = new GlobalRouteManagerLSDB ();
+  BuildGlobalRoutingDatabase ();
+  std::set<Ipv4Address> affected;
+  bool all = FindAffectedRouters (oldLsdb, m_lsdb, affected);
+  delete oldLsdb;
+  NS_LOG_INFO ("Updating the routes of " << (all ? "all" : "some") << " routers");
+
+  std::vector<Ptr<Node> > roots;
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<Node> node = *i;
+      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+      if (!rtr || !(all || affected.count (rtr->GetRouterId ())))
+        {
+          continue;
+        }
+      NS_LOG_LOGIC ("Recomputing the routes of node " << node->GetId ());
+      DeleteRoutes (node);
+      // Ignore nodes that are not assigned to our systemId (distributed sim)
+      if (node->GetSystemId () == Simulator::GetSystemId () && rtr->GetNumLSAs ())
+        {
+          roots.push_back (node);
+        }
+    }
+  SPFCalculate (roots);
+}
+
+//
+// The routes of a root only depend on the LSAs it reaches, on the external
+// LSAs, and on the order in which its SPF calculation pops the vertices.
+// The routers reaching an LSA which changed other than by the metrics of its
+// links are thus affected.  When only the metric of a link (u, w) changed,
+// the SPF calculation of a root R pops the vertices in the same order, with
+// the same parents, unless
+//  - the link was on a shortest path to w: d (R, u) + old metric == d (R, w),
+//  - or the new metric makes a path at most as short:
+//    d (R, u) + new metric <= d (R, w),
+// the distances being the ones of the old database.
+//
+bool
+GlobalRouteManagerImpl::FindAffectedRouters (const GlobalRouteManagerLSDB* oldLsdb,
+                                             const GlobalRouteManagerLSDB* newLsdb,
+                                             std::set<Ipv4Address>& affected) const
+{
+  NS_LOG_FUNCTION (this << oldLsdb << newLsdb);
+  if (oldLsdb->GetNumExtLSAs () != newLsdb->GetNumExtLSAs ())
+    {
+      return true;
+    }
+  for (uint32_t i = 0; i < oldLsdb->GetNumExtLSAs (); i++)
+    {
+      if (CompareLSAs (oldLsdb->GetExtLSA (i), newLsdb->GetExtLSA (i)) != LSA_SAME)
+        {
+          return true;
+        }
+    }
+
+  SPFGraph oldGraph (oldLsdb);
+  SPFGraph newGraph (newLsdb);
+  std::vector<uint32_t> oldChanged;
+  std::vector<uint32_t> newChanged;
+  // the links whose metric changed, as (vertex, edge) in the old graph
+  std::vector<std::pair<uint32_t, uint32_t> > metricChanged;
+  for (uint32_t v = 0; v < newGraph.GetN (); v++)
+    {
+      int32_t o = oldGraph.Find (newGraph.GetLSA (v)->GetLinkStateId ());
+      if (o < 0)
+        {
+          NS_LOG_LOGIC ("LSA " << newGraph.GetLSA (v)->GetLinkStateId () << " added");
+          newChanged.push_back (v);
+          continue;
+        }
+      LSAChange change = CompareLSAs (oldGraph.GetLSA (o), newGraph.GetLSA (v));
+//
+// The routers attached to a network are looked up by link data, and may
+// differ even if the network LSA did not change.
+//
+      const std::vector<SPFGraph::Edge>& oldEdges = oldGraph.GetEdges (o);
+      const std::vector<SPFGraph::Edge>& newEdges = newGraph.GetEdges (v);
+      if (oldEdges.size () != newEdges.size ())
+        {
+          change = LSA_CHANGED;
+        }
+      for (uint32_t j = 0; change != LSA_CHANGED && j < oldEdges.size (); j++)
+        {
+          if (oldGraph.GetLSA (oldEdges[j].vertex)->GetLinkStateId ()
+              != newGraph.GetLSA (newEdges[j].vertex)->GetLinkStateId ())
+            {
+              change = LSA_CHANGED;
+            }
+        }
+      if (change == LSA_CHANGED)
+        {
+          NS_LOG_LOGIC ("LSA " << newGraph.GetLSA (v)->GetLinkStateId () << " changed");
+          oldChanged.push_back (o);
+          newChanged.push_back (v);
+        }
+      else if (change == LSA_METRICS)
+        {
+          NS_LOG_LOGIC ("Metrics of LSA " << newGraph.GetLSA (v)->GetLinkStateId () << " changed");
+          for (uint32_t j = 0; j < oldEdges.size (); j++)
+            {
+              if (oldEdges[j].metric != newEdges[j].metric)
+                {
+                  metricChanged.push_back (std::make_pair (o, j));
+                }
+            }
+        }
+    }
+  for (uint32_t o = 0; o < oldGraph.GetN (); o++)
+    {
+      if (newGraph.Find (oldGraph.GetLSA (o)->GetLinkStateId ()) < 0)
+        {
+          NS_LOG_LOGIC ("LSA " << oldGraph.GetLSA (o)->GetLinkStateId () << " removed");
+          oldChanged.push_back (o);
+        }
+    }
+
+  std::vector<bool> oldMarked;
+  std::vector<bool> newMarked;
+  oldGraph.MarkReaching (oldChanged, oldMarked);
+  newGraph.MarkReaching (newChanged, newMarked);
+  for (uint32_t v = 0; v < newGraph.GetN (); v++)
+    {
+      if (newMarked[v] && newGraph.GetLSA (v)->GetLSType () == GlobalRoutingLSA::RouterLSA)
+        {
+          affected.insert (newGraph.GetLSA (v)->GetLinkStateId ());
+        }
+    }
+
+  std::map<uint32_t, std::vector<uint64_t> > distances;
+  for (uint32_t i = 0; i < metricChanged.size (); i++)
+    {
+      distances[metricChanged[i].first];
+      distances[oldGraph.GetEdges (metricChanged[i].first)[metricChanged[i].second].vertex];
+    }
+  if (distances.size () >= oldGraph.GetN ())
+    {
+      // as expensive as recomputing all the routes
+      return true;
+    }
+  for (std::map<uint32_t, std::vector<uint64_t> >::iterator i = distances.begin ();
+       i != distances.end (); i++)
+    {
+      oldGraph.GetDistancesTo (i->first, i->second);
+    }
+  for (uint32_t i = 0; i < metricChanged.size (); i++)
+    {
+      uint32_t u = metricChanged[i].first;
+      const SPFGraph::Edge& edge = oldGraph.GetEdges (u)[metricChanged[i].second];
+      uint32_t w = edge.vertex;
+      int32_t n = newGraph.Find (oldGraph.GetLSA (u)->GetLinkStateId ());
+      uint64_t newMetric = newGraph.GetEdges (n)[metricChanged[i].second].metric;
+      const std::vector<uint64_t>& toU = distances[u];
+      const std::vector<uint64_t>& toW = distances[w];
+      for (uint32_t r = 0; r < oldGraph.GetN (); r++)
+        {
+          if (oldMarked[r] || toU[r] == std::numeric_limits<uint64_t>::max ()
+              || oldGraph.GetLSA (r)->GetLSType () != GlobalRoutingLSA::RouterLSA)
+            {
+              continue;
+            }
+          if (toU[r] + edge.metric == toW[r] || toU[r] + newMetric <= toW[r])
+            {
+              affected.insert (oldGraph.GetLSA (r)->GetLinkStateId ());
+            }
+        }
+    }
+  for (uint32_t o = 0; o < oldGraph.GetN (); o++)
+    {
+      if (oldMarked[o] && oldGraph.GetLSA (o)->GetLSType () == GlobalRoutingLSA::RouterLSA)
+        {
+          affected.insert (oldGraph.GetLSA (o)->GetLinkStateId ());
+        }
+    }
+  return false;
+}
+
+void
+GlobalRouteManagerImpl::SPFCalculate (const std::vector<Ptr<Node> >& roots)
+{
+  NS_LOG_FUNCTION (this << roots.size ());
+//
+// The state of each calculation is set up here, so that the threads running
+// the calculations only read the LSDB and write to the routing table of
+// their root.
+//
+  std::vector<SPFContext> contexts (roots.size ());
+  bool hasNodes = NodeList::GetNNodes () > 0;
+  for (uint32_t i = 0; i < roots.size (); i++)
+    {
+      SPFContext& ctx = contexts[i];
+      ctx.hasNodes = hasNodes;
+      Ptr<GlobalRouter> rtr = roots[i]->GetObject<GlobalRouter> ();
+      ctx.rootId = rtr->GetRouterId ();
+      ctx.node = roots[i];
+      ctx.ipv4 = roots[i]->GetObject<Ipv4> ();
+      NS_ASSERT_MSG (ctx.ipv4,
+                     "GlobalRouteManagerImpl::SPFCalculate (): "
+                     "GetObject for <Ipv4> interface failed");
+      ctx.routing = rtr->GetRoutingProtocol ();
+      NS_ASSERT (ctx.routing);
+    }
+
+  UintegerValue value;
+  g_spfThreads.GetValue (value);
+  uint32_t nThreads = value.Get ();
+  if (nThreads == 0)
+    {
+      nThreads = std::max (std::thread::hardware_concurrency (), 1U);
+    }
+  nThreads = std::min<uint32_t> (nThreads, contexts.size ());
+  if (nThreads <= 1)
+    {
+      for (uint32_t i = 0; i < contexts.size (); i++)
+        {
+          SPFCalculate (contexts[i]);
+        }
+      return;
+    }
+
+  NS_LOG_LOGIC ("Running " << contexts.size () << " SPF calculations on "
+                << nThreads << " threads");
+  SPFBatch batch;
+  batch.impl = this;
+  batch.contexts = &contexts;
+  batch.next = 0;
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < nThreads; i++)
+    {
+      threads.push_back (Create<SystemThread> (MakeBoundCallback (&GlobalRouteManagerImpl::SPFThread, &batch)));
+      threads.back ()->Start ();
+    }
+  for (uint32_t i = 0; i < nThreads; i++)
+    {
+      threads[i]->Join ();
+    }
+}
+
+void
+GlobalRouteManagerImpl::SPFThread (SPFBatch* batch)
+{
+  for (uint32_t i = batch->next++; i < batch->contexts->size (); i = batch->next++)
+    {
+      batch->impl->SPFCalculate ((*batch->contexts)[i]);
+    }
+}
+
 //
 // This method is derived from quagga ospf_spf_next ().  See RFC2328 Section 
 // 16.1 (2) for further details.
@@ -743,7 +1352,7 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 // vertex already on the candidate list, store the new (lower) cost.
 //
 void
-GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
+GlobalRouteManagerImpl::SPFNext (SPFContext& ctx, SPFVertex* v, CandidateQueue& candidate)
 {
   NS_LOG_FUNCTION (this << v << &candidate);
 
@@ -835,7 +1444,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // If the link is to a router that is already in the shortest path first tree
 // then we have it covered -- ignore it.
 //
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
+      if (ctx.GetStatus (w_lsa) == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
         {
           NS_LOG_LOGIC ("Skipping ->  LSA "<< 
                         w_lsa->GetLinkStateId () << " already in SPF tree");
@@ -860,7 +1469,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
       NS_LOG_LOGIC ("Considering w_lsa " << w_lsa->GetLinkStateId ());
 
 // Is there already vertex w in candidate list?
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
+      if (ctx.GetStatus (w_lsa) == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
         {
 // Calculate nexthop to w
 // We need to figure out how to actually get to the new router represented
@@ -870,9 +1479,9 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 
 // prepare vertex w
           w = new SPFVertex (w_lsa);
-          if (SPFNexthopCalculation (v, w, l, distance))
+          if (SPFNexthopCalculation (ctx, v, w, l, distance))
             {
-              w_lsa->SetStatus (GlobalRoutingLSA::LSA_SPF_CANDIDATE);
+              ctx.status[w_lsa] = GlobalRoutingLSA::LSA_SPF_CANDIDATE;
 //
 // Push this new vertex onto the priority queue (ordered by distance from the
 // root node).
@@ -887,7 +1496,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
             NS_ASSERT_MSG (0, "SPFNexthopCalculation never " 
                            << "return false, but it does now!");
         }
-      else if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
+      else if (ctx.GetStatus (w_lsa) == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
         {
 //
 // We have already considered the link represented by <w>.  What wse have to
@@ -934,7 +1543,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 
 // prepare vertex w
               w = new SPFVertex (w_lsa);
-              SPFNexthopCalculation (v, w, l, distance);
+              SPFNexthopCalculation (ctx, v, w, l, distance);
               cw->MergeRootExitDirections (w);
               cw->MergeParent (w);
 // SPFVertexAddParent (w) is necessary as the destructor of 
@@ -953,13 +1562,13 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // N.B. the nexthop_calculation is conditional, if it finds a valid nexthop
 // it will call spf_add_parents, which will flush the old parents
 //
-              if (SPFNexthopCalculation (v, cw, l, distance))
+              if (SPFNexthopCalculation (ctx, v, cw, l, distance))
                 {
 //
 // If we've changed the cost to get to the vertex represented by <w>, we 
 // must reorder the priority queue keyed to that cost.
 //
-                  candidate.Reorder ();
+                  candidate.Update (cw);
                 }
             } // new lower cost path found
         } // end W is already on the candidate list
@@ -978,6 +1587,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 //
 int
 GlobalRouteManagerImpl::SPFNexthopCalculation (
+  SPFContext& ctx,
   SPFVertex* v, 
   SPFVertex* w,
   GlobalRoutingLinkRecord* l,
@@ -994,7 +1604,7 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
 */
 
 //
-// The vertex m_spfroot is a distinguished vertex representing the node at
+// The vertex ctx.root is a distinguished vertex representing the node at
 // the root of the calculations.  That is, it is the node for which we are
 // calculating the routes.
 //
@@ -1016,7 +1626,7 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
 // The point-to-point link information is only useful in this calculation when
 // we are examining the root node. 
 //
-  if (v == m_spfroot)
+  if (v == ctx.root)
     {
 //
 // In this case <v> is the root node, which means it is the starting point
@@ -1061,7 +1671,7 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
 // from the perspective of <v> -- remember that <l> is the link "from"
 // <v> "to" <w>.
 //
-          uint32_t outIf = FindOutgoingInterfaceId (l->GetLinkData ());
+          uint32_t outIf = FindOutgoingInterfaceId (ctx, l->GetLinkData ());
 
           w->SetRootExitDirection (nextHop, outIf);
           w->SetDistanceFromRoot (distance);
@@ -1079,7 +1689,7 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
           GlobalRoutingLSA* w_lsa = w->GetLSA ();
           NS_ASSERT (w_lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA);
 // Find outgoing interface ID for this network
-          uint32_t outIf = FindOutgoingInterfaceId (w_lsa->GetLinkStateId (), 
+          uint32_t outIf = FindOutgoingInterfaceId (ctx, w_lsa->GetLinkStateId (), 
                                                     w_lsa->GetNetworkLSANetworkMask () );
 // Set the next hop to 0.0.0.0 meaning "not exist"
           Ipv4Address nextHop = Ipv4Address::GetZero ();
@@ -1096,7 +1706,7 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
   else if (v->GetVertexType () == SPFVertex::VertexNetwork) 
     {
 // See if any of v's parents are the root
-      if (v->GetParent () == m_spfroot)
+      if (v->GetParent () == ctx.root)
         {
 // 16.1.1 para 5. ...the parent vertex is a network that
 // directly connects the calculating router to the destination
@@ -1246,7 +1856,22 @@ void
 GlobalRouteManagerImpl::DebugSPFCalculate (Ipv4Address root)
 {
   NS_LOG_FUNCTION (this << root);
-  SPFCalculate (root);
+  SPFContext ctx;
+  ctx.rootId = root;
+  ctx.hasNodes = NodeList::GetNNodes () > 0;
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<GlobalRouter> rtr = (*i)->GetObject<GlobalRouter> ();
+      if (rtr && rtr->GetRouterId () == root)
+        {
+          ctx.node = *i;
+          ctx.ipv4 = (*i)->GetObject<Ipv4> ();
+          ctx.routing = rtr->GetRoutingProtocol ();
+          break;
+        }
+    }
+  SPFCalculate (ctx);
 }
 
 //
@@ -1256,8 +1881,9 @@ GlobalRouteManagerImpl::DebugSPFCalculate (Ipv4Address root)
 // to be run
 //
 bool
-GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
+GlobalRouteManagerImpl::CheckForStubNode (SPFContext& ctx)
 {
+  Ipv4Address root = ctx.rootId;
   NS_LOG_FUNCTION (this << root);
   GlobalRoutingLSA *rlsa = m_lsdb->GetLSA (root);
   Ipv4Address myRouterId = rlsa->GetLinkStateId ();
@@ -1319,15 +1945,13 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
               if (lr->GetLinkId () == myRouterId)
                 {
                   // Next hop is stored in the LinkID field of lr
-                  Ptr<GlobalRouter> router = rlsa->GetNode ()->GetObject<GlobalRouter> ();
-                  NS_ASSERT (router);
-                  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+                  Ptr<Ipv4GlobalRouting> gr = ctx.routing;
                   NS_ASSERT (gr);
                   gr->AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), lr->GetLinkData (), 
-                                         FindOutgoingInterfaceId (transitLink->GetLinkData ()));
+                                         FindOutgoingInterfaceId (ctx, transitLink->GetLinkData ()));
                   NS_LOG_LOGIC ("Inserting default route for node " << myRouterId << " to next hop " << 
                                 lr->GetLinkData () << " via interface " << 
-                                FindOutgoingInterfaceId (transitLink->GetLinkData ()));
+                                FindOutgoingInterfaceId (ctx, transitLink->GetLinkData ()));
                   return true;
                 }
             }
@@ -1338,15 +1962,17 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
 
 // quagga ospf_spf_calculate
 void
-GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
+GlobalRouteManagerImpl::SPFCalculate (SPFContext& ctx)
 {
+  Ipv4Address root = ctx.rootId;
   NS_LOG_FUNCTION (this << root);
 
   SPFVertex *v;
 //
-// Initialize the Link State Database.
+// The status of the LSAs is kept in the context of the calculation, which
+// initially has every LSA unexplored, so that the LSDB is not modified.
 //
-  m_lsdb->Initialize ();
+  ctx.status.clear ();
 //
 // The candidate queue is a priority queue of SPFVertex objects, with the top
 // of the queue being the closest vertex in terms of distance from the root
@@ -1364,9 +1990,9 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // This vertex is the root of the SPF tree and it is distance 0 from the root.
 // We also mark this vertex as being in the SPF tree.
 //
-  m_spfroot= v;
+  ctx.root = v;
   v->SetDistanceFromRoot (0);
-  v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+  ctx.status[v->GetLSA ()] = GlobalRoutingLSA::LSA_SPF_IN_SPFTREE;
   NS_LOG_LOGIC ("Starting SPFCalculate for node " << root);
 
 //
@@ -1374,12 +2000,14 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // We do not need to calculate SPF for every node in the network if this
 // node has only one interface through which another router can be 
 // reached.  Instead, short-circuit this computation and just install
-// a default route in the CheckForStubNode() method.
+// a default route in the CheckForStubNode() method.  The calculation may
+// run on a worker thread, so the NodeList was read when it was set up.
 //
-  if (NodeList::GetNNodes () > 0 && CheckForStubNode (root))
+  if (ctx.hasNodes && CheckForStubNode (ctx))
     {
       NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root);
-      delete m_spfroot;
+      delete ctx.root;
+      ctx.root = 0;
       return;
     }
 
@@ -1399,7 +2027,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // shortest path).  If the new vertices represent shorter paths, we use them
 // and update the path cost.
 //
-      SPFNext (v, candidate);
+      SPFNext (ctx, v, candidate);
 //
 // RFC2328 16.1. (3). 
 //
@@ -1427,7 +2055,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // Update the status field of the vertex to indicate that it is in the SPF
 // tree.
 //
-      v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+      ctx.status[v->GetLSA ()] = GlobalRoutingLSA::LSA_SPF_IN_SPFTREE;
 //
 // The current vertex has a parent pointer.  By calling this rather oddly 
 // named method (blame quagga) we add the current vertex to the list of 
@@ -1443,12 +2071,11 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
 // RFC2328 16.1. (4). 
 //
-// This is the method that actually adds the routes.  It'll walk the list
-// of nodes in the system, looking for the node corresponding to the router
-// ID of the root of the tree -- that is the router we're building the routes
-// for.  It looks for the Ipv4 interface of that node and remembers it.  So
-// we are only actually adding routes to that one node at the root of the SPF 
-// tree.
+// This is the method that actually adds the routes.  It uses the node
+// corresponding to the router ID of the root of the tree -- that is the
+// router we're building the routes for -- and its Ipv4 interface, both
+// found in the context of the calculation.  So we are only actually adding
+// routes to that one node at the root of the SPF tree.
 //
 // We're going to pop of a pointer to every vertex in the tree except the 
 // root in order of distance from the root.  For each of the vertices, we call
@@ -1466,11 +2093,11 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
       if (v->GetVertexType () == SPFVertex::VertexRouter)
         {
-          SPFIntraAddRouter (v);
+          SPFIntraAddRouter (ctx, v);
         }
       else if (v->GetVertexType () == SPFVertex::VertexNetwork)
         {
-          SPFIntraAddTransit (v);
+          SPFIntraAddTransit (ctx, v);
         }
       else
         {
@@ -1485,13 +2112,13 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
     }  // end for loop
 
 // Second stage of SPF calculation procedure
-  SPFProcessStubs (m_spfroot);
+  SPFProcessStubs (ctx, ctx.root);
   for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs (); i++)
     {
-      m_spfroot->ClearVertexProcessed ();
+      ctx.root->ClearVertexProcessed ();
       GlobalRoutingLSA *extlsa = m_lsdb->GetExtLSA (i);
       NS_LOG_LOGIC ("Processing External LSA with id " << extlsa->GetLinkStateId ());
-      ProcessASExternals (m_spfroot, extlsa);
+      ProcessASExternals (ctx, ctx.root, extlsa);
     }
 
 //
@@ -1499,12 +2126,13 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // the SPF tree.  Delete all of the vertices and corresponding resources.  Go
 // possibly do it again for the next router.
 //
-  delete m_spfroot;
-  m_spfroot = 0;
+  delete ctx.root;
+  ctx.root = 0;
+  ctx.status.clear ();
 }
 
 void
-GlobalRouteManagerImpl::ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extlsa)
+GlobalRouteManagerImpl::ProcessASExternals (SPFContext& ctx, SPFVertex* v, GlobalRoutingLSA* extlsa)
 {
   NS_LOG_FUNCTION (this << v << extlsa);
   NS_LOG_LOGIC ("Processing external for destination " << 
@@ -1518,7 +2146,7 @@ GlobalRouteManagerImpl::ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extl
       if ((rlsa->GetLinkStateId ()) == (extlsa->GetAdvertisingRouter ()))
         {
           NS_LOG_LOGIC ("Found advertising router to destination");
-          SPFAddASExternal (extlsa,v);
+          SPFAddASExternal (ctx, extlsa,v);
         }
     }
   for (uint32_t i = 0; i < v->GetNChildren (); i++)
@@ -1526,7 +2154,7 @@ GlobalRouteManagerImpl::ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extl
       if (!v->GetChild (i)->IsVertexProcessed ())
         {
           NS_LOG_LOGIC ("Vertex's child " << i << " not yet processed, processing...");
-          ProcessASExternals (v->GetChild (i), extlsa);
+          ProcessASExternals (ctx, v->GetChild (i), extlsa);
           v->GetChild (i)->SetVertexProcessed (true);
         }
     }
@@ -1538,15 +2166,15 @@ GlobalRouteManagerImpl::ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extl
 //
 
 void
-GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v)
+GlobalRouteManagerImpl::SPFAddASExternal (SPFContext& ctx, GlobalRoutingLSA *extlsa, SPFVertex *v)
 {
   NS_LOG_FUNCTION (this << extlsa << v);
 
-  NS_ASSERT_MSG (m_spfroot, "GlobalRouteManagerImpl::SPFAddASExternal (): Root pointer not set");
+  NS_ASSERT_MSG (ctx.root, "GlobalRouteManagerImpl::SPFAddASExternal (): Root pointer not set");
 // Two cases to consider: We are advertising the external ourselves
 // => No need to add anything
 // OR find best path to the advertising router
-  if (v->GetVertexId () == m_spfroot->GetVertexId ())
+  if (v->GetVertexId () == ctx.root->GetVertexId ())
     {
       NS_LOG_LOGIC ("External is on local host: " 
                     << v->GetVertexId () << "; returning");
@@ -1555,62 +2183,32 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
   NS_LOG_LOGIC ("External is on remote host: " 
                 << extlsa->GetAdvertisingRouter () << "; installing");
 
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
+  Ipv4Address routerId = ctx.root->GetVertexId ();
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The routing information is written to the node that has the router ID
+// corresponding to the root vertex, which was looked up before the
+// calculation started.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  if (ctx.routing == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+      NS_LOG_LOGIC ("Can't find root node " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for node " << ctx.node->GetId ());
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = extlsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = extlsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
 
 //
 // Here's why we did all of that work.  We're going to add a host route to the
@@ -1625,39 +2223,30 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add external network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  Ptr<Ipv4GlobalRouting> gr = ctx.routing;
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
+        {
+          gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << ctx.node->GetId () <<
+                        " add external network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << ctx.node->GetId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 
@@ -1665,7 +2254,7 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 // stub link records will exist for point-to-point interfaces and for
 // broadcast interfaces for which no neighboring router can be found
 void
-GlobalRouteManagerImpl::SPFProcessStubs (SPFVertex* v)
+GlobalRouteManagerImpl::SPFProcessStubs (SPFContext& ctx, SPFVertex* v)
 {
   NS_LOG_FUNCTION (this << v);
   NS_LOG_LOGIC ("Processing stubs for " << v->GetVertexId ());
@@ -1682,7 +2271,7 @@ GlobalRouteManagerImpl::SPFProcessStubs (SPFVertex* v)
           if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
             {
               NS_LOG_LOGIC ("Found a Stub record to " << l->GetLinkId ());
-              SPFIntraAddStub (l, v);
+              SPFIntraAddStub (ctx, l, v);
               continue;
             }
         }
@@ -1691,7 +2280,7 @@ GlobalRouteManagerImpl::SPFProcessStubs (SPFVertex* v)
     {
       if (!v->GetChild (i)->IsVertexProcessed ())
         {
-          SPFProcessStubs (v->GetChild (i));
+          SPFProcessStubs (ctx, v->GetChild (i));
           v->GetChild (i)->SetVertexProcessed (true);
         }
     }
@@ -1699,11 +2288,11 @@ GlobalRouteManagerImpl::SPFProcessStubs (SPFVertex* v)
 
 // RFC2328 16.1. second stage. 
 void
-GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex* v)
+GlobalRouteManagerImpl::SPFIntraAddStub (SPFContext& ctx, GlobalRoutingLinkRecord *l, SPFVertex* v)
 {
   NS_LOG_FUNCTION (this << l << v);
 
-  NS_ASSERT_MSG (m_spfroot, 
+  NS_ASSERT_MSG (ctx.root, 
                  "GlobalRouteManagerImpl::SPFIntraAddStub (): Root pointer not set");
 
   // XXX simplifed logic for the moment.  There are two cases to consider:
@@ -1711,7 +2300,7 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
   //    (already handled above)
   // 2) the stub network is on a remote router, so I should use the
   // same next hop that I use to get to vertex v
-  if (v->GetVertexId () == m_spfroot->GetVertexId ())
+  if (v->GetVertexId () == ctx.root->GetVertexId ())
     {
       NS_LOG_LOGIC ("Stub is on local host: " << v->GetVertexId () << "; returning");
       return;
@@ -1720,68 +2309,30 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 //
 // The root of the Shortest Path First tree is the router to which we are 
 // going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// to this router has a vertex ID which is the router ID of that node, which
+// was looked up before the calculation started.
 //
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
+  Ipv4Address routerId = ctx.root->GetVertexId ();
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  if (ctx.routing == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+      NS_LOG_LOGIC ("Can't find root node " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for node " << ctx.node->GetId ());
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask (l->GetLinkData ().Get ());
-          Ipv4Address tempip = l->GetLinkId ();
-          tempip = tempip.CombineMask (tempmask);
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask (l->GetLinkData ().Get ());
+  Ipv4Address tempip = l->GetLinkId ();
+  tempip = tempip.CombineMask (tempmask);
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -1795,118 +2346,72 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  Ptr<Ipv4GlobalRouting> gr = ctx.routing;
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
+        {
+          gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << ctx.node->GetId () <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << ctx.node->GetId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 //
 // Return the interface number corresponding to a given IP address and mask
-// This is a wrapper around GetInterfaceForPrefix(), but we first
-// have to find the right node pointer to pass to that function.
+// This is a wrapper around GetInterfaceForPrefix() on the node at the root
+// of the SPF calculation.
 // If no such interface is found, return -1 (note:  unit test framework
 // for routing assumes -1 to be a legal return value)
 //
 int32_t
-GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
+GlobalRouteManagerImpl::FindOutgoingInterfaceId (const SPFContext& ctx, Ipv4Address a, Ipv4Mask amask)
 {
   NS_LOG_FUNCTION (this << a << amask);
 //
-// We have an IP address <a> and a vertex ID of the root of the SPF tree.
-// The question is what interface index does this address correspond to.
-// The answer is a little complicated since we have to find a pointer to
-// the node corresponding to the vertex ID, find the Ipv4 interface on that
-// node in order to iterate the interfaces and find the one corresponding to
-// the address in question.
+// We have an IP address <a> and the node at the root of the SPF tree.  The
+// question is what interface index does this address correspond to.  The
+// Ipv4 interface of the node was looked up before the calculation started,
+// since this node is participating in routing IP version 4 packets.
 //
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-//
-// Walk the list of nodes in the system looking for the one corresponding to
-// the node at the root of the SPF tree.  This is the node for which we are
-// building the routing table.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  if (ctx.ipv4 == 0)
     {
-      Ptr<Node> node = *i;
-
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
 //
-// If the node doesn't have a GlobalRouter interface it can't be the one
-// we're interested in.
-//
-      if (rtr == 0)
-        {
-          continue;
-        }
-
-      if (rtr->GetRouterId () == routerId)
-        {
-//
-// This is the node we're building the routing table for.  We're going to need
-// the Ipv4 interface to look for the ipv4 interface index.  Since this node
-// is participating in routing IP version 4 packets, it certainly must have 
-// an Ipv4 interface.
+// Couldn't find it.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                         "GetObject for <Ipv4> interface failed");
+      NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << ctx.rootId);
+      return -1;
+    }
 //
 // Look through the interfaces on this node for one that has the IP address
 // we're looking for.  If we find one, return the corresponding interface
 // index, or -1 if not found.
 //
-          int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
+  int32_t interface = ctx.ipv4->GetInterfaceForPrefix (a, amask);
 
 #if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif 
-          return interface;
-        }
+  if (interface < 0)
+    {
+      NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
+                      "Expected an interface associated with address a:" << a);
     }
-//
-// Couldn't find it.
-//
-  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << routerId);
-  return -1;
+#endif 
+  return interface;
 }
 
 //
@@ -1926,77 +2431,39 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 // route.
 //
 void
-GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
+GlobalRouteManagerImpl::SPFIntraAddRouter (SPFContext& ctx, SPFVertex* v)
 {
   NS_LOG_FUNCTION (this << v);
 
-  NS_ASSERT_MSG (m_spfroot, 
+  NS_ASSERT_MSG (ctx.root, 
                  "GlobalRouteManagerImpl::SPFIntraAddRouter (): Root pointer not set");
 //
 // The root of the Shortest Path First tree is the router to which we are 
 // going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// to this router has a vertex ID which is the router ID of that node, which
+// was looked up before the calculation started.
 //
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
+  Ipv4Address routerId = ctx.root->GetVertexId ();
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  if (ctx.routing == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "GetObject for <Ipv4> interface failed");
+      NS_LOG_LOGIC ("Can't find root node " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for node " << ctx.node->GetId ());
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
 
-          uint32_t nLinkRecords = lsa->GetNLinkRecords ();
+  uint32_t nLinkRecords = lsa->GetNLinkRecords ();
 //
 // Iterate through the link records on the vertex to which we're going to add
 // routes.  To make sure we're being clear, we're going to add routing table
@@ -2005,18 +2472,19 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // the local side of the point-to-point links found on the node described by
 // the vertex <v>.
 //
-          NS_LOG_LOGIC (" Node " << node->GetId () <<
-                        " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
-          for (uint32_t j = 0; j < nLinkRecords; ++j)
-            {
+  NS_LOG_LOGIC (" Node " << ctx.node->GetId () <<
+                " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
+  Ptr<Ipv4GlobalRouting> gr = ctx.routing;
+  for (uint32_t j = 0; j < nLinkRecords; ++j)
+    {
 //
 // We are only concerned about point-to-point links
 //
-              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
-              if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                  continue;
-                }
+      GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+      if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+        {
+          continue;
+        }
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -2030,153 +2498,94 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-              Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-              if (router == 0)
-                {
-                  continue;
-                }
-              Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-              NS_ASSERT (gr);
-              // walk through all available exit directions due to ECMP,
-              // and add host route for each of the exit direction toward
-              // the vertex 'v'
-              for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-                {
-                  SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-                  Ipv4Address nextHop = exit.first;
-                  int32_t outIf = exit.second;
-                  if (outIf >= 0)
-                    {
-                      gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
-                                          outIf);
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " adding host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " and outgoing interface " << outIf);
-                    }
-                  else
-                    {
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " NOT able to add host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " since outgoing interface id is negative " << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
+      // walk through all available exit directions due to ECMP,
+      // and add host route for each of the exit direction toward
+      // the vertex 'v'
+      for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+        {
+          SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+          Ipv4Address nextHop = exit.first;
+          int32_t outIf = exit.second;
+          if (outIf >= 0)
+            {
+              gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
+                                  outIf);
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << ctx.node->GetId () <<
+                            " adding host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " and outgoing interface " << outIf);
             }
-//
-// Done adding the routes for the selected node.
-//
-          return;
-        }
+          else
+            {
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << ctx.node->GetId () <<
+                            " NOT able to add host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " since outgoing interface id is negative " << outIf);
+            }
+        } // for all routes from the root the vertex 'v'
     }
 }
 void
-GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
+GlobalRouteManagerImpl::SPFIntraAddTransit (SPFContext& ctx, SPFVertex* v)
 {
   NS_LOG_FUNCTION (this << v);
 
-  NS_ASSERT_MSG (m_spfroot, 
+  NS_ASSERT_MSG (ctx.root, 
                  "GlobalRouteManagerImpl::SPFIntraAddTransit (): Root pointer not set");
 //
 // The root of the Shortest Path First tree is the router to which we are 
 // going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// to this router has a vertex ID which is the router ID of that node, which
+// was looked up before the calculation started.
 //
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
+  Ipv4Address routerId = ctx.root->GetVertexId ();
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  if (ctx.routing == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "GetObject for <Ipv4> interface failed");
+      NS_LOG_LOGIC ("Can't find root node " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("setting routes for node " << ctx.node->GetId ());
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = lsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all available exit directions due to ECMP,
-          // and add host route for each of the exit direction toward
-          // the vertex 'v'
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = lsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+  Ptr<Ipv4GlobalRouting> gr = ctx.routing;
+  // walk through all available exit directions due to ECMP,
+  // and add host route for each of the exit direction toward
+  // the vertex 'v'
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
 
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative " << outIf);
-                }
-            }
+      if (outIf >= 0)
+        {
+          gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << ctx.node->GetId () <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-    } 
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << ctx.node->GetId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative " << outIf);
+        }
+    }
 }
 
 // Derived from quagga ospf_vertex_add_parents ()
@@ -26,6 +26,7 @@
 #include <list>
 #include <queue>
 #include <map>
+#include <set>
 #include <vector>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
@@ -38,6 +39,7 @@ const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
 class Ipv4GlobalRouting;
+class Node;
 
 /**
  * \ingroup globalrouting
@@ -538,6 +540,10 @@ private:
   ListOfSPFVertex_t m_parents; //!< parent list
   ListOfSPFVertex_t m_children; //!< Children list
   bool m_vertexProcessed; //!< Flag to note whether vertex has been processed in stage two of SPF computation
+  uint32_t m_candidateIndex; //!< Position in the heap of the CandidateQueue
+  uint64_t m_candidateOrder; //!< Order of the last push or update in the CandidateQueue
+
+  friend class CandidateQueue;
 
 /**
  * @brief The SPFVertex copy construction is disallowed.  There's no need for
@@ -641,6 +647,24 @@ public:
  */
   GlobalRoutingLSA* GetLSAByLinkData (Ipv4Address addr) const;
 
+/**
+ * @brief Get the number of router and network Link State Advertisements.
+ *
+ * @see GlobalRoutingLSA
+ * @returns the number of router and network Link State Advertisements.
+ */
+  uint32_t GetNumLSAs () const;
+
+/**
+ * @brief Look up the router or network Link State Advertisement associated
+ * with the given index, in the order in which they were inserted.
+ *
+ * @see GlobalRoutingLSA
+ * @param index the index associated with the LSA.
+ * @returns A pointer to the Link State Advertisement.
+ */
+  GlobalRoutingLSA* GetLSAByIndex (uint32_t index) const;
+
 /**
  * @brief Set all LSA flags to an initialized state, for SPF computation
  *
@@ -680,6 +704,10 @@ private:
   typedef std::pair<Ipv4Address, GlobalRoutingLSA*> LSDBPair_t; //!< pair of IPv4 addresses / Link State Advertisements
 
   LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
+  std::vector<GlobalRoutingLSA*> m_lsas; //!< Link State Advertisements of the database, in insertion order
+  /// container of link data / database entries
+  typedef std::map<Ipv4Address, LSDBMap_t::const_iterator> LinkDataMap_t;
+  LinkDataMap_t m_linkData; //!< database entries by link data of their TransitNetwork link records
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
 
 /**
@@ -732,9 +760,25 @@ public:
 /**
  * @brief Compute routes using a Dijkstra SPF computation and populate
  * per-node forwarding tables
+ *
+ * The SPF computations of the routers are independent; the global value
+ * "GlobalRoutingSpfThreads" sets the number of threads running them.  The
+ * log messages of computations running concurrently are interleaved.
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database, and recompute the routes of the
+ * routers whose routes may have changed since the routes were last computed.
+ *
+ * The routes of a router are recomputed if its shortest path tree may go
+ * through a router or network whose Link State Advertisement changed, or
+ * through a link whose metric changed.  The routes of the other routers are
+ * left untouched.  If the routes were never computed, or were deleted by
+ * DeleteGlobalRoutes (), all the routes are computed.
+ */
+  virtual void UpdateRoutes ();
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  */
@@ -766,9 +810,52 @@ private:
  */
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
-  SPFVertex* m_spfroot; //!< the root node
+  /**
+   * \brief The state of the SPF calculation rooted at a router.
+   */
+  struct SPFContext;
+
+  /**
+   * \brief The SPF calculations shared by the threads of InitializeRoutes ().
+   */
+  struct SPFBatch;
+
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
 
+  /**
+   * \brief Delete the routes of a router.
+   *
+   * \param node the node of the router
+   */
+  void DeleteRoutes (Ptr<Node> node);
+
+  /**
+   * \brief Find the routers whose routes may differ between two databases.
+   *
+   * \param oldLsdb the database the routes were computed from
+   * \param newLsdb the new database
+   * \param affected the router IDs of the routers whose routes may differ
+   * \returns true if the routes of every router may differ
+   */
+  bool FindAffectedRouters (const GlobalRouteManagerLSDB* oldLsdb,
+                            const GlobalRouteManagerLSDB* newLsdb,
+                            std::set<Ipv4Address>& affected) const;
+
+  /**
+   * \brief Calculate the SPF trees rooted at some routers, and install
+   * the routes of these routers.
+   *
+   * \param roots the nodes of the routers
+   */
+  void SPFCalculate (const std::vector<Ptr<Node> >& roots);
+
+  /**
+   * \brief Run the SPF calculations of a batch until none is left.
+   *
+   * \param batch the batch
+   */
+  static void SPFThread (SPFBatch* batch);
+
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
    *
@@ -776,18 +863,18 @@ private:
    * can safely be added to the next-hop router and SPF does not need
    * to be run
    *
-   * \param root the root node
+   * \param ctx the SPF calculation
    * \returns true if the node is a stub
    */
-  bool CheckForStubNode (Ipv4Address root);
+  bool CheckForStubNode (SPFContext& ctx);
 
   /**
    * \brief Calculate the shortest path first (SPF) tree
    *
    * Equivalent to quagga ospf_spf_calculate
-   * \param root the root node
+   * \param ctx the SPF calculation
    */
-  void SPFCalculate (Ipv4Address root);
+  void SPFCalculate (SPFContext& ctx);
 
   /**
    * \brief Process Stub nodes
@@ -796,17 +883,19 @@ private:
    * stub link records will exist for point-to-point interfaces and for
    * broadcast interfaces for which no neighboring router can be found
    *
+   * \param ctx the SPF calculation
    * \param v vertex to be processed
    */
-  void SPFProcessStubs (SPFVertex* v);
+  void SPFProcessStubs (SPFContext& ctx, SPFVertex* v);
 
   /**
    * \brief Process Autonomous Systems (AS) External LSA
    *
+   * \param ctx the SPF calculation
    * \param v vertex to be processed
    * \param extlsa external LSA
    */
-  void ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extlsa);
+  void ProcessASExternals (SPFContext& ctx, SPFVertex* v, GlobalRoutingLSA* extlsa);
 
   /**
    * \brief Examine the links in v's LSA and update the list of candidates with any
@@ -826,10 +915,11 @@ private:
    * vertices not already on the list.  If a lower-cost path is found to a
    * vertex already on the candidate list, store the new (lower) cost.
    *
+   * \param ctx the SPF calculation
    * \param v the vertex
    * \param candidate the SPF candidate queue
    */
-  void SPFNext (SPFVertex* v, CandidateQueue& candidate);
+  void SPFNext (SPFContext& ctx, SPFVertex* v, CandidateQueue& candidate);
 
   /**
    * \brief Calculate nexthop from root through V (parent) to vertex W (destination)
@@ -838,13 +928,14 @@ private:
    * This method is derived from quagga ospf_nexthop_calculation() 16.1.1.
    * For now, this is greatly simplified from the quagga code
    *
+   * \param ctx the SPF calculation
    * \param v the parent
    * \param w the destination
    * \param l the link record
    * \param distance the target distance
    * \returns 1 on success
    */
-  int SPFNexthopCalculation (SPFVertex* v, SPFVertex* w, 
+  int SPFNexthopCalculation (SPFContext& ctx, SPFVertex* v, SPFVertex* w, 
                              GlobalRoutingLinkRecord* l, uint32_t distance);
 
   /**
@@ -904,47 +995,52 @@ private:
    * a destination IP address, reachable from the root, to which we add a host
    * route.
    *
+   * \param ctx the SPF calculation
    * \param v the vertex
    *
    */
-  void SPFIntraAddRouter (SPFVertex* v);
+  void SPFIntraAddRouter (SPFContext& ctx, SPFVertex* v);
 
   /**
    * \brief Add a transit to the routing tables
    *
+   * \param ctx the SPF calculation
    * \param v the vertex
    */
-  void SPFIntraAddTransit (SPFVertex* v);
+  void SPFIntraAddTransit (SPFContext& ctx, SPFVertex* v);
 
   /**
    * \brief Add a stub to the routing tables
    *
+   * \param ctx the SPF calculation
    * \param l the global routing link record
    * \param v the vertex
    */
-  void SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex* v);
+  void SPFIntraAddStub (SPFContext& ctx, GlobalRoutingLinkRecord *l, SPFVertex* v);
 
   /**
    * \brief Add an external route to the routing tables
    *
+   * \param ctx the SPF calculation
    * \param extlsa the external LSA
    * \param v the vertex
    */
-  void SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v);
+  void SPFAddASExternal (SPFContext& ctx, GlobalRoutingLSA *extlsa, SPFVertex *v);
 
   /**
    * \brief Return the interface number corresponding to a given IP address and mask
    *
-   * This is a wrapper around GetInterfaceForPrefix(), but we first
-   * have to find the right node pointer to pass to that function.
+   * This is a wrapper around GetInterfaceForPrefix() on the node at the
+   * root of the SPF calculation.
    * If no such interface is found, return -1 (note:  unit test framework
    * for routing assumes -1 to be a legal return value)
    *
+   * \param ctx the SPF calculation
    * \param a the target IP address
    * \param amask the target subnet mask
    * \return the outgoing interface number
    */
-  int32_t FindOutgoingInterfaceId (Ipv4Address a, 
+  int32_t FindOutgoingInterfaceId (const SPFContext& ctx, Ipv4Address a, 
                                    Ipv4Mask amask = Ipv4Mask ("255.255.255.255"));
 };
 
@@ -29,6 +29,7 @@
 #include "ns3/boolean.h"
 #include "ns3/ipv4-route.h"
 #include "ns3/ipv6-interface.h"
+#include "ns3/packet-census.h"
 
 namespace ns3 {
 
@@ -113,6 +114,7 @@ void
 Icmpv4L4Protocol::SendMessage (Ptr<Packet> packet, Ipv4Address dest, uint8_t type, uint8_t code)
 {
   NS_LOG_FUNCTION (this << packet << dest << static_cast<uint32_t> (type) << static_cast<uint32_t> (code));
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
   Ptr<Ipv4> ipv4 = m_node->GetObject<Ipv4> ();
   NS_ASSERT (ipv4 != 0 && ipv4->GetRoutingProtocol () != 0);
   Ipv4Header header;
@@ -138,6 +140,7 @@ void
 Icmpv4L4Protocol::SendMessage (Ptr<Packet> packet, Ipv4Address source, Ipv4Address dest, uint8_t type, uint8_t code, Ptr<Ipv4Route> route)
 {
   NS_LOG_FUNCTION (this << packet << source << dest << static_cast<uint32_t> (type) << static_cast<uint32_t> (code) << route);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
   Icmpv4Header icmp;
   icmp.SetType (type);
   icmp.SetCode (code);
@@ -169,6 +172,7 @@ Icmpv4L4Protocol::SendDestUnreach (Ipv4Header header, Ptr<const Packet> orgData,
                                    uint8_t code, uint16_t nextHopMtu)
 {
   NS_LOG_FUNCTION (this << header << *orgData << (uint32_t) code << nextHopMtu);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
   Ptr<Packet> p = Create<Packet> ();
   Icmpv4DestinationUnreachable unreach;
   unreach.SetNextHopMtu (nextHopMtu);
@@ -182,6 +186,7 @@ void
 Icmpv4L4Protocol::SendTimeExceededTtl (Ipv4Header header, Ptr<const Packet> orgData, bool isFragment)
 {
   NS_LOG_FUNCTION (this << header << *orgData);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
   Ptr<Packet> p = Create<Packet> ();
   Icmpv4TimeExceeded time;
   time.SetHeader (header);
@@ -204,6 +209,7 @@ Icmpv4L4Protocol::HandleEcho (Ptr<Packet> p,
                               Ipv4Address destination)
 {
   NS_LOG_FUNCTION (this << p << header << source << destination);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
 
   Ptr<Packet> reply = Create<Packet> ();
   Icmpv4Echo echo;
@@ -22,6 +22,8 @@
 #include "ipv4-end-point.h"
 #include "ipv4-interface-address.h"
 #include "ns3/log.h"
+#include "ns3/abort.h"
+#include <algorithm>
 
 
 namespace ns3 {
@@ -49,25 +51,18 @@ bool
 Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
 {
   NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
-    {
-      if ((*i)->GetLocalPort  () == port) 
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_localPorts.find (port) != m_localPorts.end ();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv4Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  std::pair<FourTupleMap::iterator, FourTupleMap::iterator> range =
+    m_localTuples.equal_range (FourTuple (addr, port, Ipv4Address::GetAny (), 0));
+  for (FourTupleMap::iterator i = range.first; i != range.second; i++)
     {
-      if ((*i)->GetLocalPort () == port &&
-          (*i)->GetLocalAddress () == addr &&
-          (*i)->GetBoundNetDevice () == boundNetDevice)
+      if ((*i->second)->GetBoundNetDevice () == boundNetDevice)
         {
           return true;
         }
@@ -87,6 +82,7 @@ Ipv4EndPointDemux::Allocate (void)
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
   m_endPoints.push_back (endPoint);
+  Insert (--m_endPoints.end ());
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -103,6 +99,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
   m_endPoints.push_back (endPoint);
+  Insert (--m_endPoints.end ());
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -126,6 +123,7 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv4Address address,
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
   m_endPoints.push_back (endPoint);
+  Insert (--m_endPoints.end ());
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -136,13 +134,11 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort << boundNetDevice);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  std::pair<FourTupleMap::iterator, FourTupleMap::iterator> range =
+    m_fourTuples.equal_range (FourTuple (localAddress, localPort, peerAddress, peerPort));
+  for (FourTupleMap::iterator i = range.first; i != range.second; i++)
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress &&
-          ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0))
+      if ((*i->second)->GetBoundNetDevice () == boundNetDevice || (*i->second)->GetBoundNetDevice () == 0)
         {
           NS_LOG_WARN ("Duplicated endpoint.");
           return 0;
@@ -151,6 +147,7 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
   m_endPoints.push_back (endPoint);
+  Insert (--m_endPoints.end ());
 
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
 
@@ -161,15 +158,76 @@ void
 Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this << endPoint);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  EndPointsI i = Remove (endPoint, FourTuple (endPoint->m_localAddr, endPoint->m_localPort,
+                                              endPoint->m_peerAddr, endPoint->m_peerPort));
+  if (i != m_endPoints.end ())
+    {
+      delete endPoint;
+      m_endPoints.erase (i);
+    }
+}
+
+void
+Ipv4EndPointDemux::Insert (EndPointsI endPoint)
+{
+  NS_LOG_FUNCTION (this << *endPoint);
+  Ipv4EndPoint *endP = *endPoint;
+  endP->m_demux = this;
+  m_fourTuples.insert (std::make_pair (FourTuple (endP->m_localAddr, endP->m_localPort,
+                                                  endP->m_peerAddr, endP->m_peerPort),
+                                       endPoint));
+  m_localTuples.insert (std::make_pair (FourTuple (endP->m_localAddr, endP->m_localPort,
+                                                   Ipv4Address::GetAny (), 0),
+                                        endPoint));
+  m_localPorts[endP->m_localPort]++;
+}
+
+Ipv4EndPointDemux::EndPointsI
+Ipv4EndPointDemux::Remove (Ipv4EndPoint *endPoint, const FourTuple &tuple)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  EndPointsI endP = m_endPoints.end ();
+  std::pair<FourTupleMap::iterator, FourTupleMap::iterator> range = m_fourTuples.equal_range (tuple);
+  for (FourTupleMap::iterator i = range.first; i != range.second; i++)
     {
-      if (*i == endPoint)
+      if (*i->second == endPoint)
         {
-          delete endPoint;
-          m_endPoints.erase (i);
+          endP = i->second;
+          m_fourTuples.erase (i);
           break;
         }
     }
+  if (endP == m_endPoints.end ())
+    {
+      return endP;
+    }
+  range = m_localTuples.equal_range (FourTuple (tuple.localAddress, tuple.localPort, Ipv4Address::GetAny (), 0));
+  for (FourTupleMap::iterator i = range.first; i != range.second; i++)
+    {
+      if (*i->second == endPoint)
+        {
+          m_localTuples.erase (i);
+          break;
+        }
+    }
+  std::unordered_map<uint16_t, uint32_t>::iterator port = m_localPorts.find (tuple.localPort);
+  if (--port->second == 0)
+    {
+      m_localPorts.erase (port);
+    }
+  return endP;
+}
+
+void
+Ipv4EndPointDemux::Update (Ipv4EndPoint *endPoint, Ipv4Address localAddress,
+                           Ipv4Address peerAddress, uint16_t peerPort)
+{
+  NS_LOG_FUNCTION (this << endPoint << localAddress << peerAddress << peerPort);
+  EndPointsI i = Remove (endPoint, FourTuple (localAddress, endPoint->m_localPort, peerAddress, peerPort));
+  if (i != m_endPoints.end ())
+    {
+      Insert (i);
+    }
 }
 
 /*
@@ -190,32 +248,15 @@ Ipv4EndPointDemux::GetAllEndPoints (void)
 }
 
 
-/*
- * If we have an exact match, we return it.
- * Otherwise, if we find a generic match, we return it.
- * Otherwise, we return 0.
- */
-Ipv4EndPointDemux::EndPoints
-Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport, 
-                           Ipv4Address saddr, uint16_t sport,
-                           Ptr<Ipv4Interface> incomingInterface)
+void
+Ipv4EndPointDemux::AddMatches (const FourTuple &tuple, Ptr<Ipv4Interface> incomingInterface,
+                               EndPoints &endPoints)
 {
-  NS_LOG_FUNCTION (this << daddr << dport << saddr << sport << incomingInterface);
-  
-  EndPoints retval1; // Matches exact on local port, wildcards on others
-  EndPoints retval2; // Matches exact on local port/adder, wildcards on others
-  EndPoints retval3; // Matches all but local address
-  EndPoints retval4; // Exact match on all 4
-
-  NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr << ":" << dport);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  NS_LOG_FUNCTION (this << tuple.localAddress << tuple.localPort << tuple.peerAddress << tuple.peerPort);
+  std::pair<FourTupleMap::iterator, FourTupleMap::iterator> range = m_fourTuples.equal_range (tuple);
+  for (FourTupleMap::iterator i = range.first; i != range.second; i++)
     {
-      Ipv4EndPoint* endP = *i;
-
-      NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
-                                                 << " daddr=" << endP->GetLocalAddress ()
-                                                 << " sport=" << endP->GetPeerPort ()
-                                                 << " saddr=" << endP->GetPeerAddress ());
+      Ipv4EndPoint* endP = *i->second;
 
       if (!endP->IsRxEnabled ())
         {
@@ -224,14 +265,6 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
           continue;
         }
 
-      if (endP->GetLocalPort () != dport) 
-        {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
-          continue;
-        }
       if (endP->GetBoundNetDevice ())
         {
           if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
@@ -244,92 +277,74 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
             }
         }
 
-      bool localAddressMatchesExact = false;
-      bool localAddressIsAny = false;
-      bool localAddressIsSubnetAny = false;
+      NS_LOG_LOGIC ("Found an endpoint, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
+      endPoints.push_back (endP);
+    }
+}
 
-      // We have 3 cases:
-      // 1) Exact local / destination address match
-      // 2) Local endpoint bound to Any -> matches anything
-      // 3) Local endpoint bound to x.y.z.0 -> matches Subnet-directed broadcast packet (e.g., x.y.z.255 in a /24 net) and direct destination match.
+/*
+ * If we have an exact match, we return it.
+ * Otherwise, if we find a generic match, we return it.
+ * Otherwise, we return 0.
+ */
+Ipv4EndPointDemux::EndPoints
+Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport, 
+                           Ipv4Address saddr, uint16_t sport,
+                           Ptr<Ipv4Interface> incomingInterface)
+{
+  NS_LOG_FUNCTION (this << daddr << dport << saddr << sport << incomingInterface);
+  NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr << ":" << dport);
 
-      if (endP->GetLocalAddress () == daddr)
-        {
-          // Case 1:
-          localAddressMatchesExact = true;
-        }
-      else if (endP->GetLocalAddress () == Ipv4Address::GetAny ())
-        {
-          // Case 2:
-          localAddressIsAny = true;
-        }
-      else
+  // A local address matches the destination address in 3 cases:
+  // 1) Exact local / destination address match
+  // 2) Local endpoint bound to Any -> matches anything
+  // 3) Local endpoint bound to x.y.z.0 -> matches Subnet-directed broadcast packet (e.g., x.y.z.255 in a /24 net) and direct destination match.
+  // Here we collect the local addresses of the cases 2 and 3.
+  std::vector<Ipv4Address> wildcards;
+  if (daddr != Ipv4Address::GetAny ())
+    {
+      wildcards.push_back (Ipv4Address::GetAny ());
+    }
+  if (incomingInterface)
+    {
+      for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
         {
-          // Case 3:
-          for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
+          Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
+          Ipv4Address addrNetpart = addr.GetLocal ().CombineMask (addr.GetMask ());
+          if (addrNetpart != daddr && addrNetpart == daddr.CombineMask (addr.GetMask ())
+              && std::find (wildcards.begin (), wildcards.end (), addrNetpart) == wildcards.end ())
             {
-              Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
-
-              Ipv4Address addrNetpart = addr.GetLocal ().CombineMask (addr.GetMask ());
-              if (endP->GetLocalAddress () == addrNetpart)
-                {
-                  NS_LOG_LOGIC ("Endpoint is SubnetDirectedAny " << endP->GetLocalAddress () << "/" << addr.GetMask ().GetPrefixLength ());
-
-                  Ipv4Address daddrNetPart = daddr.CombineMask (addr.GetMask ());
-                  if (addrNetpart == daddrNetPart)
-                    {
-                      localAddressIsSubnetAny = true;
-                    }
-                }
+              NS_LOG_LOGIC ("Looking for SubnetDirectedAny endpoints " << addrNetpart << "/" << addr.GetMask ().GetPrefixLength ());
+              wildcards.push_back (addrNetpart);
             }
-
-          // if no match here, keep looking
-          if (!localAddressIsSubnetAny)
-            continue;
-        }
-
-      bool remotePortMatchesExact = endP->GetPeerPort () == sport;
-      bool remotePortMatchesWildCard = endP->GetPeerPort () == 0;
-      bool remoteAddressMatchesExact = endP->GetPeerAddress () == saddr;
-      bool remoteAddressMatchesWildCard = endP->GetPeerAddress () == Ipv4Address::GetAny ();
-
-      // If remote does not match either with exact or wildcard,
-      // skip this one
-      if (!(remotePortMatchesExact || remotePortMatchesWildCard))
-        continue;
-      if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
-        continue;
-
-      bool localAddressMatchesWildCard = localAddressIsAny || localAddressIsSubnetAny;
-
-      if (localAddressMatchesExact && remoteAddressMatchesExact && remotePortMatchesExact)
-        { // All 4 match - this is the case of an open TCP connection, for example.
-          NS_LOG_LOGIC ("Found an endpoint for case 4, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
-          retval4.push_back (endP);
-        }
-      if (localAddressMatchesWildCard && remoteAddressMatchesExact && remotePortMatchesExact)
-        { // All but local address - no idea what this case could be.
-          NS_LOG_LOGIC ("Found an endpoint for case 3, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
-          retval3.push_back (endP);
-        }
-      if (localAddressMatchesExact && remoteAddressMatchesWildCard && remotePortMatchesWildCard)
-        { // Only local port and local address matches exactly - Not yet opened connection
-          NS_LOG_LOGIC ("Found an endpoint for case 2, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
-          retval2.push_back (endP);
-        }
-      if (localAddressMatchesWildCard && remoteAddressMatchesWildCard && remotePortMatchesWildCard)
-        { // Only local port matches exactly - Endpoint open to "any" connection
-          NS_LOG_LOGIC ("Found an endpoint for case 1, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
-          retval1.push_back (endP);
         }
     }
 
   // Here we find the most exact match
   EndPoints retval;
-  if (!retval4.empty ()) retval = retval4;
-  else if (!retval3.empty ()) retval = retval3;
-  else if (!retval2.empty ()) retval = retval2;
-  else retval = retval1;
+  // All 4 match - this is the case of an open TCP connection, for example.
+  AddMatches (FourTuple (daddr, dport, saddr, sport), incomingInterface, retval);
+  if (retval.empty ())
+    {
+      // All but local address - no idea what this case could be.
+      for (std::vector<Ipv4Address>::const_iterator i = wildcards.begin (); i != wildcards.end (); i++)
+        {
+          AddMatches (FourTuple (*i, dport, saddr, sport), incomingInterface, retval);
+        }
+    }
+  if (retval.empty ())
+    {
+      // Only local port and local address matches exactly - Not yet opened connection
+      AddMatches (FourTuple (daddr, dport, Ipv4Address::GetAny (), 0), incomingInterface, retval);
+    }
+  if (retval.empty ())
+    {
+      // Only local port matches exactly - Endpoint open to "any" connection
+      for (std::vector<Ipv4Address>::const_iterator i = wildcards.begin (); i != wildcards.end (); i++)
+        {
+          AddMatches (FourTuple (*i, dport, Ipv4Address::GetAny (), 0), incomingInterface, retval);
+        }
+    }
 
   NS_ABORT_MSG_IF (retval.size () > 1, "Too many endpoints - perhaps you created too many sockets without binding them to different NetDevices.");
   return retval;  // might be empty if no matches
@@ -16,10 +16,12 @@
 // Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 //
 
+#include <algorithm>
 #include <vector>
 #include <iomanip>
 #include "ns3/names.h"
 #include "ns3/log.h"
+#include "ns3/unused.h"
 #include "ns3/simulator.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
@@ -59,7 +61,8 @@ Ipv4GlobalRouting::GetTypeId (void)
 
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
-    m_respondToInterfaceEvents (false)
+    m_respondToInterfaceEvents (false),
+    m_nextRank (0)
 {
   NS_LOG_FUNCTION (this);
 
@@ -80,6 +83,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  IndexRoute (m_hostRouteTrie, route);
 }
 
 void 
@@ -90,6 +94,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  IndexRoute (m_hostRouteTrie, route);
 }
 
 void 
@@ -105,6 +110,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  IndexRoute (m_networkRouteTrie, route);
 }
 
 void 
@@ -118,6 +124,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  IndexRoute (m_networkRouteTrie, route);
 }
 
 void 
@@ -133,6 +140,7 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  IndexRoute (m_ASexternalRouteTrie, route);
 }
 
 
@@ -146,72 +154,98 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
   typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
   RouteVec_t allRoutes;
 
+  uint8_t key[4];
+  dest.Serialize (key);
+
   NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
-       i++) 
+  const RouteTrie::Entries *hostRoutes = m_hostRouteTrie.Find (key, 32);
+  if (hostRoutes != 0)
     {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest () == dest)
+      for (RouteTrie::Entries::const_iterator i = hostRoutes->begin ();
+           i != hostRoutes->end ();
+           i++)
         {
+          NS_ASSERT (i->route->IsHost () && i->route->GetDest () == dest);
           if (oif != 0)
             {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
+              if (oif != m_ipv4->GetNetDevice (i->route->GetInterface ()))
                 {
                   NS_LOG_LOGIC ("Not on requested interface, skipping");
                   continue;
                 }
             }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
+          allRoutes.push_back (i->route);
+          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << i->route);
         }
     }
   if (allRoutes.size () == 0) // if no host route is found
     {
       NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end (); 
-           j++) 
+      // all the matching network routes are candidates, whatever the
+      // length of their prefix, in the order of m_networkRoutes
+      std::vector<RankedRoute> matches;
+      m_networkRouteTrie.Lookup (key, [&] (uint8_t length, const RouteTrie::Entries &entries)
+      {
+        for (RouteTrie::Entries::const_iterator j = entries.begin (); j != entries.end (); j++)
+          {
+            Ipv4RoutingTableEntry *route = j->route;
+            if (!route->GetDestNetworkMask ().IsMatch (dest, route->GetDestNetwork ()))
+              {
+                continue;
+              }
+            if (oif != 0)
+              {
+                if (oif != m_ipv4->GetNetDevice (route->GetInterface ()))
+                  {
+                    NS_LOG_LOGIC ("Not on requested interface, skipping");
+                    continue;
+                  }
+              }
+            matches.push_back (*j);
+          }
+        return true;
+      });
+      std::sort (matches.begin (), matches.end (),
+                 [] (const RankedRoute &a, const RankedRoute &b) { return a.rank < b.rank; });
+      for (std::vector<RankedRoute>::const_iterator j = matches.begin (); j != matches.end (); j++)
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry)) 
-            {
-              if (oif != 0)
-                {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
-                }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
-            }
+          allRoutes.push_back (j->route);
+          NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << j->route);
         }
     }
   if (allRoutes.size () == 0)  // consider external if no host/network found
     {
-      for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
-           k != m_ASexternalRoutes.end ();
-           k++)
+      // the first matching external route
+      const RankedRoute *first = 0;
+      m_ASexternalRouteTrie.Lookup (key, [&] (uint8_t length, const RouteTrie::Entries &entries)
+      {
+        for (RouteTrie::Entries::const_iterator k = entries.begin (); k != entries.end (); k++)
+          {
+            Ipv4RoutingTableEntry *route = k->route;
+            if (!route->GetDestNetworkMask ().IsMatch (dest, route->GetDestNetwork ()))
+              {
+                continue;
+              }
+            NS_LOG_LOGIC ("Found external route" << route);
+            if (oif != 0)
+              {
+                if (oif != m_ipv4->GetNetDevice (route->GetInterface ()))
+                  {
+                    NS_LOG_LOGIC ("Not on requested interface, skipping");
+                    continue;
+                  }
+              }
+            if (first == 0 || k->rank < first->rank)
+              {
+                first = &(*k);
+              }
+            break;
+          }
+        return true;
+      });
+      if (first != 0)
         {
-          Ipv4Mask mask = (*k)->GetDestNetworkMask ();
-          Ipv4Address entry = (*k)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry))
-            {
-              NS_LOG_LOGIC ("Found external route" << *k);
-              if (oif != 0)
-                {
-                  if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
-                }
-              allRoutes.push_back (*k);
-              break;
-            }
+          allRoutes.push_back (first->route);
         }
     }
   if (allRoutes.size () > 0 ) // if route(s) is found
@@ -319,6 +353,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
           if (tmp  == index)
             {
               NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_hostRoutes.size ());
+              UnindexRoute (m_hostRouteTrie, *i);
               delete *i;
               m_hostRoutes.erase (i);
               NS_LOG_LOGIC ("Done removing host route " << index << "; host route remaining size = " << m_hostRoutes.size ());
@@ -336,6 +371,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_networkRoutes.size ());
+          UnindexRoute (m_networkRouteTrie, *j);
           delete *j;
           m_networkRoutes.erase (j);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -352,6 +388,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_ASexternalRoutes.size ());
+          UnindexRoute (m_ASexternalRouteTrie, *k);
           delete *k;
           m_ASexternalRoutes.erase (k);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -362,6 +399,32 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
   NS_ASSERT (false);
 }
 
+void
+Ipv4GlobalRouting::IndexRoute (RouteTrie &trie, Ipv4RoutingTableEntry *route)
+{
+  NS_LOG_FUNCTION (this << route);
+  uint8_t key[4];
+  route->GetDestNetwork ().Serialize (key);
+  RankedRoute ranked;
+  ranked.route = route;
+  ranked.rank = m_nextRank++;
+  trie.Insert (key, route->GetDestNetworkMask ().GetPrefixLength (), ranked);
+}
+
+void
+Ipv4GlobalRouting::UnindexRoute (RouteTrie &trie, Ipv4RoutingTableEntry *route)
+{
+  NS_LOG_FUNCTION (this << route);
+  uint8_t key[4];
+  route->GetDestNetwork ().Serialize (key);
+  RankedRoute ranked;
+  ranked.route = route;
+  ranked.rank = 0;
+  bool removed = trie.Remove (key, route->GetDestNetworkMask ().GetPrefixLength (), ranked);
+  NS_ASSERT (removed);
+  NS_UNUSED (removed);
+}
+
 int64_t
 Ipv4GlobalRouting::AssignStreams (int64_t stream)
 {
@@ -392,6 +455,9 @@ Ipv4GlobalRouting::DoDispose (void)
     {
       delete (*l);
     }
+  m_hostRouteTrie.Clear ();
+  m_networkRouteTrie.Clear ();
+  m_ASexternalRouteTrie.Clear ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -537,9 +603,7 @@ Ipv4GlobalRouting::NotifyInterfaceUp (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateRoutes ();
     }
 }
 
@@ -549,9 +613,7 @@ Ipv4GlobalRouting::NotifyInterfaceDown (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateRoutes ();
     }
 }
 
@@ -561,9 +623,7 @@ Ipv4GlobalRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress ad
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateRoutes ();
     }
 }
 
@@ -573,9 +633,7 @@ Ipv4GlobalRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateRoutes ();
     }
 }
 
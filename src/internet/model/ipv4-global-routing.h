@@ -23,6 +23,7 @@
 #include <list>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
+#include "ns3/prefix-trie.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
@@ -260,6 +261,36 @@ private:
   /// iterator of container of Ipv4RoutingTableEntry (routes to external AS)
   typedef std::list<Ipv4RoutingTableEntry *>::iterator ASExternalRoutesI;
 
+  /// A route indexed by destination prefix, with its rank in its container
+  struct RankedRoute
+  {
+    Ipv4RoutingTableEntry *route; //!< the route
+    uint64_t rank;                //!< increases with the position of the route in its container
+    /**
+     * \param o another ranked route
+     * \return true if both refer to the same route
+     */
+    bool operator== (const RankedRoute &o) const
+    {
+      return route == o.route;
+    }
+  };
+  /// index of the routes by destination prefix
+  typedef PrefixTrie<RankedRoute, 4> RouteTrie;
+
+  /**
+   * \brief Index a route which has been appended to its container.
+   * \param trie the index of the container
+   * \param route the route
+   */
+  void IndexRoute (RouteTrie &trie, Ipv4RoutingTableEntry *route);
+  /**
+   * \brief Remove a route from the index of its container.
+   * \param trie the index of the container
+   * \param route the route
+   */
+  void UnindexRoute (RouteTrie &trie, Ipv4RoutingTableEntry *route);
+
   /**
    * \brief Lookup in the forwarding table for destination.
    * \param dest destination address
@@ -271,6 +302,10 @@ private:
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
+  RouteTrie m_hostRouteTrie;           //!< Routes to hosts, indexed by destination
+  RouteTrie m_networkRouteTrie;        //!< Routes to networks, indexed by destination prefix
+  RouteTrie m_ASexternalRouteTrie;     //!< External routes, indexed by destination prefix
+  uint64_t m_nextRank;                 //!< Rank of the next route added
 
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
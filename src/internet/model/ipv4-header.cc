@@ -380,16 +380,9 @@ Ipv4Header::GetSerializedSize (void) const
 }
 
 void
-Ipv4Header::Serialize (Buffer::Iterator start) const
+Ipv4Header::WriteFields (uint8_t *buffer) const
 {
-  NS_LOG_FUNCTION (this << &start);
-  Buffer::Iterator i = start;
-
-  uint8_t verIhl = (4 << 4) | (5);
-  i.WriteU8 (verIhl);
-  i.WriteU8 (m_tos);
-  i.WriteHtonU16 (m_payloadSize + 5*4);
-  i.WriteHtonU16 (m_identification);
+  uint16_t totalLength = m_payloadSize + 5*4;
   uint32_t fragmentOffset = m_fragmentOffset / 8;
   uint8_t flagsFrag = (fragmentOffset >> 8) & 0x1f;
   if (m_flags & DONT_FRAGMENT) 
@@ -400,25 +393,61 @@ Ipv4Header::Serialize (Buffer::Iterator start) const
     {
       flagsFrag |= (1<<5);
     }
-  i.WriteU8 (flagsFrag);
-  uint8_t frag = fragmentOffset & 0xff;
-  i.WriteU8 (frag);
-  i.WriteU8 (m_ttl);
-  i.WriteU8 (m_protocol);
-  i.WriteHtonU16 (0);
-  i.WriteHtonU32 (m_source.Get ());
-  i.WriteHtonU32 (m_destination.Get ());
+  buffer[0] = (4 << 4) | (5);
+  buffer[1] = m_tos;
+  buffer[2] = totalLength >> 8;
+  buffer[3] = totalLength & 0xff;
+  buffer[4] = m_identification >> 8;
+  buffer[5] = m_identification & 0xff;
+  buffer[6] = flagsFrag;
+  buffer[7] = fragmentOffset & 0xff;
+  buffer[8] = m_ttl;
+  buffer[9] = m_protocol;
+  buffer[10] = 0;
+  buffer[11] = 0;
+  m_source.Serialize (buffer + 12);
+  m_destination.Serialize (buffer + 16);
 
   if (m_calcChecksum) 
     {
-      i = start;
-      uint16_t checksum = i.CalculateIpChecksum (20);
+      /* see RFC 1071, and Buffer::Iterator::CalculateIpChecksum */
+      uint32_t sum = 0;
+      for (uint32_t j = 0; j < 20; j += 2)
+        {
+          sum += buffer[j] | (buffer[j + 1] << 8);
+        }
+      while (sum >> 16)
+        {
+          sum = (sum & 0xffff) + (sum >> 16);
+        }
+      uint16_t checksum = ~sum;
       NS_LOG_LOGIC ("checksum=" <<checksum);
-      i = start;
-      i.Next (10);
-      i.WriteU16 (checksum);
+      buffer[10] = checksum & 0xff;
+      buffer[11] = checksum >> 8;
+    }
+}
+
+void
+Ipv4Header::Serialize (Buffer::Iterator start) const
+{
+  NS_LOG_FUNCTION (this << &start);
+  uint8_t buffer[20];
+  WriteFields (buffer);
+  start.Write (buffer, 20);
+}
+
+uint32_t
+Ipv4Header::SerializeTo (uint8_t *buffer, uint32_t payloadSize) const
+{
+  NS_LOG_FUNCTION (this << &buffer << payloadSize);
+  if (m_headerSize != 20)
+    {
+      return 0;
     }
+  WriteFields (buffer);
+  return 20;
 }
+
 uint32_t
 Ipv4Header::Deserialize (Buffer::Iterator start)
 {
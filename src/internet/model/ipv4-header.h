@@ -238,7 +238,21 @@ public:
   virtual uint32_t GetSerializedSize (void) const;
   virtual void Serialize (Buffer::Iterator start) const;
   virtual uint32_t Deserialize (Buffer::Iterator start);
+  /**
+   * \brief Serialize the header in contiguous memory (see HeaderTraits).
+   * \param [out] buffer The buffer, of at least 20 bytes.
+   * \param [in] payloadSize The number of bytes which follow the header.
+   * \returns The number of bytes written, or 0 if the header was
+   *          deserialized with options.
+   */
+  uint32_t SerializeTo (uint8_t *buffer, uint32_t payloadSize) const;
 private:
+  /**
+   * \brief Write the 20 bytes of the header, and their checksum if
+   *        checksums are enabled.
+   * \param [out] buffer The buffer, of 20 bytes.
+   */
+  void WriteFields (uint8_t *buffer) const;
 
   /// flags related to IP fragmentation
   enum FlagsE {
@@ -262,6 +276,15 @@ private:
   uint16_t m_headerSize; //!< IP header size
 };
 
+/**
+ * \brief The IPv4 header can be added to a packet without virtual calls.
+ */
+template <>
+struct HeaderTraits<Ipv4Header>
+{
+  static constexpr uint32_t MAX_SIZE = 20; //!< The size of the header, without options.
+};
+
 } // namespace ns3
 
 
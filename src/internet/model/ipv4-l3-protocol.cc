@@ -43,6 +43,7 @@
 #include "icmpv4-l4-protocol.h"
 #include "ipv4-interface.h"
 #include "ipv4-raw-socket-impl.h"
+#include "ns3/packet-census.h"
 
 namespace ns3 {
 
@@ -754,6 +755,7 @@ Ipv4L3Protocol::Send (Ptr<Packet> packet,
                       Ptr<Ipv4Route> route)
 {
   NS_LOG_FUNCTION (this << packet << source << destination << uint32_t (protocol) << route);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
 
   bool mayFragment = true;
 
@@ -1578,14 +1580,18 @@ Ipv4L3Protocol::Fragments::AddFragment (Ptr<Packet> fragment, uint16_t fragmentO
 {
   NS_LOG_FUNCTION (this << fragment << fragmentOffset << moreFragment);
 
-  std::list<std::pair<Ptr<Packet>, uint16_t> >::iterator it;
+  std::list<std::pair<Ptr<Packet>, uint16_t> >::iterator it = m_fragments.end ();
 
-  for (it = m_fragments.begin (); it != m_fragments.end (); it++)
+  // fragments mostly arrive in order: look for their place from the end
+  while (it != m_fragments.begin ())
     {
-      if (it->second > fragmentOffset)
+      std::list<std::pair<Ptr<Packet>, uint16_t> >::iterator prev = it;
+      prev--;
+      if (prev->second <= fragmentOffset)
         {
           break;
         }
+      it = prev;
     }
 
   if (it == m_fragments.end ())
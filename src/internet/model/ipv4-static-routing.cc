@@ -25,6 +25,7 @@
 
 #include <iomanip>
 #include "ns3/log.h"
+#include "ns3/unused.h"
 #include "ns3/names.h"
 #include "ns3/packet.h"
 #include "ns3/node.h"
@@ -72,7 +73,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         nextHop,
                                                         interface);
-  m_networkRoutes.push_back (make_pair (route,metric));
+  InsertNetworkRoute (route, metric);
 }
 
 void 
@@ -86,7 +87,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
   *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
                                                         networkMask,
                                                         interface);
-  m_networkRoutes.push_back (make_pair (route,metric));
+  InsertNetworkRoute (route, metric);
 }
 
 void 
@@ -143,7 +144,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
   *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
                                                         networkMask,
                                                         outputInterface);
-  m_networkRoutes.push_back (make_pair (route,0));
+  InsertNetworkRoute (route, 0);
 }
 
 uint32_t 
@@ -219,13 +220,34 @@ Ipv4StaticRouting::RemoveMulticastRoute (uint32_t index)
     }
 }
 
+void
+Ipv4StaticRouting::InsertNetworkRoute (Ipv4RoutingTableEntry *route, uint32_t metric)
+{
+  NS_LOG_FUNCTION (this << route << metric);
+  uint8_t key[4];
+  route->GetDestNetwork ().Serialize (key);
+  m_networkRoutes.push_back (make_pair (route, metric));
+  m_networkRouteTrie.Insert (key, route->GetDestNetworkMask ().GetPrefixLength (), make_pair (route, metric));
+}
+
+Ipv4StaticRouting::NetworkRoutesI
+Ipv4StaticRouting::EraseNetworkRoute (NetworkRoutesI it)
+{
+  NS_LOG_FUNCTION (this << it->first);
+  uint8_t key[4];
+  it->first->GetDestNetwork ().Serialize (key);
+  bool removed = m_networkRouteTrie.Remove (key, it->first->GetDestNetworkMask ().GetPrefixLength (), *it);
+  NS_ASSERT (removed);
+  NS_UNUSED (removed);
+  delete it->first;
+  return m_networkRoutes.erase (it);
+}
+
 Ptr<Ipv4Route>
 Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
 {
   NS_LOG_FUNCTION (this << dest << " " << oif);
   Ptr<Ipv4Route> rtentry = 0;
-  uint16_t longest_mask = 0;
-  uint32_t shortest_metric = 0xffffffff;
   /* when sending on local multicast, there have to be interface specified */
   if (dest.IsLocalMulticast ())
     {
@@ -240,55 +262,54 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
     }
 
 
-  for (NetworkRoutesI i = m_networkRoutes.begin (); 
-       i != m_networkRoutes.end (); 
-       i++) 
+  // visit the matching prefixes from the longest to the shortest, and
+  // stop at the first one with a route on the requested interface
+  Ipv4RoutingTableEntry *route = 0;
+  uint8_t key[4];
+  dest.Serialize (key);
+  m_networkRouteTrie.Lookup (key, [&] (uint8_t masklen, const NetworkRouteTrie::Entries &entries)
+  {
+    uint32_t shortest_metric = 0xffffffff;
+    for (NetworkRouteTrie::Entries::const_iterator i = entries.begin (); i != entries.end (); i++)
+      {
+        Ipv4RoutingTableEntry *j = i->first;
+        uint32_t metric = i->second;
+        // the prefix of the trie is only the leading ones of the mask
+        if (!j->GetDestNetworkMask ().IsMatch (dest, j->GetDestNetwork ()))
+          {
+            continue;
+          }
+        NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << (uint32_t)masklen << ", metric " << metric);
+        if (oif != 0)
+          {
+            if (oif != m_ipv4->GetNetDevice (j->GetInterface ()))
+              {
+                NS_LOG_LOGIC ("Not on requested interface, skipping");
+                continue;
+              }
+          }
+        if (metric > shortest_metric)
+          {
+            NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
+            continue;
+          }
+        shortest_metric = metric;
+        route = j;
+        if (masklen == 32)
+          {
+            break;
+          }
+      }
+    return route == 0;
+  });
+  if (route != 0)
     {
-      Ipv4RoutingTableEntry *j=i->first;
-      uint32_t metric =i->second;
-      Ipv4Mask mask = (j)->GetDestNetworkMask ();
-      uint16_t masklen = mask.GetPrefixLength ();
-      Ipv4Address entry = (j)->GetDestNetwork ();
-      NS_LOG_LOGIC ("Searching for route to " << dest << ", checking against route to " << entry << "/" << masklen);
-      if (mask.IsMatch (dest, entry)) 
-        {
-          NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << masklen << ", metric " << metric);
-          if (oif != 0)
-            {
-              if (oif != m_ipv4->GetNetDevice (j->GetInterface ()))
-                {
-                  NS_LOG_LOGIC ("Not on requested interface, skipping");
-                  continue;
-                }
-            }
-          if (masklen < longest_mask) // Not interested if got shorter mask
-            {
-              NS_LOG_LOGIC ("Previous match longer, skipping");
-              continue;
-            }
-          if (masklen > longest_mask) // Reset metric if longer masklen
-            {
-              shortest_metric = 0xffffffff;
-            }
-          longest_mask = masklen;
-          if (metric > shortest_metric)
-            {
-              NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
-              continue;
-            }
-          shortest_metric = metric;
-          Ipv4RoutingTableEntry* route = (j);
-          uint32_t interfaceIdx = route->GetInterface ();
-          rtentry = Create<Ipv4Route> ();
-          rtentry->SetDestination (route->GetDest ());
-          rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
-          rtentry->SetGateway (route->GetGateway ());
-          rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
-          if (masklen == 32)
-            {
-              break;
-            }
-        }
+      uint32_t interfaceIdx = route->GetInterface ();
+      rtentry = Create<Ipv4Route> ();
+      rtentry->SetDestination (route->GetDest ());
+      rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
+      rtentry->SetGateway (route->GetGateway ());
+      rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
     }
   if (rtentry != 0)
     {
@@ -447,8 +468,7 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
     {
       if (tmp == index)
         {
-          delete j->first;
-          m_networkRoutes.erase (j);
+          EraseNetworkRoute (j);
           return;
         }
       tmp++;
@@ -575,6 +595,7 @@ Ipv4StaticRouting::DoDispose (void)
     {
       delete (j->first);
     }
+  m_networkRouteTrie.Clear ();
   for (MulticastRoutesI i = m_multicastRoutes.begin (); 
        i != m_multicastRoutes.end (); 
        i = m_multicastRoutes.erase (i)) 
@@ -613,8 +634,7 @@ Ipv4StaticRouting::NotifyInterfaceDown (uint32_t i)
     {
       if (it->first->GetInterface () == i)
         {
-          delete it->first;
-          it = m_networkRoutes.erase (it);
+          it = EraseNetworkRoute (it);
         }
       else
         {
@@ -660,8 +680,7 @@ Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
           && it->first->GetDestNetwork () == networkAddress
           && it->first->GetDestNetworkMask () == networkMask)
         {
-          delete it->first;
-          it = m_networkRoutes.erase (it);
+          it = EraseNetworkRoute (it);
         }
       else
         {
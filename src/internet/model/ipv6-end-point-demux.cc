@@ -21,6 +21,7 @@
 #include "ipv6-end-point-demux.h"
 #include "ipv6-end-point.h"
 #include "ns3/log.h"
+#include "ns3/abort.h"
 
 namespace ns3 {
 
@@ -48,24 +49,17 @@ Ipv6EndPointDemux::~Ipv6EndPointDemux ()
 bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
 {
   NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
-    {
-      if ((*i)->GetLocalPort  () == port)
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_localPorts.find (port) != m_localPorts.end ();
 }
 
 bool Ipv6EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv6Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  std::pair<FourTupleMap::iterator, FourTupleMap::iterator> range =
+    m_localTuples.equal_range (FourTuple (addr, port, Ipv6Address::GetAny (), 0));
+  for (FourTupleMap::iterator i = range.first; i != range.second; i++)
     {
-      if ((*i)->GetLocalPort () == port &&
-          (*i)->GetLocalAddress () == addr &&
-          (*i)->GetBoundNetDevice () == boundNetDevice)
+      if ((*i->second)->GetBoundNetDevice () == boundNetDevice)
         {
           return true;
         }
@@ -84,6 +78,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (Ipv6Address::GetAny (), port);
   m_endPoints.push_back (endPoint);
+  Insert (--m_endPoints.end ());
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -99,6 +94,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
   m_endPoints.push_back (endPoint);
+  Insert (--m_endPoints.end ());
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -120,6 +116,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv6Ad
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
   m_endPoints.push_back (endPoint);
+  Insert (--m_endPoints.end ());
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -129,13 +126,11 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                                            Ipv6Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << boundNetDevice << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  std::pair<FourTupleMap::iterator, FourTupleMap::iterator> range =
+    m_fourTuples.equal_range (FourTuple (localAddress, localPort, peerAddress, peerPort));
+  for (FourTupleMap::iterator i = range.first; i != range.second; i++)
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress &&
-          ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0))
+      if ((*i->second)->GetBoundNetDevice () == boundNetDevice || (*i->second)->GetBoundNetDevice () == 0)
         {
           NS_LOG_WARN ("Duplicated endpoint.");
           return 0;
@@ -144,6 +139,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
   m_endPoints.push_back (endPoint);
+  Insert (--m_endPoints.end ());
 
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
 
@@ -153,42 +149,83 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
 void Ipv6EndPointDemux::DeAllocate (Ipv6EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  EndPointsI i = Remove (endPoint, FourTuple (endPoint->m_localAddr, endPoint->m_localPort,
+                                              endPoint->m_peerAddr, endPoint->m_peerPort));
+  if (i != m_endPoints.end ())
+    {
+      delete endPoint;
+      m_endPoints.erase (i);
+    }
+}
+
+void Ipv6EndPointDemux::Insert (EndPointsI endPoint)
+{
+  NS_LOG_FUNCTION (this << *endPoint);
+  Ipv6EndPoint *endP = *endPoint;
+  endP->m_demux = this;
+  m_fourTuples.insert (std::make_pair (FourTuple (endP->m_localAddr, endP->m_localPort,
+                                                  endP->m_peerAddr, endP->m_peerPort),
+                                       endPoint));
+  m_localTuples.insert (std::make_pair (FourTuple (endP->m_localAddr, endP->m_localPort,
+                                                   Ipv6Address::GetAny (), 0),
+                                        endPoint));
+  m_localPorts[endP->m_localPort]++;
+}
+
+Ipv6EndPointDemux::EndPointsI Ipv6EndPointDemux::Remove (Ipv6EndPoint *endPoint, const FourTuple &tuple)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  EndPointsI endP = m_endPoints.end ();
+  std::pair<FourTupleMap::iterator, FourTupleMap::iterator> range = m_fourTuples.equal_range (tuple);
+  for (FourTupleMap::iterator i = range.first; i != range.second; i++)
+    {
+      if (*i->second == endPoint)
+        {
+          endP = i->second;
+          m_fourTuples.erase (i);
+          break;
+        }
+    }
+  if (endP == m_endPoints.end ())
     {
-      if (*i == endPoint)
+      return endP;
+    }
+  range = m_localTuples.equal_range (FourTuple (tuple.localAddress, tuple.localPort, Ipv6Address::GetAny (), 0));
+  for (FourTupleMap::iterator i = range.first; i != range.second; i++)
+    {
+      if (*i->second == endPoint)
         {
-          delete endPoint;
-          m_endPoints.erase (i);
+          m_localTuples.erase (i);
           break;
         }
     }
+  std::unordered_map<uint16_t, uint32_t>::iterator port = m_localPorts.find (tuple.localPort);
+  if (--port->second == 0)
+    {
+      m_localPorts.erase (port);
+    }
+  return endP;
 }
 
-/*
- * If we have an exact match, we return it.
- * Otherwise, if we find a generic match, we return it.
- * Otherwise, we return 0.
- */
-Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint16_t dport,
-                                                        Ipv6Address saddr, uint16_t sport,
-                                                        Ptr<Ipv6Interface> incomingInterface)
+void Ipv6EndPointDemux::Update (Ipv6EndPoint *endPoint, Ipv6Address localAddress,
+                                Ipv6Address peerAddress, uint16_t peerPort)
 {
-  NS_LOG_FUNCTION (this << daddr << dport << saddr << sport << incomingInterface);
-
-  EndPoints retval1; /* Matches exact on local port, wildcards on others */
-  EndPoints retval2; /* Matches exact on local port/adder, wildcards on others */
-  EndPoints retval3; /* Matches all but local address */
-  EndPoints retval4; /* Exact match on all 4 */
-
-  NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  NS_LOG_FUNCTION (this << endPoint << localAddress << peerAddress << peerPort);
+  EndPointsI i = Remove (endPoint, FourTuple (localAddress, endPoint->m_localPort, peerAddress, peerPort));
+  if (i != m_endPoints.end ())
     {
-      Ipv6EndPoint* endP = *i;
+      Insert (i);
+    }
+}
 
-      NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
-                                                 << " daddr=" << endP->GetLocalAddress ()
-                                                 << " sport=" << endP->GetPeerPort ()
-                                                 << " saddr=" << endP->GetPeerAddress ());
+void Ipv6EndPointDemux::AddMatches (const FourTuple &tuple, Ptr<Ipv6Interface> incomingInterface,
+                                    EndPoints &endPoints)
+{
+  NS_LOG_FUNCTION (this << tuple.localAddress << tuple.localPort << tuple.peerAddress << tuple.peerPort);
+  std::pair<FourTupleMap::iterator, FourTupleMap::iterator> range = m_fourTuples.equal_range (tuple);
+  for (FourTupleMap::iterator i = range.first; i != range.second; i++)
+    {
+      Ipv6EndPoint* endP = *i->second;
 
       if (!endP->IsRxEnabled ())
         {
@@ -197,15 +234,6 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
           continue;
         }
 
-      if (endP->GetLocalPort () != dport)
-        {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
-          continue;
-        }
-
       if (endP->GetBoundNetDevice ())
         {
           if (!incomingInterface)
@@ -222,67 +250,45 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
             }
         }
 
-      /*    Ipv6Address incomingInterfaceAddr = incomingInterface->GetAddress (); */
-      NS_LOG_DEBUG ("dest addr " << daddr);
-
-      bool localAddressMatchesWildCard = endP->GetLocalAddress () == Ipv6Address::GetAny ();
-      bool localAddressMatchesExact = endP->GetLocalAddress () == daddr;
-      bool localAddressMatchesAllRouters = endP->GetLocalAddress () == Ipv6Address::GetAllRoutersMulticast ();
+      endPoints.push_back (endP);
+    }
+}
 
-      /* if no match here, keep looking */
-      if (!(localAddressMatchesExact || localAddressMatchesWildCard))
-        {
-          continue;
-        }
-      bool remotePeerMatchesExact = endP->GetPeerPort () == sport;
-      bool remotePeerMatchesWildCard = endP->GetPeerPort () == 0;
-      bool remoteAddressMatchesExact = endP->GetPeerAddress () == saddr;
-      bool remoteAddressMatchesWildCard = endP->GetPeerAddress () == Ipv6Address::GetAny ();
-
-      /* If remote does not match either with exact or wildcard,i
-         skip this one */
-      if (!(remotePeerMatchesExact || remotePeerMatchesWildCard))
-        {
-          continue;
-        }
-      if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
-        {
-          continue;
-        }
+/*
+ * If we have an exact match, we return it.
+ * Otherwise, if we find a generic match, we return it.
+ * Otherwise, we return 0.
+ */
+Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint16_t dport,
+                                                        Ipv6Address saddr, uint16_t sport,
+                                                        Ptr<Ipv6Interface> incomingInterface)
+{
+  NS_LOG_FUNCTION (this << daddr << dport << saddr << sport << incomingInterface);
+  NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
 
-      /* Now figure out which return list to add this one to */
-      if (localAddressMatchesWildCard
-          && remotePeerMatchesWildCard
-          && remoteAddressMatchesWildCard)
-        { /* Only local port matches exactly */
-          retval1.push_back (endP);
-        }
-      if ((localAddressMatchesExact || (localAddressMatchesAllRouters))
-          && remotePeerMatchesWildCard
-          && remoteAddressMatchesWildCard)
-        { /* Only local port and local address matches exactly */
-          retval2.push_back (endP);
-        }
-      if (localAddressMatchesWildCard
-          && remotePeerMatchesExact
-          && remoteAddressMatchesExact)
-        { /* All but local address */
-          retval3.push_back (endP);
-        }
-      if (localAddressMatchesExact
-          && remotePeerMatchesExact
-          && remoteAddressMatchesExact)
-        { /* All 4 match */
-          retval4.push_back (endP);
-        }
-    }
+  // An end point bound to the wildcard address matches any destination
+  // address, but it matches it exactly if the destination is the wildcard.
+  bool wildcard = daddr != Ipv6Address::GetAny ();
 
   // Here we find the most exact match
   EndPoints retval;
-  if (!retval4.empty ()) retval = retval4;
-  else if (!retval3.empty ()) retval = retval3;
-  else if (!retval2.empty ()) retval = retval2;
-  else retval = retval1;
+  /* Exact match on all 4 */
+  AddMatches (FourTuple (daddr, dport, saddr, sport), incomingInterface, retval);
+  if (retval.empty () && wildcard)
+    {
+      /* Matches all but local address */
+      AddMatches (FourTuple (Ipv6Address::GetAny (), dport, saddr, sport), incomingInterface, retval);
+    }
+  if (retval.empty ())
+    {
+      /* Matches exact on local port/adder, wildcards on others */
+      AddMatches (FourTuple (daddr, dport, Ipv6Address::GetAny (), 0), incomingInterface, retval);
+    }
+  if (retval.empty () && wildcard)
+    {
+      /* Matches exact on local port, wildcards on others */
+      AddMatches (FourTuple (Ipv6Address::GetAny (), dport, Ipv6Address::GetAny (), 0), incomingInterface, retval);
+    }
 
   NS_ABORT_MSG_IF (retval.size () > 1, "Too many endpoints - perhaps you created too many sockets without binding them to different NetDevices.");
   return retval;  // might be empty if no matches
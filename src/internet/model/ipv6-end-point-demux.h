@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <unordered_map>
 #include "ns3/ipv6-address.h"
 #include "ipv6-interface.h"
 
@@ -34,6 +35,11 @@ class Ipv6EndPoint;
  * \ingroup ipv6
  *
  * \brief Demultiplexer for end points.
+ *
+ * The endpoints are indexed by their four-tuple and by their local address
+ * and port, so that a lookup takes a few hash lookups, whatever the number
+ * of endpoints.  The endpoints notify the demux when their addresses or
+ * peer port change.
  */
 class Ipv6EndPointDemux
 {
@@ -153,6 +159,102 @@ public:
   EndPoints GetEndPoints () const;
 
 private:
+  friend class Ipv6EndPoint;
+
+  /**
+   * \brief The addresses and ports identifying an end point.
+   */
+  struct FourTuple
+  {
+    /**
+     * \brief Constructor.
+     * \param localAddress local address
+     * \param localPort local port
+     * \param peerAddress peer address
+     * \param peerPort peer port
+     */
+    FourTuple (Ipv6Address localAddress, uint16_t localPort, Ipv6Address peerAddress, uint16_t peerPort)
+      : localAddress (localAddress),
+        localPort (localPort),
+        peerAddress (peerAddress),
+        peerPort (peerPort)
+    {
+    }
+    /**
+     * \brief Comparison operator.
+     * \param other the four-tuple to compare with
+     * \return true if the four-tuples are equal
+     */
+    bool operator== (const FourTuple &other) const
+    {
+      return localPort == other.localPort && peerPort == other.peerPort
+             && localAddress == other.localAddress && peerAddress == other.peerAddress;
+    }
+    Ipv6Address localAddress; //!< The local address.
+    uint16_t localPort;       //!< The local port.
+    Ipv6Address peerAddress;  //!< The peer address.
+    uint16_t peerPort;        //!< The peer port.
+  };
+
+  /**
+   * \brief Hashing for the four-tuples.
+   */
+  struct FourTupleHash
+  {
+    /**
+     * \brief operator ()
+     * \param tuple the four-tuple to hash
+     * \return the hash of the four-tuple
+     */
+    size_t operator() (const FourTuple &tuple) const
+    {
+      size_t h = Ipv6AddressHash () (tuple.localAddress);
+      h = h * 31 + Ipv6AddressHash () (tuple.peerAddress);
+      return h * 31 + ((tuple.localPort << 16) | tuple.peerPort);
+    }
+  };
+
+  /**
+   * \brief Container of the IPv6 endpoints, indexed by four-tuple.
+   */
+  typedef std::unordered_multimap<FourTuple, EndPointsI, FourTupleHash> FourTupleMap;
+
+  /**
+   * \brief Index an end point by its addresses and ports.
+   * \param endPoint the end point in the list of end points
+   */
+  void Insert (EndPointsI endPoint);
+
+  /**
+   * \brief Remove an end point from the indices.
+   * \param endPoint the end point
+   * \param tuple the addresses and ports by which the end point is indexed
+   * \return the end point in the list of end points, or the end of the list
+   * if the end point is not indexed
+   */
+  EndPointsI Remove (Ipv6EndPoint *endPoint, const FourTuple &tuple);
+
+  /**
+   * \brief Index an end point again after its addresses or peer port changed.
+   *
+   * This is called by the end point itself.
+   *
+   * \param endPoint the end point
+   * \param localAddress the previous local address
+   * \param peerAddress the previous peer address
+   * \param peerPort the previous peer port
+   */
+  void Update (Ipv6EndPoint *endPoint, Ipv6Address localAddress,
+               Ipv6Address peerAddress, uint16_t peerPort);
+
+  /**
+   * \brief Add the end points which can receive a packet for a four-tuple.
+   * \param tuple the four-tuple
+   * \param incomingInterface the incoming interface
+   * \param endPoints the list to add the end points to
+   */
+  void AddMatches (const FourTuple &tuple, Ptr<Ipv6Interface> incomingInterface, EndPoints &endPoints);
+
   /**
    * \brief Allocate a ephemeral port.
    * \return a port
@@ -178,6 +280,21 @@ private:
    * \brief A list of IPv6 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The end points, by local address and port and peer address and port.
+   */
+  FourTupleMap m_fourTuples;
+
+  /**
+   * \brief The end points, by local address and port (with wildcard peer).
+   */
+  FourTupleMap m_localTuples;
+
+  /**
+   * \brief The number of end points using each local port.
+   */
+  std::unordered_map<uint16_t, uint32_t> m_localPorts;
 };
 
 } /* namespace ns3 */
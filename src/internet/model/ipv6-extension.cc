@@ -679,14 +679,18 @@ Ipv6ExtensionFragment::Fragments::~Fragments ()
 void Ipv6ExtensionFragment::Fragments::AddFragment (Ptr<Packet> fragment, uint16_t fragmentOffset, bool moreFragment)
 {
   NS_LOG_FUNCTION (this << fragment << fragmentOffset << moreFragment);
-  std::list<std::pair<Ptr<Packet>, uint16_t> >::iterator it;
+  std::list<std::pair<Ptr<Packet>, uint16_t> >::iterator it = m_packetFragments.end ();
 
-  for (it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
+  // fragments mostly arrive in order: look for their place from the end
+  while (it != m_packetFragments.begin ())
     {
-      if (it->second > fragmentOffset)
+      std::list<std::pair<Ptr<Packet>, uint16_t> >::iterator prev = it;
+      prev--;
+      if (prev->second <= fragmentOffset)
         {
           break;
         }
+      it = prev;
     }
 
   if (it == m_packetFragments.end ())
@@ -45,6 +45,7 @@
 #include "icmpv6-l4-protocol.h"
 #include "ndisc-cache.h"
 #include "ipv6-raw-socket-factory-impl.h"
+#include "ns3/packet-census.h"
 
 /// Minimum IPv6 MTU, as defined by \RFC{2460}
 #define IPV6_MIN_MTU 1280
@@ -824,6 +825,7 @@ void Ipv6L3Protocol::SetDefaultTclass (uint8_t tclass)
 void Ipv6L3Protocol::Send (Ptr<Packet> packet, Ipv6Address source, Ipv6Address destination, uint8_t protocol, Ptr<Ipv6Route> route)
 {
   NS_LOG_FUNCTION (this << packet << source << destination << (uint32_t)protocol << route);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
   Ipv6Header hdr;
   uint8_t ttl = m_defaultTtl;
   SocketIpv6HopLimitTag tag;
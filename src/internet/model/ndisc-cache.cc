@@ -22,6 +22,7 @@
 #include "ns3/uinteger.h"
 #include "ns3/node.h"
 #include "ns3/names.h"
+#include "ns3/packet-census.h"
 
 #include "ipv6-l3-protocol.h" 
 #include "icmpv6-l4-protocol.h"
@@ -256,15 +257,21 @@ void NdiscCache::Entry::AddWaitingPacket (Ipv6PayloadHeaderPair p)
     {
       /* we store only m_unresQlen packet => first packet in first packet remove */
       /** \todo report packet as 'dropped' */
+      PacketCensus::Release (m_waiting.front ().first);
       m_waiting.pop_front ();
     }
   m_waiting.push_back (p);
+  PacketCensus::Hold (p.first, NdiscCache::GetTypeId ());
 }
 
 void NdiscCache::Entry::ClearWaitingPacket ()
 {
   NS_LOG_FUNCTION (this);
   /** \todo report packets as 'dropped' */
+  for (std::list<Ipv6PayloadHeaderPair>::const_iterator i = m_waiting.begin (); i != m_waiting.end (); ++i)
+    {
+      PacketCensus::Release (i->first);
+    }
   m_waiting.clear ();
 }
 
@@ -498,6 +505,7 @@ void NdiscCache::Entry::MarkIncomplete (Ipv6PayloadHeaderPair p)
   if (p.first)
     {
       m_waiting.push_back (p);
+      PacketCensus::Hold (p.first, NdiscCache::GetTypeId ());
     }
 }
 
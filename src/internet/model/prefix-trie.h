@@ -0,0 +1,353 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PREFIX_TRIE_H
+#define PREFIX_TRIE_H
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup internet
+ *
+ * \brief Path-compressed binary trie of address prefixes, for longest
+ * prefix match.
+ *
+ * Each prefix of the trie holds the list of its entries (e.g., the
+ * routes to this prefix, several of them for equal-cost multipath), in
+ * the order in which they were inserted. Lookup visits the prefixes
+ * matching an address from the longest to the shortest, in O(N * 8)
+ * steps whatever the number of prefixes. The nodes which hold no entry
+ * are only kept where two branches of the trie diverge.
+ *
+ * The keys are addresses in network byte order (e.g., as written by
+ * Ipv4Address::Serialize); the bits beyond the length of a prefix are
+ * ignored.
+ *
+ * \tparam T The type of the entries, which must be equality comparable.
+ * \tparam N The size of the keys, in bytes.
+ */
+template <typename T, uint32_t N>
+class PrefixTrie
+{
+public:
+  /** The entries of a prefix. */
+  typedef std::vector<T> Entries;
+
+  PrefixTrie ();
+  ~PrefixTrie ();
+
+  /**
+   * \brief Add an entry to a prefix, after its other entries.
+   * \param [in] key The prefix.
+   * \param [in] length The length of the prefix, in bits.
+   * \param [in] entry The entry.
+   */
+  void Insert (const uint8_t *key, uint8_t length, const T &entry);
+  /**
+   * \brief Remove the first entry of a prefix equal to a given entry.
+   * \param [in] key The prefix.
+   * \param [in] length The length of the prefix, in bits.
+   * \param [in] entry The entry.
+   * \returns false if the prefix holds no such entry.
+   */
+  bool Remove (const uint8_t *key, uint8_t length, const T &entry);
+  /**
+   * \brief Remove all the entries.
+   */
+  void Clear (void);
+  /**
+   * \param [in] key The prefix.
+   * \param [in] length The length of the prefix, in bits.
+   * \returns The entries of the prefix, or 0 if it has none.
+   */
+  const Entries *Find (const uint8_t *key, uint8_t length) const;
+  /**
+   * \brief Visit the prefixes matching an address.
+   *
+   * The visitor is called as
+   * \code
+   *   bool visitor (uint8_t length, const Entries &entries);
+   * \endcode
+   * for each prefix with entries which matches the address, from the
+   * longest to the shortest, until it returns false.
+   *
+   * \param [in] key The address.
+   * \param [in] visitor The visitor.
+   */
+  template <typename F>
+  void Lookup (const uint8_t *key, F visitor) const;
+
+private:
+  /** A prefix of the trie. */
+  struct Node
+  {
+    uint8_t key[N];   //!< The prefix, with the bits beyond its length cleared.
+    uint8_t length;   //!< The length of the prefix.
+    Entries entries;  //!< The entries of the prefix.
+    Node *child[2];   //!< The longer prefixes, by their next bit.
+  };
+
+  /** The number of bits of a key. */
+  static const uint32_t BITS = N * 8;
+
+  /**
+   * \param [in] key A key.
+   * \param [in] i The index of a bit, 0 being the most significant one.
+   * \returns The bit.
+   */
+  static uint32_t GetBit (const uint8_t *key, uint32_t i);
+  /**
+   * \param [in] a A key.
+   * \param [in] b A key.
+   * \param [in] max The maximum length.
+   * \returns The length of the common prefix of the keys, at most max.
+   */
+  static uint32_t GetCommonLength (const uint8_t *a, const uint8_t *b, uint32_t max);
+  /**
+   * \param [in] key A key.
+   * \param [in] length A length.
+   * \param [in] entry The entry of the node, if any.
+   * \returns A new node, with the key truncated to the length.
+   */
+  static Node *CreateNode (const uint8_t *key, uint32_t length, const T *entry);
+  /**
+   * \brief Delete a subtree.
+   * \param [in] node The root of the subtree.
+   */
+  static void DeleteTree (Node *node);
+
+  Node *m_root; //!< The shortest prefix.
+};
+
+} // namespace ns3
+
+/****************************************************
+ *  Implementation of the template methods
+ ***************************************************/
+
+namespace ns3 {
+
+template <typename T, uint32_t N>
+PrefixTrie<T, N>::PrefixTrie ()
+  : m_root (0)
+{
+}
+
+template <typename T, uint32_t N>
+PrefixTrie<T, N>::~PrefixTrie ()
+{
+  DeleteTree (m_root);
+}
+
+template <typename T, uint32_t N>
+uint32_t
+PrefixTrie<T, N>::GetBit (const uint8_t *key, uint32_t i)
+{
+  return (key[i / 8] >> (7 - i % 8)) & 1;
+}
+
+template <typename T, uint32_t N>
+uint32_t
+PrefixTrie<T, N>::GetCommonLength (const uint8_t *a, const uint8_t *b, uint32_t max)
+{
+  uint32_t i = 0;
+  while (i < max && a[i / 8] == b[i / 8])
+    {
+      i += 8;
+    }
+  while (i < max && GetBit (a, i) == GetBit (b, i))
+    {
+      i++;
+    }
+  return std::min (i, max);
+}
+
+template <typename T, uint32_t N>
+typename PrefixTrie<T, N>::Node *
+PrefixTrie<T, N>::CreateNode (const uint8_t *key, uint32_t length, const T *entry)
+{
+  Node *node = new Node ();
+  memset (node->key, 0, N);
+  memcpy (node->key, key, (length + 7) / 8);
+  if (length % 8 != 0)
+    {
+      node->key[length / 8] &= 0xff << (8 - length % 8);
+    }
+  node->length = length;
+  node->child[0] = 0;
+  node->child[1] = 0;
+  if (entry != 0)
+    {
+      node->entries.push_back (*entry);
+    }
+  return node;
+}
+
+template <typename T, uint32_t N>
+void
+PrefixTrie<T, N>::DeleteTree (Node *node)
+{
+  if (node != 0)
+    {
+      DeleteTree (node->child[0]);
+      DeleteTree (node->child[1]);
+      delete node;
+    }
+}
+
+template <typename T, uint32_t N>
+void
+PrefixTrie<T, N>::Insert (const uint8_t *key, uint8_t length, const T &entry)
+{
+  NS_ASSERT (length <= BITS);
+  Node **link = &m_root;
+  while (*link != 0)
+    {
+      Node *node = *link;
+      uint32_t common = GetCommonLength (node->key, key, std::min<uint32_t> (node->length, length));
+      if (common < node->length)
+        {
+          // the new prefix branches off before the node
+          Node *parent;
+          if (common == length)
+            {
+              parent = CreateNode (key, length, &entry);
+            }
+          else
+            {
+              parent = CreateNode (key, common, 0);
+              parent->child[GetBit (key, common)] = CreateNode (key, length, &entry);
+            }
+          parent->child[GetBit (node->key, common)] = node;
+          *link = parent;
+          return;
+        }
+      if (node->length == length)
+        {
+          node->entries.push_back (entry);
+          return;
+        }
+      link = &node->child[GetBit (key, node->length)];
+    }
+  *link = CreateNode (key, length, &entry);
+}
+
+template <typename T, uint32_t N>
+bool
+PrefixTrie<T, N>::Remove (const uint8_t *key, uint8_t length, const T &entry)
+{
+  // the links to the nodes from the root to the prefix
+  Node **links[BITS + 1];
+  uint32_t depth = 0;
+  Node **link = &m_root;
+  while (*link != 0 && (*link)->length < length
+         && GetCommonLength ((*link)->key, key, (*link)->length) == (*link)->length)
+    {
+      links[depth++] = link;
+      link = &(*link)->child[GetBit (key, (*link)->length)];
+    }
+  Node *node = *link;
+  if (node == 0 || node->length != length
+      || GetCommonLength (node->key, key, length) != length)
+    {
+      return false;
+    }
+  typename Entries::iterator it = std::find (node->entries.begin (), node->entries.end (), entry);
+  if (it == node->entries.end ())
+    {
+      return false;
+    }
+  node->entries.erase (it);
+  // remove the nodes left without entries and with less than two children
+  while (node != 0 && node->entries.empty ()
+         && (node->child[0] == 0 || node->child[1] == 0))
+    {
+      *link = node->child[0] != 0 ? node->child[0] : node->child[1];
+      delete node;
+      if (depth == 0)
+        {
+          break;
+        }
+      link = links[--depth];
+      node = *link;
+    }
+  return true;
+}
+
+template <typename T, uint32_t N>
+void
+PrefixTrie<T, N>::Clear (void)
+{
+  DeleteTree (m_root);
+  m_root = 0;
+}
+
+template <typename T, uint32_t N>
+const typename PrefixTrie<T, N>::Entries *
+PrefixTrie<T, N>::Find (const uint8_t *key, uint8_t length) const
+{
+  const Node *node = m_root;
+  while (node != 0 && node->length <= length
+         && GetCommonLength (node->key, key, node->length) == node->length)
+    {
+      if (node->length == length)
+        {
+          return node->entries.empty () ? 0 : &node->entries;
+        }
+      node = node->child[GetBit (key, node->length)];
+    }
+  return 0;
+}
+
+template <typename T, uint32_t N>
+template <typename F>
+void
+PrefixTrie<T, N>::Lookup (const uint8_t *key, F visitor) const
+{
+  const Node *matches[BITS + 1];
+  uint32_t n = 0;
+  const Node *node = m_root;
+  while (node != 0 && GetCommonLength (node->key, key, node->length) == node->length)
+    {
+      if (!node->entries.empty ())
+        {
+          matches[n++] = node;
+        }
+      if (node->length == BITS)
+        {
+          break;
+        }
+      node = node->child[GetBit (key, node->length)];
+    }
+  while (n > 0)
+    {
+      --n;
+      if (!visitor (matches[n]->length, matches[n]->entries))
+        {
+          return;
+        }
+    }
+}
+
+} // namespace ns3
+
+#endif /* PREFIX_TRIE_H */
@@ -45,6 +45,7 @@
 #include "tcp-recovery-ops.h"
 #include "tcp-prr-recovery.h"
 #include "rtt-estimator.h"
+#include "ns3/packet-census.h"
 
 #include <vector>
 #include <sstream>
@@ -557,6 +558,7 @@ TcpL4Protocol::SendPacketV4 (Ptr<Packet> packet, const TcpHeader &outgoing,
                              Ptr<NetDevice> oif) const
 {
   NS_LOG_FUNCTION (this << packet << saddr << daddr << oif);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
   NS_LOG_LOGIC ("TcpL4Protocol " << this
                                  << " sending seq " << outgoing.GetSequenceNumber ()
                                  << " ack " << outgoing.GetAckNumber ()
@@ -608,6 +610,7 @@ TcpL4Protocol::SendPacketV6 (Ptr<Packet> packet, const TcpHeader &outgoing,
                              Ptr<NetDevice> oif) const
 {
   NS_LOG_FUNCTION (this << packet << saddr << daddr << oif);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
   NS_LOG_LOGIC ("TcpL4Protocol " << this
                                  << " sending seq " << outgoing.GetSequenceNumber ()
                                  << " ack " << outgoing.GetAckNumber ()
@@ -59,6 +59,7 @@
 #include "tcp-congestion-ops.h"
 #include "tcp-recovery-ops.h"
 #include "ns3/tcp-rate-ops.h"
+#include "ns3/packet-census.h"
 
 #include <math.h>
 #include <algorithm>
@@ -813,6 +814,7 @@ int
 TcpSocketBase::Send (Ptr<Packet> p, uint32_t flags)
 {
   NS_LOG_FUNCTION (this << p);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
   NS_ABORT_MSG_IF (flags, "use of flags is not supported in TcpSocketBase::Send()");
   if (m_state == ESTABLISHED || m_state == SYN_SENT || m_state == CLOSE_WAIT)
     {
@@ -2600,6 +2602,7 @@ void
 TcpSocketBase::SendEmptyPacket (uint8_t flags)
 {
   NS_LOG_FUNCTION (this << static_cast<uint32_t> (flags));
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
 
   if (m_endPoint == nullptr && m_endPoint6 == nullptr)
     {
@@ -2972,6 +2975,7 @@ uint32_t
 TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool withAck)
 {
   NS_LOG_FUNCTION (this << seq << maxSize << withAck);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
 
   bool isStartOfTransmission = BytesInFlight () == 0U;
   TcpTxItem *outItem = m_txBuffer->CopyFromSequence (maxSize, seq);
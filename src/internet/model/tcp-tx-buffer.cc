@@ -296,7 +296,7 @@ TcpTxBuffer::GetNewSegment (uint32_t numBytes)
   NS_ASSERT (it != m_appList.end ());
 
   m_appList.erase (it);
-  m_sentList.insert (m_sentList.end (), item);
+  IndexItem (m_sentList.insert (m_sentList.end (), item));
   m_sentSize += item->m_packet->GetSize ();
 
   return item;
@@ -310,36 +310,33 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
   NS_ASSERT (numBytes <= m_sentSize);
   NS_ASSERT (m_sentList.size () >= 1);
 
-  auto it = m_sentList.begin ();
   bool listEdited = false;
   uint32_t s = numBytes;
 
   // Avoid to merge different packet for this retransmission if flags are
   // different.
-  for (; it != m_sentList.end(); ++it)
+  SentIndex::const_iterator index = m_sentIndex.find (seq);
+  if (index != m_sentIndex.end ())
     {
-      if ((*it)->m_startSeq == seq)
+      auto it = index->second;
+      auto next = it;
+      next++;
+      if (next != m_sentList.end ())
         {
-          auto next = it;
-          next++;
-          if (next != m_sentList.end ())
+          // Next is not sacked and have the same value for m_lost ... there is the possibility to merge
+          if ((! (*next)->m_sacked) && ((*it)->m_lost == (*next)->m_lost))
             {
-              // Next is not sacked and have the same value for m_lost ... there is the possibility to merge
-              if ((! (*next)->m_sacked) && ((*it)->m_lost == (*next)->m_lost))
-                {
-                  s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
-                }
-              else
-                {
-                  // Next is sacked... better to retransmit only the first segment
-                  s = std::min(s, (*it)->m_packet->GetSize ());
-                }
+              s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
             }
           else
             {
+              // Next is sacked... better to retransmit only the first segment
               s = std::min(s, (*it)->m_packet->GetSize ());
             }
-          break;
+        }
+      else
+        {
+          s = std::min(s, (*it)->m_packet->GetSize ());
         }
     }
 
@@ -347,8 +344,10 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
 
   if (! item->m_retrans)
     {
+      RemoveFromScoreboard (item);
       m_retrans += item->m_packet->GetSize ();
       item->m_retrans = true;
+      AddToScoreboard (item);
     }
 
   return item;
@@ -359,21 +358,15 @@ TcpTxBuffer::FindHighestSacked () const
 {
   NS_LOG_FUNCTION (this);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
-  auto ret = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
-
-  for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  const SeqSet &sacked = m_scoreboard[SACKED];
+  if (sacked.empty ())
     {
-      const TcpTxItem *item = *it;
-      if (item->m_sacked)
-        {
-          ret = std::make_pair (it, beginOfCurrentPacket);
-        }
-      beginOfCurrentPacket += item->m_packet->GetSize ();
+      return std::make_pair (m_sentList.end (), SequenceNumber32 (0));
     }
 
-  return ret;
+  SentIndex::const_iterator it = m_sentIndex.find (*sacked.rbegin ());
+  NS_ASSERT (it != m_sentIndex.end ());
+  return std::make_pair (PacketList::const_iterator (it->second), it->first);
 }
 
 
@@ -400,7 +393,7 @@ TcpTxBuffer::SplitItems (TcpTxItem *t1, TcpTxItem *t2, uint32_t size) const
 TcpTxItem*
 TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listStartFrom,
                                 uint32_t numBytes, const SequenceNumber32 &seq,
-                                bool *listEdited) const
+                                bool *listEdited)
 {
   NS_LOG_FUNCTION (this << numBytes << seq);
 
@@ -437,11 +430,25 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
   PacketList::iterator it = list.begin ();
   SequenceNumber32 beginOfCurrentPacket = listStartFrom;
 
+  // The items of the sent list are indexed: start from the one holding seq,
+  // and keep the index and the scoreboard in sync with the edits of the list
+  bool indexed = &list == &m_sentList;
+  if (indexed)
+    {
+      SentIndex::const_iterator index = m_sentIndex.upper_bound (seq);
+      if (index != m_sentIndex.begin ())
+        {
+          --index;
+          it = index->second;
+          beginOfCurrentPacket = index->first;
+        }
+    }
+
   while (it != list.end ())
     {
       currentItem = *it;
       currentPacket = currentItem->m_packet;
-      NS_ASSERT_MSG (list != m_sentList || currentItem->m_startSeq >= m_firstByteSeq,
+      NS_ASSERT_MSG (!indexed || currentItem->m_startSeq >= m_firstByteSeq,
                      "start: " << m_firstByteSeq << " currentItem start: " <<
                      currentItem->m_startSeq);
 
@@ -468,10 +475,19 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
                            " and now we recurse because packet ends at "
                                         << beginOfCurrentPacket + currentPacket->GetSize ());
               TcpTxItem *firstPart = new TcpTxItem ();
+              if (indexed)
+                {
+                  UnindexItem (currentItem);
+                }
               SplitItems (firstPart, currentItem, seq - beginOfCurrentPacket);
 
               // insert firstPart before currentItem
-              list.insert (it, firstPart);
+              PacketList::iterator firstPartIt = list.insert (it, firstPart);
+              if (indexed)
+                {
+                  IndexItem (firstPartIt);
+                  IndexItem (it);
+                }
               if (listEdited)
                 {
                   *listEdited = true;
@@ -515,12 +531,22 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
                   // current > outPacket in the list. Merge current with the
                   // previous, and recurse.
                   NS_ASSERT (it != list.begin ());
-                  TcpTxItem *previous = *(--it);
+                  PacketList::iterator previousIt = it;
+                  TcpTxItem *previous = *(--previousIt);
 
+                  if (indexed)
+                    {
+                      UnindexItem (previous);
+                      UnindexItem (currentItem);
+                    }
                   list.erase (it);
 
                   MergeItems (previous, currentItem);
                   delete currentItem;
+                  if (indexed)
+                    {
+                      IndexItem (previousIt);
+                    }
                   if (listEdited)
                     {
                       *listEdited = true;
@@ -534,10 +560,19 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
               // the end is inside the current packet, but it isn't exactly
               // the packet end. Just fragment, fix the list, and return.
               TcpTxItem *firstPart = new TcpTxItem ();
+              if (indexed)
+                {
+                  UnindexItem (currentItem);
+                }
               SplitItems (firstPart, currentItem, numBytes);
 
               // insert firstPart before currentItem
-              list.insert (it, firstPart);
+              PacketList::iterator firstPartIt = list.insert (it, firstPart);
+              if (indexed)
+                {
+                  IndexItem (firstPartIt);
+                  IndexItem (it);
+                }
               if (listEdited)
                 {
                   *listEdited = true;
@@ -550,6 +585,7 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
         {
           // The end isn't inside current packet, but there is an exception for
           // the merge and recurse strategy...
+          PacketList::iterator currentIt = it;
           if (++it == list.end ())
             {
               // ...current is the last packet we sent. We have not more data;
@@ -565,8 +601,17 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
           TcpTxItem *next = (*it); // Please remember we have incremented it
                                    // in the previous if
 
+          if (indexed)
+            {
+              UnindexItem (currentItem);
+              UnindexItem (next);
+            }
           MergeItems (currentItem, next);
           list.erase (it);
+          if (indexed)
+            {
+              IndexItem (currentIt);
+            }
 
           delete next;
 
@@ -655,16 +700,15 @@ bool
 TcpTxBuffer::IsRetransmittedDataAcked (const SequenceNumber32& ack) const
 {
   NS_LOG_FUNCTION (this);
-  for (const auto &it : m_sentList)
-     {
-       TcpTxItem *item = it;
-       Ptr<Packet> p = item->m_packet;
-       if (item->m_startSeq + p->GetSize () == ack && !item->m_sacked && item->m_retrans)
-         {
-           return true;
-         }
-     }
-  return false;
+  // The only item which can end at ack is the last one starting before it
+  SentIndex::const_iterator it = m_sentIndex.lower_bound (ack);
+  if (it == m_sentIndex.begin ())
+    {
+      return false;
+    }
+  --it;
+  const TcpTxItem *item = *it->second;
+  return item->m_startSeq + item->m_packet->GetSize () == ack && !item->m_sacked && item->m_retrans;
 }
 
 void
@@ -713,6 +757,7 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq,
 
           RemoveFromCounts (item, pktSize);
 
+          UnindexItem (item);
           i = m_sentList.erase (i);
           NS_LOG_INFO ("Removed " << *item << " lost: " << m_lostOut <<
                        " retrans: " << m_retrans << " sacked: " << m_sackedOut <<
@@ -730,6 +775,7 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq,
         { // Part of the packet is behind the seqnum. Fragment
           pktSize -= offset;
           NS_LOG_INFO (*item);
+          UnindexItem (item);
           // PacketTags are preserved when fragmenting
           item->m_packet = item->m_packet->CreateFragment (offset, pktSize);
           item->m_startSeq += offset;
@@ -738,6 +784,7 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq,
           m_firstByteSeq += offset;
 
           RemoveFromCounts (item, offset);
+          IndexItem (i);
 
           NS_LOG_INFO ("Fragmented one packet by size " << offset <<
                        ", new size=" << pktSize << " resulting item is " <<
@@ -760,7 +807,9 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq,
           // It is not possible to have the UNA sacked; otherwise, it would
           // have been ACKed. This is, most likely, our wrong guessing
           // when adding Reno dupacks in the count.
+          RemoveFromScoreboard (head);
           head->m_sacked = false;
+          AddToScoreboard (head);
           m_sackedOut -= head->m_packet->GetSize ();
           NS_LOG_INFO ("Moving the SACK flag from the HEAD to another segment");
           AddRenoSack ();
@@ -796,18 +845,20 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list,
 
   for (auto option_it = list.begin (); option_it != list.end (); ++option_it)
     {
-      PacketList::iterator item_it = m_sentList.begin ();
-      SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
       if (m_firstByteSeq + m_sentSize < (*option_it).first)
         {
           NS_LOG_INFO ("Not updating scoreboard, the option block is outside the sent list");
           return bytesSacked;
         }
 
+      // Start from the first item which begins inside the block
+      SentIndex::const_iterator index = m_sentIndex.lower_bound ((*option_it).first);
+      PacketList::iterator item_it = index != m_sentIndex.end () ? index->second : m_sentList.end ();
+
       while (item_it != m_sentList.end ())
         {
           uint32_t pktSize = (*item_it)->m_packet->GetSize ();
+          SequenceNumber32 beginOfCurrentPacket = (*item_it)->m_startSeq;
 
           // Check the boundary of this packet ... only mark as sacked if
           // it is precisely mapped over the option. It means that if the receiver
@@ -826,6 +877,7 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list,
                 }
               else
                 {
+                  RemoveFromScoreboard (*item_it);
                   if ((*item_it)->m_lost)
                     {
                       (*item_it)->m_lost = false;
@@ -833,6 +885,7 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list,
                     }
 
                   (*item_it)->m_sacked = true;
+                  AddToScoreboard (*item_it);
                   m_sackedOut += (*item_it)->m_packet->GetSize ();
                   bytesSacked += (*item_it)->m_packet->GetSize ();
 
@@ -862,7 +915,6 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list,
               break;
             }
 
-          beginOfCurrentPacket += pktSize;
           ++item_it;
         }
     }
@@ -885,45 +937,38 @@ void
 TcpTxBuffer::UpdateLostCount ()
 {
   NS_LOG_FUNCTION (this);
-  uint32_t sacked = 0;
-  SequenceNumber32 beginOfCurrentPacket = m_highestSack.second;
-  if (m_highestSack.first == m_sentList.end ())
-    {
-      NS_LOG_INFO ("Status before the update: " << *this <<
-                   ", will start from the latest sent item");
-    }
-  else
-    {
-      NS_LOG_INFO ("Status before the update: " << *this <<
-                   ", will start from item " << *(*m_highestSack.first));
-    }
-
-  for (auto it = m_highestSack.first; it != m_sentList.begin(); --it)
+  NS_ASSERT (m_highestSack.first != m_sentList.end ());
+  NS_LOG_INFO ("Status before the update: " << *this <<
+               ", will start from item " << *(*m_highestSack.first));
+
+  // Count dupThresh sacked items down from the highest sacked one, the head
+  // excluded: the items below the last one counted are lost
+  const SeqSet &sacked = m_scoreboard[SACKED];
+  SequenceNumber32 highestSack = (*m_highestSack.first)->m_startSeq;
+  SeqSet::const_iterator it = sacked.upper_bound (highestSack);
+  uint32_t count = 0;
+  while (count < m_dupAckThresh && it != sacked.begin ())
     {
-      TcpTxItem *item = *it;
-      if (item->m_sacked)
+      SeqSet::const_iterator prev = it;
+      if (*(--prev) == m_firstByteSeq)
         {
-          sacked++;
-        }
-
-      if (sacked >= m_dupAckThresh)
-        {
-          if (!item->m_sacked && !item->m_lost)
-            {
-              item->m_lost = true;
-              m_lostOut += item->m_packet->GetSize ();
-            }
+          break;
         }
-      beginOfCurrentPacket -= item->m_packet->GetSize ();
+      it = prev;
+      ++count;
     }
 
-  if (sacked >= m_dupAckThresh)
+  if (count >= m_dupAckThresh)
     {
-      TcpTxItem *item = *m_sentList.begin ();
-      if (!item->m_lost)
+      SequenceNumber32 limit = count > 0 ? *it : highestSack + 1;
+      SeqSet &out = m_scoreboard[OUT];
+      while (!out.empty () && *out.begin () < limit)
         {
+          TcpTxItem *item = *m_sentIndex.find (*out.begin ())->second;
+          RemoveFromScoreboard (item);
           item->m_lost = true;
           m_lostOut += item->m_packet->GetSize ();
+          AddToScoreboard (item);
         }
     }
   NS_LOG_INFO ("Status after the update: " << *this);
@@ -935,37 +980,26 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq) const
 {
   NS_LOG_FUNCTION (this << seq);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-  PacketList::const_iterator it;
-
   if (seq >= m_highestSack.second)
     {
       return false;
     }
 
-  // In theory, using a map and hints when inserting elements can improve
-  // performance
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
-    {
-      // Search for the right iterator before calling IsLost()
-      if (beginOfCurrentPacket >= seq)
-        {
-          if ((*it)->m_lost == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
-              return true;
-            }
+  // The first item from seq which is either lost or sacked decides
+  SeqSet::const_iterator lost = m_scoreboard[LOST].lower_bound (seq);
+  SeqSet::const_iterator sacked = m_scoreboard[SACKED].lower_bound (seq);
 
-          if ((*it)->m_sacked == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
-              return false;
-            }
-        }
-
-      beginOfCurrentPacket += (*it)->m_packet->GetSize ();
+  if (lost != m_scoreboard[LOST].end ()
+      && (sacked == m_scoreboard[SACKED].end () || *lost <= *sacked))
+    {
+      NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
+      return true;
     }
 
+  if (sacked != m_scoreboard[SACKED].end ())
+    {
+      NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
+    }
   return false;
 }
 
@@ -987,36 +1021,25 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, SequenceNumber32 *seqHigh, bool isR
    *
    *     (1.c) IsLost (S2) returns true.
    */
-  PacketList::const_iterator it;
-  TcpTxItem *item;
+  // Condition 1.a , 1.b , and 1.c: the first lost item, neither
+  // retransmitted nor sacked
+  const SeqSet &lost = m_scoreboard[LOST_NOT_RETRANS];
+  if (!lost.empty ())
+    {
+      NS_LOG_INFO("IsLost, returning" << *lost.begin ());
+      *seq = *lost.begin ();
+      *seqHigh = *seq + m_segmentSize;
+      return true;
+    }
+
   SequenceNumber32 seqPerRule3;
   bool isSeqPerRule3Valid = false;
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
-
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  const SeqSet &out = m_scoreboard[OUT_NOT_RETRANS];
+  if (!out.empty () && isRecovery)
     {
-      item = *it;
-
-      // Condition 1.a , 1.b , and 1.c
-      if (item->m_retrans == false && item->m_sacked == false)
-        {
-          if (item->m_lost)
-            {
-              NS_LOG_INFO("IsLost, returning" << beginOfCurrentPkt);
-              *seq = beginOfCurrentPkt;
-              *seqHigh = *seq + m_segmentSize;
-              return true;
-            }
-          else if (seqPerRule3.GetValue () == 0 && isRecovery)
-            {
-              NS_LOG_INFO ("Saving for rule 3 the seq " << beginOfCurrentPkt);
-              isSeqPerRule3Valid = true;
-              seqPerRule3 = beginOfCurrentPkt;
-            }
-        }
-
-      // Nothing found, iterate
-      beginOfCurrentPkt += item->m_packet->GetSize ();
+      NS_LOG_INFO ("Saving for rule 3 the seq " << *out.begin ());
+      isSeqPerRule3Valid = true;
+      seqPerRule3 = *out.begin ();
     }
 
   /* (2) If no sequence number 'S2' per rule (1) exists but there
@@ -1224,9 +1247,12 @@ TcpTxBuffer::ResetRenoSack ()
   NS_LOG_FUNCTION (this);
 
   m_sackedOut = 0;
-  for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  while (!m_scoreboard[SACKED].empty ())
     {
-      (*it)->m_sacked = false;
+      TcpTxItem *item = *m_sentIndex.find (*m_scoreboard[SACKED].begin ())->second;
+      RemoveFromScoreboard (item);
+      item->m_sacked = false;
+      AddToScoreboard (item);
     }
 
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
@@ -1253,6 +1279,11 @@ TcpTxBuffer::ResetSentList ()
       m_appList.push_front (item);
       m_sentList.pop_back ();
     }
+  m_sentIndex.clear ();
+  for (uint32_t i = 0; i < SCOREBOARD_SETS; i++)
+    {
+      m_scoreboard[i].clear ();
+    }
 
   m_sentSize = 0;
   m_lostOut = 0;
@@ -1269,6 +1300,7 @@ TcpTxBuffer::ResetLastSegmentSent ()
     {
       TcpTxItem *item = m_sentList.back ();
 
+      UnindexItem (item);
       m_sentList.pop_back ();
       m_sentSize -= item->m_packet->GetSize ();
       if (item->m_retrans)
@@ -1297,6 +1329,12 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
       m_lostOut = 0;
     }
 
+  // All the items change state: rebuild the scoreboard in order
+  for (uint32_t i = 0; i < SCOREBOARD_SETS; i++)
+    {
+      m_scoreboard[i].clear ();
+    }
+
   for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
     {
       if (resetSack)
@@ -1320,6 +1358,7 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
         }
 
       (*it)->m_retrans = false;
+      AddToScoreboard (*it);
     }
 
   NS_LOG_INFO ("Set sent list lost, status: " << *this);
@@ -1352,7 +1391,9 @@ TcpTxBuffer::DeleteRetransmittedFlagFromHead ()
 
   if (m_sentList.front ()->m_retrans)
     {
+      RemoveFromScoreboard (m_sentList.front ());
       m_sentList.front ()->m_retrans = false;
+      AddToScoreboard (m_sentList.front ());
       m_retrans -= m_sentList.front ()->m_packet->GetSize ();
     }
   ConsistencyCheck ();
@@ -1363,6 +1404,8 @@ TcpTxBuffer::MarkHeadAsLost ()
 {
   if (m_sentList.size () > 0)
     {
+      RemoveFromScoreboard (m_sentList.front ());
+
       // If the head is sacked (reneging by the receiver the previously sent
       // information) we revert the sacked flag.
       // A sacked head means that we should advance SND.UNA.. so it's an error.
@@ -1383,6 +1426,8 @@ TcpTxBuffer::MarkHeadAsLost ()
           m_sentList.front()->m_lost = true;
           m_lostOut += m_sentList.front ()->m_packet->GetSize ();
         }
+
+      AddToScoreboard (m_sentList.front ());
     }
   ConsistencyCheck ();
 }
@@ -1403,19 +1448,17 @@ TcpTxBuffer::AddRenoSack (void)
 
   m_renoSack = true;
 
-  // We can _never_ SACK the head, so start from the second segment sent
-  auto it = ++m_sentList.begin ();
-
-  // Find the "highest sacked" point, that is SND.UNA + m_sackedOut
-  while (it != m_sentList.end () && (*it)->m_sacked)
-    {
-      ++it;
-    }
+  // We can _never_ SACK the head, so start from the second segment sent,
+  // and find the first segment not sacked
+  SentIndex::const_iterator index = GetFirstItem (NOT_SACKED, m_sentList.front ()->m_startSeq + 1);
+  PacketList::iterator it = index != m_sentIndex.end () ? index->second : m_sentList.end ();
 
   // Add to the sacked size the size of the first "not sacked" segment
   if (it != m_sentList.end ())
     {
+      RemoveFromScoreboard (*it);
       (*it)->m_sacked = true;
+      AddToScoreboard (*it);
       m_sackedOut += (*it)->m_packet->GetSize ();
       m_highestSack = std::make_pair (it, (*it)->m_startSeq);
       NS_LOG_INFO ("Added a Reno SACK, status: " << *this);
@@ -1429,16 +1472,77 @@ TcpTxBuffer::AddRenoSack (void)
   ConsistencyCheck ();
 }
 
+uint32_t
+TcpTxBuffer::GetScoreboardSets (const TcpTxItem *item)
+{
+  uint32_t sets = item->m_lost ? 1 << LOST : 0;
+  if (item->m_sacked)
+    {
+      return sets | 1 << SACKED;
+    }
+  sets |= 1 << NOT_SACKED;
+  if (item->m_lost)
+    {
+      return sets | (item->m_retrans ? 0 : 1 << LOST_NOT_RETRANS);
+    }
+  return sets | 1 << OUT | (item->m_retrans ? 0 : 1 << OUT_NOT_RETRANS);
+}
+
 void
-TcpTxBuffer::ConsistencyCheck () const
+TcpTxBuffer::AddToScoreboard (const TcpTxItem *item)
 {
-  static const bool enable = false;
+  uint32_t sets = GetScoreboardSets (item);
+  for (uint32_t i = 0; i < SCOREBOARD_SETS; i++)
+    {
+      if (sets & (1 << i))
+        {
+          // constant time when the item is the last one, as it is for new segments
+          m_scoreboard[i].insert (m_scoreboard[i].end (), item->m_startSeq);
+        }
+    }
+}
 
-  if (!enable)
+void
+TcpTxBuffer::RemoveFromScoreboard (const TcpTxItem *item)
+{
+  uint32_t sets = GetScoreboardSets (item);
+  for (uint32_t i = 0; i < SCOREBOARD_SETS; i++)
     {
-      return;
+      if (sets & (1 << i))
+        {
+          m_scoreboard[i].erase (item->m_startSeq);
+        }
+    }
+}
+
+void
+TcpTxBuffer::IndexItem (PacketList::iterator it)
+{
+  m_sentIndex.insert (m_sentIndex.end (), std::make_pair ((*it)->m_startSeq, it));
+  AddToScoreboard (*it);
+}
+
+void
+TcpTxBuffer::UnindexItem (const TcpTxItem *item)
+{
+  RemoveFromScoreboard (item);
+  m_sentIndex.erase (item->m_startSeq);
+}
+
+TcpTxBuffer::SentIndex::const_iterator
+TcpTxBuffer::GetFirstItem (ScoreboardSet set, const SequenceNumber32 &seq) const
+{
+  SeqSet::const_iterator it = m_scoreboard[set].lower_bound (seq);
+  if (it == m_scoreboard[set].end ())
+    {
+      return m_sentIndex.end ();
     }
+  return m_sentIndex.find (*it);
+}
 
+bool
+TcpTxBuffer::IsConsistent (void) const
+{
   uint32_t sacked = 0;
   uint32_t lost = 0;
   uint32_t retrans = 0;
@@ -1459,12 +1563,64 @@ TcpTxBuffer::ConsistencyCheck () const
         }
     }
 
-  NS_ASSERT_MSG (sacked == m_sackedOut, "Counted SACK: " << sacked <<
-                 " stored SACK: " << m_sackedOut);
-  NS_ASSERT_MSG (lost == m_lostOut, " Counted lost: " << lost <<
-                 " stored lost: " << m_lostOut);
-  NS_ASSERT_MSG (retrans == m_retrans, " Counted retrans: " << retrans <<
-                 " stored retrans: " << m_retrans);
+  if (sacked != m_sackedOut || lost != m_lostOut || retrans != m_retrans)
+    {
+      NS_LOG_ERROR ("Counted SACK: " << sacked << " stored SACK: " << m_sackedOut <<
+                    " counted lost: " << lost << " stored lost: " << m_lostOut <<
+                    " counted retrans: " << retrans << " stored retrans: " << m_retrans);
+      return false;
+    }
+
+  uint32_t sets[SCOREBOARD_SETS] = { 0 };
+  if (m_sentIndex.size () != m_sentList.size ())
+    {
+      NS_LOG_ERROR ("Index out of sync with the sent list");
+      return false;
+    }
+  for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
+    {
+      SentIndex::const_iterator index = m_sentIndex.find ((*it)->m_startSeq);
+      if (index == m_sentIndex.end () || index->second != it)
+        {
+          NS_LOG_ERROR ("Item " << **it << " not indexed");
+          return false;
+        }
+      uint32_t itemSets = GetScoreboardSets (*it);
+      for (uint32_t i = 0; i < SCOREBOARD_SETS; i++)
+        {
+          if (itemSets & (1 << i))
+            {
+              if (m_scoreboard[i].count ((*it)->m_startSeq) != 1)
+                {
+                  NS_LOG_ERROR ("Item " << **it << " not in the scoreboard set " << i);
+                  return false;
+                }
+              sets[i]++;
+            }
+        }
+    }
+  for (uint32_t i = 0; i < SCOREBOARD_SETS; i++)
+    {
+      if (sets[i] != m_scoreboard[i].size ())
+        {
+          NS_LOG_ERROR ("Scoreboard set " << i << " out of sync with the sent list");
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+TcpTxBuffer::ConsistencyCheck () const
+{
+  static const bool enable = false;
+
+  if (!enable)
+    {
+      return;
+    }
+
+  NS_ASSERT_MSG (IsConsistent (), "TcpTxBuffer out of sync: " << *this);
 }
 
 std::ostream &
@@ -22,6 +22,8 @@
 #ifndef TCP_TX_BUFFER_H
 #define TCP_TX_BUFFER_H
 
+#include <map>
+#include <set>
 #include "ns3/object.h"
 #include "ns3/traced-value.h"
 #include "ns3/sequence-number.h"
@@ -70,8 +72,18 @@ class Packet;
  * associated with every segment sent. This is done through the use of the
  * class TcpTxItem: instead of storing a list of packets, we store a list of
  * TcpTxItem. Each item has different flags (check the corresponding
- * documentation) and maintaining the scoreboard is a matter of travelling the
- * list and set the SACK flag on the corresponding segment sent.
+ * documentation) and maintaining the scoreboard is a matter of setting the
+ * SACK flag on the corresponding segment sent.
+ *
+ * To avoid travelling the list, which becomes expensive with large windows,
+ * the items of the SentList are indexed by their first sequence number, and
+ * the scoreboard keeps the ordered sets of the sequence numbers of the items
+ * by state (sacked or not, lost, neither sacked nor lost, and the latter two
+ * without the retransmitted items). Mapping a SACK block, checking if a
+ * sequence is lost, finding the next segment to retransmit, or marking the
+ * segments lost below the dupThresh-th sacked one, therefore take a
+ * logarithmic time in the number of segments in flight, plus the number of
+ * items whose flags change.
  *
  * Item properties
  * ---------------
@@ -276,6 +288,16 @@ public:
    */
   bool IsRetransmittedDataAcked (const SequenceNumber32& ack) const;
 
+  /**
+   * \brief Check that the values of sacked, lost, retrans, the index and
+   * the scoreboard are in sync with the sent list
+   *
+   * The check walks the whole sent list; it is meant for the tests.
+   *
+   * \return true if they are in sync
+   */
+  bool IsConsistent (void) const;
+
   /**
    * \brief Discard data up to but not including this sequence number.
    *
@@ -412,6 +434,69 @@ private:
   friend std::ostream & operator<< (std::ostream & os, TcpTxBuffer const & tcpTxBuf);
 
   typedef std::list<TcpTxItem*> PacketList; //!< container for data stored in the buffer
+  typedef std::map<SequenceNumber32, PacketList::iterator> SentIndex; //!< items of the sent list, by first sequence number
+  typedef std::set<SequenceNumber32> SeqSet; //!< ordered set of sequence numbers
+
+  /**
+   * \brief The sets of the scoreboard, by state of the sent items
+   */
+  enum ScoreboardSet
+  {
+    SACKED = 0,       //!< Sacked items
+    NOT_SACKED,       //!< Items not sacked
+    LOST,             //!< Lost items, even if sacked
+    LOST_NOT_RETRANS, //!< Lost items neither sacked nor retransmitted (NextSeg rule 1)
+    OUT,              //!< Items neither sacked nor lost
+    OUT_NOT_RETRANS,  //!< Items neither sacked, lost, nor retransmitted (NextSeg rule 3)
+    SCOREBOARD_SETS   //!< Number of sets
+  };
+
+  /**
+   * \brief Get the scoreboard sets of an item, from its flags
+   * \param item the item
+   * \return a bit mask of the sets, indexed by ScoreboardSet
+   */
+  static uint32_t GetScoreboardSets (const TcpTxItem *item);
+
+  /**
+   * \brief Add an item of the sent list to the sets of the scoreboard
+   *
+   * To be called after changing the flags of the item.
+   * \param item the item
+   */
+  void AddToScoreboard (const TcpTxItem *item);
+
+  /**
+   * \brief Remove an item of the sent list from the sets of the scoreboard
+   *
+   * To be called before changing the flags of the item.
+   * \param item the item
+   */
+  void RemoveFromScoreboard (const TcpTxItem *item);
+
+  /**
+   * \brief Index an item of the sent list, and add it to the scoreboard
+   * \param it the item in the sent list
+   */
+  void IndexItem (PacketList::iterator it);
+
+  /**
+   * \brief Remove an item of the sent list from the index and the scoreboard
+   *
+   * To be called before changing the first sequence number of the item, or
+   * removing it from the sent list.
+   * \param item the item
+   */
+  void UnindexItem (const TcpTxItem *item);
+
+  /**
+   * \brief Get the first sent item, at or after a sequence number, in a
+   * set of the scoreboard
+   * \param set the set
+   * \param seq the sequence number
+   * \return the item in the index, or the end of the index
+   */
+  SentIndex::const_iterator GetFirstItem (ScoreboardSet set, const SequenceNumber32 &seq) const;
 
   /**
    * \brief Update the lost count
@@ -428,8 +513,9 @@ private:
    * The {New}Reno cases, for now, are managed in TcpSocketBase through the
    * call to MarkHeadAsLost.
    * This function is, therefore, called after a SACK option has been received,
-   * and updates the lost count. It can be probably optimized by not walking
-   * the entire list, but a subset.
+   * and updates the lost count. It finds the dupThresh-th sacked segment below
+   * the highest sacked one in the scoreboard, and walks only the segments
+   * below it which are neither sacked nor lost.
    *
    */
   void UpdateLostCount ();
@@ -562,7 +648,7 @@ private:
    */
   TcpTxItem* GetPacketFromList (PacketList &list, const SequenceNumber32 &startingSeq,
                                 uint32_t numBytes, const SequenceNumber32 &requestedSeq,
-                                bool *listEdited = nullptr) const;
+                                bool *listEdited = nullptr);
 
   /**
    * \brief Merge two TcpTxItem
@@ -589,8 +675,7 @@ private:
   void SplitItems (TcpTxItem *t1, TcpTxItem *t2, uint32_t size) const;
 
   /**
-   * \brief Check if the values of sacked, lost, retrans, are in sync
-   * with the sent list.
+   * \brief Assert that the buffer IsConsistent, if enabled at compile time.
    */
   void ConsistencyCheck () const;
 
@@ -603,6 +688,8 @@ private:
 
   PacketList m_appList;  //!< Buffer for application data
   PacketList m_sentList; //!< Buffer for sent (but not acked) data
+  SentIndex m_sentIndex; //!< Items of the sent list, by first sequence number
+  SeqSet m_scoreboard[SCOREBOARD_SETS]; //!< First sequence numbers of the sent items, by state
   uint32_t m_maxBuffer;  //!< Max number of data bytes in buffer (SND.WND)
   uint32_t m_size;       //!< Size of all data in this buffer
   uint32_t m_sentSize;   //!< Size of sent (and not discarded) segments
@@ -180,42 +180,53 @@ UdpHeader::GetSerializedSize (void) const
   return 8;
 }
 
+void
+UdpHeader::WriteFields (uint8_t *buffer, uint32_t size) const
+{
+  uint16_t length = m_payloadSize == 0 ? size : m_payloadSize;
+  buffer[0] = m_sourcePort >> 8;
+  buffer[1] = m_sourcePort & 0xff;
+  buffer[2] = m_destinationPort >> 8;
+  buffer[3] = m_destinationPort & 0xff;
+  buffer[4] = length >> 8;
+  buffer[5] = length & 0xff;
+  // the checksum is kept in network order, and written as is
+  buffer[6] = m_checksum & 0xff;
+  buffer[7] = m_checksum >> 8;
+}
+
 void
 UdpHeader::Serialize (Buffer::Iterator start) const
 {
   Buffer::Iterator i = start;
 
-  i.WriteHtonU16 (m_sourcePort);
-  i.WriteHtonU16 (m_destinationPort);
-  if (m_payloadSize == 0)
-    {
-      i.WriteHtonU16 (start.GetSize ());
-    }
-  else
-    {
-      i.WriteHtonU16 (m_payloadSize);
-    }
+  uint8_t buffer[8];
+  WriteFields (buffer, start.GetSize ());
+  i.Write (buffer, 8);
 
-  if ( m_checksum == 0)
+  if (m_checksum == 0 && m_calcChecksum)
     {
-      i.WriteU16 (0);
-
-      if (m_calcChecksum)
-        {
-          uint16_t headerChecksum = CalculateHeaderChecksum (start.GetSize ());
-          i = start;
-          uint16_t checksum = i.CalculateIpChecksum (start.GetSize (), headerChecksum);
-
-          i = start;
-          i.Next (6);
-          i.WriteU16 (checksum);
-        }
+      uint16_t headerChecksum = CalculateHeaderChecksum (start.GetSize ());
+      i = start;
+      uint16_t checksum = i.CalculateIpChecksum (start.GetSize (), headerChecksum);
+
+      i = start;
+      i.Next (6);
+      i.WriteU16 (checksum);
     }
-  else
+}
+
+uint32_t
+UdpHeader::SerializeTo (uint8_t *buffer, uint32_t payloadSize) const
+{
+  if (m_checksum == 0 && m_calcChecksum)
     {
-      i.WriteU16 (m_checksum);
+      return 0;
     }
+  WriteFields (buffer, payloadSize + 8);
+  return 8;
 }
+
 uint32_t
 UdpHeader::Deserialize (Buffer::Iterator start)
 {
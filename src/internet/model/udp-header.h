@@ -124,6 +124,14 @@ public:
   virtual uint32_t GetSerializedSize (void) const;
   virtual void Serialize (Buffer::Iterator start) const;
   virtual uint32_t Deserialize (Buffer::Iterator start);
+  /**
+   * \brief Serialize the header in contiguous memory (see HeaderTraits).
+   * \param [out] buffer The buffer, of at least 8 bytes.
+   * \param [in] payloadSize The number of bytes which follow the header.
+   * \returns The number of bytes written, or 0 if the checksum has to be
+   *          calculated over the payload.
+   */
+  uint32_t SerializeTo (uint8_t *buffer, uint32_t payloadSize) const;
 
   /**
    * \brief Is the UDP checksum correct ?
@@ -173,6 +181,13 @@ private:
    * \returns the checksum
    */
   uint16_t CalculateHeaderChecksum (uint16_t size) const;
+  /**
+   * \brief Write the fields of the header, with a null checksum unless
+   *        it is forced.
+   * \param [out] buffer The buffer, of 8 bytes.
+   * \param [in] size The size of the header and of the payload.
+   */
+  void WriteFields (uint8_t *buffer, uint32_t size) const;
   uint16_t m_sourcePort;      //!< Source port
   uint16_t m_destinationPort; //!< Destination port
   uint16_t m_payloadSize;     //!< Payload size
@@ -185,6 +200,15 @@ private:
   bool m_goodChecksum;        //!< Flag to indicate that checksum is correct
 };
 
+/**
+ * \brief The UDP header can be added to a packet without virtual calls.
+ */
+template <>
+struct HeaderTraits<UdpHeader>
+{
+  static constexpr uint32_t MAX_SIZE = 8; //!< The size of the header.
+};
+
 } // namespace ns3
 
 #endif /* UDP_HEADER */
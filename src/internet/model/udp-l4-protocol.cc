@@ -39,6 +39,7 @@
 #include "ipv4-l3-protocol.h"
 #include "ipv6-l3-protocol.h"
 #include "udp-socket-impl.h"
+#include "ns3/packet-census.h"
 
 namespace ns3 {
 
@@ -418,6 +419,7 @@ UdpL4Protocol::Send (Ptr<Packet> packet,
                      uint16_t sport, uint16_t dport)
 {
   NS_LOG_FUNCTION (this << packet << saddr << daddr << sport << dport);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
 
   UdpHeader udpHeader;
   if(Node::ChecksumEnabled ())
@@ -441,6 +443,7 @@ UdpL4Protocol::Send (Ptr<Packet> packet,
                      uint16_t sport, uint16_t dport, Ptr<Ipv4Route> route)
 {
   NS_LOG_FUNCTION (this << packet << saddr << daddr << sport << dport << route);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
 
   UdpHeader udpHeader;
   if(Node::ChecksumEnabled ())
@@ -464,6 +467,7 @@ UdpL4Protocol::Send (Ptr<Packet> packet,
                      uint16_t sport, uint16_t dport)
 {
   NS_LOG_FUNCTION (this << packet << saddr << daddr << sport << dport);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
 
   UdpHeader udpHeader;
   if(Node::ChecksumEnabled ())
@@ -487,6 +491,7 @@ UdpL4Protocol::Send (Ptr<Packet> packet,
                      uint16_t sport, uint16_t dport, Ptr<Ipv6Route> route)
 {
   NS_LOG_FUNCTION (this << packet << saddr << daddr << sport << dport << route);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
 
   UdpHeader udpHeader;
   if(Node::ChecksumEnabled ())
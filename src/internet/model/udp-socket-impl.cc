@@ -38,6 +38,7 @@
 #include "udp-l4-protocol.h"
 #include "ipv4-end-point.h"
 #include "ipv6-end-point.h"
+#include "ns3/packet-census.h"
 #include <limits>
 
 namespace ns3 {
@@ -433,6 +434,7 @@ int
 UdpSocketImpl::Send (Ptr<Packet> p, uint32_t flags)
 {
   NS_LOG_FUNCTION (this << p << flags);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
 
   if (!m_connected)
     {
@@ -801,6 +803,7 @@ int
 UdpSocketImpl::SendTo (Ptr<Packet> p, uint32_t flags, const Address &address)
 {
   NS_LOG_FUNCTION (this << p << flags << address);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
   if (InetSocketAddress::IsMatchingType (address))
     {
       InetSocketAddress transport = InetSocketAddress::ConvertFrom (address);
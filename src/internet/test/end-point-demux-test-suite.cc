@@ -0,0 +1,282 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-interface-address.h"
+#include "ns3/ipv6-end-point.h"
+#include "ns3/ipv6-end-point-demux.h"
+#include "ns3/ipv6-interface.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4EndPointDemux lookup test.
+ */
+class Ipv4EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \param [in] endPoints The end points found by a lookup.
+   * \returns The end point, or 0 if none was found.
+   */
+  static Ipv4EndPoint *GetEndPoint (const Ipv4EndPointDemux::EndPoints &endPoints);
+};
+
+Ipv4EndPointDemuxTestCase::Ipv4EndPointDemuxTestCase ()
+  : TestCase ("Ipv4EndPointDemux lookup")
+{
+}
+
+Ipv4EndPoint *
+Ipv4EndPointDemuxTestCase::GetEndPoint (const Ipv4EndPointDemux::EndPoints &endPoints)
+{
+  return endPoints.empty () ? 0 : endPoints.front ();
+}
+
+void
+Ipv4EndPointDemuxTestCase::DoRun (void)
+{
+  Ipv4Address local ("10.1.1.1");
+  Ipv4Address subnet ("10.1.1.0");
+  Ipv4Address broadcast ("10.1.1.255");
+  Ipv4Address peer ("10.2.2.2");
+  Ipv4Address any = Ipv4Address::GetAny ();
+
+  Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface> ();
+  interface->SetDevice (CreateObject<SimpleNetDevice> ());
+  interface->AddAddress (Ipv4InterfaceAddress (local, Ipv4Mask ("255.255.255.0")));
+
+  Ipv4EndPointDemux demux;
+  Ipv4EndPoint *listener = demux.Allocate (0, 80);
+  NS_TEST_ASSERT_MSG_NE (listener, 0, "listener not allocated");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (80), true, "port 80 not used");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (81), false, "port 81 used");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (0, any, 80), true, "listener not found");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (0, local, 80), false, "unexpected end point");
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (0, 80), 0, "duplicated listener allocated");
+
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (local, 80, peer, 1000, interface)), listener,
+                         "wildcard listener not found");
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (local, 81, peer, 1000, interface)), 0,
+                         "unexpected end point for port 81");
+
+  // the most exact match wins
+  Ipv4EndPoint *bound = demux.Allocate (0, local, 80);
+  NS_TEST_ASSERT_MSG_NE (bound, 0, "bound listener not allocated");
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (local, 80, peer, 1000, interface)), bound,
+                         "bound listener not preferred");
+  Ipv4EndPoint *connected = demux.Allocate (0, any, 80, peer, 1000);
+  NS_TEST_ASSERT_MSG_NE (connected, 0, "connected end point not allocated");
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (local, 80, peer, 1000, interface)), connected,
+                         "connected end point not preferred");
+  Ipv4EndPoint *exact = demux.Allocate (0, local, 80, peer, 1001);
+  NS_TEST_ASSERT_MSG_NE (exact, 0, "exact end point not allocated");
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (0, local, 80, peer, 1001), 0, "duplicated end point allocated");
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (local, 80, peer, 1001, interface)), exact,
+                         "exact end point not found");
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (local, 80, peer, 1002, interface)), bound,
+                         "bound listener not found");
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (Ipv4Address ("10.3.3.3"), 80, peer, 1002, interface)), listener,
+                         "wildcard listener not found");
+
+  // a subnet-directed broadcast matches the end points bound to the subnet
+  Ipv4EndPoint *subnetListener = demux.Allocate (0, subnet, 90);
+  NS_TEST_ASSERT_MSG_NE (subnetListener, 0, "subnet listener not allocated");
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (broadcast, 90, peer, 1000, interface)), subnetListener,
+                         "subnet listener not found");
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (Ipv4Address ("10.1.2.255"), 90, peer, 1000, interface)), 0,
+                         "subnet listener found for another subnet");
+
+  // the end points are indexed again when their addresses change
+  exact->SetPeer (peer, 2000);
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (local, 80, peer, 1001, interface)), bound,
+                         "end point found by its previous peer");
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (local, 80, peer, 2000, interface)), exact,
+                         "end point not found by its new peer");
+  listener->SetLocalAddress (Ipv4Address ("10.3.3.3"));
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (0, Ipv4Address ("10.3.3.3"), 80), true,
+                         "listener not found by its new address");
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (Ipv4Address ("10.3.3.3"), 80, peer, 1002, interface)), listener,
+                         "listener not found by its new address");
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (Ipv4Address ("10.4.4.4"), 80, peer, 1002, interface)), 0,
+                         "listener found by its previous address");
+
+  // the end points which can not receive, or are bound to another device, are skipped
+  connected->SetRxEnabled (false);
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (local, 80, peer, 1000, interface)), bound,
+                         "disabled end point found");
+  connected->SetRxEnabled (true);
+  connected->BindToNetDevice (CreateObject<SimpleNetDevice> ());
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (local, 80, peer, 1000, interface)), bound,
+                         "end point bound to another device found");
+  connected->BindToNetDevice (interface->GetDevice ());
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (local, 80, peer, 1000, interface)), connected,
+                         "end point bound to the device not found");
+
+  demux.DeAllocate (connected);
+  demux.DeAllocate (bound);
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (local, 80, peer, 1000, interface)), 0,
+                         "deallocated end point found");
+  demux.DeAllocate (exact);
+  demux.DeAllocate (listener);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (80), false, "port 80 still used");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (90), true, "port 90 not used");
+
+  Ipv4EndPoint *ephemeral = demux.Allocate ();
+  NS_TEST_ASSERT_MSG_NE (ephemeral, 0, "ephemeral end point not allocated");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (ephemeral->GetLocalPort ()), true, "ephemeral port not used");
+  NS_TEST_EXPECT_MSG_EQ (demux.GetAllEndPoints ().size (), 2, "wrong number of end points");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv6EndPointDemux lookup test.
+ */
+class Ipv6EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv6EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \param [in] endPoints The end points found by a lookup.
+   * \returns The end point, or 0 if none was found.
+   */
+  static Ipv6EndPoint *GetEndPoint (const Ipv6EndPointDemux::EndPoints &endPoints);
+};
+
+Ipv6EndPointDemuxTestCase::Ipv6EndPointDemuxTestCase ()
+  : TestCase ("Ipv6EndPointDemux lookup")
+{
+}
+
+Ipv6EndPoint *
+Ipv6EndPointDemuxTestCase::GetEndPoint (const Ipv6EndPointDemux::EndPoints &endPoints)
+{
+  return endPoints.empty () ? 0 : endPoints.front ();
+}
+
+void
+Ipv6EndPointDemuxTestCase::DoRun (void)
+{
+  Ipv6Address local ("2001:1::1");
+  Ipv6Address other ("2001:3::3");
+  Ipv6Address peer ("2001:2::2");
+  Ipv6Address any = Ipv6Address::GetAny ();
+
+  Ptr<Ipv6Interface> interface = CreateObject<Ipv6Interface> ();
+  interface->SetDevice (CreateObject<SimpleNetDevice> ());
+
+  Ipv6EndPointDemux demux;
+  Ipv6EndPoint *listener = demux.Allocate (0, 80);
+  NS_TEST_ASSERT_MSG_NE (listener, 0, "listener not allocated");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (80), true, "port 80 not used");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (0, any, 80), true, "listener not found");
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (0, 80), 0, "duplicated listener allocated");
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (local, 80, peer, 1000, interface)), listener,
+                         "wildcard listener not found");
+
+  // the most exact match wins
+  Ipv6EndPoint *bound = demux.Allocate (0, local, 80);
+  NS_TEST_ASSERT_MSG_NE (bound, 0, "bound listener not allocated");
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (local, 80, peer, 1000, interface)), bound,
+                         "bound listener not preferred");
+  Ipv6EndPoint *connected = demux.Allocate (0, any, 80, peer, 1000);
+  NS_TEST_ASSERT_MSG_NE (connected, 0, "connected end point not allocated");
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (local, 80, peer, 1000, interface)), connected,
+                         "connected end point not preferred");
+  Ipv6EndPoint *exact = demux.Allocate (0, local, 80, peer, 1001);
+  NS_TEST_ASSERT_MSG_NE (exact, 0, "exact end point not allocated");
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (0, local, 80, peer, 1001), 0, "duplicated end point allocated");
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (local, 80, peer, 1001, interface)), exact,
+                         "exact end point not found");
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (other, 80, peer, 1002, interface)), listener,
+                         "wildcard listener not found");
+
+  // the end points are indexed again when their addresses change
+  exact->SetPeer (peer, 2000);
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (local, 80, peer, 1001, interface)), bound,
+                         "end point found by its previous peer");
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (local, 80, peer, 2000, interface)), exact,
+                         "end point not found by its new peer");
+  listener->SetLocalAddress (other);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (0, other, 80), true, "listener not found by its new address");
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (other, 80, peer, 1002, interface)), listener,
+                         "listener not found by its new address");
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (Ipv6Address ("2001:4::4"), 80, peer, 1002, interface)), 0,
+                         "listener found by its previous address");
+
+  // the end points which can not receive, or are bound to another device, are skipped
+  connected->SetRxEnabled (false);
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (local, 80, peer, 1000, interface)), bound,
+                         "disabled end point found");
+  connected->SetRxEnabled (true);
+  connected->BindToNetDevice (CreateObject<SimpleNetDevice> ());
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (local, 80, peer, 1000, interface)), bound,
+                         "end point bound to another device found");
+  connected->BindToNetDevice (interface->GetDevice ());
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (local, 80, peer, 1000, interface)), connected,
+                         "end point bound to the device not found");
+
+  demux.DeAllocate (connected);
+  demux.DeAllocate (bound);
+  NS_TEST_EXPECT_MSG_EQ (GetEndPoint (demux.Lookup (local, 80, peer, 1000, interface)), 0,
+                         "deallocated end point found");
+  demux.DeAllocate (exact);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (80), true, "port 80 not used");
+  demux.DeAllocate (listener);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (80), false, "port 80 still used");
+
+  Ipv6EndPoint *ephemeral = demux.Allocate ();
+  NS_TEST_ASSERT_MSG_NE (ephemeral, 0, "ephemeral end point not allocated");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (ephemeral->GetLocalPort ()), true, "ephemeral port not used");
+  NS_TEST_EXPECT_MSG_EQ (demux.GetEndPoints ().size (), 1, "wrong number of end points");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief End point demultiplexer TestSuite
+ */
+class EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  EndPointDemuxTestSuite ()
+    : TestSuite ("end-point-demux", UNIT)
+  {
+    AddTestCase (new Ipv4EndPointDemuxTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv6EndPointDemuxTestCase, TestCase::QUICK);
+  }
+};
+
+static EndPointDemuxTestSuite g_endPointDemuxTestSuite; //!< Static variable for test initialization
@@ -65,13 +65,45 @@ GlobalRouteManagerImplTestCase::DoRun (void)
       candidate.Push (v);
     }
 
+  uint32_t lastDistance = 0;
   for (int i = 0; i < 100; ++i)
     {
       SPFVertex *v = candidate.Pop ();
+      NS_TEST_ASSERT_MSG_GT_OR_EQ (v->GetDistanceFromRoot (), lastDistance,
+                                   "CandidateQueue out of order");
+      lastDistance = v->GetDistanceFromRoot ();
       delete v;
       v = 0;
     }
 
+  // At equal distances, networks come first, then the vertices in the
+  // order in which they were pushed or updated
+  const char *ids[] = { "0.0.0.1", "0.0.0.2", "0.0.0.3", "0.0.0.4", "10.1.1.0" };
+  SPFVertex *vertices[5];
+  for (int i = 0; i < 5; ++i)
+    {
+      vertices[i] = new SPFVertex;
+      vertices[i]->SetVertexId (Ipv4Address (ids[i]));
+      vertices[i]->SetVertexType (i == 4 ? SPFVertex::VertexNetwork : SPFVertex::VertexRouter);
+      vertices[i]->SetDistanceFromRoot (i < 2 ? 2 : 3);
+      candidate.Push (vertices[i]);
+    }
+  NS_TEST_ASSERT_MSG_EQ (candidate.Find (Ipv4Address ("0.0.0.3")), vertices[2], "Find failed");
+  NS_TEST_ASSERT_MSG_EQ (candidate.Find (Ipv4Address ("0.0.0.5")), 0, "Find found a missing vertex");
+  vertices[3]->SetDistanceFromRoot (2);
+  candidate.Update (vertices[3]);
+  vertices[4]->SetDistanceFromRoot (2);
+  candidate.Update (vertices[4]);
+  int order[] = { 4, 0, 1, 3, 2 };
+  for (int i = 0; i < 5; ++i)
+    {
+      SPFVertex *v = candidate.Pop ();
+      NS_TEST_ASSERT_MSG_EQ (v, vertices[order[i]], "CandidateQueue out of order at " << i);
+      delete v;
+    }
+  NS_TEST_ASSERT_MSG_EQ (candidate.Find (Ipv4Address ("0.0.0.3")), 0, "Popped vertex found");
+  NS_TEST_ASSERT_MSG_EQ (candidate.Empty (), true, "CandidateQueue not empty");
+
   // Build fake link state database; four routers (0-3), 3 point-to-point
   // links
   //
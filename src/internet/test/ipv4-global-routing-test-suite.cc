@@ -14,6 +14,7 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <sstream>
 #include <vector>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
@@ -42,6 +43,7 @@
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/ipv4-global-routing.h"
 #include "ns3/bridge-helper.h"
+#include "ns3/random-variable-stream.h"
 
 using namespace ns3;
 
@@ -1244,6 +1246,200 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting parallel and incremental computation test.
+ *
+ * The routes computed on several threads, and the routes updated after
+ * changes of the topology, must be the routes of a full computation.
+ */
+class Ipv4GlobalRoutingUpdateTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingUpdateTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param [in] nodes The nodes.
+   * \returns The routes of each node, in the order of its routing table.
+   */
+  static std::vector<std::string> GetRoutes (const NodeContainer &nodes);
+  /**
+   * \brief Check that updating the routes yields the routes of a full
+   * computation.
+   * \param [in] nodes The nodes.
+   * \param [in] change The change of the topology.
+   */
+  void CheckUpdate (const NodeContainer &nodes, std::string change);
+};
+
+Ipv4GlobalRoutingUpdateTestCase::Ipv4GlobalRoutingUpdateTestCase ()
+  : TestCase ("Parallel and incremental global routes computation")
+{
+}
+
+std::vector<std::string>
+Ipv4GlobalRoutingUpdateTestCase::GetRoutes (const NodeContainer &nodes)
+{
+  std::vector<std::string> routes;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = nodes.Get (i)->GetObject<Ipv4> ()->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+      std::ostringstream oss;
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          oss << *routing->GetRoute (j) << std::endl;
+        }
+      routes.push_back (oss.str ());
+    }
+  return routes;
+}
+
+void
+Ipv4GlobalRoutingUpdateTestCase::CheckUpdate (const NodeContainer &nodes, std::string change)
+{
+  Ipv4GlobalRoutingHelper::UpdateRoutingTables ();
+  std::vector<std::string> updated = GetRoutes (nodes);
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  std::vector<std::string> computed = GetRoutes (nodes);
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (updated[i], computed[i], "Wrong routes of node " << i << " after " << change);
+    }
+}
+
+void
+Ipv4GlobalRoutingUpdateTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+  const uint32_t nNodes = 16;
+  // equal-cost paths to a LAN are not supported: the first topology has
+  // equal-cost paths but no LAN, the second one is a tree with a LAN
+  for (uint32_t topology = 0; topology < 2; topology++)
+    {
+      NodeContainer nodes;
+      nodes.Create (nNodes);
+      NodeContainer lanNodes;
+      if (topology == 1)
+        {
+          lanNodes.Add (nodes.Get (0));
+          lanNodes.Create (2);
+          nodes.Add (lanNodes.Get (1));
+          nodes.Add (lanNodes.Get (2));
+        }
+      InternetStackHelper internet;
+      Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+      internet.SetRoutingHelper (ipv4RoutingHelper);
+      internet.Install (nodes);
+
+      SimpleNetDeviceHelper simpleHelper;
+      simpleHelper.SetNetDevicePointToPointMode (true);
+      Ipv4AddressHelper ipv4;
+      ipv4.SetBase ("10.1.0.0", "255.255.255.252");
+      Ipv4InterfaceContainer interfaces;
+      for (uint32_t i = 1; i < nNodes + (topology == 0 ? 8 : 0); i++)
+        {
+          uint32_t a;
+          uint32_t b;
+          if (topology == 0)
+            {
+              // a ring with chords
+              a = i < nNodes ? i : rng->GetInteger (0, nNodes - 1);
+              b = i < nNodes ? i - 1 : rng->GetInteger (0, nNodes - 1);
+              b = i == nNodes - 1 ? 0 : b;
+            }
+          else
+            {
+              // a random tree
+              a = i;
+              b = rng->GetInteger (0, i - 1);
+            }
+          if (a == b)
+            {
+              continue;
+            }
+          NetDeviceContainer net = simpleHelper.Install (NodeContainer (nodes.Get (a), nodes.Get (b)),
+                                                         CreateObject<SimpleChannel> ());
+          interfaces.Add (ipv4.Assign (net));
+          ipv4.NewNetwork ();
+        }
+      if (topology == 0)
+        {
+          NetDeviceContainer net = simpleHelper.Install (NodeContainer (nodes.Get (nNodes - 1), nodes.Get (nNodes - 2)),
+                                                         CreateObject<SimpleChannel> ());
+          interfaces.Add (ipv4.Assign (net));
+        }
+      else
+        {
+          SimpleNetDeviceHelper lanHelper;
+          NetDeviceContainer lan = lanHelper.Install (lanNodes, CreateObject<SimpleChannel> ());
+          ipv4.SetBase ("10.2.0.0", "255.255.255.0");
+          interfaces.Add (ipv4.Assign (lan));
+        }
+      for (uint32_t i = 0; i < interfaces.GetN (); i++)
+        {
+          std::pair<Ptr<Ipv4>, uint32_t> interface = interfaces.Get (i);
+          interface.first->SetMetric (interface.second, rng->GetInteger (1, 3));
+        }
+
+      Config::SetGlobal ("GlobalRoutingSpfThreads", UintegerValue (1));
+      Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+      std::vector<std::string> routes = GetRoutes (nodes);
+      Config::SetGlobal ("GlobalRoutingSpfThreads", UintegerValue (4));
+      Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+      std::vector<std::string> parallelRoutes = GetRoutes (nodes);
+      for (uint32_t i = 0; i < nodes.GetN (); i++)
+        {
+          NS_TEST_EXPECT_MSG_NE (routes[i], "", "No routes for node " << i);
+          NS_TEST_EXPECT_MSG_EQ (parallelRoutes[i], routes[i], "Wrong routes of node " << i << " on several threads");
+        }
+
+      // the routes are left untouched when the topology did not change
+      Ptr<Ipv4GlobalRouting> routing = nodes.Get (1)->GetObject<Ipv4> ()->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+      uint32_t nRoutes = routing->GetNRoutes ();
+      routing->AddHostRouteTo (Ipv4Address ("192.168.0.1"), interfaces.GetAddress (1), interfaces.Get (0).second);
+      Ipv4GlobalRoutingHelper::UpdateRoutingTables ();
+      NS_TEST_EXPECT_MSG_EQ (routing->GetNRoutes (), nRoutes + 1, "Routes recomputed without any change");
+      Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+
+      for (uint32_t step = 0; step < 20; step++)
+        {
+          std::pair<Ptr<Ipv4>, uint32_t> interface = interfaces.Get (rng->GetInteger (0, interfaces.GetN () - 1));
+          std::ostringstream change;
+          change << "step " << step << " of topology " << topology << ": ";
+          if (step % 4 == 3)
+            {
+              bool up = !interface.first->IsUp (interface.second);
+              change << "interface " << interface.second << " of node "
+                     << interface.first->GetObject<Node> ()->GetId () << (up ? " up" : " down");
+              if (up)
+                {
+                  interface.first->SetUp (interface.second);
+                }
+              else
+                {
+                  interface.first->SetDown (interface.second);
+                }
+            }
+          else
+            {
+              uint16_t metric = rng->GetInteger (1, 3);
+              change << "metric of interface " << interface.second << " of node "
+                     << interface.first->GetObject<Node> ()->GetId () << " set to " << metric;
+              interface.first->SetMetric (interface.second, metric);
+            }
+          CheckUpdate (nodes, change.str ());
+        }
+
+      Config::SetGlobal ("GlobalRoutingSpfThreads", UintegerValue (1));
+      Simulator::Destroy ();
+    }
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1463,7 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingUpdateTestCase, TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
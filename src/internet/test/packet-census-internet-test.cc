@@ -0,0 +1,149 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <set>
+#include <sstream>
+#include <string>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/packet-census.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/socket.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/nstime.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * Check that the packets created by the internet stack are attributed
+ * to the protocol which created them: the ARP request to ArpL3Protocol
+ * and the TCP handshake to TcpSocketBase.
+ */
+class PacketCensusInternetTestCase : public TestCase
+{
+public:
+  PacketCensusInternetTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Record the creators of the live packets.
+   * \param [in] snapshot The snapshot.
+   */
+  void Record (const PacketCensus::Snapshot &snapshot);
+  /**
+   * Accept the connection.
+   * \param [in] socket The new socket.
+   * \param [in] from The address of the peer.
+   */
+  void Accept (Ptr<Socket> socket, const Address &from);
+
+  std::set<std::string> m_creators;  //!< Creating contexts seen.
+  Ptr<Socket> m_accepted;            //!< The accepted socket.
+};
+
+PacketCensusInternetTestCase::PacketCensusInternetTestCase ()
+  : TestCase ("Check the creators of the packets of the internet stack")
+{
+}
+
+void
+PacketCensusInternetTestCase::Record (const PacketCensus::Snapshot &snapshot)
+{
+  for (std::map<std::string, PacketCensus::Usage>::const_iterator i = snapshot.creators.begin ();
+       i != snapshot.creators.end (); ++i)
+    {
+      m_creators.insert (i->first);
+    }
+}
+
+void
+PacketCensusInternetTestCase::Accept (Ptr<Socket> socket, const Address &from)
+{
+  m_accepted = socket;
+}
+
+void
+PacketCensusInternetTestCase::DoRun (void)
+{
+  std::ostringstream report;
+  PacketCensus::SetReportStream (&report);
+  PacketCensus::Enable ();
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  // keep the packets in flight long enough to be seen by the snapshots
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (10)));
+  SimpleNetDeviceHelper simpleHelper;
+  NetDeviceContainer devices = simpleHelper.Install (nodes, channel);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  Ptr<Socket> server = Socket::CreateSocket (nodes.Get (1), TcpSocketFactory::GetTypeId ());
+  server->Bind (InetSocketAddress (Ipv4Address::GetAny (), 1234));
+  server->Listen ();
+  server->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                             MakeCallback (&PacketCensusInternetTestCase::Accept, this));
+  Ptr<Socket> client = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
+  client->Bind ();
+  Simulator::Schedule (Seconds (1), &Socket::Connect, client,
+                       Address (InetSocketAddress (interfaces.GetAddress (1), 1234)));
+
+  PacketCensus::ScheduleSnapshots (MilliSeconds (1), MakeCallback (&PacketCensusInternetTestCase::Record, this));
+  Simulator::Stop (Seconds (2));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_NE (m_accepted, 0, "Connection not established");
+  NS_TEST_EXPECT_MSG_EQ (m_creators.count ("ns3::ArpL3Protocol"), 1, "ARP request not attributed to ArpL3Protocol");
+  NS_TEST_EXPECT_MSG_EQ (m_creators.count ("ns3::TcpSocketBase"), 1, "TCP segments not attributed to TcpSocketBase");
+
+  client->Close ();
+  m_accepted = 0;
+  Simulator::Destroy ();
+  PacketCensus::Disable ();
+  PacketCensus::SetReportStream (&std::clog);
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Packet census of the internet stack TestSuite
+ */
+class PacketCensusInternetTestSuite : public TestSuite
+{
+public:
+  PacketCensusInternetTestSuite ();
+};
+
+PacketCensusInternetTestSuite::PacketCensusInternetTestSuite ()
+  : TestSuite ("packet-census-internet", UNIT)
+{
+  AddTestCase (new PacketCensusInternetTestCase, TestCase::QUICK);
+}
+
+static PacketCensusInternetTestSuite g_packetCensusInternetTestSuite; //!< Static variable for test initialization
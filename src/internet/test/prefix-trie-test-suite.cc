@@ -0,0 +1,279 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/prefix-trie.h"
+#include "ns3/random-variable-stream.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief PrefixTrie insertion, removal and entry order test.
+ */
+class PrefixTrieBasicTestCase : public TestCase
+{
+public:
+  PrefixTrieBasicTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PrefixTrieBasicTestCase::PrefixTrieBasicTestCase ()
+  : TestCase ("PrefixTrie insertion, removal and entry order")
+{
+}
+
+void
+PrefixTrieBasicTestCase::DoRun (void)
+{
+  typedef PrefixTrie<int, 4> Trie;
+  Trie trie;
+  const uint8_t net10[4] = { 10, 0, 0, 0 };
+  const uint8_t net10_1[4] = { 10, 1, 0, 0 };
+  const uint8_t host[4] = { 10, 1, 2, 3 };
+  const uint8_t other[4] = { 192, 168, 0, 1 };
+  const uint8_t any[4] = { 0, 0, 0, 0 };
+
+  trie.Insert (net10_1, 16, 1);
+  trie.Insert (net10, 8, 2);
+  trie.Insert (any, 0, 3);
+  trie.Insert (net10_1, 16, 4);
+  // the bits beyond the length are ignored
+  trie.Insert (host, 16, 5);
+
+  const Trie::Entries *entries = trie.Find (net10_1, 16);
+  NS_TEST_ASSERT_MSG_NE (entries, 0, "10.1/16 not found");
+  NS_TEST_ASSERT_MSG_EQ (entries->size (), 3, "wrong number of entries");
+  NS_TEST_EXPECT_MSG_EQ ((*entries)[0], 1, "entries out of order");
+  NS_TEST_EXPECT_MSG_EQ ((*entries)[1], 4, "entries out of order");
+  NS_TEST_EXPECT_MSG_EQ ((*entries)[2], 5, "entries out of order");
+  NS_TEST_EXPECT_MSG_EQ (trie.Find (net10_1, 12), 0, "unexpected 10.0/12");
+  NS_TEST_EXPECT_MSG_EQ (trie.Find (other, 32), 0, "unexpected 192.168.0.1/32");
+
+  std::vector<uint8_t> lengths;
+  trie.Lookup (host, [&] (uint8_t length, const Trie::Entries &)
+  {
+    lengths.push_back (length);
+    return true;
+  });
+  NS_TEST_ASSERT_MSG_EQ (lengths.size (), 3, "wrong number of matching prefixes");
+  NS_TEST_EXPECT_MSG_EQ (uint32_t (lengths[0]), 16, "prefixes out of order");
+  NS_TEST_EXPECT_MSG_EQ (uint32_t (lengths[1]), 8, "prefixes out of order");
+  NS_TEST_EXPECT_MSG_EQ (uint32_t (lengths[2]), 0, "prefixes out of order");
+
+  // the visitor stops the lookup
+  lengths.clear ();
+  trie.Lookup (host, [&] (uint8_t length, const Trie::Entries &)
+  {
+    lengths.push_back (length);
+    return false;
+  });
+  NS_TEST_EXPECT_MSG_EQ (lengths.size (), 1, "lookup not stopped");
+
+  NS_TEST_EXPECT_MSG_EQ (trie.Remove (net10_1, 16, 6), false, "removed a missing entry");
+  NS_TEST_EXPECT_MSG_EQ (trie.Remove (net10_1, 24, 1), false, "removed from a missing prefix");
+  NS_TEST_EXPECT_MSG_EQ (trie.Remove (net10_1, 16, 4), true, "entry not removed");
+  entries = trie.Find (net10_1, 16);
+  NS_TEST_ASSERT_MSG_NE (entries, 0, "10.1/16 not found");
+  NS_TEST_ASSERT_MSG_EQ (entries->size (), 2, "wrong number of entries");
+  NS_TEST_EXPECT_MSG_EQ ((*entries)[0], 1, "entries out of order");
+  NS_TEST_EXPECT_MSG_EQ ((*entries)[1], 5, "entries out of order");
+
+  NS_TEST_EXPECT_MSG_EQ (trie.Remove (net10, 8, 2), true, "entry not removed");
+  NS_TEST_EXPECT_MSG_EQ (trie.Find (net10, 8), 0, "10/8 not removed");
+  NS_TEST_EXPECT_MSG_NE (trie.Find (net10_1, 16), 0, "10.1/16 removed with 10/8");
+
+  trie.Clear ();
+  NS_TEST_EXPECT_MSG_EQ (trie.Find (any, 0), 0, "trie not cleared");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief PrefixTrie test against an exhaustive search of the prefixes.
+ */
+class PrefixTrieRandomTestCase : public TestCase
+{
+public:
+  PrefixTrieRandomTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /** A prefix and its entry. */
+  struct Prefix
+  {
+    uint8_t key[4];  //!< The prefix.
+    uint8_t length;  //!< The length of the prefix.
+    uint32_t entry;  //!< The entry.
+  };
+
+  /**
+   * \param [in] prefix A prefix.
+   * \param [in] key An address.
+   * \returns true if the prefix matches the address.
+   */
+  static bool IsMatch (const Prefix &prefix, const uint8_t *key);
+  /**
+   * \brief Check the lookup of an address against an exhaustive search.
+   * \param [in] trie The trie.
+   * \param [in] prefixes The prefixes of the trie.
+   * \param [in] key The address.
+   */
+  void CheckLookup (const PrefixTrie<uint32_t, 4> &trie,
+                    const std::vector<Prefix> &prefixes, const uint8_t *key);
+};
+
+PrefixTrieRandomTestCase::PrefixTrieRandomTestCase ()
+  : TestCase ("PrefixTrie lookup of random prefixes")
+{
+}
+
+bool
+PrefixTrieRandomTestCase::IsMatch (const Prefix &prefix, const uint8_t *key)
+{
+  for (uint32_t i = 0; i < prefix.length; i++)
+    {
+      uint8_t bit = 0x80 >> (i % 8);
+      if ((prefix.key[i / 8] & bit) != (key[i / 8] & bit))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+PrefixTrieRandomTestCase::CheckLookup (const PrefixTrie<uint32_t, 4> &trie,
+                                       const std::vector<Prefix> &prefixes,
+                                       const uint8_t *key)
+{
+  // the matching entries, from the longest prefix to the shortest, and
+  // in insertion order for a given prefix
+  std::vector<uint32_t> expected;
+  for (int32_t length = 32; length >= 0; length--)
+    {
+      for (std::vector<Prefix>::const_iterator it = prefixes.begin (); it != prefixes.end (); it++)
+        {
+          if (it->length == length && IsMatch (*it, key))
+            {
+              expected.push_back (it->entry);
+            }
+        }
+    }
+  std::vector<uint32_t> found;
+  trie.Lookup (key, [&] (uint8_t length, const PrefixTrie<uint32_t, 4>::Entries &entries)
+  {
+    found.insert (found.end (), entries.begin (), entries.end ());
+    return true;
+  });
+  NS_TEST_ASSERT_MSG_EQ (found.size (), expected.size (), "wrong number of matching entries");
+  for (uint32_t i = 0; i < found.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (found[i], expected[i], "wrong matching entry " << i);
+    }
+}
+
+void
+PrefixTrieRandomTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+  PrefixTrie<uint32_t, 4> trie;
+  std::vector<Prefix> prefixes;
+
+  // few distinct leading bytes, so that the prefixes overlap
+  for (uint32_t i = 0; i < 500; i++)
+    {
+      Prefix prefix;
+      prefix.key[0] = 10 + rng->GetInteger (0, 1);
+      prefix.key[1] = rng->GetInteger (0, 3);
+      prefix.key[2] = rng->GetInteger (0, 255);
+      prefix.key[3] = rng->GetInteger (0, 255);
+      prefix.length = rng->GetInteger (0, 32);
+      prefix.entry = i;
+      prefixes.push_back (prefix);
+      trie.Insert (prefix.key, prefix.length, prefix.entry);
+    }
+
+  for (uint32_t round = 0; round < 2; round++)
+    {
+      for (uint32_t i = 0; i < 200; i++)
+        {
+          // addresses close to the prefixes, and the prefixes themselves
+          uint8_t key[4];
+          if (i % 2 == 0)
+            {
+              key[0] = 10 + rng->GetInteger (0, 1);
+              key[1] = rng->GetInteger (0, 3);
+              key[2] = rng->GetInteger (0, 255);
+              key[3] = rng->GetInteger (0, 255);
+            }
+          else
+            {
+              const Prefix &prefix = prefixes[rng->GetInteger (0, prefixes.size () - 1)];
+              memcpy (key, prefix.key, 4);
+            }
+          CheckLookup (trie, prefixes, key);
+        }
+
+      // remove half of the prefixes, and check again
+      for (uint32_t i = 0; i < prefixes.size (); i++)
+        {
+          bool removed = trie.Remove (prefixes[i].key, prefixes[i].length, prefixes[i].entry);
+          NS_TEST_ASSERT_MSG_EQ (removed, true, "prefix " << i << " not removed");
+          prefixes.erase (prefixes.begin () + i);
+        }
+    }
+
+  for (std::vector<Prefix>::const_iterator it = prefixes.begin (); it != prefixes.end (); it++)
+    {
+      trie.Remove (it->key, it->length, it->entry);
+    }
+  uint8_t any[4] = { 0, 0, 0, 0 };
+  std::vector<uint32_t> found;
+  trie.Lookup (any, [&] (uint8_t length, const PrefixTrie<uint32_t, 4>::Entries &entries)
+  {
+    found.insert (found.end (), entries.begin (), entries.end ());
+    return true;
+  });
+  NS_TEST_EXPECT_MSG_EQ (found.size (), 0, "trie not empty");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief PrefixTrie TestSuite
+ */
+class PrefixTrieTestSuite : public TestSuite
+{
+public:
+  PrefixTrieTestSuite ()
+    : TestSuite ("prefix-trie", UNIT)
+  {
+    AddTestCase (new PrefixTrieBasicTestCase, TestCase::QUICK);
+    AddTestCase (new PrefixTrieRandomTestCase, TestCase::QUICK);
+  }
+};
+
+static PrefixTrieTestSuite g_prefixTrieTestSuite; //!< Static variable for test initialization
@@ -53,6 +53,9 @@ private:
   /** \brief Test the logic of merging items in GetTransmittedSegment()
    * which is triggered by CopyFromSequence()*/
   void TestMergeItemsWhenGetTransmittedSegment ();
+  /** \brief Test the scoreboard with a large window and many SACK blocks,
+   * checking that it stays in sync with the sent list */
+  void TestScoreboard ();
   /** \brief Callback to provide a value of receiver window */
   uint32_t GetRWnd (void) const;
 };
@@ -98,6 +101,16 @@ TcpTxBufferTestCase::DoRun ()
   Simulator::Schedule (Seconds (0.0),
                          &TcpTxBufferTestCase::TestMergeItemsWhenGetTransmittedSegment, this);
 
+  /*
+   * Case for the scoreboard:
+   *  -> a large window, in which every other segment is sacked
+   *  -> the holes followed by dupThresh sacked segments are lost, and they
+   *     are retransmitted in order
+   *  -> a cumulative ACK in the middle of the window
+   */
+  Simulator::Schedule (Seconds (0.0),
+                       &TcpTxBufferTestCase::TestScoreboard, this);
+
   Simulator::Run ();
   Simulator::Destroy ();
 }
@@ -382,6 +395,134 @@ TcpTxBufferTestCase::TestMergeItemsWhenGetTransmittedSegment ()
   txBuf.CopyFromSequence (2000, SequenceNumber32(1));
 }
 
+void
+TcpTxBufferTestCase::TestScoreboard ()
+{
+  Ptr<TcpTxBuffer> txBuf = CreateObject<TcpTxBuffer> ();
+  txBuf->SetRWndCallback (MakeCallback (&TcpTxBufferTestCase::GetRWnd, this));
+  SequenceNumber32 head (1);
+  txBuf->SetHeadSequence (head);
+  const uint32_t segmentSize = 100;
+  const uint32_t segments = 1000;
+  txBuf->SetSegmentSize (segmentSize);
+  txBuf->SetDupAckThresh (3);
+  txBuf->SetMaxBufferSize (2 * segments * segmentSize);
+
+  txBuf->Add (Create<Packet> (segments * segmentSize));
+  for (uint32_t i = 0; i < segments; ++i)
+    {
+      txBuf->CopyFromSequence (segmentSize, head + segmentSize * i);
+      NS_TEST_ASSERT_MSG_EQ (txBuf->IsConsistent (), true, "Out of sync after sending segment " << i);
+    }
+
+  // SACK the odd segments, a few blocks at a time as a receiver would do
+  Ptr<TcpOptionSack> sack = CreateObject<TcpOptionSack> ();
+  for (uint32_t i = 1; i < segments; i += 2)
+    {
+      SequenceNumber32 begin = head + segmentSize * i;
+      sack->AddSackBlock (TcpOptionSack::SackBlock (begin, begin + segmentSize));
+      if (sack->GetNumSackBlocks () == 3)
+        {
+          txBuf->Update (sack->GetSackList ());
+          NS_TEST_ASSERT_MSG_EQ (txBuf->IsConsistent (), true, "Out of sync after the SACK of segment " << i);
+          sack->ClearSackList ();
+        }
+    }
+  txBuf->Update (sack->GetSackList ());
+  NS_TEST_ASSERT_MSG_EQ (txBuf->IsConsistent (), true, "Out of sync after the last SACK");
+
+  // The even segments are lost when at least 3 sacked segments follow them,
+  // i.e., all of them but the last two
+  const uint32_t lost = segments / 2 - 2;
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetSacked (), segments / 2 * segmentSize,
+                         "Wrong amount of sacked bytes");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetLost (), lost * segmentSize,
+                         "Wrong amount of lost bytes");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->BytesInFlight (), 2 * segmentSize,
+                         "Wrong amount of bytes in flight");
+  for (uint32_t i = 0; i < segments; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (txBuf->IsLost (head + segmentSize * i), (i % 2 == 0 && i < 2 * lost),
+                             "Wrong loss state of segment " << i);
+    }
+
+  // The lost segments are retransmitted in order, then the last holes
+  SequenceNumber32 ret;
+  SequenceNumber32 retHigh;
+  for (uint32_t i = 0; i < lost; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (txBuf->NextSeg (&ret, &retHigh, true), true,
+                             "No NextSeq with lost segments");
+      NS_TEST_ASSERT_MSG_EQ (ret, head + segmentSize * 2 * i,
+                             "Different NextSeq than expected for lost segment " << i);
+      txBuf->CopyFromSequence (segmentSize, ret);
+      NS_TEST_ASSERT_MSG_EQ (txBuf->IsConsistent (), true, "Out of sync after retransmitting segment " << 2 * i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf->BytesInFlight (), (lost + 2) * segmentSize,
+                         "Wrong amount of bytes in flight after retransmissions");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->NextSeg (&ret, &retHigh, true), true,
+                         "No NextSeq per rule 3");
+  NS_TEST_ASSERT_MSG_EQ (ret, head + segmentSize * 2 * lost,
+                         "Different NextSeq than expected per rule 3");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->NextSeg (&ret, &retHigh, false), false,
+                         "NextSeq per rule 3 out of recovery");
+
+  NS_TEST_ASSERT_MSG_EQ (txBuf->IsRetransmittedDataAcked (head + segmentSize), true,
+                         "The end of a retransmitted segment is not detected");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->IsRetransmittedDataAcked (head + segmentSize * 2), false,
+                         "The end of a sacked segment is detected");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->IsRetransmittedDataAcked (head + segmentSize / 2), false,
+                         "The middle of a segment is detected");
+
+  // A cumulative ACK in the middle of the window, and one more SACK block
+  // above the last holes, which are lost now
+  head = head + segmentSize * segments / 2;
+  txBuf->DiscardUpTo (head);
+  NS_TEST_ASSERT_MSG_EQ (txBuf->IsConsistent (), true, "Out of sync after the cumulative ACK");
+  const uint32_t left = segments / 2;
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetSacked (), left / 2 * segmentSize,
+                         "Wrong amount of sacked bytes after the cumulative ACK");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetLost (), (left / 2 - 2) * segmentSize,
+                         "Wrong amount of lost bytes after the cumulative ACK");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->IsLost (head), true,
+                         "The lost head is not lost anymore");
+
+  txBuf->Add (Create<Packet> (4 * segmentSize));
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      txBuf->CopyFromSequence (segmentSize, head + segmentSize * (left + i));
+      NS_TEST_ASSERT_MSG_EQ (txBuf->IsConsistent (), true, "Out of sync after sending new segment " << i);
+    }
+  sack->ClearSackList ();
+  sack->AddSackBlock (TcpOptionSack::SackBlock (head + segmentSize * (left + 1),
+                                                head + segmentSize * (left + 4)));
+  txBuf->Update (sack->GetSackList ());
+  NS_TEST_ASSERT_MSG_EQ (txBuf->IsConsistent (), true, "Out of sync after the SACK of the new segments");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->IsLost (head + segmentSize * (left - 2)), true,
+                         "A hole followed by 3 sacked segments is not lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->NextSeg (&ret, &retHigh, true), true,
+                         "No NextSeq with the last holes lost");
+  NS_TEST_ASSERT_MSG_EQ (ret, head + segmentSize * (left - 4),
+                         "Different NextSeq than expected for the last holes");
+
+  // A retransmission timeout marks every unsacked segment as lost, then
+  // every segment when the SACK information is discarded
+  txBuf->SetSentListLost ();
+  NS_TEST_ASSERT_MSG_EQ (txBuf->IsConsistent (), true, "Out of sync after marking the sent list lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetLost (), (left / 2 + 1) * segmentSize,
+                         "Wrong amount of lost bytes after marking the sent list lost");
+  txBuf->SetSentListLost (true);
+  NS_TEST_ASSERT_MSG_EQ (txBuf->IsConsistent (), true, "Out of sync after resetting the SACK information");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetSacked (), 0, "Sacked bytes after resetting the SACK information");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetLost (), (left + 4) * segmentSize,
+                         "Wrong amount of lost bytes after resetting the SACK information");
+
+  txBuf->DiscardUpTo (head + segmentSize * (left + 4));
+  NS_TEST_ASSERT_MSG_EQ (txBuf->IsConsistent (), true, "Out of sync after acknowledging everything");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->Size (), 0, "Data inside the buffer");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->BytesInFlight (), 0, "Bytes in flight in an empty buffer");
+}
+
 void
 TcpTxBufferTestCase::TestTransmittedBlock ()
 {
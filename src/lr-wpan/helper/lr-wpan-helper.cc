@@ -344,6 +344,7 @@ LrWpanHelper::EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, bool pr
     }
 
   PcapHelper pcapHelper;
+  pcapHelper.SetFileFormat (GetPcapFileFormat ());
 
   std::string filename;
   if (explicitFilename)
@@ -355,8 +356,9 @@ LrWpanHelper::EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, bool pr
       filename = pcapHelper.GetFilenameFromDevice (prefix, device);
     }
 
-  Ptr<PcapFileWrapper> file = pcapHelper.CreateFile (filename, std::ios::out,
-                                                     PcapHelper::DLT_IEEE802_15_4);
+  Ptr<PcapFileWrapper> file = pcapHelper.CreateFile (filename, std::ios::out, PcapHelper::DLT_IEEE802_15_4,
+                                                     std::numeric_limits<uint32_t>::max (), 0,
+                                                     pcapHelper.GetInterfaceNameFromDevice (device));
 
   if (promiscuous == true)
     {
@@ -110,6 +110,7 @@ DistributedSimulatorImpl::DistributedSimulatorImpl ()
   m_currentContext = Simulator::NO_CONTEXT;
   m_unscheduledEvents = 0;
   m_eventCount = 0;
+  m_cancelledEvents = 0;
   m_events = 0;
 }
 
@@ -311,6 +312,10 @@ DistributedSimulatorImpl::ProcessOneEvent (void)
   NS_ASSERT (next.key.m_ts >= m_currentTs);
   m_unscheduledEvents--;
   m_eventCount++;
+  if (m_cancelledEvents > 0 && next.impl->IsCancelled ())
+    {
+      m_cancelledEvents--;
+    }
 
   NS_LOG_LOGIC ("handle " << next.key.m_ts);
   m_currentTs = next.key.m_ts;
@@ -578,6 +583,10 @@ DistributedSimulatorImpl::Cancel (const EventId &id)
   if (!IsExpired (id))
     {
       id.PeekEventImpl ()->Cancel ();
+      if (id.GetUid () != 2)
+        {
+          m_cancelledEvents++;
+        }
     }
 }
 
@@ -635,4 +644,16 @@ DistributedSimulatorImpl::GetEventCount (void) const
   return m_eventCount;
 }
 
+uint64_t
+DistributedSimulatorImpl::GetLiveEventCount (void) const
+{
+  return m_unscheduledEvents - m_cancelledEvents;
+}
+
+uint64_t
+DistributedSimulatorImpl::GetCancelledEventCount (void) const
+{
+  return m_cancelledEvents;
+}
+
 } // namespace ns3
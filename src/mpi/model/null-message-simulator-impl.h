@@ -72,6 +72,8 @@ public:
   virtual uint32_t GetSystemId (void) const;
   virtual uint32_t GetContext (void) const;
   virtual uint64_t GetEventCount (void) const;
+  virtual uint64_t GetLiveEventCount (void) const;
+  virtual uint64_t GetCancelledEventCount (void) const;
 
   /**
    * \return singleton instance
@@ -182,6 +184,8 @@ private:
   // number of events that have been inserted but not yet scheduled,
   // not counting the "destroy" events; this is used for validation
   int m_unscheduledEvents;
+  // number of cancelled events still in the event list
+  uint64_t m_cancelledEvents;
 
   uint32_t     m_myId;        // MPI Rank
   uint32_t     m_systemCount; // MPI Size
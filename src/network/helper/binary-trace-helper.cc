@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "binary-trace-helper.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BinaryTraceHelper");
+
+BinaryTraceHelper::BinaryTraceHelper ()
+  : m_chunkSize (16384),
+    m_async (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+BinaryTraceHelper::SetChunkSize (uint32_t chunkSize)
+{
+  NS_LOG_FUNCTION (this << chunkSize);
+  m_chunkSize = chunkSize;
+}
+
+void
+BinaryTraceHelper::SetAsyncWrite (bool async)
+{
+  NS_LOG_FUNCTION (this << async);
+  m_async = async;
+}
+
+Ptr<BinaryTraceWriter>
+BinaryTraceHelper::CreateFile (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  Ptr<BinaryTraceWriter> file = Create<BinaryTraceWriter> (filename, m_chunkSize, m_async);
+  NS_ABORT_MSG_IF (file->Fail (), "Unable to Open " << filename);
+  return file;
+}
+
+void
+BinaryTraceHelper::EnableBinary (Ptr<BinaryTraceWriter> file, Ptr<NetDevice> nd)
+{
+  NS_LOG_FUNCTION (this << file << nd);
+  Source source;
+  source.node = nd->GetNode ()->GetId ();
+  source.device = nd->GetIfIndex ();
+
+  source.kind = BinaryTraceWriter::RECEIVE;
+  Hook (nd, "MacRx", file, source);
+  source.kind = BinaryTraceWriter::DROP;
+  Hook (nd, "PhyRxDrop", file, source);
+
+  TypeId::AttributeInformation info;
+  if (nd->GetInstanceTypeId ().LookupAttributeByName ("TxQueue", &info))
+    {
+      PointerValue queue;
+      nd->GetAttribute ("TxQueue", queue);
+      Ptr<Object> txq = queue.GetObject ();
+      if (txq != 0)
+        {
+          source.kind = BinaryTraceWriter::ENQUEUE;
+          Hook (txq, "Enqueue", file, source);
+          source.kind = BinaryTraceWriter::DEQUEUE;
+          Hook (txq, "Dequeue", file, source);
+          source.kind = BinaryTraceWriter::DROP;
+          Hook (txq, "Drop", file, source);
+        }
+    }
+}
+
+void
+BinaryTraceHelper::EnableBinary (Ptr<BinaryTraceWriter> file, NetDeviceContainer d)
+{
+  NS_LOG_FUNCTION (this << file);
+  for (NetDeviceContainer::Iterator i = d.Begin (); i != d.End (); ++i)
+    {
+      EnableBinary (file, *i);
+    }
+}
+
+void
+BinaryTraceHelper::EnableBinary (Ptr<BinaryTraceWriter> file, NodeContainer n)
+{
+  NS_LOG_FUNCTION (this << file);
+  for (NodeContainer::Iterator i = n.Begin (); i != n.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          EnableBinary (file, node->GetDevice (j));
+        }
+    }
+}
+
+void
+BinaryTraceHelper::EnableBinaryAll (Ptr<BinaryTraceWriter> file)
+{
+  NS_LOG_FUNCTION (this << file);
+  EnableBinary (file, NodeContainer::GetGlobal ());
+}
+
+void
+BinaryTraceHelper::Hook (Ptr<Object> object, std::string traceName,
+                         Ptr<BinaryTraceWriter> file, Source source)
+{
+  NS_LOG_FUNCTION (object << traceName << file);
+  if (!object->TraceConnectWithoutContext (traceName, MakeBoundCallback (&BinaryTraceHelper::Sink, file, source)))
+    {
+      NS_LOG_INFO ("No trace source " << traceName << " in " << object->GetInstanceTypeId ().GetName ());
+    }
+}
+
+void
+BinaryTraceHelper::Sink (Ptr<BinaryTraceWriter> file, Source source, Ptr<const Packet> p)
+{
+  file->Write (Simulator::Now (), source.node, source.device, source.kind, p);
+}
+
+} // namespace ns3
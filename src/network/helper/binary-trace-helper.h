@@ -0,0 +1,144 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_TRACE_HELPER_H
+#define BINARY_TRACE_HELPER_H
+
+#include <string>
+#include "ns3/ptr.h"
+#include "ns3/net-device-container.h"
+#include "ns3/node-container.h"
+#include "ns3/binary-trace-file.h"
+
+namespace ns3 {
+
+class Object;
+
+/**
+ * \ingroup network
+ *
+ * \brief Trace the packet events of devices to a binary trace file.
+ *
+ * This helper records the events of the ascii traces of the device
+ * helpers ('+', '-' and 'd' from the transmit queue of the device, 'r'
+ * and 'd' from its MacRx and PhyRxDrop trace sources) as records of a
+ * BinaryTraceWriter instead of formatted text: the packets are not
+ * printed, and the events of all the devices go to a single file, whose
+ * records hold the node id and the device index.  Any device is
+ * supported: the trace sources it lacks are skipped.
+ *
+ * \code
+ *   BinaryTraceHelper binary;
+ *   Ptr<BinaryTraceWriter> file = binary.CreateFile ("trace.bin");
+ *   // the protocol number of IPv4 packets behind a PPP header
+ *   file->AddField ("proto", BinaryTraceWriter::MakeByteField (11, 1));
+ *   binary.EnableBinaryAll (file);
+ * \endcode
+ */
+class BinaryTraceHelper
+{
+public:
+  BinaryTraceHelper ();
+
+  /**
+   * \brief Set the number of records of the chunks of the files created.
+   * \param chunkSize the number of records per chunk
+   */
+  void SetChunkSize (uint32_t chunkSize);
+
+  /**
+   * \brief Set whether the files created are written from a background thread.
+   * \param async true to write from a background thread
+   */
+  void SetAsyncWrite (bool async);
+
+  /**
+   * \brief Create a binary trace file.
+   * \param filename the file name
+   * \returns the file
+   */
+  Ptr<BinaryTraceWriter> CreateFile (std::string filename);
+
+  /**
+   * \brief Trace the events of a device.
+   * \param file the file to write to
+   * \param nd the device
+   */
+  void EnableBinary (Ptr<BinaryTraceWriter> file, Ptr<NetDevice> nd);
+
+  /**
+   * \brief Trace the events of the devices of a container.
+   * \param file the file to write to
+   * \param d the devices
+   */
+  void EnableBinary (Ptr<BinaryTraceWriter> file, NetDeviceContainer d);
+
+  /**
+   * \brief Trace the events of the devices of the nodes of a container.
+   * \param file the file to write to
+   * \param n the nodes
+   */
+  void EnableBinary (Ptr<BinaryTraceWriter> file, NodeContainer n);
+
+  /**
+   * \brief Trace the events of all the devices of all the nodes.
+   * \param file the file to write to
+   */
+  void EnableBinaryAll (Ptr<BinaryTraceWriter> file);
+
+private:
+  /** The origin of the events of a trace source. */
+  struct Source
+  {
+    uint32_t node;                      //!< The node id.
+    uint32_t device;                    //!< The device index.
+    BinaryTraceWriter::EventKind kind;  //!< The kind of the events.
+    /**
+     * Compare with another origin, as required by bound callback arguments.
+     * \param o the other origin
+     * \returns true if the origins differ
+     */
+    bool operator != (const Source &o) const
+    {
+      return node != o.node || device != o.device || kind != o.kind;
+    }
+  };
+
+  /**
+   * \brief Connect a trace source of an object to the sink, if it exists.
+   * \param object the object
+   * \param traceName the name of the trace source
+   * \param file the file to write to
+   * \param source the origin of the events
+   */
+  static void Hook (Ptr<Object> object, std::string traceName,
+                    Ptr<BinaryTraceWriter> file, Source source);
+
+  /**
+   * \brief The trace sink.
+   * \param file the file to write to
+   * \param source the origin of the event
+   * \param p the packet
+   */
+  static void Sink (Ptr<BinaryTraceWriter> file, Source source, Ptr<const Packet> p);
+
+  uint32_t m_chunkSize; //!< The number of records per chunk
+  bool m_async;         //!< Write from a background thread
+};
+
+} // namespace ns3
+
+#endif /* BINARY_TRACE_HELPER_H */
@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-helper.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/simulator.h"
+#include "ns3/channel-list.h"
+#include "ns3/net-device.h"
+#include "ns3/channel.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorHelper");
+
+MultithreadedSimulatorHelper::MultithreadedSimulatorHelper ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultithreadedSimulatorHelper::Assign (NodeContainer c, uint32_t partition)
+{
+  NS_LOG_FUNCTION (this << partition);
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      m_partitions[(*i)->GetId ()] = partition;
+    }
+}
+
+void
+MultithreadedSimulatorHelper::AssignBlocks (NodeContainer c, uint32_t partitions)
+{
+  NS_LOG_FUNCTION (this << partitions);
+  NS_ABORT_MSG_IF (partitions == 0, "At least one partition is needed");
+  uint32_t n = c.GetN ();
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      m_partitions[c.Get (i)->GetId ()] = static_cast<uint32_t> ((static_cast<uint64_t> (i) * partitions) / n);
+    }
+}
+
+uint32_t
+MultithreadedSimulatorHelper::GetPartition (Ptr<Node> node) const
+{
+  std::map<uint32_t, uint32_t>::const_iterator i = m_partitions.find (node->GetId ());
+  return i != m_partitions.end () ? i->second : 0;
+}
+
+bool
+MultithreadedSimulatorHelper::CrossesPartitions (Ptr<Channel> channel) const
+{
+  for (std::size_t i = 1; i < channel->GetNDevices (); ++i)
+    {
+      if (GetPartition (channel->GetDevice (i)->GetNode ())
+          != GetPartition (channel->GetDevice (0)->GetNode ()))
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+Time
+MultithreadedSimulatorHelper::GetLookAhead (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Time lookAhead = Simulator::GetMaximumSimulationTime ();
+  for (ChannelList::Iterator i = ChannelList::Begin (); i != ChannelList::End (); ++i)
+    {
+      Ptr<Channel> channel = *i;
+      if (!CrossesPartitions (channel))
+        {
+          continue;
+        }
+      // Shared medium channels (CSMA, wireless, simple channels) hand
+      // the same packet to every device and cannot cross partitions.
+      if (!channel->SupportsCrossPartition ())
+        {
+          NS_FATAL_ERROR ("Channel " << channel->GetId () << " (" <<
+                          channel->GetInstanceTypeId ().GetName () <<
+                          ") crosses a partition boundary, but does not support it; "
+                          "only point-to-point channels may");
+        }
+      TimeValue delay;
+      channel->GetAttribute ("Delay", delay);
+      if (delay.Get () < lookAhead)
+        {
+          lookAhead = delay.Get ();
+        }
+    }
+  return lookAhead;
+}
+
+Time
+MultithreadedSimulatorHelper::Install (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<MultithreadedSimulatorImpl> impl = DynamicCast<MultithreadedSimulatorImpl> (Simulator::GetImplementation ());
+  NS_ABORT_MSG_IF (impl == 0, "SimulatorImplementationType is not ns3::MultithreadedSimulatorImpl");
+  Time lookAhead = GetLookAhead ();
+  NS_ABORT_MSG_IF (!lookAhead.IsStrictlyPositive (),
+                   "A channel with no delay connects two partitions");
+  for (std::map<uint32_t, uint32_t>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      impl->SetContextPartition (i->first, i->second);
+    }
+  for (ChannelList::Iterator i = ChannelList::Begin (); i != ChannelList::End (); ++i)
+    {
+      if ((*i)->SupportsCrossPartition ())
+        {
+          (*i)->SetCrossPartition (CrossesPartitions (*i));
+        }
+    }
+  NS_LOG_LOGIC ("lookahead " << lookAhead.As (Time::S));
+  impl->SetLookAhead (lookAhead);
+  return lookAhead;
+}
+
+} // namespace ns3
@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef MULTITHREADED_SIMULATOR_HELPER_H
+#define MULTITHREADED_SIMULATOR_HELPER_H
+
+#include "ns3/nstime.h"
+#include "ns3/node-container.h"
+#include "ns3/channel.h"
+
+#include <map>
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief Partition the nodes of a simulation for the
+ * MultithreadedSimulatorImpl.
+ *
+ * The helper maps every node to a partition and computes the
+ * lookahead from the "Delay" attribute of the channels connecting two
+ * partitions, as the MPI DistributedSimulatorImpl does for its
+ * point-to-point remote channels.  The simulator implementation must
+ * have been selected beforehand, and the topology created before
+ * Install () is called:
+ * \code
+ *   GlobalValue::Bind ("SimulatorImplementationType",
+ *                      StringValue ("ns3::MultithreadedSimulatorImpl"));
+ *   // create a point-to-point topology, install the stacks and applications
+ *   MultithreadedSimulatorHelper partitions;
+ *   partitions.AssignBlocks (NodeContainer::GetGlobal (), 4);
+ *   partitions.Install ();
+ *   Simulator::Run ();
+ * \endcode
+ *
+ * Only the channels which Channel::SupportsCrossPartition may cross a
+ * partition boundary, with a strictly positive "Delay" attribute;
+ * Install () calls Channel::SetCrossPartition on them, so that they hand
+ * their packets over to the receiving partition in serialized form.
+ * Currently only ns3::PointToPointChannel does: CSMA, wireless and
+ * simple channels deliver the same packet to every attached device and
+ * are not supported across partitions, so all the nodes of a CSMA
+ * segment must be assigned to the same partition.
+ */
+class MultithreadedSimulatorHelper
+{
+public:
+  MultithreadedSimulatorHelper ();
+
+  /**
+   * Assign nodes to a partition.
+   *
+   * \param c The nodes.
+   * \param partition The partition index.
+   */
+  void Assign (NodeContainer c, uint32_t partition);
+  /**
+   * Split nodes in contiguous blocks of (almost) equal size.
+   *
+   * \param c The nodes, usually NodeContainer::GetGlobal ().
+   * \param partitions The number of blocks.
+   */
+  void AssignBlocks (NodeContainer c, uint32_t partitions);
+  /**
+   * \param node The node.
+   * \return The partition of the node (0 if it was not assigned).
+   */
+  uint32_t GetPartition (Ptr<Node> node) const;
+  /**
+   * Compute the lookahead: the smallest delay of the channels
+   * connecting nodes of different partitions, or the maximum
+   * simulation time if no channel crosses a partition boundary.
+   * Aborts if a channel which does not SupportsCrossPartition (e.g. a
+   * CSMA channel) crosses a partition boundary.
+   *
+   * \return The lookahead.
+   */
+  Time GetLookAhead (void) const;
+  /**
+   * Configure the MultithreadedSimulatorImpl with the partitions of
+   * the nodes and the lookahead, and the channels which
+   * SupportsCrossPartition with whether they cross a partition boundary.
+   *
+   * \return The lookahead.
+   */
+  Time Install (void) const;
+
+private:
+  /**
+   * \param channel The channel.
+   * \return true if the devices of the channel are not all in the same
+   * partition.
+   */
+  bool CrossesPartitions (Ptr<Channel> channel) const;
+
+  /** The partition of each node id. */
+  std::map<uint32_t, uint32_t> m_partitions;
+};
+
+} // namespace ns3
+
+#endif /* MULTITHREADED_SIMULATOR_HELPER_H */
@@ -28,6 +28,7 @@
 #include "ns3/names.h"
 #include "ns3/net-device.h"
 #include "ns3/pcap-file-wrapper.h"
+#include "ns3/pcapng-file.h"
 
 #include "trace-helper.h"
 
@@ -36,6 +37,7 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("TraceHelper");
 
 PcapHelper::PcapHelper ()
+  : m_fileFormat (PCAP)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -51,9 +53,27 @@ PcapHelper::CreateFile (
   std::ios::openmode filemode,
   DataLinkType dataLinkType,
   uint32_t    snapLen, 
-  int32_t     tzCorrection)
+  int32_t     tzCorrection,
+  std::string interfaceName)
 {
-  NS_LOG_FUNCTION (filename << filemode << dataLinkType << snapLen << tzCorrection);
+  NS_LOG_FUNCTION (filename << filemode << dataLinkType << snapLen << tzCorrection << interfaceName);
+
+  std::string const suffix = ".pcapng";
+  if (filename.size () > suffix.size ()
+      && filename.compare (filename.size () - suffix.size (), suffix.size (), suffix) == 0)
+    {
+      Ptr<PcapngFile> ngFile = PcapngFile::Lookup (filename);
+      if (ngFile == 0)
+        {
+          ngFile = Create<PcapngFile> ();
+          ngFile->Open (filename, filemode);
+          NS_ABORT_MSG_IF (ngFile->Fail (), "Unable to Open " << filename << " for mode " << filemode);
+        }
+      Ptr<PcapFileWrapper> file = CreateObject<PcapFileWrapper> ();
+      file->Init (ngFile, dataLinkType, interfaceName, snapLen);
+      NS_ABORT_MSG_IF (file->Fail (), "Unable to Init " << filename);
+      return file;
+    }
 
   Ptr<PcapFileWrapper> file = CreateObject<PcapFileWrapper> ();
   file->Open (filename, filemode);
@@ -105,6 +125,12 @@ PcapHelper::GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> device, bo
       oss << node->GetId ();
     }
 
+  if (m_fileFormat == PCAPNG)
+    {
+      oss << ".pcapng";
+      return oss.str ();
+    }
+
   oss << "-";
 
   if (devicename.size ())
@@ -154,11 +180,104 @@ PcapHelper::GetFilenameFromInterfacePair (std::string prefix, Ptr<Object> object
       oss << "n" << node->GetId ();
     }
 
+  if (m_fileFormat == PCAPNG)
+    {
+      oss << ".pcapng";
+      return oss.str ();
+    }
+
   oss << "-i" << interface << ".pcap";
 
   return oss.str ();
 }
 
+std::string
+PcapHelper::GetInterfaceNameFromDevice (Ptr<NetDevice> device, bool useObjectNames)
+{
+  NS_LOG_FUNCTION (device << useObjectNames);
+
+  std::string nodename;
+  std::string devicename;
+
+  Ptr<Node> node = device->GetNode ();
+
+  if (useObjectNames)
+    {
+      nodename = Names::FindName (node);
+      devicename = Names::FindName (device);
+    }
+
+  if (devicename.size ())
+    {
+      return devicename;
+    }
+
+  std::ostringstream oss;
+
+  if (nodename.size ())
+    {
+      oss << nodename;
+    }
+  else
+    {
+      oss << "node-" << node->GetId ();
+    }
+
+  oss << "-dev-" << device->GetIfIndex ();
+
+  return oss.str ();
+}
+
+std::string
+PcapHelper::GetInterfaceNameFromInterfacePair (Ptr<Object> object, uint32_t interface, bool useObjectNames)
+{
+  NS_LOG_FUNCTION (object << interface << useObjectNames);
+
+  std::ostringstream oss;
+
+  std::string objname;
+  std::string nodename;
+
+  Ptr<Node> node = object->GetObject<Node> ();
+
+  if (useObjectNames)
+    {
+      objname = Names::FindName (object);
+      nodename = Names::FindName (node);
+    }
+
+  if (objname.size ())
+    {
+      oss << objname;
+    }
+  else if (nodename.size ())
+    {
+      oss << nodename;
+    }
+  else
+    {
+      oss << "node-" << node->GetId ();
+    }
+
+  oss << "-if-" << interface;
+
+  return oss.str ();
+}
+
+void
+PcapHelper::SetFileFormat (FileFormat format)
+{
+  NS_LOG_FUNCTION (this << format);
+  m_fileFormat = format;
+}
+
+PcapHelper::FileFormat
+PcapHelper::GetFileFormat (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_fileFormat;
+}
+
 //
 // The basic default trace sink.  This one just writes the packet to the pcap
 // file which is good enough for most kinds of captures.
@@ -397,6 +516,18 @@ AsciiTraceHelper::DefaultReceiveSinkWithContext (Ptr<OutputStreamWrapper> stream
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
+void
+PcapHelperForDevice::SetPcapFileFormat (PcapHelper::FileFormat format)
+{
+  m_pcapFileFormat = format;
+}
+
+PcapHelper::FileFormat
+PcapHelperForDevice::GetPcapFileFormat (void) const
+{
+  return m_pcapFileFormat;
+}
+
 void 
 PcapHelperForDevice::EnablePcap (std::string prefix, Ptr<NetDevice> nd, bool promiscuous, bool explicitFilename)
 {
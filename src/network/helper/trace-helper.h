@@ -60,6 +60,14 @@ public:
     DLT_NETLINK = 253
   };
 
+  /**
+   * The format of the files named by the pcap helpers.
+   */
+  enum FileFormat {
+    PCAP,     //!< One pcap file per device or interface
+    PCAPNG    //!< One pcapng file per node, with one interface per device or interface
+  };
+
   /**
    * @brief Create a pcap helper.
    */
@@ -70,9 +78,31 @@ public:
    */
   ~PcapHelper ();
 
+  /**
+   * @brief Set the format of the files named by this pcap helper.
+   *
+   * In PCAPNG mode, the filenames returned by GetFilenameFromDevice and
+   * GetFilenameFromInterfacePair no longer depend on the device or on the
+   * interface, so that all the traces of a node enabled with the same
+   * prefix share a single file, which saves file descriptors in large
+   * simulations.
+   *
+   * @param format the file format
+   */
+  void SetFileFormat (FileFormat format);
+
+  /**
+   * @brief Get the format of the files named by this pcap helper.
+   *
+   * @returns the file format
+   */
+  FileFormat GetFileFormat (void) const;
+
   /**
    * @brief Let the pcap helper figure out a reasonable filename to use for a
    * pcap file associated with a device.
+   *
+   * In PCAPNG mode, the filename only depends on the node of the device.
    * 
    * @param prefix prefix string
    * @param device NetDevice
@@ -84,6 +114,8 @@ public:
   /**
    * @brief Let the pcap helper figure out a reasonable filename to use for the
    * pcap file associated with a node.
+   *
+   * In PCAPNG mode, the filename does not depend on the interface.
    * 
    * @param prefix prefix string
    * @param object interface (such as Ipv4Interface or Ipv6Interface)
@@ -94,21 +126,51 @@ public:
   std::string GetFilenameFromInterfacePair (std::string prefix, Ptr<Object> object, 
                                             uint32_t interface, bool useObjectNames = true);
 
+  /**
+   * @brief Let the pcap helper figure out a name for the interface of a
+   * pcapng file associated with a device.
+   *
+   * @param device NetDevice
+   * @param useObjectNames use node and device names instead of indexes
+   * @returns the name of the device if it has one, "node-N-dev-M" otherwise
+   */
+  std::string GetInterfaceNameFromDevice (Ptr<NetDevice> device, bool useObjectNames = true);
+
+  /**
+   * @brief Let the pcap helper figure out a name for the interface of a
+   * pcapng file associated with an interface pair.
+   *
+   * @param object interface (such as Ipv4Interface or Ipv6Interface)
+   * @param interface interface id
+   * @param useObjectNames use node names instead of indexes
+   * @returns "node-N-if-M", where N is the name of the object or of its node
+   * if any
+   */
+  std::string GetInterfaceNameFromInterfacePair (Ptr<Object> object, uint32_t interface,
+                                                 bool useObjectNames = true);
+
   /**
    * @brief Create and initialize a pcap file.
+   *
+   * If the filename ends with ".pcapng", the returned wrapper writes to a
+   * new interface of that pcapng file, named after interfaceName, which is
+   * created by the first call and shared by the next ones while it is open;
+   * the time zone correction is then ignored.
    * 
    * @param filename file name
    * @param filemode file mode
    * @param dataLinkType data link type of packet data
    * @param snapLen maximum length of packet data stored in records
    * @param tzCorrection time zone correction to be applied to timestamps of packets
+   * @param interfaceName name of the interface of a pcapng file
    * @returns a smart pointer to the Pcap file
    */
   Ptr<PcapFileWrapper> CreateFile (std::string filename,
                                    std::ios::openmode filemode,
                                    DataLinkType dataLinkType,
                                    uint32_t snapLen = std::numeric_limits<uint32_t>::max (),
-                                   int32_t tzCorrection = 0);
+                                   int32_t tzCorrection = 0,
+                                   std::string interfaceName = "");
   /**
    * @brief Hook a trace source to the default trace sink
    * 
@@ -141,6 +203,8 @@ private:
    * @see DefaultSink
    */
   static void SinkWithHeader (Ptr<PcapFileWrapper> file, const Header& header, Ptr<const Packet> p);
+
+  FileFormat m_fileFormat; //!< The format of the files named by this pcap helper
 };
 
 template <typename T> void
@@ -555,13 +619,32 @@ public:
   /**
    * @brief Construct a PcapHelperForDevice
    */
-  PcapHelperForDevice () {}
+  PcapHelperForDevice () : m_pcapFileFormat (PcapHelper::PCAP) {}
 
   /**
    * @brief Destroy a PcapHelperForDevice
    */
   virtual ~PcapHelperForDevice () {}
 
+  /**
+   * @brief Set the format of the pcap files of this helper.
+   *
+   * In PCAPNG mode, the traces of the devices of a node enabled with the
+   * same prefix share a single pcapng file, with an interface per device
+   * named after the device (see PcapHelper::GetInterfaceNameFromDevice).
+   * Set the format before enabling the traces.
+   *
+   * @param format the file format
+   */
+  void SetPcapFileFormat (PcapHelper::FileFormat format);
+
+  /**
+   * @brief Get the format of the pcap files of this helper.
+   *
+   * @returns the file format
+   */
+  PcapHelper::FileFormat GetPcapFileFormat (void) const;
+
   /**
    * @brief Enable pcap output the indicated net device.
    *
@@ -632,6 +715,9 @@ public:
    * @param promiscuous If true capture all possible packets available at the device.
    */
   void EnablePcapAll (std::string prefix, bool promiscuous = false);
+
+private:
+  PcapHelper::FileFormat m_pcapFileFormat; //!< The format of the pcap files
 };
 
 /**
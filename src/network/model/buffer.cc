@@ -18,6 +18,7 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "buffer.h"
+#include "packet-allocator.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
 
@@ -50,98 +51,54 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Buffer");
 
 
-uint32_t Buffer::g_recommendedStart = 0;
+thread_local uint32_t Buffer::g_recommendedStart = 0;
 #ifdef BUFFER_FREE_LIST
-/* The following macros are pretty evil but they are needed to allow us to
- * keep track of 3 possible states for the g_freeList variable:
- *  - uninitialized means that no one has created a buffer yet
- *    so no one has created the associated free list (it is created
- *    on-demand when the first buffer is created)
- *  - initialized means that the free list exists and is valid
- *  - destroyed means that the static destructors of this compilation unit
- *    have run so, the free list has been cleared from its content
- * The key is that in destroyed state, we are careful not re-create it
- * which is a typical weakness of lazy evaluation schemes which use 
- * '0' as a special value to indicate both un-initialized and destroyed.
- * Note that it is important to use '0' as the marker for un-initialized state
- * because the variable holding this state information is initialized to zero
- * which the compiler assigns to zero-memory which is initialized to _zero_
- * before the constructors run so this ensures perfect handling of crazy 
- * constructor orderings.
- */
-#define MAGIC_DESTROYED (~(long) 0)
-#define IS_UNINITIALIZED(x) (x == (Buffer::FreeList*)0)
-#define IS_DESTROYED(x) (x == (Buffer::FreeList*)MAGIC_DESTROYED)
-#define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
-#define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
-#define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
-struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
-
-Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
-{
-  NS_LOG_FUNCTION (this);
-  if (IS_INITIALIZED (g_freeList))
-    {
-      for (Buffer::FreeList::iterator i = g_freeList->begin ();
-           i != g_freeList->end (); i++)
-        {
-          Buffer::Deallocate (*i);
-        }
-      delete g_freeList;
-      g_freeList = DESTROYED;
-    }
-}
+thread_local uint32_t Buffer::g_maxSize = 0;
 
 void
 Buffer::Recycle (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
-  NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
   g_maxSize = std::max (g_maxSize, data->m_size);
-  /* feed into free list */
-  if (data->m_size < g_maxSize ||
-      IS_DESTROYED (g_freeList) ||
-      g_freeList->size () > 1000)
-    {
-      Buffer::Deallocate (data);
-    }
-  else
-    {
-      NS_ASSERT (IS_INITIALIZED (g_freeList));
-      g_freeList->push_back (data);
-    }
+  Buffer::Deallocate (data);
 }
 
 Buffer::Data *
 Buffer::Create (uint32_t dataSize)
 {
   NS_LOG_FUNCTION (dataSize);
-  /* try to find a buffer correctly sized. */
-  if (IS_UNINITIALIZED (g_freeList))
-    {
-      g_freeList = new Buffer::FreeList ();
-    }
-  else if (IS_INITIALIZED (g_freeList))
+  /* allocate buffers as large as the largest buffer released so far,
+   * so that they can hold the headers added to them without being
+   * resized. */
+  return Buffer::Allocate (std::max (dataSize, g_maxSize));
+}
+
+struct Buffer::Data *
+Buffer::Allocate (uint32_t reqSize)
+{
+  NS_LOG_FUNCTION (reqSize);
+  if (reqSize == 0) 
     {
-      while (!g_freeList->empty ()) 
-        {
-          struct Buffer::Data *data = g_freeList->back ();
-          g_freeList->pop_back ();
-          if (data->m_size >= dataSize) 
-            {
-              data->m_count = 1;
-              return data;
-            }
-          Buffer::Deallocate (data);
-        }
+      reqSize = 1;
     }
-  struct Buffer::Data *data = Buffer::Allocate (dataSize);
-  NS_ASSERT (data->m_count == 1);
+  NS_ASSERT (reqSize >= 1);
+  uint32_t size = reqSize - 1 + sizeof (struct Buffer::Data);
+  uint32_t capacity = PacketAllocator::GetCapacity (size);
+  void *b = PacketAllocator::Allocate (size);
+  struct Buffer::Data *data = static_cast<struct Buffer::Data*> (b);
+  data->m_size = capacity + 1 - sizeof (struct Buffer::Data);
+  data->m_count = 1;
   return data;
 }
+
+void
+Buffer::Deallocate (struct Buffer::Data *data)
+{
+  NS_LOG_FUNCTION (data);
+  NS_ASSERT (data->m_count == 0);
+  PacketAllocator::Deallocate (data, data->m_size - 1 + sizeof (struct Buffer::Data));
+}
 #else /* BUFFER_FREE_LIST */
 void
 Buffer::Recycle (struct Buffer::Data *data)
@@ -157,7 +114,6 @@ Buffer::Create (uint32_t size)
   NS_LOG_FUNCTION (size);
   return Allocate (size);
 }
-#endif /* BUFFER_FREE_LIST */
 
 struct Buffer::Data *
 Buffer::Allocate (uint32_t reqSize)
@@ -184,6 +140,7 @@ Buffer::Deallocate (struct Buffer::Data *data)
   uint8_t *buf = reinterpret_cast<uint8_t *> (data);
   delete [] buf;
 }
+#endif /* BUFFER_FREE_LIST */
 
 Buffer::Buffer ()
 {
@@ -221,7 +178,7 @@ Buffer::CheckInternalState (void) const
     m_zeroAreaEnd <= m_end;
   bool dirtyOk =
     m_start >= m_data->m_dirtyStart &&
-    m_end <= m_data->m_dirtyEnd;
+    GetInternalEnd () <= m_data->m_dirtyEnd;
   bool internalSizeOk = m_end - (m_zeroAreaEnd - m_zeroAreaStart) <= m_data->m_size &&
     m_start <= m_data->m_size &&
     m_zeroAreaStart <= m_data->m_size;
@@ -251,7 +208,7 @@ Buffer::Initialize (uint32_t zeroSize)
   m_zeroAreaEnd = m_zeroAreaStart + zeroSize;
   m_end = m_zeroAreaEnd;
   m_data->m_dirtyStart = m_start;
-  m_data->m_dirtyEnd = m_end;
+  m_data->m_dirtyEnd = GetInternalEnd ();
   NS_ASSERT (CheckInternalState ());
 }
 
@@ -344,7 +301,7 @@ Buffer::AddAtStart (uint32_t start)
 
       // update dirty area
       m_data->m_dirtyStart = m_start;
-      m_data->m_dirtyEnd = m_end;
+      m_data->m_dirtyEnd = GetInternalEnd ();
     }
   m_maxZeroAreaStart = std::max (m_maxZeroAreaStart, m_zeroAreaStart);
   LOG_INTERNAL_STATE ("add start=" << start << ", ");
@@ -355,7 +312,7 @@ Buffer::AddAtEnd (uint32_t end)
 {
   NS_LOG_FUNCTION (this << end);
   NS_ASSERT (CheckInternalState ());
-  bool isDirty = m_data->m_count > 1 && m_end < m_data->m_dirtyEnd;
+  bool isDirty = m_data->m_count > 1 && GetInternalEnd () < m_data->m_dirtyEnd;
   if (GetInternalEnd () + end <= m_data->m_size && !isDirty)
     {
       /* enough space in buffer and not dirty
@@ -363,10 +320,10 @@ Buffer::AddAtEnd (uint32_t end)
        * Before: |**----*****|
        * After:  |**----...**|
        */
-      NS_ASSERT (m_data->m_count == 1 || m_end == m_data->m_dirtyEnd);
+      NS_ASSERT (m_data->m_count == 1 || GetInternalEnd () == m_data->m_dirtyEnd);
       m_end += end;
       // update dirty area.
-      m_data->m_dirtyEnd = m_end;
+      m_data->m_dirtyEnd = GetInternalEnd ();
     } 
   else
     {
@@ -389,7 +346,7 @@ Buffer::AddAtEnd (uint32_t end)
 
       // update dirty area
       m_data->m_dirtyStart = m_start;
-      m_data->m_dirtyEnd = m_end;
+      m_data->m_dirtyEnd = GetInternalEnd ();
     } 
   m_maxZeroAreaStart = std::max (m_maxZeroAreaStart, m_zeroAreaStart);
   LOG_INTERNAL_STATE ("add end=" << end << ", ");
@@ -400,37 +357,112 @@ void
 Buffer::AddAtEnd (const Buffer &o)
 {
   NS_LOG_FUNCTION (this << &o);
-  if (m_data->m_count == 1 &&
-      m_end == m_zeroAreaEnd &&
-      m_end == m_data->m_dirtyEnd &&
-      o.m_start == o.m_zeroAreaStart &&
-      o.m_zeroAreaEnd - o.m_zeroAreaStart > 0)
+  NS_ASSERT (CheckInternalState ());
+  if (&o == this)
+    {
+      Buffer copy = o;
+      AddAtEnd (copy);
+      return;
+    }
+  uint32_t zeroSize = m_zeroAreaEnd - m_zeroAreaStart;
+  if (o.m_data == m_data && zeroSize == 0 && o.m_start == m_end)
     {
-      /**
-       * This is an optimization which kicks in when
-       * we attempt to aggregate two buffers which contain
-       * adjacent zero areas.
+      /* o starts where we end in the same byte buffer, as two adjacent
+       * fragments of a buffer do: extend our view over the bytes of o,
+       * and take over its zero area, instead of copying them.  Without a
+       * zero area, our offsets are also the offsets in the byte buffer.
        */
-      uint32_t zeroSize = o.m_zeroAreaEnd - o.m_zeroAreaStart;
-      m_zeroAreaEnd += zeroSize;
-      m_end = m_zeroAreaEnd;
-      m_data->m_dirtyEnd = m_zeroAreaEnd;
-      uint32_t endData = o.m_end - o.m_zeroAreaEnd;
-      AddAtEnd (endData);
-      Buffer::Iterator dst = End ();
-      dst.Prev (endData);
-      Buffer::Iterator src = o.End ();
-      src.Prev (endData);
-      dst.Write (src, o.End ());
+      m_zeroAreaStart = o.m_zeroAreaStart;
+      m_zeroAreaEnd = o.m_zeroAreaEnd;
+      m_end = o.m_end;
+      m_maxZeroAreaStart = std::max (m_maxZeroAreaStart, m_zeroAreaStart);
+      LOG_INTERNAL_STATE ("join slice, ");
       NS_ASSERT (CheckInternalState ());
       return;
     }
+  uint32_t oZeroSize = o.m_zeroAreaEnd - o.m_zeroAreaStart;
+  uint32_t oDataStart = o.m_zeroAreaStart - o.m_start;
+  uint32_t oDataEnd = o.m_end - o.m_zeroAreaEnd;
+  /* A buffer holds a single virtual zero area so the zero area of o
+   * can be kept virtual only if it can be merged with ours: that is
+   * possible if we have no zero area (it can then be moved to our end)
+   * or if the two zero areas are adjacent.
+   */
+  bool canMerge = zeroSize == 0 ||
+    (m_end == m_zeroAreaEnd && oDataStart == 0);
+  if (oZeroSize == 0 || (!canMerge && oZeroSize <= zeroSize))
+    {
+      /* Keep our own zero area virtual and append the content of o,
+       * including its (smaller) zero area, as real bytes.
+       */
+      AddAtEnd (o.GetSize ());
+      Buffer::Iterator i = End ();
+      i.Prev (o.GetSize ());
+      i.Write (o.m_data->m_data + o.m_start, oDataStart);
+      i.WriteU8 (0, oZeroSize);
+      i.Write (o.m_data->m_data + o.m_zeroAreaStart, oDataEnd);
+      NS_ASSERT (CheckInternalState ());
+      return;
+    }
+  if (!canMerge)
+    {
+      /* our zero area is the smaller one: materialize it and keep
+       * the zero area of o virtual instead.
+       */
+      *this = CreateFullCopy ();
+      zeroSize = 0;
+    }
+  if (zeroSize == 0)
+    {
+      AddAtEnd (oDataStart);
+      Buffer::Iterator i = End ();
+      i.Prev (oDataStart);
+      i.Write (o.m_data->m_data + o.m_start, oDataStart);
+      /* an empty zero area can be moved anywhere: move it to the end
+       * so that it can be extended with the zero area of o.
+       */
+      m_zeroAreaStart = GetInternalEnd ();
+      m_zeroAreaEnd = m_zeroAreaStart;
+      m_end = m_zeroAreaEnd;
+    }
+  /* Growing the zero area does not touch the underlying byte buffer
+   * so this is safe even if it is shared with other Buffer instances.
+   */
+  m_zeroAreaEnd += oZeroSize;
+  m_end += oZeroSize;
+  AddAtEnd (oDataEnd);
+  Buffer::Iterator i = End ();
+  i.Prev (oDataEnd);
+  i.Write (o.m_data->m_data + o.m_zeroAreaStart, oDataEnd);
+  m_maxZeroAreaStart = std::max (m_maxZeroAreaStart, m_zeroAreaStart);
+  NS_ASSERT (CheckInternalState ());
+}
 
-  *this = CreateFullCopy ();
-  AddAtEnd (o.GetSize ());
-  Buffer::Iterator destStart = End ();
-  destStart.Prev (o.GetSize ());
-  destStart.Write (o.Begin (), o.End ());
+void
+Buffer::MakeWritable (uint32_t start, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << start << size);
+  NS_ASSERT (CheckInternalState ());
+  NS_ASSERT (start + size <= GetSize ());
+  if (m_start + start < m_zeroAreaEnd && m_start + start + size > m_zeroAreaStart)
+    {
+      // the zero area is not backed by memory: materialize it.
+      *this = CreateFullCopy ();
+    }
+  else if (m_data->m_count > 1)
+    {
+      /* The bytes are shared with another buffer: copy the bytes
+       * of this buffer, at the same offsets, into a new byte buffer.
+       */
+      struct Buffer::Data *newData = Buffer::Create (m_data->m_size);
+      memcpy (newData->m_data + m_start, m_data->m_data + m_start, GetInternalSize ());
+      m_data->m_count--;
+      m_data = newData;
+      m_data->m_dirtyStart = m_start;
+      m_data->m_dirtyEnd = GetInternalEnd ();
+    }
+  LOG_INTERNAL_STATE ("writable start=" << start << ", size=" << size << ", ");
+  NS_ASSERT (m_data->m_count == 1);
   NS_ASSERT (CheckInternalState ());
 }
 
@@ -812,14 +844,14 @@ bool
 Buffer::Iterator::CheckNoZero (uint32_t start, uint32_t end) const
 {
   NS_LOG_FUNCTION (this << &start << &end);
-  for (uint32_t i = start; i < end; i++)
+  // the zero area is a single range: check the bounds of [start, end)
+  // rather than each byte.
+  if (start >= end)
     {
-      if (!Check (i))
-        {
-          return false;
-        }
+      return true;
     }
-  return true;
+  return Check (start) && Check (end - 1)
+         && (m_zeroStart == m_zeroEnd || end <= m_zeroStart || start >= m_zeroEnd);
 }
 bool 
 Buffer::Iterator::Check (uint32_t i) const
@@ -953,7 +985,7 @@ void
 Buffer::Iterator::Write (uint8_t const*buffer, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &buffer << size);
-  NS_ASSERT_MSG (CheckNoZero (m_current, size),
+  NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
                  GetWriteErrorMessage ());
   uint8_t *to;
   if (m_current <= m_zeroStart)
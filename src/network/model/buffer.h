@@ -488,6 +488,22 @@ private:
    * \return the number of bytes stored in this buffer.
    */
   inline uint32_t GetSize (void) const;
+  /**
+   * \return the number of bytes of this buffer which are held in the
+   * "virtual zero area", that is, which are not backed by any memory.
+   *
+   * These bytes always read as zero and are only materialized if the
+   * buffer is transformed into a real buffer (see PeekData) or if they
+   * need to be copied into a buffer which already holds a larger virtual
+   * zero area of its own.
+   */
+  inline uint32_t GetVirtualSize (void) const;
+  /**
+   * \return the offset from the start of this buffer to the start
+   * of the "virtual zero area". All the bytes before this offset are
+   * real bytes.
+   */
+  inline uint32_t GetVirtualStart (void) const;
 
   /**
    * \return a pointer to the start of the internal 
@@ -525,10 +541,31 @@ private:
    * \param o the buffer to append to the end of this buffer.
    *
    * Add bytes at the end of the Buffer.
+   * The "virtual zero area" of o is kept virtual whenever it can be
+   * merged with the zero area of this buffer; otherwise, the smaller of
+   * the two zero areas is materialized.
+   * If o is the part of the underlying byte buffer which follows this
+   * buffer, for example when joining two adjacent fragments created with
+   * CreateFragment, no byte is copied: this buffer is extended over o.
    * Any call to this method invalidates any Iterator
    * pointing to this Buffer.
    */
   void AddAtEnd (const Buffer &o);
+  /**
+   * \param start offset from the start of the buffer of the bytes
+   *        which are going to be overwritten
+   * \param size the number of bytes which are going to be overwritten
+   *
+   * Make sure that these existing bytes can be overwritten with an
+   * Iterator without altering the content of the other buffers: the
+   * underlying byte buffer is copied if it is shared with another
+   * buffer, and this buffer is transformed into a real buffer if these
+   * bytes lie in the "virtual zero area". No copy is made if this
+   * buffer already owns its bytes.
+   * Any call to this method invalidates any Iterator
+   * pointing to this Buffer.
+   */
+  void MakeWritable (uint32_t start, uint32_t size);
   /**
    * \param start size to remove
    *
@@ -765,9 +802,9 @@ private:
   /**
    * location in a newly-allocated buffer where you should start
    * writing data. i.e., m_start should be initialized to this 
-   * value.
+   * value. Like the other heuristics, it is kept per thread.
    */
-  static uint32_t g_recommendedStart;
+  static thread_local uint32_t g_recommendedStart;
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -791,16 +828,7 @@ private:
   uint32_t m_end;
 
 #ifdef BUFFER_FREE_LIST
-  /// Container for buffer data
-  typedef std::vector<struct Buffer::Data*> FreeList;
-  /// Local static destructor structure
-  struct LocalStaticDestructor 
-  {
-    ~LocalStaticDestructor ();
-  };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
-  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
+  static thread_local uint32_t g_maxSize; //!< Max observed data size in this thread
 #endif
 };
 
@@ -1065,6 +1093,18 @@ Buffer::GetSize (void) const
   return m_end - m_start;
 }
 
+uint32_t
+Buffer::GetVirtualSize (void) const
+{
+  return m_zeroAreaEnd - m_zeroAreaStart;
+}
+
+uint32_t
+Buffer::GetVirtualStart (void) const
+{
+  return m_zeroAreaStart - m_start;
+}
+
 Buffer::Iterator 
 Buffer::Begin (void) const
 {
@@ -19,12 +19,13 @@
  */
 #include "byte-tag-list.h"
 #include "ns3/log.h"
+#include "packet-allocator.h"
 #include <vector>
 #include <cstring>
 #include <limits>
+#include <algorithm>
 
 #define USE_FREE_LIST 1
-#define FREE_LIST_SIZE 1000
 #define OFFSET_MAX (std::numeric_limits<int32_t>::max ())
 
 namespace ns3 {
@@ -46,30 +47,7 @@ struct ByteTagListData {
 };
 
 #ifdef USE_FREE_LIST
-/**
- * \ingroup packet
- *
- * \brief Container class for struct ByteTagListData
- *
- * Internal use only.
- */
-static class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
-{
-public:
-  ~ByteTagListDataFreeList ();
-} g_freeList; //!< Container for struct ByteTagListData
-static uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
-
-ByteTagListDataFreeList::~ByteTagListDataFreeList ()
-{
-  NS_LOG_FUNCTION (this);
-  for (ByteTagListDataFreeList::iterator i = begin ();
-       i != end (); i++)
-    {
-      uint8_t *buffer = (uint8_t *)(*i);
-      delete [] buffer;
-    }
-}
+static thread_local uint32_t g_maxSize = 0; //!< maximum data size in this thread (used for allocation)
 #endif /* USE_FREE_LIST */
 
 ByteTagList::Iterator::Item::Item (TagBuffer buf_)
@@ -143,6 +121,7 @@ ByteTagList::ByteTagList ()
     m_maxEnd (INT32_MIN),
     m_adjustment (0),
     m_used (0),
+    m_types (0),
     m_data (0)
 {
   NS_LOG_FUNCTION (this);
@@ -152,6 +131,7 @@ ByteTagList::ByteTagList (const ByteTagList &o)
     m_maxEnd (o.m_maxEnd),
     m_adjustment (o.m_adjustment),
     m_used (o.m_used),
+    m_types (o.m_types),
     m_data (o.m_data)
 {
   NS_LOG_FUNCTION (this << &o);
@@ -174,6 +154,7 @@ ByteTagList::operator = (const ByteTagList &o)
   m_adjustment = o.m_adjustment;
   m_data = o.m_data;
   m_used = o.m_used;
+  m_types = o.m_types;
   if (m_data != 0)
     {
       m_data->count++;
@@ -223,6 +204,7 @@ ByteTagList::Add (TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
     }
   m_used = spaceNeeded;
   m_data->dirty = m_used;
+  m_types |= static_cast<uint64_t> (1) << (tid.GetUid () % 64);
   return tag;
 }
 
@@ -249,6 +231,7 @@ ByteTagList::RemoveAll (void)
   m_adjustment = 0;
   m_data = 0;
   m_used = 0;
+  m_types = 0;
 }
 
 ByteTagList::Iterator 
@@ -345,24 +328,13 @@ struct ByteTagListData *
 ByteTagList::Allocate (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  while (!g_freeList.empty ())
-    {
-      struct ByteTagListData *data = g_freeList.back ();
-      g_freeList.pop_back ();
-      NS_ASSERT (data != 0);
-      if (data->size >= size)
-        {
-          data->count = 1;
-          data->dirty = 0;
-          return data;
-        }
-      uint8_t *buffer = (uint8_t *)data;
-      delete [] buffer;
-    }
-  uint8_t *buffer = new uint8_t [std::max (size, g_maxSize) + sizeof (struct ByteTagListData) - 4];
-  struct ByteTagListData *data = (struct ByteTagListData *)buffer;
+  uint32_t header = sizeof (struct ByteTagListData) - 4;
+  size = std::max (size, g_maxSize);
+  uint32_t capacity = PacketAllocator::GetCapacity (size + header);
+  void *buffer = PacketAllocator::Allocate (size + header);
+  struct ByteTagListData *data = static_cast<struct ByteTagListData *> (buffer);
   data->count = 1;
-  data->size = size;
+  data->size = capacity - header;
   data->dirty = 0;
   return data;
 }
@@ -379,16 +351,8 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
   data->count--;
   if (data->count == 0)
     {
-      if (g_freeList.size () > FREE_LIST_SIZE ||
-          data->size < g_maxSize)
-        {
-          uint8_t *buffer = (uint8_t *)data;
-          delete [] buffer;
-        }
-      else
-        {
-          g_freeList.push_back (data);
-        }
+      uint32_t header = sizeof (struct ByteTagListData) - 4;
+      PacketAllocator::Deallocate (data, data->size + header);
     }
 }
 
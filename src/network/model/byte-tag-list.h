@@ -59,6 +59,10 @@ struct ByteTagListData;
  *     the boundaries before returning item. However, when packet is extending,
  *     it calls ByteTagList::AddAtStart or ByteTagList::AddAtEnd to cut byte
  *     tags that will otherwise cover new bytes.
+ *
+ *   - A 64 bit summary of the types of the tags in the list, with the bit
+ *     <tt>uid % 64</tt> set for each tag type, lets MayContain rule out
+ *     the absent tag types without scanning the byte buffer.
  */
 class ByteTagList
 {
@@ -214,6 +218,13 @@ private:
    */
   inline void Adjust (int32_t adjustment);
 
+  /**
+   * \param [in] tid A tag type.
+   * \returns False if this list holds no tag of this type; true if it
+   *          may hold one, in which case the list has to be searched.
+   */
+  inline bool MayContain (TypeId tid) const;
+
   /**
    * Make sure that all offsets are smaller than appendOffset which represents
    * the location where new bytes have been added to the byte buffer.
@@ -280,6 +291,7 @@ private:
   int32_t m_maxEnd; //!< maximal end offset
   int32_t m_adjustment; //!< adjustment to byte tag offsets
   uint32_t m_used; //!< the number of used bytes in the buffer
+  uint64_t m_types; //!< summary of the types of the tags, see MayContain
   struct ByteTagListData *m_data; //!< the ByteTagListData structure
 };
 
@@ -289,6 +301,12 @@ ByteTagList::Adjust (int32_t adjustment)
   m_adjustment += adjustment;
 }
 
+bool
+ByteTagList::MayContain (TypeId tid) const
+{
+  return (m_types & (static_cast<uint64_t> (1) << (tid.GetUid () % 64))) != 0;
+}
+
 } // namespace ns3
 
 #endif /* BYTE_TAG_LIST_H */
@@ -21,6 +21,7 @@
 #include "net-device.h"
 
 #include "ns3/log.h"
+#include "ns3/abort.h"
 #include "ns3/uinteger.h"
 
 namespace ns3 {
@@ -62,4 +63,19 @@ Channel::GetId (void) const
   return m_id;
 }
 
+bool
+Channel::SupportsCrossPartition (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return false;
+}
+
+void
+Channel::SetCrossPartition (bool crossPartition)
+{
+  NS_LOG_FUNCTION (this << crossPartition);
+  NS_ABORT_MSG_IF (crossPartition, "Channel " << m_id << " (" << GetInstanceTypeId ().GetName ()
+                   << ") cannot connect two partitions");
+}
+
 } // namespace ns3
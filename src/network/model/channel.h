@@ -74,6 +74,27 @@ public:
    */
   virtual Ptr<NetDevice> GetDevice (std::size_t i) const = 0;
 
+  /**
+   * \returns true if this channel can connect devices running in
+   * different partitions of the MultithreadedSimulatorImpl.
+   *
+   * Such channels must hand their packets over to the other partition
+   * without sharing them between threads, and must expose their
+   * propagation delay with a "Delay" attribute, from which the
+   * MultithreadedSimulatorHelper derives the lookahead.  The default
+   * implementation returns false.
+   */
+  virtual bool SupportsCrossPartition (void) const;
+  /**
+   * \param crossPartition true if the devices of this channel run in
+   * different partitions of the MultithreadedSimulatorImpl.
+   *
+   * Called by the MultithreadedSimulatorHelper on the channels which
+   * SupportsCrossPartition.  The default implementation aborts if
+   * crossPartition is true.
+   */
+  virtual void SetCrossPartition (bool crossPartition);
+
 private:
   uint32_t m_id; //!< Channel id for this channel
 };
@@ -113,6 +113,41 @@ public:
  */
 std::ostream & operator << (std::ostream &os, const Header &header);
 
+/**
+ * \ingroup packet
+ *
+ * \brief Compile-time properties of a type of header.
+ *
+ * By default, Packet::AddHeader adds a header through the virtual
+ * methods Header::GetSerializedSize and Header::Serialize. A header
+ * whose serialized size is bounded can take a faster path, by
+ * specializing this template with the bound as MAX_SIZE, and by
+ * implementing the non-virtual method
+ * \code
+ *   uint32_t SerializeTo (uint8_t *buffer, uint32_t payloadSize) const;
+ * \endcode
+ * which writes the header in the MAX_SIZE bytes of buffer, given the
+ * number of bytes which follow the header in the packet, and returns the
+ * number of bytes written, i.e., GetSerializedSize. It may return 0
+ * when the header cannot be written this way (e.g., when it holds a
+ * checksum of the bytes which follow it), in which case Packet::AddHeader
+ * falls back to Header::Serialize. The header is then copied in the
+ * packet with a single memcpy, and neither its size nor its serialization
+ * is looked up through the virtual table.
+ *
+ * The specialization applies to the exact type of the header: the
+ * subclasses of a header type take the default path unless they
+ * specialize the template too.
+ *
+ * \tparam T The type of the header.
+ */
+template <typename T>
+struct HeaderTraits
+{
+  /** The maximum serialized size of the header, or 0 for no fast path. */
+  static constexpr uint32_t MAX_SIZE = 0;
+};
+
 } // namespace ns3
 
 #endif /* HEADER_H */
@@ -22,6 +22,7 @@
 #define NET_DEVICE_H
 
 #include <stdint.h>
+#include <vector>
 #include "ns3/callback.h"
 #include "ns3/object.h"
 #include "ns3/ptr.h"
@@ -246,6 +247,24 @@ public:
    * \return whether the Send operation succeeded 
    */
   virtual bool Send (Ptr<Packet> packet, const Address& dest, uint16_t protocolNumber) = 0;
+  /**
+   * \param [in] packets Packets sent from above down to Network Device,
+   *        in transmission order.
+   * \param [in] dest Mac address of the destination of all the packets
+   *        (already resolved).
+   * \param [in] protocolNumber Identifies the type of payload contained in
+   *        all the packets.
+   *
+   * Called from higher layer to send several packets at once to the
+   * specified destination Address, e.g., by a queue disc which dequeues
+   * packets in bulk. Each packet is handled as if passed to Send, in
+   * order, but devices may override this method to perform the checks
+   * and the lookups shared by all the packets only once. The default
+   * implementation calls Send for each packet.
+   *
+   * \return The number of packets for which the Send operation succeeded.
+   */
+  virtual uint32_t SendBatch (const std::vector<Ptr<Packet> > &packets, const Address& dest, uint16_t protocolNumber);
   /**
    * \param packet packet sent from above down to Network Device
    * \param source source mac address (so called "MAC spoofing")
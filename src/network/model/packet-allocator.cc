@@ -0,0 +1,434 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "packet-allocator.h"
+#include "ns3/log.h"
+#include "ns3/system-mutex.h"
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <vector>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PacketAllocator");
+
+namespace {
+
+/** Size of the smallest size class, as a power of two. */
+const uint32_t POOL_MIN_SHIFT = 5;
+/** Number of size classes; larger blocks use the global allocator. */
+const uint32_t POOL_CLASSES = 12;
+/** Number of bytes a thread cache may keep in each size class. */
+const uint32_t POOL_CACHE_BYTES = 1 << 20;
+/** Minimum number of blocks a thread cache may keep in a size class. */
+const uint32_t POOL_CACHE_MIN_BLOCKS = 16;
+/** Maximum number of blocks a thread cache may keep in a size class. */
+const uint32_t POOL_CACHE_MAX_BLOCKS = 1024;
+/** Size of the depot, in thread caches, for each size class. */
+const uint32_t POOL_DEPOT_CACHES = 8;
+
+/** A free memory block. */
+struct PoolBlock
+{
+  PoolBlock *next;  //!< Next free block of the same size class.
+};
+
+/**
+ * The free blocks of a thread.  This type is trivially destructible,
+ * so that blocks released during static destruction never use a
+ * destroyed cache.  The counters are only written by the owner
+ * thread, and read by PacketAllocator::GetStats.
+ */
+struct PoolCache
+{
+  PoolBlock *head[POOL_CLASSES];          //!< Free list of each size class.
+  uint32_t length[POOL_CLASSES];          //!< Length of each free list.
+  std::atomic<uint64_t> hits;             //!< Allocations from the free lists.
+  std::atomic<uint64_t> refills;          //!< Free lists refilled from the depot.
+  std::atomic<uint64_t> misses;           //!< Allocations from the global allocator.
+  std::atomic<uint64_t> bytesRetained;    //!< Bytes in the free lists.
+  bool registered;                        //!< Known to the depot.
+  bool released;                          //!< The thread is exiting.
+};
+
+/** The shared free blocks, and the registry of the thread caches. */
+struct PoolDepot
+{
+  SystemMutex mutex;                      //!< Protects all the fields.
+  PoolBlock *head[POOL_CLASSES];          //!< Free list of each size class.
+  uint32_t length[POOL_CLASSES];          //!< Length of each free list.
+  uint64_t bytesRetained;                 //!< Bytes in the free lists.
+  std::vector<PoolCache *> caches;        //!< Caches of the live threads.
+  PacketAllocator::Stats exited;          //!< Counters of the exited threads.
+};
+
+/** The free blocks of the calling thread. */
+thread_local PoolCache g_poolCache;
+
+/** \c true if the caches are in use. */
+std::atomic<bool> g_poolEnabled (true);
+
+/**
+ * Get the depot.  It is never destroyed, so that threads can return
+ * their blocks to it whatever the order of the static destructors.
+ * \returns The depot.
+ */
+PoolDepot *
+GetDepot (void)
+{
+  static PoolDepot *depot = new PoolDepot ();
+  return depot;
+}
+
+/**
+ * \param [in] size A block size.
+ * \returns The size class of the block.
+ */
+inline uint32_t
+GetClass (uint32_t size)
+{
+  uint32_t c = 0;
+  uint32_t capacity = 1 << POOL_MIN_SHIFT;
+  while (capacity < size && c < POOL_CLASSES)
+    {
+      capacity <<= 1;
+      c++;
+    }
+  return c;
+}
+
+/**
+ * \param [in] c A size class.
+ * \returns The size of the blocks of the class.
+ */
+inline uint32_t
+GetClassCapacity (uint32_t c)
+{
+  return 1 << (POOL_MIN_SHIFT + c);
+}
+
+/**
+ * \param [in] c A size class.
+ * \returns The maximum length of the free list of a thread for the class.
+ */
+inline uint32_t
+GetCacheBound (uint32_t c)
+{
+  uint32_t blocks = POOL_CACHE_BYTES / GetClassCapacity (c);
+  return std::min (std::max (blocks, POOL_CACHE_MIN_BLOCKS), POOL_CACHE_MAX_BLOCKS);
+}
+
+/**
+ * Add to a counter written by a single thread.
+ * \param [in,out] counter The counter.
+ * \param [in] delta The value to add.
+ */
+inline void
+Increment (std::atomic<uint64_t> &counter, uint64_t delta)
+{
+  counter.store (counter.load (std::memory_order_relaxed) + delta,
+                 std::memory_order_relaxed);
+}
+
+/**
+ * Subtract from a counter written by a single thread.
+ * \param [in,out] counter The counter.
+ * \param [in] delta The value to subtract.
+ */
+inline void
+Decrement (std::atomic<uint64_t> &counter, uint64_t delta)
+{
+  counter.store (counter.load (std::memory_order_relaxed) - delta,
+                 std::memory_order_relaxed);
+}
+
+/**
+ * Move blocks from a free list to the depot.  The blocks which do not
+ * fit in the depot are returned to the global allocator.
+ * \param [in,out] cache The cache of the calling thread.
+ * \param [in] c The size class.
+ * \param [in] n The number of blocks to move.
+ */
+void
+Spill (PoolCache &cache, uint32_t c, uint32_t n)
+{
+  uint32_t capacity = GetClassCapacity (c);
+  PoolBlock *excess = 0;
+  PoolDepot *depot = GetDepot ();
+  {
+    CriticalSection cs (depot->mutex);
+    uint32_t bound = POOL_DEPOT_CACHES * GetCacheBound (c);
+    for (uint32_t i = 0; i < n; ++i)
+      {
+        PoolBlock *block = cache.head[c];
+        cache.head[c] = block->next;
+        if (depot->length[c] < bound)
+          {
+            block->next = depot->head[c];
+            depot->head[c] = block;
+            depot->length[c]++;
+            depot->bytesRetained += capacity;
+          }
+        else
+          {
+            block->next = excess;
+            excess = block;
+          }
+      }
+  }
+  cache.length[c] -= n;
+  Decrement (cache.bytesRetained, static_cast<uint64_t> (n) * capacity);
+  while (excess != 0)
+    {
+      PoolBlock *block = excess;
+      excess = block->next;
+      ::operator delete (block);
+    }
+}
+
+/**
+ * Move blocks from the depot to an empty free list.
+ * \param [in,out] cache The cache of the calling thread.
+ * \param [in] c The size class.
+ */
+void
+Refill (PoolCache &cache, uint32_t c)
+{
+  uint32_t capacity = GetClassCapacity (c);
+  uint32_t n = 0;
+  PoolDepot *depot = GetDepot ();
+  {
+    CriticalSection cs (depot->mutex);
+    uint32_t half = GetCacheBound (c) / 2;
+    while (depot->head[c] != 0 && n < half)
+      {
+        PoolBlock *block = depot->head[c];
+        depot->head[c] = block->next;
+        block->next = cache.head[c];
+        cache.head[c] = block;
+        n++;
+      }
+    depot->length[c] -= n;
+    depot->bytesRetained -= static_cast<uint64_t> (n) * capacity;
+  }
+  if (n != 0)
+    {
+      cache.length[c] += n;
+      Increment (cache.bytesRetained, static_cast<uint64_t> (n) * capacity);
+      Increment (cache.refills, 1);
+    }
+}
+
+/** Returns the cache of a thread to the depot when the thread exits. */
+struct PoolCacheReleaser
+{
+  ~PoolCacheReleaser ()
+  {
+    PoolCache &cache = g_poolCache;
+    for (uint32_t c = 0; c < POOL_CLASSES; ++c)
+      {
+        if (cache.length[c] != 0)
+          {
+            Spill (cache, c, cache.length[c]);
+          }
+      }
+    cache.released = true;
+    PoolDepot *depot = GetDepot ();
+    CriticalSection cs (depot->mutex);
+    depot->exited.hits += cache.hits.load (std::memory_order_relaxed);
+    depot->exited.refills += cache.refills.load (std::memory_order_relaxed);
+    depot->exited.misses += cache.misses.load (std::memory_order_relaxed);
+    depot->caches.erase (std::remove (depot->caches.begin (), depot->caches.end (), &cache),
+                         depot->caches.end ());
+  }
+};
+
+/** Releases the cache of the calling thread at exit. */
+thread_local PoolCacheReleaser g_poolCacheReleaser;
+
+/**
+ * Register the cache of the calling thread with the depot.
+ * \param [in,out] cache The cache of the calling thread.
+ */
+void
+Register (PoolCache &cache)
+{
+  cache.registered = true;
+  // Construct the releaser of this thread.
+  (void) &g_poolCacheReleaser;
+  PoolDepot *depot = GetDepot ();
+  CriticalSection cs (depot->mutex);
+  depot->caches.push_back (&cache);
+}
+
+} // unnamed namespace
+
+void *
+PacketAllocator::Allocate (uint32_t size)
+{
+  uint32_t c = GetClass (size);
+  if (c >= POOL_CLASSES)
+    {
+      return ::operator new (size);
+    }
+  PoolCache &cache = g_poolCache;
+  if (cache.released)
+    {
+      return ::operator new (GetClassCapacity (c));
+    }
+  if (!cache.registered)
+    {
+      Register (cache);
+    }
+  if (g_poolEnabled.load (std::memory_order_relaxed))
+    {
+      if (cache.head[c] == 0)
+        {
+          Refill (cache, c);
+        }
+      PoolBlock *block = cache.head[c];
+      if (block != 0)
+        {
+          cache.head[c] = block->next;
+          cache.length[c]--;
+          Decrement (cache.bytesRetained, GetClassCapacity (c));
+          Increment (cache.hits, 1);
+          return block;
+        }
+    }
+  Increment (cache.misses, 1);
+  // Always allocate the full size class, so that the block can be
+  // recycled even if it was allocated while the caches were disabled.
+  return ::operator new (GetClassCapacity (c));
+}
+
+void
+PacketAllocator::Deallocate (void *block, uint32_t size)
+{
+  uint32_t c = GetClass (size);
+  PoolCache &cache = g_poolCache;
+  if (c >= POOL_CLASSES
+      || cache.released
+      || !g_poolEnabled.load (std::memory_order_relaxed))
+    {
+      ::operator delete (block);
+      return;
+    }
+  if (!cache.registered)
+    {
+      Register (cache);
+    }
+  uint32_t bound = GetCacheBound (c);
+  if (cache.length[c] >= bound)
+    {
+      Spill (cache, c, bound / 2);
+    }
+  PoolBlock *b = static_cast<PoolBlock *> (block);
+  b->next = cache.head[c];
+  cache.head[c] = b;
+  cache.length[c]++;
+  Increment (cache.bytesRetained, GetClassCapacity (c));
+}
+
+uint32_t
+PacketAllocator::GetCapacity (uint32_t size)
+{
+  uint32_t c = GetClass (size);
+  if (c >= POOL_CLASSES)
+    {
+      return size;
+    }
+  return GetClassCapacity (c);
+}
+
+PacketAllocator::Stats
+PacketAllocator::GetStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  PoolDepot *depot = GetDepot ();
+  CriticalSection cs (depot->mutex);
+  Stats stats = depot->exited;
+  stats.bytesRetained = depot->bytesRetained;
+  for (std::vector<PoolCache *>::const_iterator i = depot->caches.begin ();
+       i != depot->caches.end (); ++i)
+    {
+      stats.hits += (*i)->hits.load (std::memory_order_relaxed);
+      stats.refills += (*i)->refills.load (std::memory_order_relaxed);
+      stats.misses += (*i)->misses.load (std::memory_order_relaxed);
+      stats.bytesRetained += (*i)->bytesRetained.load (std::memory_order_relaxed);
+    }
+  return stats;
+}
+
+void
+PacketAllocator::Trim (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  PoolCache &cache = g_poolCache;
+  PoolBlock *blocks = 0;
+  for (uint32_t c = 0; c < POOL_CLASSES; ++c)
+    {
+      while (cache.head[c] != 0)
+        {
+          PoolBlock *block = cache.head[c];
+          cache.head[c] = block->next;
+          block->next = blocks;
+          blocks = block;
+        }
+      cache.length[c] = 0;
+    }
+  cache.bytesRetained.store (0, std::memory_order_relaxed);
+  PoolDepot *depot = GetDepot ();
+  {
+    CriticalSection cs (depot->mutex);
+    for (uint32_t c = 0; c < POOL_CLASSES; ++c)
+      {
+        while (depot->head[c] != 0)
+          {
+            PoolBlock *block = depot->head[c];
+            depot->head[c] = block->next;
+            block->next = blocks;
+            blocks = block;
+          }
+        depot->length[c] = 0;
+      }
+    depot->bytesRetained = 0;
+  }
+  while (blocks != 0)
+    {
+      PoolBlock *block = blocks;
+      blocks = block->next;
+      ::operator delete (block);
+    }
+}
+
+void
+PacketAllocator::Enable (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_poolEnabled.store (true, std::memory_order_relaxed);
+}
+
+void
+PacketAllocator::Disable (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_poolEnabled.store (false, std::memory_order_relaxed);
+}
+
+} // namespace ns3
@@ -0,0 +1,96 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PACKET_ALLOCATOR_H
+#define PACKET_ALLOCATOR_H
+
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief Memory allocator of the internal structures of the packets.
+ *
+ * The byte buffers of Buffer, the item lists of PacketMetadata and
+ * the tags of ByteTagList and PacketTagList are allocated in blocks of
+ * a few size classes, whose sizes are powers of two from 32 bytes to
+ * 64 KiB.  Each thread keeps a bounded cache of free blocks per size
+ * class: releasing a block pushes it on the cache of the calling
+ * thread, and allocating a block pops it from there, without any
+ * synchronization.  When a cache is full, half of it is moved to a
+ * shared depot, protected by a mutex, from which empty caches are
+ * refilled before falling back to the global allocator.  The depot
+ * is bounded too; the blocks in excess are returned to the global
+ * allocator.
+ *
+ * A block may be released by a different thread than the one which
+ * allocated it, so packets can be created, handed over and destroyed
+ * by different threads.  Note however that the copies of a packet
+ * share their data through non-atomic reference counts: a packet and
+ * all its copies must be used by a single thread at a time.
+ */
+class PacketAllocator
+{
+public:
+  /** Allocation counters, summed over all the threads. */
+  struct Stats
+  {
+    uint64_t hits;          //!< Allocations served by a thread cache.
+    uint64_t refills;       //!< Thread cache refills from the depot.
+    uint64_t misses;        //!< Allocations served by the global allocator.
+    uint64_t bytesRetained; //!< Bytes held by the thread caches and the depot.
+  };
+
+  /**
+   * Allocate a block.
+   * \param [in] size The minimum size of the block, in bytes.
+   * \returns The block, of GetCapacity (size) bytes.
+   */
+  static void * Allocate (uint32_t size);
+  /**
+   * Release a block allocated with Allocate().
+   * \param [in] block The block.
+   * \param [in] size The size given to Allocate(), or any size with
+   *             the same capacity.
+   */
+  static void Deallocate (void *block, uint32_t size);
+  /**
+   * \param [in] size A block size, in bytes.
+   * \returns The actual size of the blocks allocated for this size,
+   *          which callers are free to use entirely.
+   */
+  static uint32_t GetCapacity (uint32_t size);
+  /**
+   * \returns The allocation counters of all the threads, including
+   *          the threads which have exited.
+   */
+  static Stats GetStats (void);
+  /**
+   * Return the free blocks of the calling thread and of the depot to
+   * the global allocator.
+   */
+  static void Trim (void);
+  /** Recycle the blocks through the caches (the default). */
+  static void Enable (void);
+  /** Allocate every block with the global allocator. */
+  static void Disable (void);
+};
+
+} // namespace ns3
+
+#endif /* PACKET_ALLOCATOR_H */
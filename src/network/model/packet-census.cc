@@ -0,0 +1,321 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "packet.h"
+#include "packet-census.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PacketCensus");
+
+namespace {
+
+/** What the census knows about a live packet. */
+struct Record
+{
+  TypeId creator;   //!< Creating context, if any.
+  TypeId holder;    //!< Holding component, if any.
+  uint32_t node;    //!< Simulation context of the creation.
+  int64_t created;  //!< Creation time, in time steps.
+};
+
+/** The live packets. */
+struct Registry
+{
+  Registry ()
+    : report (&std::clog)
+  {
+  }
+  std::mutex mutex;                                       //!< Protects the records.
+  std::unordered_map<const Packet *, Record> records;     //!< Live packets.
+  std::ostream *report;                                   //!< Report stream.
+};
+
+/**
+ * \returns The registry, which is never destroyed so that packets may
+ *          be released by static destructors.
+ */
+Registry &
+GetRegistry (void)
+{
+  static Registry *registry = new Registry ();
+  return *registry;
+}
+
+/** The event printing the report when the simulation is destroyed. */
+EventId g_reportEvent;
+
+/** The creating context of the packets created by this thread. */
+thread_local TypeId g_context;
+
+/**
+ * \param [in] tid A TypeId, which may be unset.
+ * \param [in] unset The name of an unset TypeId.
+ * \returns The name of the TypeId.
+ */
+std::string
+GetName (TypeId tid, const char *unset)
+{
+  return tid.GetUid () == 0 ? std::string (unset) : tid.GetName ();
+}
+
+} // unnamed namespace
+
+bool PacketCensus::m_enabled = false;
+
+PacketCensus::ContextScope::ContextScope (TypeId tid)
+  : m_previous (g_context)
+{
+  g_context = tid;
+}
+
+PacketCensus::ContextScope::~ContextScope ()
+{
+  g_context = m_previous;
+}
+
+void
+PacketCensus::Enable (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_enabled = true;
+  if (g_reportEvent.IsExpired ())
+    {
+      g_reportEvent = Simulator::ScheduleDestroy (&PacketCensus::Report);
+    }
+}
+
+void
+PacketCensus::Disable (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Registry &registry = GetRegistry ();
+  std::lock_guard<std::mutex> lock (registry.mutex);
+  m_enabled = false;
+  registry.records.clear ();
+}
+
+void
+PacketCensus::SetReportStream (std::ostream *os)
+{
+  NS_LOG_FUNCTION (os);
+  Registry &registry = GetRegistry ();
+  std::lock_guard<std::mutex> lock (registry.mutex);
+  registry.report = os;
+}
+
+void
+PacketCensus::Hold (Ptr<const Packet> p, TypeId holder)
+{
+  HoldItem (p, holder);
+}
+
+void
+PacketCensus::Release (Ptr<const Packet> p)
+{
+  ReleaseItem (p);
+}
+
+void
+PacketCensus::DoHold (const Packet *p, TypeId holder)
+{
+  Registry &registry = GetRegistry ();
+  std::lock_guard<std::mutex> lock (registry.mutex);
+  std::unordered_map<const Packet *, Record>::iterator it = registry.records.find (p);
+  if (it != registry.records.end ())
+    {
+      it->second.holder = holder;
+    }
+}
+
+void
+PacketCensus::DoRelease (const Packet *p)
+{
+  Registry &registry = GetRegistry ();
+  std::lock_guard<std::mutex> lock (registry.mutex);
+  std::unordered_map<const Packet *, Record>::iterator it = registry.records.find (p);
+  if (it != registry.records.end ())
+    {
+      it->second.holder = TypeId ();
+    }
+}
+
+void
+PacketCensus::DoNotifyCreated (const Packet *p)
+{
+  Record record;
+  record.creator = g_context;
+  record.node = Simulator::GetContext ();
+  record.created = Simulator::Now ().GetTimeStep ();
+  Registry &registry = GetRegistry ();
+  std::lock_guard<std::mutex> lock (registry.mutex);
+  registry.records[p] = record;
+}
+
+void
+PacketCensus::DoNotifyCopied (const Packet *p, const Packet *o)
+{
+  Record record;
+  record.node = Simulator::GetContext ();
+  record.created = Simulator::Now ().GetTimeStep ();
+  Registry &registry = GetRegistry ();
+  std::lock_guard<std::mutex> lock (registry.mutex);
+  std::unordered_map<const Packet *, Record>::const_iterator it = registry.records.find (o);
+  // packets created before the census was enabled have no record
+  record.creator = it != registry.records.end () ? it->second.creator : g_context;
+  registry.records[p] = record;
+}
+
+void
+PacketCensus::DoNotifyDestroyed (const Packet *p)
+{
+  Registry &registry = GetRegistry ();
+  std::lock_guard<std::mutex> lock (registry.mutex);
+  registry.records.erase (p);
+}
+
+PacketCensus::Snapshot
+PacketCensus::GetSnapshot (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Snapshot snapshot;
+  snapshot.time = Simulator::Now ();
+  snapshot.total.packets = 0;
+  snapshot.total.bytes = 0;
+  // sum per TypeId first, to look up the names once per TypeId
+  std::map<TypeId, Usage> creators;
+  std::map<TypeId, Usage> holders;
+  Registry &registry = GetRegistry ();
+  {
+    std::lock_guard<std::mutex> lock (registry.mutex);
+    for (std::unordered_map<const Packet *, Record>::const_iterator it = registry.records.begin ();
+         it != registry.records.end (); ++it)
+      {
+        uint32_t size = it->first->GetSize ();
+        Usage &creator = creators[it->second.creator];
+        Usage &holder = holders[it->second.holder];
+        creator.packets++;
+        creator.bytes += size;
+        holder.packets++;
+        holder.bytes += size;
+        snapshot.total.packets++;
+        snapshot.total.bytes += size;
+      }
+  }
+  for (std::map<TypeId, Usage>::const_iterator it = creators.begin (); it != creators.end (); ++it)
+    {
+      snapshot.creators[GetName (it->first, "(unknown)")] = it->second;
+    }
+  for (std::map<TypeId, Usage>::const_iterator it = holders.begin (); it != holders.end (); ++it)
+    {
+      snapshot.holders[GetName (it->first, "(none)")] = it->second;
+    }
+  return snapshot;
+}
+
+void
+PacketCensus::ScheduleSnapshots (Time interval, SnapshotCallback cb)
+{
+  NS_LOG_FUNCTION (interval);
+  NS_ASSERT (interval.IsStrictlyPositive ());
+  Simulator::Schedule (interval, &PacketCensus::TakeSnapshot, interval, cb);
+}
+
+void
+PacketCensus::TakeSnapshot (Time interval, SnapshotCallback cb)
+{
+  NS_LOG_FUNCTION (interval);
+  cb (GetSnapshot ());
+  Simulator::Schedule (interval, &PacketCensus::TakeSnapshot, interval, cb);
+}
+
+void
+PacketCensus::Print (std::ostream &os, uint32_t nOldest)
+{
+  NS_LOG_FUNCTION (&os << nOldest);
+  os << GetSnapshot ();
+  std::vector<std::pair<const Packet *, Record> > oldest;
+  Registry &registry = GetRegistry ();
+  {
+    std::lock_guard<std::mutex> lock (registry.mutex);
+    oldest.assign (registry.records.begin (), registry.records.end ());
+  }
+  uint32_t n = std::min<uint32_t> (nOldest, oldest.size ());
+  std::partial_sort (oldest.begin (), oldest.begin () + n, oldest.end (),
+                     [] (const std::pair<const Packet *, Record> &a,
+                         const std::pair<const Packet *, Record> &b)
+                     { return a.second.created < b.second.created; });
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      const Record &record = oldest[i].second;
+      os << "  packet " << oldest[i].first->GetUid ()
+         << " size " << oldest[i].first->GetSize ()
+         << " created at " << TimeStep (record.created).As (Time::S);
+      if (record.node != Simulator::NO_CONTEXT)
+        {
+          os << " on node " << record.node;
+        }
+      os << " by " << GetName (record.creator, "(unknown)")
+         << " held by " << GetName (record.holder, "(none)")
+         << std::endl;
+    }
+}
+
+void
+PacketCensus::Report (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  std::ostream *os;
+  {
+    Registry &registry = GetRegistry ();
+    std::lock_guard<std::mutex> lock (registry.mutex);
+    os = registry.report;
+  }
+  if (m_enabled && os != 0)
+    {
+      *os << "Packets alive when the simulation is destroyed: ";
+      Print (*os);
+    }
+}
+
+std::ostream &
+operator << (std::ostream &os, const PacketCensus::Snapshot &snapshot)
+{
+  os << snapshot.total.packets << " packets, " << snapshot.total.bytes
+     << " bytes at " << snapshot.time.As (Time::S) << std::endl;
+  for (std::map<std::string, PacketCensus::Usage>::const_iterator it = snapshot.creators.begin ();
+       it != snapshot.creators.end (); ++it)
+    {
+      os << "  created by " << it->first << ": " << it->second.packets
+         << " packets, " << it->second.bytes << " bytes" << std::endl;
+    }
+  for (std::map<std::string, PacketCensus::Usage>::const_iterator it = snapshot.holders.begin ();
+       it != snapshot.holders.end (); ++it)
+    {
+      os << "  held by " << it->first << ": " << it->second.packets
+         << " packets, " << it->second.bytes << " bytes" << std::endl;
+    }
+  return os;
+}
+
+} // namespace ns3
@@ -0,0 +1,313 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PACKET_CENSUS_H
+#define PACKET_CENSUS_H
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <ostream>
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/type-id.h"
+#include "ns3/callback.h"
+
+namespace ns3 {
+
+class Packet;
+
+/**
+ * \ingroup packet
+ *
+ * \brief Census of the live packets.
+ *
+ * Once enabled, the census records every Packet object created, with
+ * the context which created it (a TypeId set with ContextScope, the
+ * node of the simulation context and the time), and the component which
+ * currently holds it, if any.  Copies and fragments of a packet inherit
+ * the creating context of the packet.  The applications, the UDP and
+ * TCP sockets, and the ARP, IPv4, IPv6, ICMP, UDP and TCP protocols
+ * open a ContextScope with their own TypeId where they create or send
+ * packets.  The queues (Queue), the ARP cache
+ * and the neighbor discovery cache declare the packets they hold; other
+ * components can do the same with Hold and Release.
+ *
+ * GetSnapshot sums the packets and their bytes (as returned by
+ * Packet::GetSize) per creating context and per holding component, and
+ * ScheduleSnapshots takes such snapshots periodically.  When the
+ * simulation is destroyed, the packets which are still alive are
+ * reported, which shows where the packets are retained.
+ *
+ * The census is meant for debugging memory usage: it takes a lock and
+ * updates a hash table on the creation and on the destruction of each
+ * packet.  When it is not enabled, its cost is a test of a flag.
+ */
+class PacketCensus
+{
+public:
+  /** The number and the size of a set of packets. */
+  struct Usage
+  {
+    uint64_t packets; //!< Number of packets.
+    uint64_t bytes;   //!< Total size of the packets, in bytes.
+  };
+
+  /** The live packets at a given time. */
+  struct Snapshot
+  {
+    Time time;                              //!< Time of the snapshot.
+    Usage total;                            //!< All the live packets.
+    std::map<std::string, Usage> creators;  //!< Packets per creating context.
+    std::map<std::string, Usage> holders;   //!< Packets per holding component.
+  };
+
+  /**
+   * Callback invoked with periodic snapshots.
+   */
+  typedef Callback<void, const Snapshot &> SnapshotCallback;
+
+  /**
+   * \brief Set the creating context of the packets created in a scope.
+   *
+   * The previous context is restored when the scope is left.
+   */
+  class ContextScope
+  {
+public:
+    /**
+     * \param [in] tid The creating context of the packets created by
+     *        the calling thread until this object is destroyed.
+     */
+    ContextScope (TypeId tid);
+    ~ContextScope ();
+private:
+    TypeId m_previous; //!< The context of the enclosing scope.
+  };
+
+  /**
+   * \brief Start recording the packets.
+   *
+   * The packets created before are ignored, so this method should be
+   * called during the simulation setup.  The packets still alive when
+   * the current simulation is destroyed are reported to the report
+   * stream.
+   */
+  static void Enable (void);
+  /**
+   * \brief Stop recording the packets and forget the recorded packets.
+   */
+  static void Disable (void);
+  /**
+   * \returns true if the census is enabled.
+   */
+  static bool IsEnabled (void);
+  /**
+   * \brief Set the stream of the report printed when the simulation is
+   * destroyed.
+   *
+   * \param [in] os The stream, std::clog by default, or 0 to disable
+   *        the report.
+   */
+  static void SetReportStream (std::ostream *os);
+
+  /**
+   * \brief Declare that a component holds a packet.
+   *
+   * \param [in] p The packet.
+   * \param [in] holder The type of the component.
+   */
+  static void Hold (Ptr<const Packet> p, TypeId holder);
+  /**
+   * \brief Declare that a packet is no longer held by its component.
+   *
+   * \param [in] p The packet.
+   */
+  static void Release (Ptr<const Packet> p);
+  /**
+   * \brief Declare that a component holds the packet of a queue item.
+   *
+   * \param [in] item A queue item with a GetPacket method, or a packet.
+   * \param [in] holder The type of the component.
+   */
+  template <typename Item>
+  static void HoldItem (Ptr<const Item> item, TypeId holder);
+  /**
+   * \brief Declare that the packet of a queue item is no longer held.
+   *
+   * \param [in] item A queue item with a GetPacket method, or a packet.
+   */
+  template <typename Item>
+  static void ReleaseItem (Ptr<const Item> item);
+
+  /**
+   * \returns The live packets, summed per creating context and per
+   *          holding component.
+   */
+  static Snapshot GetSnapshot (void);
+  /**
+   * \brief Take snapshots periodically, until the simulation stops.
+   *
+   * \param [in] interval The time between two snapshots.
+   * \param [in] cb The callback invoked with each snapshot.
+   */
+  static void ScheduleSnapshots (Time interval, SnapshotCallback cb);
+  /**
+   * \brief Print a snapshot, and the oldest live packets.
+   *
+   * \param [in] os The output stream.
+   * \param [in] nOldest The maximum number of live packets listed.
+   */
+  static void Print (std::ostream &os, uint32_t nOldest = 10);
+
+  /**
+   * \brief Record a new packet.
+   * \param [in] p The packet.
+   */
+  static void NotifyCreated (const Packet *p);
+  /**
+   * \brief Record a copy or a fragment of a packet.
+   * \param [in] p The copy.
+   * \param [in] o The original packet.
+   */
+  static void NotifyCopied (const Packet *p, const Packet *o);
+  /**
+   * \brief Forget a packet which is destroyed.
+   * \param [in] p The packet.
+   */
+  static void NotifyDestroyed (const Packet *p);
+
+private:
+  /**
+   * \param [in] p A packet.
+   * \returns The packet.
+   */
+  static const Packet *GetItemPacket (const Packet *p);
+  /**
+   * \param [in] item A queue item.
+   * \returns The packet of the item.
+   */
+  template <typename Item>
+  static const Packet *GetItemPacket (const Item *item);
+
+  /** \copydoc Hold */
+  static void DoHold (const Packet *p, TypeId holder);
+  /** \copydoc Release */
+  static void DoRelease (const Packet *p);
+  /** \copydoc NotifyCreated */
+  static void DoNotifyCreated (const Packet *p);
+  /** \copydoc NotifyCopied */
+  static void DoNotifyCopied (const Packet *p, const Packet *o);
+  /** \copydoc NotifyDestroyed */
+  static void DoNotifyDestroyed (const Packet *p);
+  /** Print the live packets when the simulation is destroyed. */
+  static void Report (void);
+  /**
+   * Take a snapshot and schedule the next one.
+   * \param [in] interval The time between two snapshots.
+   * \param [in] cb The callback invoked with the snapshot.
+   */
+  static void TakeSnapshot (Time interval, SnapshotCallback cb);
+
+  static bool m_enabled; //!< Whether the census is enabled.
+};
+
+/**
+ * \brief Stream insertion operator.
+ *
+ * \param [in] os The stream.
+ * \param [in] snapshot The snapshot.
+ * \returns The stream.
+ */
+std::ostream & operator << (std::ostream &os, const PacketCensus::Snapshot &snapshot);
+
+} // namespace ns3
+
+/****************************************************
+ *  Implementation of inline and template methods
+ ***************************************************/
+
+namespace ns3 {
+
+inline bool
+PacketCensus::IsEnabled (void)
+{
+  return m_enabled;
+}
+
+inline void
+PacketCensus::NotifyCreated (const Packet *p)
+{
+  if (m_enabled)
+    {
+      DoNotifyCreated (p);
+    }
+}
+
+inline void
+PacketCensus::NotifyCopied (const Packet *p, const Packet *o)
+{
+  if (m_enabled)
+    {
+      DoNotifyCopied (p, o);
+    }
+}
+
+inline void
+PacketCensus::NotifyDestroyed (const Packet *p)
+{
+  if (m_enabled)
+    {
+      DoNotifyDestroyed (p);
+    }
+}
+
+inline const Packet *
+PacketCensus::GetItemPacket (const Packet *p)
+{
+  return p;
+}
+
+template <typename Item>
+const Packet *
+PacketCensus::GetItemPacket (const Item *item)
+{
+  return PeekPointer (item->GetPacket ());
+}
+
+template <typename Item>
+void
+PacketCensus::HoldItem (Ptr<const Item> item, TypeId holder)
+{
+  if (m_enabled && item != 0)
+    {
+      DoHold (GetItemPacket (PeekPointer (item)), holder);
+    }
+}
+
+template <typename Item>
+void
+PacketCensus::ReleaseItem (Ptr<const Item> item)
+{
+  if (m_enabled && item != 0)
+    {
+      DoRelease (GetItemPacket (PeekPointer (item)));
+    }
+}
+
+} // namespace ns3
+
+#endif /* PACKET_CENSUS_H */
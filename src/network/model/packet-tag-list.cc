@@ -28,6 +28,7 @@
 #include "tag.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include "packet-allocator.h"
 #include <cstring>
 
 namespace ns3 {
@@ -43,14 +44,22 @@ PacketTagList::CreateTagData (size_t dataSize)
                  << " exceeds maximum "
                  << std::numeric_limits<decltype(TagData::size)>::max () );
 
-  void * p = std::malloc (sizeof (TagData) + dataSize - 1);
-  // The matching frees are in RemoveAll and RemoveWriter
+  void * p = PacketAllocator::Allocate (sizeof (TagData) + dataSize - 1);
+  // The matching frees are in DeleteTagData
 
   TagData * tag = new (p) TagData;
   tag->size = dataSize;
   return tag;
 }
 
+void
+PacketTagList::DeleteTagData (TagData *tag)
+{
+  uint32_t size = sizeof (TagData) + tag->size - 1;
+  tag->~TagData ();
+  PacketAllocator::Deallocate (tag, size);
+}
+
 bool
 PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 {
@@ -58,8 +67,8 @@ PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
   NS_LOG_FUNCTION (this << tid);
   NS_LOG_INFO     ("looking for " << tid);
 
-  // trivial case when list is empty
-  if (m_next == 0)
+  // trivial case when the list holds no tag of this type
+  if ((m_types & GetTypeBit (tid)) == 0)
     {
       return false;
     }
@@ -175,7 +184,22 @@ PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 bool
 PacketTagList::Remove (Tag & tag)
 {
-  return COWTraverse (tag, &PacketTagList::RemoveWriter);
+  bool found = COWTraverse (tag, &PacketTagList::RemoveWriter);
+  if (found)
+    {
+      UpdateTypes ();
+    }
+  return found;
+}
+
+void
+PacketTagList::UpdateTypes (void)
+{
+  m_types = 0;
+  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
+    {
+      m_types |= GetTypeBit (cur->tid);
+    }
 }
 
 // COWWriter implementing Remove
@@ -194,8 +218,7 @@ PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
   if (preMerge)
     {
       // found tid before first merge, so delete cur
-      cur->~TagData ();
-      std::free (cur);
+      DeleteTagData (cur);
     }
   else
     {
@@ -259,21 +282,26 @@ PacketTagList::ReplaceWriter (Tag & tag, bool preMerge,
 void
 PacketTagList::Add (const Tag &tag) const
 {
-  NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
+  TypeId tid = tag.GetInstanceTypeId ();
+  NS_LOG_FUNCTION (this << tid);
   // ensure this id was not yet added
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
+  if ((m_types & GetTypeBit (tid)) != 0)
     {
-      NS_ASSERT_MSG (cur->tid != tag.GetInstanceTypeId (),
-                     "Error: cannot add the same kind of tag twice.");
+      for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
+        {
+          NS_ASSERT_MSG (cur->tid != tid,
+                         "Error: cannot add the same kind of tag twice.");
+        }
     }
   struct TagData * head = CreateTagData (tag.GetSerializedSize ());
   head->count = 1;
   head->next = 0;
-  head->tid = tag.GetInstanceTypeId ();
+  head->tid = tid;
   head->next = m_next;
   tag.Serialize (TagBuffer (head->data, head->data + head->size));
 
   const_cast<PacketTagList *> (this)->m_next = head;
+  const_cast<PacketTagList *> (this)->m_types |= GetTypeBit (tid);
 }
 
 bool
@@ -281,6 +309,10 @@ PacketTagList::Peek (Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   TypeId tid = tag.GetInstanceTypeId ();
+  if ((m_types & GetTypeBit (tid)) == 0)
+    {
+      return false;
+    }
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
     {
       if (cur->tid == tid)
@@ -449,6 +481,7 @@ PacketTagList::Deserialize (const uint32_t* buffer, uint32_t size)
         }
 
       prevTag = newTag;
+      m_types |= GetTypeBit (tid);
     }
 
   NS_ASSERT (sizeCheck == 0);
@@ -119,6 +119,16 @@ class Tag;
  *       The portion of the list between the first branch and the target is
  *       shared. This portion is copied before the #Remove or #Replace is
  *       performed.
+ *
+ * \par <b> Type summary </b>
+ *
+ *   - Each PacketTagList also keeps a 64 bit summary of the types of
+ *     the tags on its branch, with the bit <tt>uid % 64</tt> set for each
+ *     tag type. #Peek, #Remove and #Replace return at once, without
+ *     walking the list, when the bit of the requested type is clear,
+ *     which is the common case of a lookup for an absent tag.
+ *     Bits may be shared by several types, so a set bit only means
+ *     that the list has to be searched.
  */
 class PacketTagList 
 {
@@ -252,6 +262,13 @@ private:
    */
   static
   TagData * CreateTagData (size_t dataSize);
+  /**
+   * Destroy and release a TagData struct created by CreateTagData.
+   *
+   * \param [in] tag The TagData object.
+   */
+  static
+  void DeleteTagData (TagData *tag);
   
   /**
    * Typedef of method function pointer for copy-on-write operations
@@ -302,10 +319,24 @@ private:
   bool ReplaceWriter (Tag & tag, bool preMerge,
                       struct TagData * cur, struct TagData ** prevNext);
 
+  /**
+   * \param [in] tid A tag type.
+   * \returns The bit of this type in the type summary.
+   */
+  static inline uint64_t GetTypeBit (TypeId tid);
+  /**
+   * Recompute the type summary from the tags on the list.
+   */
+  void UpdateTypes (void);
+
   /**
    * Pointer to first \ref TagData on the list
    */
   struct TagData *m_next;
+  /**
+   * Summary of the types of the tags on the list, see GetTypeBit.
+   */
+  uint64_t m_types;
 };
 
 } // namespace ns3
@@ -317,12 +348,14 @@ private:
 namespace ns3 {
 
 PacketTagList::PacketTagList ()
-  : m_next ()
+  : m_next (),
+    m_types (0)
 {
 }
 
 PacketTagList::PacketTagList (PacketTagList const &o)
-  : m_next (o.m_next)
+  : m_next (o.m_next),
+    m_types (o.m_types)
 {
   if (m_next != 0)
     {
@@ -340,6 +373,7 @@ PacketTagList::operator = (PacketTagList const &o)
     }
   RemoveAll ();
   m_next = o.m_next;
+  m_types = o.m_types;
   if (m_next != 0) 
     {
       m_next->count++;
@@ -365,17 +399,22 @@ PacketTagList::RemoveAll (void)
         }
       if (prev != 0) 
         {
-          prev->~TagData ();
-          std::free (prev);
+          DeleteTagData (prev);
         }
       prev = cur;
     }
   if (prev != 0) 
     {
-      prev->~TagData ();
-      std::free (prev);
+      DeleteTagData (prev);
     }
   m_next = 0;
+  m_types = 0;
+}
+
+uint64_t
+PacketTagList::GetTypeBit (TypeId tid)
+{
+  return static_cast<uint64_t> (1) << (tid.GetUid () % 64);
 }
 
 } // namespace ns3
@@ -18,6 +18,7 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "packet.h"
+#include "packet-census.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
@@ -28,8 +29,6 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Packet");
 
-uint32_t Packet::m_globalUid = 0;
-
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
 {
@@ -136,10 +135,11 @@ Packet::Packet ()
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, 0),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32
+                | Simulator::AllocatePacketUid (), 0),
     m_nixVector (0)
 {
-  m_globalUid++;
+  PacketCensus::NotifyCreated (this);
 }
 
 Packet::Packet (const Packet &o)
@@ -150,6 +150,7 @@ Packet::Packet (const Packet &o)
 {
   o.m_nixVector ? m_nixVector = o.m_nixVector->Copy ()
     : m_nixVector = 0;
+  PacketCensus::NotifyCopied (this, &o);
 }
 
 Packet &
@@ -165,9 +166,15 @@ Packet::operator = (const Packet &o)
   m_metadata = o.m_metadata;
   o.m_nixVector ? m_nixVector = o.m_nixVector->Copy () 
     : m_nixVector = 0;
+  PacketCensus::NotifyCopied (this, &o);
   return *this;
 }
 
+Packet::~Packet ()
+{
+  PacketCensus::NotifyDestroyed (this);
+}
+
 Packet::Packet (uint32_t size)
   : m_buffer (size),
     m_byteTagList (),
@@ -178,10 +185,11 @@ Packet::Packet (uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32
+                | Simulator::AllocatePacketUid (), size),
     m_nixVector (0)
 {
-  m_globalUid++;
+  PacketCensus::NotifyCreated (this);
 }
 Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
   : m_buffer (0, false),
@@ -192,6 +200,7 @@ Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
 {
   NS_ASSERT (magic);
   Deserialize (buffer, size);
+  PacketCensus::NotifyCreated (this);
 }
 
 Packet::Packet (uint8_t const*buffer, uint32_t size)
@@ -204,13 +213,14 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32
+                | Simulator::AllocatePacketUid (), size),
     m_nixVector (0)
 {
-  m_globalUid++;
   m_buffer.AddAtStart (size);
   Buffer::Iterator i = m_buffer.Begin ();
   i.Write (buffer, size);
+  PacketCensus::NotifyCreated (this);
 }
 
 Packet::Packet (const Buffer &buffer,  const ByteTagList &byteTagList, 
@@ -237,6 +247,7 @@ Packet::CreateFragment (uint32_t start, uint32_t length) const
   // through Create because it is private.
   Ptr<Packet> ret = Ptr<Packet> (new Packet (buffer, byteTagList, m_packetTagList, metadata), false);
   ret->SetNixVector (GetNixVector ());
+  PacketCensus::NotifyCopied (PeekPointer (ret), this);
   return ret;
 }
 
@@ -263,6 +274,16 @@ Packet::AddHeader (const Header &header)
   header.Serialize (m_buffer.Begin ());
   m_metadata.AddHeader (header, size);
 }
+void
+Packet::AddSerializedHeader (const Header &header, uint8_t const *bytes, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << &header << size);
+  m_buffer.AddAtStart (size);
+  m_byteTagList.Adjust (size);
+  m_byteTagList.AddAtStart (size);
+  m_buffer.Begin ().Write (bytes, size);
+  m_metadata.AddHeader (header, size);
+}
 uint32_t
 Packet::RemoveHeader (Header &header, uint32_t size)
 {
@@ -304,6 +325,15 @@ Packet::PeekHeader (Header &header, uint32_t size) const
   return deserialized;
 }
 void
+Packet::ReplaceHeader (const Header &header)
+{
+  uint32_t size = header.GetSerializedSize ();
+  NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << size);
+  NS_ASSERT (size <= m_buffer.GetSize ());
+  m_buffer.MakeWritable (0, size);
+  header.Serialize (m_buffer.Begin ());
+}
+void
 Packet::AddTrailer (const Trailer &trailer)
 {
   uint32_t size = trailer.GetSerializedSize ();
@@ -939,6 +969,10 @@ bool
 Packet::FindFirstMatchingByteTag (Tag &tag) const
 {
   TypeId tid = tag.GetInstanceTypeId ();
+  if (!m_byteTagList.MayContain (tid))
+    {
+      return false;
+    }
   ByteTagIterator i = GetByteTagIterator ();
   while (i.HasNext ())
     {
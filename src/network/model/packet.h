@@ -21,6 +21,7 @@
 #define PACKET_H
 
 #include <stdint.h>
+#include <type_traits>
 #include "buffer.h"
 #include "header.h"
 #include "trailer.h"
@@ -248,6 +249,7 @@ public:
    * \return the copied object
    */
   Packet &operator = (const Packet &o);
+  ~Packet ();
   /**
    * \brief Create a packet with a zero-filled payload.
    *
@@ -302,6 +304,24 @@ public:
    * \returns the size in bytes of the packet
    */
   inline uint32_t GetSize (void) const;
+  /**
+   * \brief Returns the number of zero-filled payload bytes of the packet
+   * which are not backed by any memory.
+   *
+   * Packets created with Packet (uint32_t size) hold a virtual
+   * zero-filled payload which stays virtual through header and trailer
+   * addition and removal, fragmentation and most concatenations. It is
+   * only materialized when the raw bytes are requested (e.g., PeekData).
+   *
+   * \returns the size in bytes of the virtual payload
+   */
+  inline uint32_t GetVirtualSize (void) const;
+  /**
+   * \returns the offset in bytes from the start of the packet to the
+   * start of the virtual payload, i.e., the number of real bytes which
+   * precede it.
+   */
+  inline uint32_t GetVirtualStart (void) const;
   /**
    * \brief Add header to this packet.
    *
@@ -313,6 +333,20 @@ public:
    * \param header a reference to the header to add to this packet.
    */
   void AddHeader (const Header & header);
+  /**
+   * \brief Add header to this packet.
+   *
+   * If HeaderTraits is specialized for the type of the header, this
+   * method invokes its non-virtual SerializeTo method to write the header
+   * on the stack, then reserves space in the buffer and copies the header
+   * there at once. Otherwise, and if SerializeTo declines, it invokes
+   * AddHeader (const Header &).
+   *
+   * \tparam T \deduced The type of the header.
+   * \param [in] header The header to add to this packet.
+   */
+  template <typename T>
+  void AddHeader (const T &header);
   /**
    * \brief Deserialize and remove the header from the internal buffer.
    *
@@ -356,6 +390,45 @@ public:
    * \returns the number of bytes read from the packet.
    */
   uint32_t PeekHeader (Header &header, uint32_t size) const;
+  /**
+   * \brief Overwrite the header at the start of the packet.
+   *
+   * This method invokes Header::Serialize and overwrites the first
+   * Header::GetSerializedSize bytes of the packet, without removing
+   * nor adding any byte: the header must be of the same type and of
+   * the same size as the header at the start of the packet, so that
+   * the packet metadata stays valid. The header is serialized in the
+   * internal buffer of the packet, so that it can compute a checksum
+   * over the bytes which follow it; this buffer is copied first only
+   * if it is shared with other packets.
+   *
+   * \param [in] header The new value of the header.
+   */
+  void ReplaceHeader (const Header &header);
+  /**
+   * \brief Modify the header at the start of the packet in place.
+   *
+   * This method deserializes the header at the start of the packet,
+   * invokes the modifier on it and serializes it back at the same
+   * place with ReplaceHeader. It is equivalent to, but cheaper than,
+   * RemoveHeader followed by AddHeader: no byte is copied if the
+   * packet does not share its internal buffer with other packets,
+   * and the packet metadata is left untouched.
+   *
+   * \code
+   *   Ipv4Header ipHeader;
+   *   packet->ModifyHeader (ipHeader, [] (Ipv4Header &h) { h.SetTtl (h.GetTtl () - 1); });
+   * \endcode
+   *
+   * \tparam T \deduced The type of the header.
+   * \tparam F \deduced The type of the modifier, callable with a T&.
+   * \param [out] header The header, as modified.
+   * \param [in] modifier The function modifying the header, which
+   *             must not change its serialized size.
+   * \returns The size of the header.
+   */
+  template <typename T, typename F>
+  uint32_t ModifyHeader (T &header, F modifier);
   /**
    * \brief Add trailer to this packet.
    *
@@ -779,6 +852,26 @@ private:
    */
   uint32_t Deserialize (uint8_t const*buffer, uint32_t size);
 
+  /**
+   * \brief Add a header without a fast path.
+   * \param [in] header The header.
+   */
+  template <typename T>
+  void DoAddHeader (const T &header, std::false_type);
+  /**
+   * \brief Add a header with a fast path, see HeaderTraits.
+   * \param [in] header The header.
+   */
+  template <typename T>
+  void DoAddHeader (const T &header, std::true_type);
+  /**
+   * \brief Add a header already serialized.
+   * \param [in] header The header.
+   * \param [in] bytes The serialized header.
+   * \param [in] size The size of the serialized header.
+   */
+  void AddSerializedHeader (const Header &header, uint8_t const *bytes, uint32_t size);
+
   Buffer m_buffer;                //!< the packet buffer (it's actual contents)
   ByteTagList m_byteTagList;      //!< the ByteTag list
   PacketTagList m_packetTagList;  //!< the packet's Tag list
@@ -786,8 +879,6 @@ private:
 
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
-
-  static uint32_t m_globalUid; //!< Global counter of packets Uid
 };
 
 /**
@@ -854,6 +945,60 @@ Packet::GetSize (void) const
   return m_buffer.GetSize ();
 }
 
+uint32_t
+Packet::GetVirtualSize (void) const
+{
+  return m_buffer.GetVirtualSize ();
+}
+
+uint32_t
+Packet::GetVirtualStart (void) const
+{
+  return m_buffer.GetVirtualStart ();
+}
+
+template <typename T>
+void
+Packet::AddHeader (const T &header)
+{
+  DoAddHeader (header, std::integral_constant<bool, (HeaderTraits<T>::MAX_SIZE > 0)> ());
+}
+
+template <typename T>
+void
+Packet::DoAddHeader (const T &header, std::false_type)
+{
+  AddHeader (static_cast<const Header &> (header));
+}
+
+template <typename T>
+void
+Packet::DoAddHeader (const T &header, std::true_type)
+{
+  uint8_t bytes[HeaderTraits<T>::MAX_SIZE];
+  uint32_t size = header.SerializeTo (bytes, GetSize ());
+  if (size == 0)
+    {
+      AddHeader (static_cast<const Header &> (header));
+      return;
+    }
+  NS_ASSERT (size <= HeaderTraits<T>::MAX_SIZE);
+  NS_ASSERT (size == header.GetSerializedSize ());
+  AddSerializedHeader (header, bytes, size);
+}
+
+template <typename T, typename F>
+uint32_t
+Packet::ModifyHeader (T &header, F modifier)
+{
+  uint32_t size = PeekHeader (header);
+  modifier (header);
+  NS_ASSERT_MSG (header.GetSerializedSize () == size,
+                 "The modifier of a header may not change its size");
+  ReplaceHeader (header);
+  return size;
+}
+
 } // namespace ns3
 
 #endif /* PACKET_H */
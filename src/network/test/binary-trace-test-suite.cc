@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/binary-trace-file.h"
+#include "ns3/binary-trace-helper.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/mac48-address.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that the records written to a binary trace file are read back,
+ * by records and by chunks.
+ */
+class BinaryTraceFileTestCase : public TestCase
+{
+public:
+  BinaryTraceFileTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+BinaryTraceFileTestCase::BinaryTraceFileTestCase ()
+  : TestCase ("Check that BinaryTraceReader reads the records of BinaryTraceWriter")
+{
+}
+
+void
+BinaryTraceFileTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("records.bin");
+  Ptr<BinaryTraceWriter> writer = Create<BinaryTraceWriter> (filename, 7, true);
+  writer->AddField ("word", BinaryTraceWriter::MakeByteField (1, 2));
+  std::vector<uint64_t> uids;
+  for (uint32_t i = 0; i < 20; ++i)
+    {
+      uint8_t data[3] = { 0, uint8_t (i), uint8_t (i + 1) };
+      // packets of one or two bytes are too short for the field
+      Ptr<Packet> p = Create<Packet> (data, 1 + i % 3);
+      uids.push_back (p->GetUid ());
+      writer->Write (MicroSeconds (i), i / 4, i % 4, i % 2 ? BinaryTraceWriter::ENQUEUE : BinaryTraceWriter::RECEIVE, p);
+    }
+  writer->Close ();
+  NS_TEST_ASSERT_MSG_EQ (writer->Fail (), false, "Write must not fail");
+
+  BinaryTraceReader reader;
+  NS_TEST_ASSERT_MSG_EQ (reader.Open (filename), true, "Unable to open " << filename);
+  NS_TEST_ASSERT_MSG_EQ (reader.GetNFields (), 1, "Bad number of fields");
+  NS_TEST_EXPECT_MSG_EQ (reader.GetFieldName (0), "word", "Bad field name");
+  BinaryTraceReader::Record record;
+  for (uint32_t i = 0; i < 20; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (reader.Read (record), true, "Missing record " << i);
+      NS_TEST_EXPECT_MSG_EQ (record.time, 1000 * i, "Bad time");
+      NS_TEST_EXPECT_MSG_EQ (record.node, i / 4, "Bad node");
+      NS_TEST_EXPECT_MSG_EQ (record.device, i % 4, "Bad device");
+      NS_TEST_EXPECT_MSG_EQ (record.kind, (i % 2 ? '+' : 'r'), "Bad kind");
+      NS_TEST_EXPECT_MSG_EQ (record.uid, uids[i], "Bad uid");
+      NS_TEST_EXPECT_MSG_EQ (record.size, 1 + i % 3, "Bad size");
+      uint64_t word = (i % 3 == 2) ? (i << 8) | (i + 1) : 0;
+      NS_TEST_EXPECT_MSG_EQ (record.fields[0], word, "Bad field");
+    }
+  NS_TEST_EXPECT_MSG_EQ (reader.Read (record), false, "Too many records");
+
+  BinaryTraceReader chunks;
+  NS_TEST_ASSERT_MSG_EQ (chunks.Open (filename), true, "Unable to open " << filename);
+  BinaryTraceReader::Chunk chunk;
+  uint32_t nChunks = 0;
+  uint32_t nRecords = 0;
+  while (chunks.ReadChunk (chunk))
+    {
+      ++nChunks;
+      nRecords += chunk.uid.size ();
+      NS_TEST_EXPECT_MSG_EQ (chunk.fields.size (), 1, "Bad number of field columns");
+      NS_TEST_EXPECT_MSG_EQ (chunk.fields[0].size (), chunk.uid.size (), "Bad field column size");
+    }
+  NS_TEST_EXPECT_MSG_EQ (nChunks, 3, "Records not stored in chunks of 7 records");
+  NS_TEST_EXPECT_MSG_EQ (nRecords, 20, "Bad number of records");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that BinaryTraceHelper records the queue events of a device.
+ */
+class BinaryTraceHelperTestCase : public TestCase
+{
+public:
+  BinaryTraceHelperTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+BinaryTraceHelperTestCase::BinaryTraceHelperTestCase ()
+  : TestCase ("Check that BinaryTraceHelper traces the events of the devices")
+{
+}
+
+void
+BinaryTraceHelperTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper simple;
+  NetDeviceContainer devices = simple.Install (nodes);
+
+  std::string filename = CreateTempDirFilename ("devices.bin");
+  BinaryTraceHelper helper;
+  helper.SetChunkSize (2);
+  Ptr<BinaryTraceWriter> file = helper.CreateFile (filename);
+  helper.EnableBinary (file, devices.Get (0));
+
+  Ptr<NetDevice> device = devices.Get (0);
+  uint32_t nodeId = device->GetNode ()->GetId ();
+  uint32_t ifIndex = device->GetIfIndex ();
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      Simulator::Schedule (MilliSeconds (i), &NetDevice::Send, device,
+                           Create<Packet> (100 + i), devices.Get (1)->GetAddress (), 0x800);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  file->Close ();
+
+  BinaryTraceReader reader;
+  NS_TEST_ASSERT_MSG_EQ (reader.Open (filename), true, "Unable to open " << filename);
+  std::map<uint8_t, uint32_t> events;
+  BinaryTraceReader::Record record;
+  while (reader.Read (record))
+    {
+      ++events[record.kind];
+      NS_TEST_EXPECT_MSG_EQ (record.node, nodeId, "Bad node");
+      NS_TEST_EXPECT_MSG_EQ (record.device, ifIndex, "Bad device");
+      NS_TEST_EXPECT_MSG_EQ ((record.size >= 100 && record.size < 103), true, "Bad size");
+    }
+  NS_TEST_EXPECT_MSG_EQ (events['+'], 3, "Bad number of enqueue events");
+  NS_TEST_EXPECT_MSG_EQ (events['-'], 3, "Bad number of dequeue events");
+  NS_TEST_EXPECT_MSG_EQ (events.size (), 2, "Unexpected events");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Binary trace files TestSuite
+ */
+class BinaryTraceTestSuite : public TestSuite
+{
+public:
+  BinaryTraceTestSuite ();
+};
+
+BinaryTraceTestSuite::BinaryTraceTestSuite ()
+  : TestSuite ("binary-trace", UNIT)
+{
+  AddTestCase (new BinaryTraceFileTestCase, TestCase::QUICK);
+  AddTestCase (new BinaryTraceHelperTestCase, TestCase::QUICK);
+}
+
+static BinaryTraceTestSuite g_binaryTraceTestSuite; //!< Static variable for test initialization
@@ -18,6 +18,9 @@
  * Author: Mathieu Lacage <mathieu.lacage@cutebugs.net>
  */
 
+#include <vector>
+#include <algorithm>
+
 #include "ns3/buffer.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/double.h"
@@ -389,6 +392,188 @@ BufferTest::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Buffer virtual zero area unit tests: check that concatenated
+ * buffers keep their zero-filled payload virtual.
+ */
+class BufferVirtualTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferVirtualTest ();
+};
+
+BufferVirtualTest::BufferVirtualTest ()
+  : TestCase ("Buffer virtual zero area") {
+}
+
+void
+BufferVirtualTest::DoRun (void)
+{
+  // two zero-only buffers are merged without any allocation
+  Buffer a = Buffer (1000);
+  a.AddAtEnd (Buffer (2000));
+  NS_TEST_ASSERT_MSG_EQ (a.GetSize (), 3000, "Bad size");
+  NS_TEST_ASSERT_MSG_EQ (a.GetVirtualSize (), 3000, "Zero area not merged");
+  NS_TEST_ASSERT_MSG_EQ (a.GetVirtualStart (), 0, "Bad zero area start");
+
+  // a header followed by zeroes, and zeroes followed by a trailer
+  Buffer b = Buffer (1000);
+  b.AddAtStart (4);
+  b.Begin ().WriteHtonU32 (0x01020304);
+  Buffer c = Buffer (500);
+  c.AddAtEnd (2);
+  Buffer::Iterator i = c.End ();
+  i.Prev (2);
+  i.WriteHtonU16 (0x0506);
+  b.AddAtEnd (c);
+  NS_TEST_ASSERT_MSG_EQ (b.GetSize (), 1506, "Bad size");
+  NS_TEST_ASSERT_MSG_EQ (b.GetVirtualSize (), 1500, "Zero area not merged");
+  NS_TEST_ASSERT_MSG_EQ (b.GetVirtualStart (), 4, "Bad zero area start");
+  i = b.Begin ();
+  NS_TEST_ASSERT_MSG_EQ (i.ReadNtohU32 (), 0x01020304, "Bad header");
+  i = b.End ();
+  i.Prev (2);
+  NS_TEST_ASSERT_MSG_EQ (i.ReadNtohU16 (), 0x0506, "Bad trailer");
+
+  // real bytes followed by a zero-only buffer
+  Buffer d;
+  d.AddAtStart (3);
+  d.Begin ().WriteU8 (0x07, 3);
+  d.AddAtEnd (Buffer (100));
+  NS_TEST_ASSERT_MSG_EQ (d.GetVirtualSize (), 100, "Zero area materialized");
+  NS_TEST_ASSERT_MSG_EQ (d.GetVirtualStart (), 3, "Bad zero area start");
+
+  // zero areas which cannot be merged: the smaller one is materialized
+  Buffer e = b;
+  e.AddAtEnd (b);
+  NS_TEST_ASSERT_MSG_EQ (e.GetSize (), 2 * 1506, "Bad size");
+  NS_TEST_ASSERT_MSG_EQ (e.GetVirtualSize (), 1500, "Bad zero area size");
+  NS_TEST_ASSERT_MSG_EQ (e.GetVirtualStart (), 4, "Bad zero area start");
+  Buffer f = d;
+  f.AddAtEnd (b);
+  NS_TEST_ASSERT_MSG_EQ (f.GetSize (), 103 + 1506, "Bad size");
+  NS_TEST_ASSERT_MSG_EQ (f.GetVirtualSize (), 1500, "Bad zero area size");
+  NS_TEST_ASSERT_MSG_EQ (f.GetVirtualStart (), 103 + 4, "Bad zero area start");
+  std::vector<uint8_t> expected (f.GetSize (), 0);
+  expected[0] = expected[1] = expected[2] = 0x07;
+  expected[103] = 0x01;
+  expected[104] = 0x02;
+  expected[105] = 0x03;
+  expected[106] = 0x04;
+  expected[f.GetSize () - 2] = 0x05;
+  expected[f.GetSize () - 1] = 0x06;
+  std::vector<uint8_t> got (f.GetSize (), 0xff);
+  f.CopyData (&got[0], f.GetSize ());
+  NS_TEST_ASSERT_MSG_EQ ((got == expected), true, "Bad content");
+
+  // self concatenation
+  Buffer g = Buffer (10);
+  g.AddAtEnd (g);
+  NS_TEST_ASSERT_MSG_EQ (g.GetSize (), 20, "Bad size");
+  NS_TEST_ASSERT_MSG_EQ (g.GetVirtualSize (), 20, "Bad zero area size");
+
+  // growing the zero area of a shared buffer must not let it
+  // overwrite the bytes written by the other sharers
+  Buffer h = Buffer (10);
+  h.AddAtEnd (4);
+  i = h.End ();
+  i.Prev (4);
+  i.WriteU32 (0xaaaaaaaa);
+  Buffer j = h;
+  j.RemoveAtEnd (4);
+  j.AddAtEnd (Buffer (100));
+  j.AddAtEnd (4);
+  i = j.End ();
+  i.Prev (4);
+  i.WriteU32 (0xbbbbbbbb);
+  i = h.End ();
+  i.Prev (4);
+  NS_TEST_ASSERT_MSG_EQ (i.ReadU32 (), 0xaaaaaaaa, "Shared buffer overwritten");
+  i = j.End ();
+  i.Prev (4);
+  NS_TEST_ASSERT_MSG_EQ (i.ReadU32 (), 0xbbbbbbbb, "Bad trailer");
+  NS_TEST_ASSERT_MSG_EQ (j.GetVirtualSize (), 110, "Zero area not merged");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Buffer fragment unit tests: check that adjacent fragments are joined
+ * without copying their bytes.
+ */
+class BufferFragmentTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferFragmentTest ();
+};
+
+BufferFragmentTest::BufferFragmentTest ()
+  : TestCase ("Buffer fragment join") {
+}
+
+void
+BufferFragmentTest::DoRun (void)
+{
+  std::vector<uint8_t> bytes (1000);
+  for (uint32_t k = 0; k < bytes.size (); ++k)
+    {
+      bytes[k] = k % 251;
+    }
+  Buffer a;
+  a.AddAtStart (bytes.size ());
+  a.Begin ().Write (&bytes[0], bytes.size ());
+
+  // adjacent fragments are joined in place
+  Buffer b = a.CreateFragment (0, 400);
+  b.AddAtEnd (a.CreateFragment (400, 300));
+  b.AddAtEnd (a.CreateFragment (700, 300));
+  NS_TEST_ASSERT_MSG_EQ (b.GetSize (), 1000, "Bad size");
+  NS_TEST_ASSERT_MSG_EQ (b.PeekData (), a.PeekData (), "Fragments copied");
+  std::vector<uint8_t> got (bytes.size ());
+  b.CopyData (&got[0], got.size ());
+  NS_TEST_ASSERT_MSG_EQ ((got == bytes), true, "Bad content");
+
+  // fragments in the wrong order are copied
+  Buffer c = a.CreateFragment (500, 500);
+  c.AddAtEnd (a.CreateFragment (0, 500));
+  NS_TEST_ASSERT_MSG_EQ ((c.PeekData () != a.PeekData ()), true, "Fragments shared");
+  c.CopyData (&got[0], got.size ());
+  NS_TEST_ASSERT_MSG_EQ ((std::equal (bytes.begin (), bytes.begin () + 500, got.begin () + 500)), true, "Bad content");
+  NS_TEST_ASSERT_MSG_EQ ((std::equal (bytes.begin () + 500, bytes.end (), got.begin ())), true, "Bad content");
+
+  // the joined buffer and the original one can grow independently
+  b.AddAtEnd (1);
+  Buffer::Iterator i = b.End ();
+  i.Prev ();
+  i.WriteU8 (0xaa);
+  a.AddAtEnd (1);
+  i = a.End ();
+  i.Prev ();
+  i.WriteU8 (0xbb);
+  i = b.End ();
+  i.Prev ();
+  NS_TEST_ASSERT_MSG_EQ (i.ReadU8 (), 0xaa, "Joined buffer overwritten");
+  i = a.End ();
+  i.Prev ();
+  NS_TEST_ASSERT_MSG_EQ (i.ReadU8 (), 0xbb, "Original buffer overwritten");
+
+  // the zero area of the second fragment is kept virtual
+  Buffer d = Buffer (1000);
+  d.AddAtStart (4);
+  d.Begin ().WriteHtonU32 (0x01020304);
+  Buffer e = d.CreateFragment (0, 2);
+  e.AddAtEnd (d.CreateFragment (2, d.GetSize () - 2));
+  NS_TEST_ASSERT_MSG_EQ (e.GetSize (), 1004, "Bad size");
+  NS_TEST_ASSERT_MSG_EQ (e.GetVirtualSize (), 1000, "Zero area materialized");
+  NS_TEST_ASSERT_MSG_EQ (e.GetVirtualStart (), 4, "Bad zero area start");
+  i = e.Begin ();
+  NS_TEST_ASSERT_MSG_EQ (i.ReadNtohU32 (), 0x01020304, "Bad header");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -405,6 +590,8 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new BufferVirtualTest, TestCase::QUICK);
+  AddTestCase (new BufferFragmentTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,171 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/packet-allocator.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include <thread>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check the size classes and the recycling of the blocks by the
+ * calling thread.
+ */
+class PacketAllocatorRecycleTestCase : public TestCase
+{
+public:
+  PacketAllocatorRecycleTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+PacketAllocatorRecycleTestCase::PacketAllocatorRecycleTestCase ()
+  : TestCase ("Check that PacketAllocator recycles the blocks of a thread")
+{
+}
+
+void
+PacketAllocatorRecycleTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (PacketAllocator::GetCapacity (1), 32, "Bad capacity");
+  NS_TEST_ASSERT_MSG_EQ (PacketAllocator::GetCapacity (32), 32, "Bad capacity");
+  NS_TEST_ASSERT_MSG_EQ (PacketAllocator::GetCapacity (33), 64, "Bad capacity");
+  NS_TEST_ASSERT_MSG_EQ (PacketAllocator::GetCapacity (1500), 2048, "Bad capacity");
+  NS_TEST_ASSERT_MSG_EQ (PacketAllocator::GetCapacity (100000), 100000,
+                         "Large blocks should not be rounded");
+
+  PacketAllocator::Trim ();
+  PacketAllocator::Stats before = PacketAllocator::GetStats ();
+  void *a = PacketAllocator::Allocate (1500);
+  PacketAllocator::Deallocate (a, 1500);
+  PacketAllocator::Stats released = PacketAllocator::GetStats ();
+  NS_TEST_ASSERT_MSG_EQ (released.bytesRetained - before.bytesRetained, 2048,
+                         "The block should be kept in the thread cache");
+  void *b = PacketAllocator::Allocate (2000);
+  NS_TEST_ASSERT_MSG_EQ (a, b, "The block should be reused for the same size class");
+  PacketAllocator::Stats after = PacketAllocator::GetStats ();
+  NS_TEST_ASSERT_MSG_EQ (after.hits - before.hits, 1, "Bad hit count");
+  NS_TEST_ASSERT_MSG_EQ (after.misses - before.misses, 1, "Bad miss count");
+  PacketAllocator::Deallocate (b, 2000);
+
+  // large blocks bypass the caches
+  void *c = PacketAllocator::Allocate (100000);
+  PacketAllocator::Deallocate (c, 100000);
+  NS_TEST_ASSERT_MSG_EQ (PacketAllocator::GetStats ().bytesRetained,
+                         after.bytesRetained + 2048, "Large blocks should not be cached");
+
+  PacketAllocator::Trim ();
+  NS_TEST_ASSERT_MSG_EQ (PacketAllocator::GetStats ().bytesRetained, 0,
+                         "Trim should release all the blocks");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Create, copy and destroy packets from several threads, and release
+ * packets created by a thread from another thread.
+ */
+class PacketAllocatorThreadsTestCase : public TestCase
+{
+public:
+  PacketAllocatorThreadsTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Create, copy and destroy packets.
+   * \param [in] n The number of packets.
+   * \param [out] kept A packet created by this thread.
+   */
+  static void Churn (uint32_t n, Ptr<Packet> *kept);
+};
+
+PacketAllocatorThreadsTestCase::PacketAllocatorThreadsTestCase ()
+  : TestCase ("Check that packets can be used from several threads")
+{
+}
+
+void
+PacketAllocatorThreadsTestCase::Churn (uint32_t n, Ptr<Packet> *kept)
+{
+  uint8_t data[64] = { 0 };
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (data, sizeof (data));
+      p->AddAtEnd (Create<Packet> (1000));
+      Ptr<Packet> q = p->Copy ();
+      q->RemoveAtStart (10);
+      *kept = q;
+    }
+}
+
+void
+PacketAllocatorThreadsTestCase::DoRun (void)
+{
+  // create the simulator, used by the packet constructors, beforehand
+  Simulator::GetSystemId ();
+  PacketAllocator::Stats before = PacketAllocator::GetStats ();
+  const uint32_t threads = 4;
+  const uint32_t n = 2000;
+  std::vector<Ptr<Packet> > kept (threads);
+  std::vector<std::thread> workers;
+  for (uint32_t i = 0; i < threads; i++)
+    {
+      workers.push_back (std::thread (&Churn, n, &kept[i]));
+    }
+  for (uint32_t i = 0; i < threads; i++)
+    {
+      workers[i].join ();
+    }
+  PacketAllocator::Stats after = PacketAllocator::GetStats ();
+  NS_TEST_ASSERT_MSG_GT (after.hits - before.hits, threads * n,
+                         "The threads should reuse their own blocks");
+  for (uint32_t i = 0; i < threads; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (kept[i]->GetSize (), 64 + 1000 - 10, "Bad packet size");
+      // release the packets of the exited threads from this thread
+      kept[i] = 0;
+    }
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * PacketAllocator TestSuite
+ */
+class PacketAllocatorTestSuite : public TestSuite
+{
+public:
+  PacketAllocatorTestSuite ();
+};
+
+PacketAllocatorTestSuite::PacketAllocatorTestSuite ()
+  : TestSuite ("packet-allocator", UNIT)
+{
+  AddTestCase (new PacketAllocatorRecycleTestCase, TestCase::QUICK);
+  AddTestCase (new PacketAllocatorThreadsTestCase, TestCase::QUICK);
+}
+
+static PacketAllocatorTestSuite g_packetAllocatorTestSuite; //!< Static variable for test initialization
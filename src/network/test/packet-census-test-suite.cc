@@ -0,0 +1,143 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <sstream>
+#include <vector>
+#include "ns3/packet-census.h"
+#include "ns3/packet.h"
+#include "ns3/node.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that the census counts the live packets per creating context
+ * and per holding component, and reports them when the simulation is
+ * destroyed.
+ */
+class PacketCensusTestCase : public TestCase
+{
+public:
+  PacketCensusTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Record a snapshot.
+   * \param [in] snapshot The snapshot.
+   */
+  void Record (const PacketCensus::Snapshot &snapshot);
+
+  std::vector<PacketCensus::Snapshot> m_snapshots; //!< Periodic snapshots.
+};
+
+PacketCensusTestCase::PacketCensusTestCase ()
+  : TestCase ("Check the census of the live packets")
+{
+}
+
+void
+PacketCensusTestCase::Record (const PacketCensus::Snapshot &snapshot)
+{
+  m_snapshots.push_back (snapshot);
+}
+
+void
+PacketCensusTestCase::DoRun (void)
+{
+  std::ostringstream report;
+  PacketCensus::SetReportStream (&report);
+  PacketCensus::Enable ();
+
+  Ptr<Packet> p1;
+  {
+    PacketCensus::ContextScope scope (Node::GetTypeId ());
+    p1 = Create<Packet> (100);
+  }
+  Ptr<Packet> p2 = Create<Packet> (50);
+  // copies and fragments are attributed to the creator of the packet
+  Ptr<Packet> p3 = p1->Copy ();
+  Ptr<Packet> p4 = p1->CreateFragment (0, 10);
+
+  PacketCensus::Snapshot snapshot = PacketCensus::GetSnapshot ();
+  NS_TEST_EXPECT_MSG_EQ (snapshot.total.packets, 4, "Bad number of packets");
+  NS_TEST_EXPECT_MSG_EQ (snapshot.total.bytes, 260, "Bad number of bytes");
+  NS_TEST_EXPECT_MSG_EQ (snapshot.creators["ns3::Node"].packets, 3, "Bad number of packets created by the node");
+  NS_TEST_EXPECT_MSG_EQ (snapshot.creators["ns3::Node"].bytes, 210, "Bad number of bytes created by the node");
+  NS_TEST_EXPECT_MSG_EQ (snapshot.creators["(unknown)"].packets, 1, "Bad number of packets of unknown creator");
+  NS_TEST_EXPECT_MSG_EQ (snapshot.holders["(none)"].packets, 4, "Bad number of packets not held");
+
+  // the queues declare the packets they hold
+  Ptr<Queue<Packet> > queue = CreateObject<DropTailQueue<Packet> > ();
+  std::string queueName = queue->GetInstanceTypeId ().GetName ();
+  queue->Enqueue (p2);
+  queue->Enqueue (p4);
+  snapshot = PacketCensus::GetSnapshot ();
+  NS_TEST_EXPECT_MSG_EQ (snapshot.holders[queueName].packets, 2, "Bad number of packets held by the queue");
+  NS_TEST_EXPECT_MSG_EQ (snapshot.holders[queueName].bytes, 60, "Bad number of bytes held by the queue");
+  NS_TEST_EXPECT_MSG_EQ (snapshot.holders["(none)"].packets, 2, "Bad number of packets not held");
+  queue->Dequeue ();
+  snapshot = PacketCensus::GetSnapshot ();
+  NS_TEST_EXPECT_MSG_EQ (snapshot.holders[queueName].packets, 1, "Dequeued packet still held");
+
+  // destroyed packets are forgotten
+  p2 = 0;
+  p3 = 0;
+  snapshot = PacketCensus::GetSnapshot ();
+  NS_TEST_EXPECT_MSG_EQ (snapshot.total.packets, 2, "Destroyed packets still counted");
+
+  PacketCensus::ScheduleSnapshots (Seconds (1), MakeCallback (&PacketCensusTestCase::Record, this));
+  Simulator::Stop (Seconds (3.5));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_snapshots.size (), 3, "Bad number of periodic snapshots");
+  NS_TEST_EXPECT_MSG_EQ (m_snapshots.back ().time, Seconds (3), "Bad snapshot time");
+  NS_TEST_EXPECT_MSG_EQ (m_snapshots.back ().total.packets, 2, "Bad number of packets");
+
+  // the packets still alive are reported when the simulation is destroyed
+  Simulator::Destroy ();
+  NS_TEST_EXPECT_MSG_EQ ((report.str ().find ("2 packets, 110 bytes") != std::string::npos), true,
+                         "Bad report: " << report.str ());
+  NS_TEST_EXPECT_MSG_EQ ((report.str ().find ("held by " + queueName + ": 1 packets, 10 bytes") != std::string::npos), true,
+                         "Bad report: " << report.str ());
+
+  PacketCensus::Disable ();
+  PacketCensus::SetReportStream (&std::clog);
+  NS_TEST_EXPECT_MSG_EQ (PacketCensus::GetSnapshot ().total.packets, 0, "Packets counted after Disable");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Packet census TestSuite
+ */
+class PacketCensusTestSuite : public TestSuite
+{
+public:
+  PacketCensusTestSuite ();
+};
+
+PacketCensusTestSuite::PacketCensusTestSuite ()
+  : TestSuite ("packet-census", UNIT)
+{
+  AddTestCase (new PacketCensusTestCase, TestCase::QUICK);
+}
+
+static PacketCensusTestSuite g_packetCensusTestSuite; //!< Static variable for test initialization
@@ -18,6 +18,8 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "ns3/packet.h"
+#include "ns3/ethernet-header.h"
+#include "ns3/packet-allocator.h"
 #include "ns3/packet-tag-list.h"
 #include "ns3/test.h"
 #include "ns3/unused.h"
@@ -27,6 +29,7 @@
 #include <iostream>
 #include <iomanip>
 #include <ctime>
+#include <vector>
 
 using namespace ns3;
 
@@ -289,6 +292,136 @@ public:
 
 };
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test header with a mutable field and a checksum over the
+ * bytes which follow it.
+ *
+ * \note Class internal to packet-test-suite.cc
+ */
+class ACountingHeader : public Header
+{
+public:
+  ACountingHeader () : m_count (0), m_error (false) {}
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("anon::ACountingHeader")
+      .SetParent<Header> ()
+      .SetGroupName ("Network")
+      .HideFromDocumentation ()
+      .AddConstructor<ACountingHeader> ()
+    ;
+    return tid;
+  }
+  virtual TypeId GetInstanceTypeId (void) const {
+    return GetTypeId ();
+  }
+  virtual uint32_t GetSerializedSize (void) const {
+    return 4;
+  }
+  virtual void Serialize (Buffer::Iterator iter) const {
+    Buffer::Iterator start = iter;
+    iter.WriteU8 (m_count);
+    iter.WriteU8 (0);
+    iter.WriteU16 (0);
+    iter = start;
+    uint16_t checksum = iter.CalculateIpChecksum (iter.GetSize ());
+    iter = start;
+    iter.Next (2);
+    iter.WriteU16 (checksum);
+  }
+  virtual uint32_t Deserialize (Buffer::Iterator iter) {
+    Buffer::Iterator start = iter;
+    m_count = iter.ReadU8 ();
+    m_error = start.CalculateIpChecksum (start.GetSize ()) != 0;
+    return 4;
+  }
+  virtual void Print (std::ostream &os) const {
+    os << "count=" << (uint32_t)m_count;
+  }
+  uint8_t m_count; //!< The mutable field
+  bool m_error;    //!< The checksum is wrong
+};
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Header with a fast path for Packet::AddHeader
+ *
+ * The header holds its value and the size of the payload, and counts
+ * the calls to each of its serialization methods.
+ *
+ * \note Class internal to packet-test-suite.cc
+ */
+class AFastHeader : public Header
+{
+public:
+  AFastHeader () : m_value (0), m_fallback (false) {}
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("anon::AFastHeader")
+      .SetParent<Header> ()
+      .SetGroupName ("Network")
+      .HideFromDocumentation ()
+      .AddConstructor<AFastHeader> ()
+    ;
+    return tid;
+  }
+  virtual TypeId GetInstanceTypeId (void) const {
+    return GetTypeId ();
+  }
+  virtual uint32_t GetSerializedSize (void) const {
+    return 3;
+  }
+  virtual void Serialize (Buffer::Iterator iter) const {
+    m_serialized++;
+    iter.WriteU8 (m_value);
+    iter.WriteHtonU16 (iter.GetSize () - 3);
+  }
+  virtual uint32_t Deserialize (Buffer::Iterator iter) {
+    m_value = iter.ReadU8 ();
+    return 3;
+  }
+  virtual void Print (std::ostream &os) const {
+    os << "value=" << (uint32_t)m_value;
+  }
+  /**
+   * \brief Serialize the header in contiguous memory.
+   * \param [out] buffer The buffer.
+   * \param [in] payloadSize The size of the payload.
+   * \returns The number of bytes written, or 0 if m_fallback is set.
+   */
+  uint32_t SerializeTo (uint8_t *buffer, uint32_t payloadSize) const {
+    if (m_fallback)
+      {
+        return 0;
+      }
+    m_serializedTo++;
+    buffer[0] = m_value;
+    buffer[1] = payloadSize >> 8;
+    buffer[2] = payloadSize & 0xff;
+    return 3;
+  }
+  uint8_t m_value;                  //!< The value
+  bool m_fallback;                  //!< Decline the fast path
+  static uint32_t m_serialized;     //!< Calls to Serialize
+  static uint32_t m_serializedTo;   //!< Successful calls to SerializeTo
+};
+
+uint32_t AFastHeader::m_serialized = 0;
+uint32_t AFastHeader::m_serializedTo = 0;
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -414,6 +547,19 @@ struct Expected
 
 }
 
+namespace ns3 {
+
+/**
+ * \brief AFastHeader is added to packets through its SerializeTo method.
+ */
+template <>
+struct HeaderTraits<AFastHeader>
+{
+  static constexpr uint32_t MAX_SIZE = 3; //!< The size of the header.
+};
+
+} // namespace ns3
+
 // tag name, start, end
 #define E(name,start,end) name,start,end
 
@@ -848,6 +994,218 @@ PacketTest::DoRun (void)
     ALargeTestTag a;
     tmp->AddPacketTag (a); 
   }
+
+  /* Test the lookups of absent tags through the tag type summaries */
+  {
+    Ptr<Packet> tmp = Create<Packet> (10);
+    ATestTag<10> a;
+    ATestTag<11> b;
+    NS_TEST_EXPECT_MSG_EQ (tmp->PeekPacketTag (a), false, "empty list");
+    tmp->AddPacketTag (ATestTag<10> ());
+    NS_TEST_EXPECT_MSG_EQ (tmp->PeekPacketTag (b), false, "absent tag found");
+    NS_TEST_EXPECT_MSG_EQ (tmp->RemovePacketTag (b), false, "absent tag removed");
+    Ptr<Packet> copy = tmp->Copy ();
+    NS_TEST_EXPECT_MSG_EQ (tmp->RemovePacketTag (a), true, "tag not removed");
+    NS_TEST_EXPECT_MSG_EQ (tmp->PeekPacketTag (a), false, "removed tag found");
+    NS_TEST_EXPECT_MSG_EQ (copy->PeekPacketTag (a), true, "tag removed from the copy");
+    NS_TEST_EXPECT_MSG_EQ (tmp->ReplacePacketTag (b), false, "absent tag replaced");
+    NS_TEST_EXPECT_MSG_EQ (tmp->PeekPacketTag (b), true, "replaced tag not added");
+    NS_TEST_EXPECT_MSG_EQ (copy->PeekPacketTag (b), false, "tag added to the copy");
+
+    NS_TEST_EXPECT_MSG_EQ (tmp->FindFirstMatchingByteTag (a), false, "empty list");
+    tmp->AddByteTag (ATestTag<10> ());
+    NS_TEST_EXPECT_MSG_EQ (tmp->FindFirstMatchingByteTag (b), false, "absent tag found");
+    NS_TEST_EXPECT_MSG_EQ (tmp->FindFirstMatchingByteTag (a), true, "tag not found");
+    tmp->RemoveAllByteTags ();
+    NS_TEST_EXPECT_MSG_EQ (tmp->FindFirstMatchingByteTag (a), false, "removed tag found");
+  }
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packet::ModifyHeader unit tests: check that headers are rewritten
+ * in place, without altering the copies of the packet.
+ */
+class PacketModifyHeaderTest : public TestCase
+{
+public:
+  PacketModifyHeaderTest ();
+private:
+  void DoRun (void);
+};
+
+PacketModifyHeaderTest::PacketModifyHeaderTest ()
+  : TestCase ("Packet::ModifyHeader")
+{
+}
+
+void
+PacketModifyHeaderTest::DoRun (void)
+{
+  uint8_t payload[100];
+  for (uint32_t i = 0; i < sizeof (payload); i++)
+    {
+      payload[i] = i;
+    }
+  Ptr<Packet> p = Create<Packet> (payload, sizeof (payload));
+  ACountingHeader header;
+  header.m_count = 5;
+  p->AddHeader (header);
+  Ptr<Packet> copy = p->Copy ();
+
+  // the copy keeps the original header
+  uint32_t size = p->ModifyHeader (header, [] (ACountingHeader &h) { h.m_count--; });
+  NS_TEST_ASSERT_MSG_EQ (size, 4, "Bad header size");
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 104, "Bad packet size");
+  ACountingHeader got;
+  p->PeekHeader (got);
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t)got.m_count, 4, "Header not modified");
+  NS_TEST_ASSERT_MSG_EQ (got.m_error, false, "Bad checksum");
+  copy->PeekHeader (got);
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t)got.m_count, 5, "Copy modified");
+  NS_TEST_ASSERT_MSG_EQ (got.m_error, false, "Bad checksum of the copy");
+  uint8_t data[104];
+  p->CopyData (data, sizeof (data));
+  NS_TEST_ASSERT_MSG_EQ (memcmp (data + 4, payload, sizeof (payload)), 0, "Payload modified");
+
+  // the buffer is not copied once the packet owns it
+  PacketAllocator::Stats before = PacketAllocator::GetStats ();
+  p->ModifyHeader (header, [] (ACountingHeader &h) { h.m_count--; });
+  PacketAllocator::Stats after = PacketAllocator::GetStats ();
+  NS_TEST_ASSERT_MSG_EQ (after.hits + after.misses, before.hits + before.misses,
+                         "Unexpected allocation");
+  p->RemoveHeader (got);
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t)got.m_count, 3, "Header not modified");
+  NS_TEST_ASSERT_MSG_EQ (got.m_error, false, "Bad checksum");
+
+  // a header over the virtual zero area
+  Ptr<Packet> zeroes = Create<Packet> (100);
+  Ptr<Packet> zeroesCopy = zeroes->Copy ();
+  zeroes->ModifyHeader (header, [] (ACountingHeader &h) { h.m_count = 7; });
+  NS_TEST_ASSERT_MSG_EQ (zeroes->GetSize (), 100, "Bad packet size");
+  zeroes->PeekHeader (got);
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t)got.m_count, 7, "Header not modified");
+  NS_TEST_ASSERT_MSG_EQ (got.m_error, false, "Bad checksum");
+  zeroesCopy->PeekHeader (got);
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t)got.m_count, 0, "Copy modified");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packet::AddHeader unit tests: check that the headers with a fast path
+ * (see HeaderTraits) are written as by Header::Serialize.
+ */
+class PacketAddHeaderTest : public TestCase
+{
+public:
+  PacketAddHeaderTest ();
+private:
+  void DoRun (void);
+  /**
+   * Check that a header is added through both paths with the same result.
+   * \param [in] header The header.
+   * \param [in] p The packet to which the header is added.
+   */
+  template <typename T>
+  void CheckSameBytes (const T &header, Ptr<const Packet> p);
+  /**
+   * Check that the byte tag of the payload follows the 3-byte header.
+   * \param [in] p The packet.
+   */
+  void CheckByteTag (Ptr<const Packet> p);
+};
+
+PacketAddHeaderTest::PacketAddHeaderTest ()
+  : TestCase ("Packet::AddHeader")
+{
+}
+
+template <typename T>
+void
+PacketAddHeaderTest::CheckSameBytes (const T &header, Ptr<const Packet> p)
+{
+  Ptr<Packet> fast = p->Copy ();
+  Ptr<Packet> slow = p->Copy ();
+  fast->AddHeader (header);
+  slow->AddHeader (static_cast<const Header &> (header));
+  NS_TEST_ASSERT_MSG_EQ (fast->GetSize (), slow->GetSize (), "Bad packet size");
+  std::vector<uint8_t> fastData (fast->GetSize ());
+  std::vector<uint8_t> slowData (slow->GetSize ());
+  fast->CopyData (fastData.data (), fastData.size ());
+  slow->CopyData (slowData.data (), slowData.size ());
+  NS_TEST_ASSERT_MSG_EQ ((fastData == slowData), true, "Different bytes");
+}
+
+void
+PacketAddHeaderTest::CheckByteTag (Ptr<const Packet> p)
+{
+  ByteTagIterator i = p->GetByteTagIterator ();
+  NS_TEST_ASSERT_MSG_EQ (i.HasNext (), true, "Byte tag lost");
+  ByteTagIterator::Item item = i.Next ();
+  NS_TEST_EXPECT_MSG_EQ (item.GetStart (), 3, "Bad byte tag start");
+  NS_TEST_EXPECT_MSG_EQ (item.GetEnd (), 1053, "Bad byte tag end");
+  NS_TEST_EXPECT_MSG_EQ (i.HasNext (), false, "Unexpected byte tag");
+}
+
+void
+PacketAddHeaderTest::DoRun (void)
+{
+  uint8_t payload[50];
+  for (uint32_t i = 0; i < sizeof (payload); i++)
+    {
+      payload[i] = i;
+    }
+  Ptr<Packet> p = Create<Packet> (payload, sizeof (payload));
+  p->AddAtEnd (Create<Packet> (1000));
+  p->AddByteTag (ATestTag<1> ());
+
+  AFastHeader header;
+  header.m_value = 42;
+  AFastHeader::m_serialized = 0;
+  AFastHeader::m_serializedTo = 0;
+  Ptr<Packet> copy = p->Copy ();
+  copy->AddHeader (header);
+  NS_TEST_ASSERT_MSG_EQ (AFastHeader::m_serializedTo, 1, "Fast path not taken");
+  NS_TEST_ASSERT_MSG_EQ (AFastHeader::m_serialized, 0, "Virtual path taken");
+  CheckByteTag (copy);
+  uint8_t data[3];
+  copy->CopyData (data, 3);
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t)data[0], 42, "Bad value");
+  NS_TEST_ASSERT_MSG_EQ (((data[1] << 8) | data[2]), 1050, "Bad payload size");
+  CheckSameBytes (header, p);
+
+  // the header declines the fast path
+  header.m_fallback = true;
+  AFastHeader::m_serialized = 0;
+  AFastHeader::m_serializedTo = 0;
+  copy = p->Copy ();
+  copy->AddHeader (header);
+  NS_TEST_ASSERT_MSG_EQ (AFastHeader::m_serializedTo, 0, "Fast path taken");
+  NS_TEST_ASSERT_MSG_EQ (AFastHeader::m_serialized, 1, "Virtual path not taken");
+  CheckByteTag (copy);
+
+  // a header known only through its base class takes the virtual path
+  header.m_fallback = false;
+  AFastHeader::m_serialized = 0;
+  const Header &base = header;
+  copy = p->Copy ();
+  copy->AddHeader (base);
+  NS_TEST_ASSERT_MSG_EQ (AFastHeader::m_serialized, 1, "Virtual path not taken");
+
+  EthernetHeader ethernet (false);
+  ethernet.SetSource (Mac48Address ("00:00:00:00:00:01"));
+  ethernet.SetDestination (Mac48Address ("00:00:00:00:00:02"));
+  ethernet.SetLengthType (0x0800);
+  CheckSameBytes (ethernet, p);
+  EthernetHeader preamble (true);
+  preamble.SetPreambleSfd (0x0102030405060708ULL);
+  CheckSameBytes (preamble, p);
+  // over a shared, empty packet
+  CheckSameBytes (ethernet, Create<Packet> ());
 }
 
 /**
@@ -1162,6 +1520,8 @@ PacketTestSuite::PacketTestSuite ()
   : TestSuite ("packet", UNIT)
 {
   AddTestCase (new PacketTest, TestCase::QUICK);
+  AddTestCase (new PacketModifyHeaderTest, TestCase::QUICK);
+  AddTestCase (new PacketAddHeaderTest, TestCase::QUICK);
   AddTestCase (new PacketTagListTest, TestCase::QUICK);
 }
 
@@ -21,10 +21,20 @@
 #include <cstdlib>
 #include <sstream>
 #include <cstring>
+#include <fstream>
+#include <iterator>
 
 #include "ns3/log.h"
 #include "ns3/test.h"
 #include "ns3/pcap-file.h"
+#include "ns3/pcapng-file.h"
+#include "ns3/pcap-file-wrapper.h"
+#include "ns3/trace-helper.h"
+#include "ns3/packet.h"
+#include "ns3/node.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/names.h"
+#include "ns3/simulator.h"
 
 using namespace ns3;
 
@@ -1144,6 +1154,318 @@ DiffTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (usec, 3696, "Files are different from 2.3696 seconds");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test that PcapFile can truncate packets at their virtual payload.
+ */
+class TruncateVirtualPayloadTestCase : public TestCase
+{
+public:
+  TruncateVirtualPayloadTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TruncateVirtualPayloadTestCase::TruncateVirtualPayloadTestCase ()
+  : TestCase ("Check that PcapFile truncates packets at their virtual payload")
+{
+}
+
+void
+TruncateVirtualPayloadTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("truncate-virtual.pcap");
+  PcapFile f;
+
+  f.Open (filename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filename << ", \"std::ios::out\") returns error");
+  f.Init (1);
+  f.SetTruncateVirtualPayload (true);
+
+  uint8_t header[4] = { 1, 2, 3, 4 };
+  Ptr<Packet> p = Create<Packet> (header, sizeof (header));
+  p->AddAtEnd (Create<Packet> (1000));
+  NS_TEST_ASSERT_MSG_EQ (p->GetVirtualStart (), 4, "Bad virtual payload start");
+  NS_TEST_ASSERT_MSG_EQ (p->GetVirtualSize (), 1000, "Bad virtual payload size");
+  f.Write (0, 0, p);
+  // packets without virtual payload are written in full
+  f.Write (0, 1, Create<Packet> (header, sizeof (header)));
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Write must not fail");
+  f.Close ();
+
+  f.Open (filename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filename << ", \"std::ios::in\") returns error");
+  uint8_t data[N_PACKET_BYTES];
+  uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+  f.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+  NS_TEST_EXPECT_MSG_EQ (inclLen, 4, "Packet not truncated at its virtual payload");
+  NS_TEST_EXPECT_MSG_EQ (origLen, 1004, "Bad original length");
+  NS_TEST_EXPECT_MSG_EQ (data[3], 4, "Bad packet content");
+  f.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+  NS_TEST_EXPECT_MSG_EQ (inclLen, 4, "Bad included length");
+  NS_TEST_EXPECT_MSG_EQ (origLen, 4, "Bad original length");
+  f.Close ();
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test that buffered writes produce the same file as direct writes.
+ */
+class WriteBufferTestCase : public TestCase
+{
+public:
+  WriteBufferTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Write the test packets to a file.
+   * \param filename the file name
+   * \param blockSize the size of the write blocks, or zero
+   * \param async whether the blocks are written from a background thread
+   */
+  void WriteFile (std::string filename, uint32_t blockSize, bool async);
+  /**
+   * Read a whole file.
+   * \param filename the file name
+   * \returns the content of the file
+   */
+  std::string ReadFile (std::string filename);
+};
+
+WriteBufferTestCase::WriteBufferTestCase ()
+  : TestCase ("Check that PcapFile buffered writes match direct writes")
+{
+}
+
+void
+WriteBufferTestCase::WriteFile (std::string filename, uint32_t blockSize, bool async)
+{
+  PcapFile f;
+  f.Open (filename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filename << ", \"std::ios::out\") returns error");
+  f.Init (1, 1000);
+  f.SetWriteBuffer (blockSize, async);
+
+  uint8_t data[600];
+  for (uint32_t i = 0; i < sizeof (data); ++i)
+    {
+      data[i] = i;
+    }
+  for (uint32_t i = 0; i < 200; ++i)
+    {
+      // sizes above the block size exercise the block growth
+      uint32_t size = (i * 37) % sizeof (data);
+      f.Write (i, i * 10, data, size);
+      f.Write (i, i * 10 + 1, Create<Packet> (data, size));
+    }
+  NS_TEST_EXPECT_MSG_EQ (f.Fail (), false, "Write must not fail");
+  f.Close ();
+}
+
+std::string
+WriteBufferTestCase::ReadFile (std::string filename)
+{
+  std::ifstream in (filename.c_str (), std::ios::binary);
+  return std::string (std::istreambuf_iterator<char> (in), std::istreambuf_iterator<char> ());
+}
+
+void
+WriteBufferTestCase::DoRun (void)
+{
+  std::string direct = CreateTempDirFilename ("direct.pcap");
+  std::string buffered = CreateTempDirFilename ("buffered.pcap");
+  std::string async = CreateTempDirFilename ("async.pcap");
+
+  WriteFile (direct, 0, false);
+  WriteFile (buffered, 512, false);
+  WriteFile (async, 512, true);
+
+  std::string expected = ReadFile (direct);
+  NS_TEST_ASSERT_MSG_GT (expected.size (), 24, "Nothing written");
+  NS_TEST_EXPECT_MSG_EQ ((ReadFile (buffered) == expected), true, "Buffered file differs");
+  NS_TEST_EXPECT_MSG_EQ ((ReadFile (async) == expected), true, "Asynchronously written file differs");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test that packets of several interfaces can be written to, and
+ * read from, a pcapng file.
+ */
+class PcapngFileTestCase : public TestCase
+{
+public:
+  PcapngFileTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PcapngFileTestCase::PcapngFileTestCase ()
+  : TestCase ("Check that PcapngFile writes and reads packets of several interfaces")
+{
+}
+
+void
+PcapngFileTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("interfaces.pcapng");
+  Ptr<PcapngFile> f = Create<PcapngFile> ();
+  f->Open (filename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f->Fail (), false, "Open (" << filename << ", \"std::ios::out\") returns error");
+  NS_TEST_EXPECT_MSG_EQ (PcapngFile::Lookup (filename), f, "File open for writing not found");
+  f->SetWriteBuffer (64, true);
+
+  uint8_t data[N_PACKET_BYTES];
+  for (uint32_t i = 0; i < N_PACKET_BYTES; ++i)
+    {
+      data[i] = i;
+    }
+  uint32_t eth = f->AddInterface (1, 65535, "eth0");
+  uint32_t ppp = f->AddInterface (9, 10, "", true);
+  NS_TEST_EXPECT_MSG_EQ (eth, 0, "Bad interface index");
+  NS_TEST_EXPECT_MSG_EQ (ppp, 1, "Bad interface index");
+  for (uint32_t i = 0; i < 20; ++i)
+    {
+      f->Write (i % 2, 0x100000000ULL * i + i, data, 1 + i % N_PACKET_BYTES);
+    }
+  f->Write (eth, 1000, Create<Packet> (data, 3));
+  NS_TEST_EXPECT_MSG_EQ (f->Fail (), false, "Write must not fail");
+  f->Close ();
+  NS_TEST_EXPECT_MSG_EQ (PcapngFile::Lookup (filename), 0, "Closed file still found");
+
+  Ptr<PcapngFile> r = Create<PcapngFile> ();
+  r->Open (filename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (r->Fail (), false, "Open (" << filename << ", \"std::ios::in\") returns error");
+  uint8_t buf[N_PACKET_BYTES];
+  uint32_t interface, inclLen, origLen, readLen;
+  uint64_t timestamp;
+  for (uint32_t i = 0; i < 20; ++i)
+    {
+      std::memset (buf, 0xff, sizeof (buf));
+      r->Read (buf, sizeof (buf), interface, timestamp, inclLen, origLen, readLen);
+      NS_TEST_ASSERT_MSG_EQ (r->Fail (), false, "Read must not fail");
+      uint32_t size = 1 + i % N_PACKET_BYTES;
+      uint32_t snapLen = (i % 2) ? 10 : 65535;
+      NS_TEST_EXPECT_MSG_EQ (interface, i % 2, "Bad interface");
+      NS_TEST_EXPECT_MSG_EQ (timestamp, 0x100000000ULL * i + i, "Bad timestamp");
+      NS_TEST_EXPECT_MSG_EQ (origLen, size, "Bad original length");
+      NS_TEST_EXPECT_MSG_EQ (inclLen, std::min (size, snapLen), "Bad included length");
+      NS_TEST_EXPECT_MSG_EQ (readLen, inclLen, "Bad read length");
+      NS_TEST_EXPECT_MSG_EQ (std::memcmp (buf, data, readLen), 0, "Bad packet data");
+    }
+  r->Read (buf, sizeof (buf), interface, timestamp, inclLen, origLen, readLen);
+  NS_TEST_EXPECT_MSG_EQ (interface, eth, "Bad interface");
+  NS_TEST_EXPECT_MSG_EQ (inclLen, 3, "Bad included length");
+  NS_TEST_EXPECT_MSG_EQ (buf[2], 2, "Bad packet data");
+
+  NS_TEST_ASSERT_MSG_EQ (r->GetNInterfaces (), 2, "Bad number of interfaces");
+  NS_TEST_EXPECT_MSG_EQ (r->GetDataLinkType (0), 1, "Bad data link type");
+  NS_TEST_EXPECT_MSG_EQ (r->GetDataLinkType (1), 9, "Bad data link type");
+  NS_TEST_EXPECT_MSG_EQ (r->GetSnapLen (1), 10, "Bad snap length");
+  NS_TEST_EXPECT_MSG_EQ (r->GetInterfaceName (0), "eth0", "Bad interface name");
+  NS_TEST_EXPECT_MSG_EQ (r->GetInterfaceName (1), "", "Bad interface name");
+  NS_TEST_EXPECT_MSG_EQ (r->IsNanoSecMode (0), false, "Bad timestamp resolution");
+  NS_TEST_EXPECT_MSG_EQ (r->IsNanoSecMode (1), true, "Bad timestamp resolution");
+
+  r->Read (buf, sizeof (buf), interface, timestamp, inclLen, origLen, readLen);
+  NS_TEST_EXPECT_MSG_EQ (r->Fail (), true, "Read past the last packet must fail");
+  r->Close ();
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test that the pcap helper shares pcapng files between the traces,
+ * and names their interfaces after the devices.
+ */
+class PcapngHelperTestCase : public TestCase
+{
+public:
+  PcapngHelperTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PcapngHelperTestCase::PcapngHelperTestCase ()
+  : TestCase ("Check that PcapHelper shares a named pcapng file between traces")
+{
+}
+
+void
+PcapngHelperTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<SimpleNetDevice> eth = CreateObject<SimpleNetDevice> ();
+  node->AddDevice (eth);
+  Ptr<SimpleNetDevice> ppp = CreateObject<SimpleNetDevice> ();
+  node->AddDevice (ppp);
+  Names::Add ("ppp0", ppp);
+
+  // the format is a setting of each helper
+  PcapHelper helper;
+  PcapHelper other;
+  helper.SetFileFormat (PcapHelper::PCAPNG);
+  std::ostringstream base;
+  base << "prefix-" << node->GetId ();
+  NS_TEST_EXPECT_MSG_EQ (helper.GetFilenameFromDevice ("prefix", eth), base.str () + ".pcapng", "Bad pcapng filename");
+  NS_TEST_EXPECT_MSG_EQ (helper.GetFilenameFromDevice ("prefix", ppp), base.str () + ".pcapng", "Bad pcapng filename");
+  NS_TEST_EXPECT_MSG_EQ (other.GetFileFormat (), PcapHelper::PCAP, "The format of a helper changed another one");
+  NS_TEST_EXPECT_MSG_EQ (other.GetFilenameFromDevice ("prefix", eth), base.str () + "-0.pcap", "Bad pcap filename");
+
+  std::ostringstream ethName;
+  ethName << "node-" << node->GetId () << "-dev-0";
+  NS_TEST_EXPECT_MSG_EQ (helper.GetInterfaceNameFromDevice (eth), ethName.str (), "Bad interface name");
+  NS_TEST_EXPECT_MSG_EQ (helper.GetInterfaceNameFromDevice (ppp), "ppp0", "Bad interface name");
+
+  std::string filename = CreateTempDirFilename ("node.pcapng");
+  Ptr<PcapFileWrapper> first = helper.CreateFile (filename, std::ios::out, PcapHelper::DLT_EN10MB,
+                                                  std::numeric_limits<uint32_t>::max (), 0,
+                                                  helper.GetInterfaceNameFromDevice (eth));
+  Ptr<PcapFileWrapper> second = helper.CreateFile (filename, std::ios::out, PcapHelper::DLT_PPP,
+                                                   std::numeric_limits<uint32_t>::max (), 0,
+                                                   helper.GetInterfaceNameFromDevice (ppp));
+  NS_TEST_EXPECT_MSG_EQ (first->GetDataLinkType (), PcapHelper::DLT_EN10MB, "Bad data link type");
+  NS_TEST_EXPECT_MSG_EQ (second->GetDataLinkType (), PcapHelper::DLT_PPP, "Bad data link type");
+
+  first->Write (MicroSeconds (1), Create<Packet> (10));
+  second->Write (MicroSeconds (2), Create<Packet> (20));
+  first->Write (MicroSeconds (3), Create<Packet> (30));
+  first = 0;
+  second = 0;
+
+  PcapngFile r;
+  r.Open (filename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (r.Fail (), false, "Open (" << filename << ", \"std::ios::in\") returns error");
+  uint8_t buf[64];
+  uint32_t interface, inclLen, origLen, readLen;
+  uint64_t timestamp;
+  uint32_t expected[][3] = { { 0, 1, 10 }, { 1, 2, 20 }, { 0, 3, 30 } };
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      r.Read (buf, sizeof (buf), interface, timestamp, inclLen, origLen, readLen);
+      NS_TEST_ASSERT_MSG_EQ (r.Fail (), false, "Read must not fail");
+      NS_TEST_EXPECT_MSG_EQ (interface, expected[i][0], "Bad interface");
+      NS_TEST_EXPECT_MSG_EQ (timestamp, expected[i][1], "Bad timestamp");
+      NS_TEST_EXPECT_MSG_EQ (origLen, expected[i][2], "Bad original length");
+    }
+  NS_TEST_EXPECT_MSG_EQ (r.GetNInterfaces (), 2, "Bad number of interfaces");
+  NS_TEST_EXPECT_MSG_EQ (r.GetInterfaceName (0), ethName.str (), "Bad interface name");
+  NS_TEST_EXPECT_MSG_EQ (r.GetInterfaceName (1), "ppp0", "Bad interface name");
+  r.Close ();
+  Names::Clear ();
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1167,6 +1489,10 @@ PcapFileTestSuite::PcapFileTestSuite ()
   AddTestCase (new RecordHeaderTestCase, TestCase::QUICK);
   AddTestCase (new ReadFileTestCase, TestCase::QUICK);
   AddTestCase (new DiffTestCase, TestCase::QUICK);
+  AddTestCase (new TruncateVirtualPayloadTestCase, TestCase::QUICK);
+  AddTestCase (new WriteBufferTestCase, TestCase::QUICK);
+  AddTestCase (new PcapngFileTestCase, TestCase::QUICK);
+  AddTestCase (new PcapngHelperTestCase, TestCase::QUICK);
 }
 
 static PcapFileTestSuite pcapFileTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,356 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include "ns3/assert.h"
+#include "ns3/packet.h"
+#include "ns3/log.h"
+#include "binary-trace-file.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BinaryTraceFile");
+
+namespace {
+
+const uint32_t MAGIC = 0x4e534254;            //!< File magic number
+const uint32_t CHUNK_MAGIC = 0x4b4e4843;      //!< Chunk magic number
+const uint16_t VERSION = 1;                   //!< File format version
+const uint32_t BLOCK_SIZE = 256 * 1024;       //!< Size of the write blocks
+const uint32_t MAX_CHUNK_RECORDS = 0x1000000; //!< Largest chunk accepted when reading
+
+/**
+ * \param [in] v A value.
+ * \returns The value with its byte order swapped.
+ */
+template <typename T>
+T
+SwapBytes (T v)
+{
+  uint8_t *p = reinterpret_cast<uint8_t *> (&v);
+  std::reverse (p, p + sizeof (T));
+  return v;
+}
+
+/**
+ * \brief Extract an integer stored in a packet.
+ * \param [in] offset The offset of the integer.
+ * \param [in] size The size of the integer.
+ * \param [in] p The packet.
+ * \returns The integer, or 0 if the packet is too short.
+ */
+uint64_t
+ExtractBytes (uint32_t offset, uint32_t size, Ptr<const Packet> p)
+{
+  if (p->GetSize () < offset + size)
+    {
+      return 0;
+    }
+  // the usual header fields fit in the stack buffer
+  uint8_t stack[64];
+  std::vector<uint8_t> heap;
+  uint8_t *data = stack;
+  if (offset + size > sizeof (stack))
+    {
+      heap.resize (offset + size);
+      data = heap.data ();
+    }
+  p->CopyData (data, offset + size);
+  uint64_t value = 0;
+  for (uint32_t i = offset; i < offset + size; ++i)
+    {
+      value = (value << 8) | data[i];
+    }
+  return value;
+}
+
+} // unnamed namespace
+
+BinaryTraceWriter::BinaryTraceWriter (std::string const &filename, uint32_t chunkSize, bool async)
+  : m_chunkSize (chunkSize),
+    m_headerWritten (false)
+{
+  NS_LOG_FUNCTION (this << filename << chunkSize << async);
+  NS_ASSERT (chunkSize > 0);
+  m_file.open (filename.c_str (), std::ios::out | std::ios::binary);
+  if (!m_file.fail ())
+    {
+      m_buffer.Attach (&m_file, BLOCK_SIZE, async);
+    }
+  m_time.reserve (m_chunkSize);
+  m_node.reserve (m_chunkSize);
+  m_device.reserve (m_chunkSize);
+  m_kind.reserve (m_chunkSize);
+  m_uid.reserve (m_chunkSize);
+  m_size.reserve (m_chunkSize);
+}
+
+BinaryTraceWriter::~BinaryTraceWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+void
+BinaryTraceWriter::AddField (std::string const &name, FieldExtractor extractor)
+{
+  NS_LOG_FUNCTION (this << name);
+  NS_ASSERT_MSG (!m_headerWritten && m_time.empty (), "Fields must be added before the first record");
+  NS_ASSERT (name.size () <= 0xffff && m_names.size () < 0xffff);
+  m_names.push_back (name);
+  m_extractors.push_back (extractor);
+  m_fields.push_back (std::vector<uint64_t> ());
+  m_fields.back ().reserve (m_chunkSize);
+}
+
+BinaryTraceWriter::FieldExtractor
+BinaryTraceWriter::MakeByteField (uint32_t offset, uint32_t size)
+{
+  NS_LOG_FUNCTION (offset << size);
+  NS_ASSERT (size >= 1 && size <= 8);
+  return MakeBoundCallback (&ExtractBytes, offset, size);
+}
+
+void
+BinaryTraceWriter::Write (Time t, uint32_t node, uint32_t device, EventKind kind, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << t << node << device << kind << p);
+  m_time.push_back (t.GetNanoSeconds ());
+  m_node.push_back (node);
+  m_device.push_back (device);
+  m_kind.push_back (kind);
+  m_uid.push_back (p->GetUid ());
+  m_size.push_back (p->GetSize ());
+  for (uint32_t i = 0; i < m_extractors.size (); ++i)
+    {
+      m_fields[i].push_back (m_extractors[i] (p));
+    }
+  if (m_time.size () == m_chunkSize)
+    {
+      Flush ();
+    }
+}
+
+void
+BinaryTraceWriter::WriteFileHeader (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint16_t nFields = m_names.size ();
+  m_buffer.Write (&MAGIC, sizeof (MAGIC));
+  m_buffer.Write (&VERSION, sizeof (VERSION));
+  m_buffer.Write (&nFields, sizeof (nFields));
+  for (std::vector<std::string>::const_iterator i = m_names.begin (); i != m_names.end (); ++i)
+    {
+      uint16_t len = i->size ();
+      m_buffer.Write (&len, sizeof (len));
+      m_buffer.Write (i->data (), len);
+    }
+  m_headerWritten = true;
+}
+
+void
+BinaryTraceWriter::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_buffer.IsAttached ())
+    {
+      return;
+    }
+  if (!m_headerWritten)
+    {
+      WriteFileHeader ();
+    }
+  uint32_t n = m_time.size ();
+  if (n > 0)
+    {
+      m_buffer.Write (&CHUNK_MAGIC, sizeof (CHUNK_MAGIC));
+      m_buffer.Write (&n, sizeof (n));
+      m_buffer.Write (m_time.data (), n * sizeof (int64_t));
+      m_buffer.Write (m_node.data (), n * sizeof (uint32_t));
+      m_buffer.Write (m_device.data (), n * sizeof (uint32_t));
+      m_buffer.Write (m_kind.data (), n * sizeof (uint8_t));
+      m_buffer.Write (m_uid.data (), n * sizeof (uint64_t));
+      m_buffer.Write (m_size.data (), n * sizeof (uint32_t));
+      for (std::vector<std::vector<uint64_t> >::iterator i = m_fields.begin (); i != m_fields.end (); ++i)
+        {
+          m_buffer.Write (i->data (), n * sizeof (uint64_t));
+          i->clear ();
+        }
+      m_time.clear ();
+      m_node.clear ();
+      m_device.clear ();
+      m_kind.clear ();
+      m_uid.clear ();
+      m_size.clear ();
+    }
+  m_buffer.Flush ();
+}
+
+void
+BinaryTraceWriter::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+  m_buffer.Detach ();
+  m_file.close ();
+}
+
+bool
+BinaryTraceWriter::Fail (void) const
+{
+  NS_LOG_FUNCTION (this);
+  m_buffer.Sync ();
+  return m_file.fail ();
+}
+
+BinaryTraceReader::BinaryTraceReader ()
+  : m_swapMode (false),
+    m_next (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+bool
+BinaryTraceReader::Open (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  m_file.open (filename.c_str (), std::ios::in | std::ios::binary);
+  uint32_t magic = 0;
+  uint16_t version = 0;
+  uint16_t nFields = 0;
+  m_file.read ((char *)&magic, sizeof (magic));
+  if (m_file.fail () || (magic != MAGIC && magic != SwapBytes (MAGIC)))
+    {
+      return false;
+    }
+  m_swapMode = (magic != MAGIC);
+  m_file.read ((char *)&version, sizeof (version));
+  m_file.read ((char *)&nFields, sizeof (nFields));
+  if (m_swapMode)
+    {
+      version = SwapBytes (version);
+      nFields = SwapBytes (nFields);
+    }
+  if (m_file.fail () || version != VERSION)
+    {
+      return false;
+    }
+  m_names.clear ();
+  for (uint16_t i = 0; i < nFields; ++i)
+    {
+      uint16_t len = 0;
+      m_file.read ((char *)&len, sizeof (len));
+      if (m_swapMode)
+        {
+          len = SwapBytes (len);
+        }
+      std::string name (len, '\0');
+      m_file.read (&name[0], len);
+      m_names.push_back (name);
+    }
+  m_chunk = Chunk ();
+  m_next = 0;
+  return !m_file.fail ();
+}
+
+uint32_t
+BinaryTraceReader::GetNFields (void) const
+{
+  return m_names.size ();
+}
+
+std::string
+BinaryTraceReader::GetFieldName (uint32_t i) const
+{
+  NS_ASSERT (i < m_names.size ());
+  return m_names[i];
+}
+
+template <typename T>
+bool
+BinaryTraceReader::ReadColumn (std::vector<T> &column, uint32_t n)
+{
+  column.resize (n);
+  m_file.read ((char *)column.data (), n * sizeof (T));
+  if (m_swapMode)
+    {
+      for (typename std::vector<T>::iterator i = column.begin (); i != column.end (); ++i)
+        {
+          *i = SwapBytes (*i);
+        }
+    }
+  return !m_file.fail ();
+}
+
+bool
+BinaryTraceReader::ReadChunk (Chunk &chunk)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t magic = 0;
+  uint32_t n = 0;
+  m_file.read ((char *)&magic, sizeof (magic));
+  m_file.read ((char *)&n, sizeof (n));
+  if (m_swapMode)
+    {
+      magic = SwapBytes (magic);
+      n = SwapBytes (n);
+    }
+  if (m_file.fail () || magic != CHUNK_MAGIC || n > MAX_CHUNK_RECORDS)
+    {
+      return false;
+    }
+  chunk.fields.resize (m_names.size ());
+  bool ok = ReadColumn (chunk.time, n)
+    && ReadColumn (chunk.node, n)
+    && ReadColumn (chunk.device, n)
+    && ReadColumn (chunk.kind, n)
+    && ReadColumn (chunk.uid, n)
+    && ReadColumn (chunk.size, n);
+  for (uint32_t i = 0; ok && i < chunk.fields.size (); ++i)
+    {
+      ok = ReadColumn (chunk.fields[i], n);
+    }
+  return ok;
+}
+
+bool
+BinaryTraceReader::Read (Record &record)
+{
+  while (m_next == m_chunk.time.size ())
+    {
+      m_next = 0;
+      if (!ReadChunk (m_chunk))
+        {
+          m_chunk = Chunk ();
+          return false;
+        }
+    }
+  record.time = m_chunk.time[m_next];
+  record.node = m_chunk.node[m_next];
+  record.device = m_chunk.device[m_next];
+  record.kind = m_chunk.kind[m_next];
+  record.uid = m_chunk.uid[m_next];
+  record.size = m_chunk.size[m_next];
+  record.fields.resize (m_chunk.fields.size ());
+  for (uint32_t i = 0; i < m_chunk.fields.size (); ++i)
+    {
+      record.fields[i] = m_chunk.fields[i][m_next];
+    }
+  ++m_next;
+  return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,250 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_TRACE_FILE_H
+#define BINARY_TRACE_FILE_H
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <stdint.h>
+#include "ns3/ptr.h"
+#include "ns3/callback.h"
+#include "ns3/nstime.h"
+#include "ns3/simple-ref-count.h"
+#include "trace-file-buffer.h"
+
+namespace ns3 {
+
+class Packet;
+
+/**
+ * \ingroup network
+ *
+ * \brief Writer of binary packet trace files.
+ *
+ * A binary trace file holds fixed-width records, one per packet event:
+ * the time in nanoseconds, the node id, the device index, the kind of the
+ * event (which is the character of the ascii traces: '+', '-', 'd' or
+ * 'r'), the packet uid and size, and any number of additional 64-bit
+ * fields extracted from the packet by user-provided callbacks.  The
+ * records are not formatted: they are stored by columns in chunks of a
+ * fixed number of records, so that post-processing tools can load each
+ * column of a chunk as an array.
+ *
+ * The file starts with a header:
+ *   - the magic number 0x4e534254, which also gives the byte order of the
+ *     file (that of the writing system),
+ *   - the format version (16 bits) and the number of additional fields
+ *     (16 bits),
+ *   - for each additional field, the length of its name (16 bits) followed
+ *     by the name.
+ *
+ * Each chunk then holds the magic number 0x4b4e4843, the number of
+ * records in the chunk (32 bits), and the columns one after the other:
+ * time (64 bits, signed), node (32 bits), device (32 bits), kind (8 bits),
+ * uid (64 bits), size (32 bits), and the additional fields (64 bits each).
+ *
+ * BinaryTraceReader reads these files back, and the print-binary-trace
+ * program converts them to CSV.
+ */
+class BinaryTraceWriter : public SimpleRefCount<BinaryTraceWriter>
+{
+public:
+  /**
+   * The kinds of events, named after the ascii trace events.
+   */
+  enum EventKind
+  {
+    ENQUEUE = '+',  //!< Packet enqueued in a device queue
+    DEQUEUE = '-',  //!< Packet dequeued from a device queue
+    DROP = 'd',     //!< Packet dropped
+    RECEIVE = 'r'   //!< Packet received by a device
+  };
+
+  /**
+   * Callback extracting an additional field from a packet.
+   */
+  typedef Callback<uint64_t, Ptr<const Packet> > FieldExtractor;
+
+  /**
+   * \brief Create a binary trace file.
+   *
+   * \param [in] filename The name of the file.
+   * \param [in] chunkSize The number of records of each chunk.
+   * \param [in] async Whether the chunks are written from a background
+   *        thread (see TraceFileBuffer).
+   */
+  BinaryTraceWriter (std::string const &filename, uint32_t chunkSize = 16384,
+                     bool async = false);
+  ~BinaryTraceWriter ();
+
+  /**
+   * \brief Add a field to the records.
+   *
+   * The fields must be added before the first record is written.
+   *
+   * \param [in] name The name of the field.
+   * \param [in] extractor The callback returning the value of the field.
+   */
+  void AddField (std::string const &name, FieldExtractor extractor);
+
+  /**
+   * \brief Get an extractor for an integer stored in the packet.
+   *
+   * \param [in] offset The offset of the integer from the start of the packet.
+   * \param [in] size The size of the integer, in network byte order, from 1
+   *        to 8 bytes.
+   * \returns The extractor, which returns 0 for packets which are too short.
+   */
+  static FieldExtractor MakeByteField (uint32_t offset, uint32_t size);
+
+  /**
+   * \brief Write a record.
+   *
+   * \param [in] t The time of the event.
+   * \param [in] node The node id.
+   * \param [in] device The device index in the node.
+   * \param [in] kind The kind of the event.
+   * \param [in] p The packet.
+   */
+  void Write (Time t, uint32_t node, uint32_t device, EventKind kind, Ptr<const Packet> p);
+
+  /**
+   * \brief Write the records of the current chunk, even if it is not full.
+   */
+  void Flush (void);
+
+  /**
+   * \brief Write the pending records and close the file.
+   */
+  void Close (void);
+
+  /**
+   * \return true if the 'fail' bit is set in the underlying iostream, false otherwise.
+   */
+  bool Fail (void) const;
+
+private:
+  /** Write the file header. */
+  void WriteFileHeader (void);
+
+  std::ofstream m_file;                         //!< File stream.
+  mutable TraceFileBuffer m_buffer;             //!< Write buffer.
+  uint32_t m_chunkSize;                         //!< Records per chunk.
+  bool m_headerWritten;                         //!< File header written.
+  std::vector<std::string> m_names;             //!< Additional field names.
+  std::vector<FieldExtractor> m_extractors;     //!< Additional field extractors.
+  std::vector<int64_t> m_time;                  //!< Time column.
+  std::vector<uint32_t> m_node;                 //!< Node column.
+  std::vector<uint32_t> m_device;               //!< Device column.
+  std::vector<uint8_t> m_kind;                  //!< Kind column.
+  std::vector<uint64_t> m_uid;                  //!< Uid column.
+  std::vector<uint32_t> m_size;                 //!< Size column.
+  std::vector<std::vector<uint64_t> > m_fields; //!< Additional field columns.
+};
+
+/**
+ * \ingroup network
+ *
+ * \brief Reader of binary packet trace files.
+ *
+ * \see BinaryTraceWriter
+ */
+class BinaryTraceReader
+{
+public:
+  /** The columns of a chunk. */
+  struct Chunk
+  {
+    std::vector<int64_t> time;                  //!< Time, in nanoseconds.
+    std::vector<uint32_t> node;                 //!< Node id.
+    std::vector<uint32_t> device;               //!< Device index.
+    std::vector<uint8_t> kind;                  //!< Event kind.
+    std::vector<uint64_t> uid;                  //!< Packet uid.
+    std::vector<uint32_t> size;                 //!< Packet size.
+    std::vector<std::vector<uint64_t> > fields; //!< Additional fields.
+  };
+
+  /** A record. */
+  struct Record
+  {
+    int64_t time;                 //!< Time, in nanoseconds.
+    uint32_t node;                //!< Node id.
+    uint32_t device;              //!< Device index.
+    uint8_t kind;                 //!< Event kind.
+    uint64_t uid;                 //!< Packet uid.
+    uint32_t size;                //!< Packet size.
+    std::vector<uint64_t> fields; //!< Additional fields.
+  };
+
+  BinaryTraceReader ();
+
+  /**
+   * \brief Open a binary trace file and read its header.
+   *
+   * \param [in] filename The name of the file.
+   * \returns false if the file cannot be read, or is not a binary trace file.
+   */
+  bool Open (std::string const &filename);
+
+  /**
+   * \returns The number of additional fields of the records.
+   */
+  uint32_t GetNFields (void) const;
+
+  /**
+   * \param [in] i The index of an additional field.
+   * \returns The name of the field.
+   */
+  std::string GetFieldName (uint32_t i) const;
+
+  /**
+   * \brief Read the next chunk.
+   *
+   * \param [out] chunk The columns of the chunk.
+   * \returns false at the end of the file, or if the file is corrupted.
+   */
+  bool ReadChunk (Chunk &chunk);
+
+  /**
+   * \brief Read the next record.
+   *
+   * \param [out] record The record.
+   * \returns false at the end of the file, or if the file is corrupted.
+   */
+  bool Read (Record &record);
+
+private:
+  /**
+   * \brief Read a column.
+   * \param [out] column The column.
+   * \param [in] n The number of values.
+   * \returns false if the column cannot be read.
+   */
+  template <typename T>
+  bool ReadColumn (std::vector<T> &column, uint32_t n);
+
+  std::ifstream m_file;               //!< File stream.
+  bool m_swapMode;                    //!< File written in foreign byte order.
+  std::vector<std::string> m_names;   //!< Additional field names.
+  Chunk m_chunk;                      //!< Chunk read by Read.
+  uint32_t m_next;                    //!< Next record of m_chunk.
+};
+
+} // namespace ns3
+
+#endif /* BINARY_TRACE_FILE_H */
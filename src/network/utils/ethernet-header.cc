@@ -160,15 +160,30 @@ void
 EthernetHeader::Serialize (Buffer::Iterator start) const
 {
   NS_LOG_FUNCTION (this << &start);
-  Buffer::Iterator i = start;
+  uint8_t buffer[PREAMBLE_SIZE + LENGTH_SIZE + 2*MAC_ADDR_SIZE];
+  start.Write (buffer, SerializeTo (buffer, 0));
+}
+uint32_t
+EthernetHeader::SerializeTo (uint8_t *buffer, uint32_t payloadSize) const
+{
+  NS_LOG_FUNCTION (this << &buffer << payloadSize);
+  uint8_t *i = buffer;
 
   if (m_enPreambleSfd)
     {
-      i.WriteU64 (m_preambleSfd);
+      // least significant byte first, as Buffer::Iterator::WriteU64
+      for (int j = 0; j < PREAMBLE_SIZE; j++)
+        {
+          *i++ = (m_preambleSfd >> (8 * j)) & 0xff;
+        }
     }
-  WriteTo (i, m_destination);
-  WriteTo (i, m_source);
-  i.WriteHtonU16 (m_lengthType);
+  m_destination.CopyTo (i);
+  i += MAC_ADDR_SIZE;
+  m_source.CopyTo (i);
+  i += MAC_ADDR_SIZE;
+  *i++ = m_lengthType >> 8;
+  *i++ = m_lengthType & 0xff;
+  return i - buffer;
 }
 uint32_t
 EthernetHeader::Deserialize (Buffer::Iterator start)
@@ -115,6 +115,13 @@ public:
   virtual uint32_t GetSerializedSize (void) const;
   virtual void Serialize (Buffer::Iterator start) const;
   virtual uint32_t Deserialize (Buffer::Iterator start);
+  /**
+   * \brief Serialize the header in contiguous memory (see HeaderTraits).
+   * \param [out] buffer The buffer, of at least 22 bytes.
+   * \param [in] payloadSize The number of bytes which follow the header.
+   * \returns The number of bytes written.
+   */
+  uint32_t SerializeTo (uint8_t *buffer, uint32_t payloadSize) const;
 private:
   static const int PREAMBLE_SIZE = 8; //!< size of the preamble_sfd header field
   static const int LENGTH_SIZE = 2;   //!< size of the length_type header field
@@ -130,6 +137,15 @@ private:
   Mac48Address m_destination;   //!< Destination address
 };
 
+/**
+ * \brief The Ethernet header can be added to a packet without virtual calls.
+ */
+template <>
+struct HeaderTraits<EthernetHeader>
+{
+  static constexpr uint32_t MAX_SIZE = 22; //!< The size of the header, with the preamble.
+};
+
 } // namespace ns3
 
 
@@ -43,6 +43,7 @@ NetDeviceQueue::GetTypeId (void)
 NetDeviceQueue::NetDeviceQueue ()
   : m_stoppedByDevice (false),
     m_stoppedByQueueLimits (false),
+    m_room (1),
     NS_LOG_TEMPLATE_DEFINE ("NetDeviceQueueInterface")
 {
   NS_LOG_FUNCTION (this);
@@ -54,6 +55,7 @@ NetDeviceQueue::~NetDeviceQueue ()
 
   m_queueLimits = 0;
   m_wakeCallback.Nullify ();
+  m_initRoom.Nullify ();
   m_device = 0;
 }
 
@@ -64,6 +66,33 @@ NetDeviceQueue::IsStopped (void) const
   return m_stoppedByDevice || m_stoppedByQueueLimits;
 }
 
+uint32_t
+NetDeviceQueue::GetRoom (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_room;
+}
+
+void
+NetDeviceQueue::UpdateRoom (QueueSize current, QueueSize max)
+{
+  NS_LOG_FUNCTION (this << current << max);
+
+  NS_ASSERT_MSG (m_device, "Aggregated NetDevice not set");
+
+  uint32_t free = (current < max ? max.GetValue () - current.GetValue () : 0);
+
+  if (max.GetUnit () == QueueSizeUnit::BYTES && m_device->GetMtu () > 0)
+    {
+      // count how many packets as large as the MTU fit in the free space
+      m_room = free / m_device->GetMtu ();
+    }
+  else
+    {
+      m_room = free;
+    }
+}
+
 void
 NetDeviceQueue::Start (void)
 {
@@ -100,6 +129,11 @@ NetDeviceQueue::NotifyAggregatedObject (Ptr<NetDeviceQueueInterface> ndqi)
 
   m_device = ndqi->GetObject<NetDevice> ();
   NS_ABORT_MSG_IF (!m_device, "No NetDevice object was aggregated to the NetDeviceQueueInterface");
+
+  if (!m_initRoom.IsNull ())
+    {
+      m_initRoom ();
+    }
 }
 
 void
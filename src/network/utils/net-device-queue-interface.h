@@ -28,6 +28,7 @@
 #include "ns3/log.h"
 #include "ns3/net-device.h"
 #include "ns3/object-factory.h"
+#include "ns3/queue-size.h"
 
 namespace ns3 {
 
@@ -93,6 +94,19 @@ public:
    */
   virtual bool IsStopped (void) const;
 
+  /**
+   * \brief Get the room left in the device transmission queue.
+   * \return the number of MTU-sized packets the device queue is able to store.
+   *
+   * The value is computed from the limits of the device queue once its traces
+   * are connected (see ConnectQueueTraces) and the NetDeviceQueueInterface is
+   * aggregated to the device, then updated by the methods connected to the
+   * traces. It can be used by queue discs to decide how many packets to
+   * dequeue at once. If the device queue traces are not connected, room for
+   * one packet is reported.
+   */
+  uint32_t GetRoom (void) const;
+
   /**
    * \brief Notify this NetDeviceQueue that the NetDeviceQueueInterface was
    *        aggregated to an object.
@@ -204,11 +218,27 @@ public:
   void ConnectQueueTraces (Ptr<QueueType> queue);
 
 private:
+  /**
+   * \brief Compute the room left in the device queue, in MTU-sized packets
+   * \param current the current size of the device queue
+   * \param max the maximum size of the device queue
+   */
+  void UpdateRoom (QueueSize current, QueueSize max);
+
+  /**
+   * \brief Compute the room left in a device queue, in MTU-sized packets
+   * \param queue the device queue
+   */
+  template <typename QueueType>
+  void InitRoom (QueueType* queue);
+
   bool m_stoppedByDevice;         //!< True if the queue has been stopped by the device
   bool m_stoppedByQueueLimits;    //!< True if the queue has been stopped by a queue limits object
   Ptr<QueueLimits> m_queueLimits; //!< Queue limits object
   WakeCallback m_wakeCallback;    //!< Wake callback
   Ptr<NetDevice> m_device;        //!< the netdevice aggregated to the NetDeviceQueueInterface
+  uint32_t m_room;                //!< MTU-sized packets the device queue can store
+  Callback<void> m_initRoom;      //!< Compute the room from the limits of the device queue
 
   NS_LOG_TEMPLATE_DECLARE;        //!< redefinition of the log component
 };
@@ -335,6 +365,22 @@ NetDeviceQueue::ConnectQueueTraces (Ptr<QueueType> queue)
   queue->TraceConnectWithoutContext ("DropBeforeEnqueue",
                                      MakeCallback (&NetDeviceQueue::PacketDiscarded<QueueType>, this)
                                      .Bind (PeekPointer (queue)));
+
+  // The room can be computed only once the device is known, i.e., after the
+  // NetDeviceQueueInterface has been aggregated to it
+  m_initRoom = MakeCallback (&NetDeviceQueue::InitRoom<QueueType>, this).Bind (PeekPointer (queue));
+  if (m_device)
+    {
+      m_initRoom ();
+    }
+}
+
+template <typename QueueType>
+void
+NetDeviceQueue::InitRoom (QueueType* queue)
+{
+  NS_LOG_FUNCTION (this << queue);
+  UpdateRoom (queue->GetCurrentSize (), queue->GetMaxSize ());
 }
 
 template <typename QueueType>
@@ -346,13 +392,12 @@ NetDeviceQueue::PacketEnqueued (QueueType* queue, Ptr<const typename QueueType::
   // Inform BQL
   NotifyQueuedBytes (item->GetSize ());
 
-  NS_ASSERT_MSG (m_device, "Aggregated NetDevice not set");
-  Ptr<Packet> p = Create<Packet> (m_device->GetMtu ());
-
   // After enqueuing a packet, we need to check whether the queue is able to
   // store another packet. If not, we stop the queue
 
-  if (queue->GetCurrentSize () + p > queue->GetMaxSize ())
+  UpdateRoom (queue->GetCurrentSize (), queue->GetMaxSize ());
+
+  if (m_room == 0)
     {
       NS_LOG_DEBUG ("The device queue is being stopped (" << queue->GetCurrentSize ()
                     << " inside)");
@@ -369,14 +414,13 @@ NetDeviceQueue::PacketDequeued (QueueType* queue, Ptr<const typename QueueType::
   // Inform BQL
   NotifyTransmittedBytes (item->GetSize ());
 
-  NS_ASSERT_MSG (m_device, "Aggregated NetDevice not set");
-  Ptr<Packet> p = Create<Packet> (m_device->GetMtu ());
-
   // After dequeuing a packet, if there is room for another packet we
   // call Wake () that ensures that the queue is not stopped and restarts
   // the queue disc if the queue was stopped
 
-  if (queue->GetCurrentSize () + p <= queue->GetMaxSize ())
+  UpdateRoom (queue->GetCurrentSize (), queue->GetMaxSize ());
+
+  if (m_room > 0)
     {
       Wake ();
     }
@@ -396,6 +440,7 @@ NetDeviceQueue::PacketDiscarded (QueueType* queue, Ptr<const typename QueueType:
   NS_LOG_ERROR ("BUG! No room in the device queue for the received packet! ("
                 << queue->GetCurrentSize () << " inside)");
 
+  m_room = 0;
   Stop ();
 }
 
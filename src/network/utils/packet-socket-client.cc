@@ -30,6 +30,7 @@
 #include "ns3/uinteger.h"
 #include "ns3/abort.h"
 #include "packet-socket-client.h"
+#include "ns3/packet-census.h"
 #include <cstdlib>
 #include <cstdio>
 
@@ -154,6 +155,7 @@ void
 PacketSocketClient::Send (void)
 {
   NS_LOG_FUNCTION (this);
+  PacketCensus::ContextScope scope (GetInstanceTypeId ());
   NS_ASSERT (m_sendEvent.IsExpired ());
 
   Ptr<Packet> p = Create<Packet> (m_size);
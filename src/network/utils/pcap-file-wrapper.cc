@@ -17,6 +17,7 @@
  */
 
 #include "ns3/log.h"
+#include "ns3/assert.h"
 #include "ns3/boolean.h"
 #include "ns3/uinteger.h"
 #include "ns3/buffer.h"
@@ -46,12 +47,31 @@ PcapFileWrapper::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&PcapFileWrapper::m_nanosecMode),
                    MakeBooleanChecker())
+    .AddAttribute ("TruncateVirtualPayload",
+                   "Whether packets are truncated at the start of their zero-filled "
+                   "virtual payload rather than written in full (cf. Packet::GetVirtualSize).",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PcapFileWrapper::m_truncateVirtual),
+                   MakeBooleanChecker())
+    .AddAttribute ("BufferSize",
+                   "Size of the blocks in which records are gathered before being "
+                   "written to the file; zero writes each record to the file stream.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_bufferSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("AsyncWrite",
+                   "Whether full blocks are written to the file by a background "
+                   "thread rather than by the simulation (requires a BufferSize).",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PcapFileWrapper::m_asyncWrite),
+                   MakeBooleanChecker())
   ;
   return tid;
 }
 
 
 PcapFileWrapper::PcapFileWrapper ()
+  : m_interface (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -66,6 +86,10 @@ bool
 PcapFileWrapper::Fail (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_ngFile)
+    {
+      return m_ngFile->Fail ();
+    }
   return m_file.Fail ();
 }
 
@@ -73,12 +97,20 @@ bool
 PcapFileWrapper::Eof (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_ngFile)
+    {
+      return m_ngFile->Eof ();
+    }
   return m_file.Eof ();
 }
 void 
 PcapFileWrapper::Clear (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_ngFile)
+    {
+      m_ngFile->Clear ();
+    }
   m_file.Clear ();
 }
 
@@ -86,6 +118,8 @@ void
 PcapFileWrapper::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  // the pcapng file is closed when its last wrapper releases it
+  m_ngFile = 0;
   m_file.Close ();
 }
 
@@ -113,12 +147,48 @@ PcapFileWrapper::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrec
     {
       m_file.Init (dataLinkType, m_snapLen, tzCorrection, false, m_nanosecMode);
     } 
+  m_file.SetTruncateVirtualPayload (m_truncateVirtual);
+  m_file.SetWriteBuffer (m_bufferSize, m_asyncWrite);
+}
+
+void
+PcapFileWrapper::Init (Ptr<PcapngFile> file, uint32_t dataLinkType,
+                       std::string const &name, uint32_t snapLen)
+{
+  NS_LOG_FUNCTION (this << file << dataLinkType << name << snapLen);
+  if (snapLen == std::numeric_limits<uint32_t>::max ())
+    {
+      snapLen = m_snapLen;
+    }
+  m_ngFile = file;
+  if (m_ngFile->GetNInterfaces () == 0 && m_bufferSize > 0)
+    {
+      // the first wrapper of the file sets its write buffer
+      m_ngFile->SetWriteBuffer (m_bufferSize, m_asyncWrite);
+    }
+  m_interface = m_ngFile->AddInterface (dataLinkType, snapLen, name,
+                                        m_nanosecMode, m_truncateVirtual);
+}
+
+uint64_t
+PcapFileWrapper::GetPcapngTimestamp (Time t) const
+{
+  if (m_ngFile->IsNanoSecMode (m_interface))
+    {
+      return t.GetNanoSeconds ();
+    }
+  return t.GetMicroSeconds ();
 }
 
 void
 PcapFileWrapper::Write (Time t, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << t << p);
+  if (m_ngFile)
+    {
+      m_ngFile->Write (m_interface, GetPcapngTimestamp (t), p);
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -139,6 +209,11 @@ void
 PcapFileWrapper::Write (Time t, const Header &header, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << t << &header << p);
+  if (m_ngFile)
+    {
+      m_ngFile->Write (m_interface, GetPcapngTimestamp (t), header, p);
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -159,6 +234,11 @@ void
 PcapFileWrapper::Write (Time t, uint8_t const *buffer, uint32_t length)
 {
   NS_LOG_FUNCTION (this << t << &buffer << length);
+  if (m_ngFile)
+    {
+      m_ngFile->Write (m_interface, GetPcapngTimestamp (t), buffer, length);
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -184,6 +264,7 @@ PcapFileWrapper::Read (Time &t)
   uint32_t origLen;
   uint32_t readLen;
 
+  NS_ASSERT_MSG (!m_ngFile, "Reading from a pcapng interface is not supported");
   uint32_t maxBytes=65536;
   uint8_t  datbuf[maxBytes];
 
@@ -246,6 +327,10 @@ uint32_t
 PcapFileWrapper::GetSnapLen (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_ngFile)
+    {
+      return m_ngFile->GetSnapLen (m_interface);
+    }
   return m_file.GetSnapLen ();
 }
 
@@ -253,6 +338,10 @@ uint32_t
 PcapFileWrapper::GetDataLinkType (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_ngFile)
+    {
+      return m_ngFile->GetDataLinkType (m_interface);
+    }
   return m_file.GetDataLinkType ();
 }
 
@@ -27,6 +27,7 @@
 #include "ns3/object.h"
 #include "ns3/nstime.h"
 #include "pcap-file.h"
+#include "pcapng-file.h"
 
 namespace ns3 {
 
@@ -109,6 +110,28 @@ public:
              uint32_t snapLen = std::numeric_limits<uint32_t>::max (), 
              int32_t tzCorrection = PcapFile::ZONE_DEFAULT);
 
+  /**
+   * Write to a new interface of a pcapng file, which may be shared with
+   * other wrappers, instead of to a pcap file of its own.  The interface
+   * gets the "CaptureSize", "NanosecMode" and "TruncateVirtualPayload"
+   * attributes of this wrapper, unless a snaplen is provided.  The
+   * wrapper is then write-only: Read is not supported.  The first wrapper
+   * of a file sets its write buffer from its "BufferSize" and "AsyncWrite"
+   * attributes.
+   *
+   * \param file The pcapng file, opened with write permissions.
+   *
+   * \param dataLinkType A data link type as defined in the pcap library.
+   *
+   * \param name The name of the interface, which may be empty.
+   *
+   * \param snapLen An optional maximum size for packets written to the file.
+   */
+  void Init (Ptr<PcapngFile> file,
+             uint32_t dataLinkType,
+             std::string const &name,
+             uint32_t snapLen = std::numeric_limits<uint32_t>::max ());
+
   /**
    * \brief Write the next packet to file
    * 
@@ -221,9 +244,21 @@ public:
   uint32_t GetDataLinkType (void);
 
 private:
+  /**
+   * \brief Convert a time to a timestamp of the pcapng interface
+   * \param t the time
+   * \returns the timestamp, in microseconds or nanoseconds
+   */
+  uint64_t GetPcapngTimestamp (Time t) const;
+
   PcapFile m_file; //!< Pcap file
+  Ptr<PcapngFile> m_ngFile; //!< Pcapng file, if writing to a pcapng interface
+  uint32_t m_interface; //!< Interface in the pcapng file
   uint32_t m_snapLen; //!< max length of saved packets
   bool     m_nanosecMode; //!< Timestamps in nanosecond mode
+  bool     m_truncateVirtual; //!< Truncate packets at their virtual payload
+  uint32_t m_bufferSize; //!< Size of the write blocks, or zero
+  bool     m_asyncWrite; //!< Write blocks from a background thread
 };
 
 } // namespace ns3
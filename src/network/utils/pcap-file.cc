@@ -50,7 +50,8 @@ const uint16_t VERSION_MINOR = 4;             /**< Minor version of supported pc
 PcapFile::PcapFile ()
   : m_file (),
     m_swapMode (false),
-    m_nanosecMode (false)
+    m_nanosecMode (false),
+    m_truncateVirtual (false)
 {
   NS_LOG_FUNCTION (this);
   FatalImpl::RegisterStream (&m_file); 
@@ -68,12 +69,14 @@ bool
 PcapFile::Fail (void) const
 {
   NS_LOG_FUNCTION (this);
+  m_buffer.Sync ();
   return m_file.fail ();
 }
 bool 
 PcapFile::Eof (void) const
 {
   NS_LOG_FUNCTION (this);
+  m_buffer.Sync ();
   return m_file.eof ();
 }
 void 
@@ -88,6 +91,7 @@ void
 PcapFile::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  m_buffer.Detach ();
   m_file.close ();
 }
 
@@ -206,6 +210,7 @@ PcapFile::WriteFileHeader (void)
   // If we're initializing the file, we need to write the pcap file header
   // at the start of the file.
   //
+  m_buffer.Sync ();
   m_file.seekp (0, std::ios::beg);
  
   //
@@ -231,16 +236,18 @@ PcapFile::WriteFileHeader (void)
     }
 
   //
-  // Watch out for memory alignment differences between machines, so write
-  // them all individually.
+  // Watch out for memory alignment differences between machines, so copy
+  // them all individually, and write them at once.
   //
-  m_file.write ((const char *)&headerOut->m_magicNumber, sizeof(headerOut->m_magicNumber));
-  m_file.write ((const char *)&headerOut->m_versionMajor, sizeof(headerOut->m_versionMajor));
-  m_file.write ((const char *)&headerOut->m_versionMinor, sizeof(headerOut->m_versionMinor));
-  m_file.write ((const char *)&headerOut->m_zone, sizeof(headerOut->m_zone));
-  m_file.write ((const char *)&headerOut->m_sigFigs, sizeof(headerOut->m_sigFigs));
-  m_file.write ((const char *)&headerOut->m_snapLen, sizeof(headerOut->m_snapLen));
-  m_file.write ((const char *)&headerOut->m_type, sizeof(headerOut->m_type));
+  uint8_t out[24];
+  std::memcpy (out, &headerOut->m_magicNumber, 4);
+  std::memcpy (out + 4, &headerOut->m_versionMajor, 2);
+  std::memcpy (out + 6, &headerOut->m_versionMinor, 2);
+  std::memcpy (out + 8, &headerOut->m_zone, 4);
+  std::memcpy (out + 12, &headerOut->m_sigFigs, 4);
+  std::memcpy (out + 16, &headerOut->m_snapLen, 4);
+  std::memcpy (out + 20, &headerOut->m_type, 4);
+  m_file.write ((const char *)out, sizeof (out));
 }
 
 void
@@ -399,13 +406,34 @@ PcapFile::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t timeZoneCorrect
   WriteFileHeader ();
 }
 
-uint32_t
-PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
+void
+PcapFile::SetTruncateVirtualPayload (bool truncate)
 {
-  NS_LOG_FUNCTION (this << tsSec << tsUsec << totalLen);
-  NS_ASSERT (m_file.good ());
+  NS_LOG_FUNCTION (this << truncate);
+  m_truncateVirtual = truncate;
+}
+
+void
+PcapFile::SetWriteBuffer (uint32_t blockSize, bool async)
+{
+  NS_LOG_FUNCTION (this << blockSize << async);
+  if (blockSize == 0)
+    {
+      m_buffer.Detach ();
+    }
+  else
+    {
+      m_buffer.Attach (&m_file, blockSize, async);
+    }
+}
 
+uint32_t
+PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen,
+                             uint32_t maxInclLen)
+{
+  NS_LOG_FUNCTION (this << tsSec << tsUsec << totalLen << maxInclLen);
   uint32_t inclLen = totalLen > m_fileHeader.m_snapLen ? m_fileHeader.m_snapLen : totalLen;
+  inclLen = std::min (inclLen, maxInclLen);
 
   PcapRecordHeader header;
   header.m_tsSec = tsSec;
@@ -419,14 +447,24 @@ PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
     }
 
   //
-  // Watch out for memory alignment differences between machines, so write
-  // them all individually.
+  // Watch out for memory alignment differences between machines, so copy
+  // them all individually, and write them at once.
   //
-  m_file.write ((const char *)&header.m_tsSec, sizeof(header.m_tsSec));
-  m_file.write ((const char *)&header.m_tsUsec, sizeof(header.m_tsUsec));
-  m_file.write ((const char *)&header.m_inclLen, sizeof(header.m_inclLen));
-  m_file.write ((const char *)&header.m_origLen, sizeof(header.m_origLen));
-  NS_BUILD_DEBUG(m_file.flush());
+  uint8_t out[16];
+  std::memcpy (out, &header.m_tsSec, 4);
+  std::memcpy (out + 4, &header.m_tsUsec, 4);
+  std::memcpy (out + 8, &header.m_inclLen, 4);
+  std::memcpy (out + 12, &header.m_origLen, 4);
+  if (m_buffer.IsAttached ())
+    {
+      m_buffer.Write (out, sizeof (out));
+    }
+  else
+    {
+      NS_ASSERT (m_file.good ());
+      m_file.write ((const char *)out, sizeof (out));
+      NS_BUILD_DEBUG(m_file.flush());
+    }
   return inclLen;
 }
 
@@ -435,6 +473,11 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const * const data, ui
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << &data << totalLen);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalLen);
+  if (m_buffer.IsAttached ())
+    {
+      m_buffer.Write (data, inclLen);
+      return;
+    }
   m_file.write ((const char *)data, inclLen);
   NS_BUILD_DEBUG(m_file.flush());
 }
@@ -443,7 +486,17 @@ void
 PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << p);
-  uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, p->GetSize ());
+  uint32_t maxInclLen = std::numeric_limits<uint32_t>::max ();
+  if (m_truncateVirtual && p->GetVirtualSize () > 0)
+    {
+      maxInclLen = p->GetVirtualStart ();
+    }
+  uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, p->GetSize (), maxInclLen);
+  if (m_buffer.IsAttached ())
+    {
+      p->CopyData (m_buffer.Reserve (inclLen), inclLen);
+      return;
+    }
   p->CopyData (&m_file, inclLen);
   NS_BUILD_DEBUG(m_file.flush());
 }
@@ -454,12 +507,24 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, const Header &header, Ptr<cons
   NS_LOG_FUNCTION (this << tsSec << tsUsec << &header << p);
   uint32_t headerSize = header.GetSerializedSize ();
   uint32_t totalSize = headerSize + p->GetSize ();
-  uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalSize);
+  uint32_t maxInclLen = std::numeric_limits<uint32_t>::max ();
+  if (m_truncateVirtual && p->GetVirtualSize () > 0)
+    {
+      maxInclLen = headerSize + p->GetVirtualStart ();
+    }
+  uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalSize, maxInclLen);
 
   Buffer headerBuffer;
   headerBuffer.AddAtStart (headerSize);
   header.Serialize (headerBuffer.Begin ());
   uint32_t toCopy = std::min (headerSize, inclLen);
+  if (m_buffer.IsAttached ())
+    {
+      uint8_t *record = m_buffer.Reserve (inclLen);
+      headerBuffer.CopyData (record, toCopy);
+      p->CopyData (record + toCopy, inclLen - toCopy);
+      return;
+    }
   headerBuffer.CopyData (&m_file, toCopy);
   inclLen -= toCopy;
   p->CopyData (&m_file, inclLen);
@@ -24,7 +24,9 @@
 #include <string>
 #include <fstream>
 #include <stdint.h>
+#include <limits>
 #include "ns3/ptr.h"
+#include "trace-file-buffer.h"
 
 namespace ns3 {
 
@@ -153,6 +155,34 @@ public:
    */
   void Write (uint32_t tsSec, uint32_t tsUsec, const Header &header, Ptr<const Packet> p);
 
+  /**
+   * \brief Truncate captured packets at the start of their virtual payload
+   *
+   * When enabled, packet records written from a Packet only include the
+   * real bytes which precede the zero-filled virtual payload (see
+   * Packet::GetVirtualSize), exactly as if the snapshot length had been
+   * set to that size for this packet. The original length of the packet
+   * is still recorded. This avoids writing megabytes of zeroes when
+   * tracing bulk transfers of dummy application data.
+   *
+   * \param truncate true to truncate packets at their virtual payload
+   */
+  void SetTruncateVirtualPayload (bool truncate);
+
+  /**
+   * \brief Buffer the packet records written to the file
+   *
+   * By default, each record is written to the file stream field by field.
+   * When a buffer size is set, the records are gathered in blocks of that
+   * size, each written to the file in a single operation, optionally by a
+   * background I/O thread shared by all the files (see TraceFileBuffer).
+   * The file must have been opened for writing.  A block size of zero
+   * writes the pending blocks and restores the default behavior.
+   *
+   * \param blockSize the size of the write blocks, in bytes, or zero
+   * \param async true to write the blocks from a background thread
+   */
+  void SetWriteBuffer (uint32_t blockSize, bool async);
 
   /**
    * \brief Read next packet from file
@@ -357,9 +387,11 @@ private:
    * \param tsSec Time stamp (seconds part)
    * \param tsUsec Time stamp (microseconds part)
    * \param totalLen total packet length
+   * \param maxInclLen maximum number of bytes to write, in addition to the snaplen
    * \returns the length of the packet to write in the Pcap file
    */
-  uint32_t WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen);
+  uint32_t WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen,
+                              uint32_t maxInclLen = std::numeric_limits<uint32_t>::max ());
 
   /**
    * \brief Read and verify a Pcap file header
@@ -371,6 +403,8 @@ private:
   PcapFileHeader m_fileHeader;  //!< file header
   bool m_swapMode;              //!< swap mode
   bool m_nanosecMode;           //!< nanosecond timestamp mode
+  bool m_truncateVirtual;       //!< truncate packets at their virtual payload
+  mutable TraceFileBuffer m_buffer; //!< write buffer, if enabled
 };
 
 } // namespace ns3
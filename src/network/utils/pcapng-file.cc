@@ -0,0 +1,541 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include <map>
+#include "ns3/assert.h"
+#include "ns3/packet.h"
+#include "ns3/header.h"
+#include "ns3/buffer.h"
+#include "ns3/fatal-impl.h"
+#include "ns3/log.h"
+#include "ns3/build-profile.h"
+#include "pcapng-file.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapngFile");
+
+namespace {
+
+const uint32_t SHB_TYPE = 0x0a0d0d0a;         //!< Section Header Block type
+const uint32_t IDB_TYPE = 0x00000001;         //!< Interface Description Block type
+const uint32_t EPB_TYPE = 0x00000006;         //!< Enhanced Packet Block type
+const uint32_t BYTE_ORDER_MAGIC = 0x1a2b3c4d; //!< Section Header Block byte-order magic
+const uint16_t VERSION_MAJOR = 1;             //!< Major version of the pcapng format
+const uint16_t VERSION_MINOR = 0;             //!< Minor version of the pcapng format
+
+const uint16_t OPT_ENDOFOPT = 0;              //!< End of options
+const uint16_t OPT_IF_NAME = 2;               //!< Interface name option
+const uint16_t OPT_IF_TSRESOL = 9;            //!< Interface timestamp resolution option
+
+const uint32_t EPB_HEADER_SIZE = 28;          //!< Enhanced Packet Block size before the data
+const uint32_t MAX_BLOCK_SIZE = 0x4000000;    //!< Largest block accepted when reading
+
+/** The files open for writing, by name. */
+std::map<std::string, PcapngFile *> g_writers;
+
+/**
+ * \param [in] len A length.
+ * \returns The length padded to 32 bits.
+ */
+inline uint32_t
+Pad32 (uint32_t len)
+{
+  return (len + 3) & ~3U;
+}
+
+/**
+ * \brief Store a 32-bit value in host byte order.
+ * \param [out] p Where to store the value.
+ * \param [in] v The value.
+ * \returns The position after the value.
+ */
+inline uint8_t *
+Put32 (uint8_t *p, uint32_t v)
+{
+  std::memcpy (p, &v, 4);
+  return p + 4;
+}
+
+/**
+ * \brief Store a 16-bit value in host byte order.
+ * \param [out] p Where to store the value.
+ * \param [in] v The value.
+ * \returns The position after the value.
+ */
+inline uint8_t *
+Put16 (uint8_t *p, uint16_t v)
+{
+  std::memcpy (p, &v, 2);
+  return p + 2;
+}
+
+/**
+ * \param [in] v A value.
+ * \returns The value with its byte order swapped.
+ */
+inline uint32_t
+Swap32 (uint32_t v)
+{
+  return ((v & 0xff) << 24) | ((v & 0xff00) << 8) | ((v >> 8) & 0xff00) | (v >> 24);
+}
+
+} // unnamed namespace
+
+PcapngFile::PcapngFile ()
+  : m_file (),
+    m_writing (false),
+    m_swapMode (false)
+{
+  NS_LOG_FUNCTION (this);
+  FatalImpl::RegisterStream (&m_file);
+}
+
+PcapngFile::~PcapngFile ()
+{
+  NS_LOG_FUNCTION (this);
+  FatalImpl::UnregisterStream (&m_file);
+  Close ();
+}
+
+bool
+PcapngFile::Fail (void) const
+{
+  NS_LOG_FUNCTION (this);
+  m_buffer.Sync ();
+  return m_file.fail ();
+}
+
+bool
+PcapngFile::Eof (void) const
+{
+  NS_LOG_FUNCTION (this);
+  m_buffer.Sync ();
+  return m_file.eof ();
+}
+
+void
+PcapngFile::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.clear ();
+}
+
+void
+PcapngFile::Open (std::string const &filename, std::ios::openmode mode)
+{
+  NS_LOG_FUNCTION (this << filename << mode);
+  NS_ASSERT ((mode & std::ios::app) == 0);
+  NS_ASSERT (!m_file.is_open ());
+  m_filename = filename;
+  m_interfaces.clear ();
+  m_swapMode = false;
+  m_file.open (filename.c_str (), mode | std::ios::binary);
+  if (mode & std::ios::in)
+    {
+      uint32_t type;
+      std::vector<uint8_t> body;
+      if (!ReadBlock (type, body) || type != SHB_TYPE)
+        {
+          m_file.setstate (std::ios::failbit);
+        }
+      return;
+    }
+  if (m_file.fail ())
+    {
+      return;
+    }
+
+  uint8_t *p = BeginBlock (28);
+  p = Put32 (p, SHB_TYPE);
+  p = Put32 (p, 28);
+  p = Put32 (p, BYTE_ORDER_MAGIC);
+  p = Put16 (p, VERSION_MAJOR);
+  p = Put16 (p, VERSION_MINOR);
+  // unknown section length
+  p = Put32 (p, 0xffffffff);
+  p = Put32 (p, 0xffffffff);
+  Put32 (p, 28);
+  EndBlock (28);
+
+  m_writing = true;
+  g_writers[m_filename] = this;
+}
+
+void
+PcapngFile::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_buffer.Detach ();
+  m_file.close ();
+  if (m_writing)
+    {
+      std::map<std::string, PcapngFile *>::iterator it = g_writers.find (m_filename);
+      if (it != g_writers.end () && it->second == this)
+        {
+          g_writers.erase (it);
+        }
+      m_writing = false;
+    }
+}
+
+void
+PcapngFile::SetWriteBuffer (uint32_t blockSize, bool async)
+{
+  NS_LOG_FUNCTION (this << blockSize << async);
+  if (blockSize == 0)
+    {
+      m_buffer.Detach ();
+    }
+  else
+    {
+      m_buffer.Attach (&m_file, blockSize, async);
+    }
+}
+
+Ptr<PcapngFile>
+PcapngFile::Lookup (std::string const &filename)
+{
+  NS_LOG_FUNCTION (filename);
+  std::map<std::string, PcapngFile *>::const_iterator it = g_writers.find (filename);
+  if (it == g_writers.end ())
+    {
+      return 0;
+    }
+  return it->second;
+}
+
+uint32_t
+PcapngFile::AddInterface (uint32_t dataLinkType, uint32_t snapLen,
+                          std::string const &name, bool nanosecMode,
+                          bool truncateVirtual)
+{
+  NS_LOG_FUNCTION (this << dataLinkType << snapLen << name << nanosecMode << truncateVirtual);
+  NS_ASSERT (m_writing);
+  NS_ASSERT (dataLinkType <= 0xffff);
+
+  Interface iface;
+  iface.dataLinkType = dataLinkType;
+  iface.snapLen = snapLen;
+  iface.name = name;
+  iface.nanosecMode = nanosecMode;
+  iface.truncateVirtual = truncateVirtual;
+  m_interfaces.push_back (iface);
+
+  uint32_t nameLen = name.size ();
+  uint32_t size = 16 + 8 + 4 + (nameLen > 0 ? 4 + Pad32 (nameLen) : 0) + 4;
+  uint8_t *p = BeginBlock (size);
+  p = Put32 (p, IDB_TYPE);
+  p = Put32 (p, size);
+  p = Put16 (p, dataLinkType);
+  p = Put16 (p, 0);
+  p = Put32 (p, snapLen);
+  if (nameLen > 0)
+    {
+      p = Put16 (p, OPT_IF_NAME);
+      p = Put16 (p, nameLen);
+      std::memcpy (p, name.data (), nameLen);
+      std::memset (p + nameLen, 0, Pad32 (nameLen) - nameLen);
+      p += Pad32 (nameLen);
+    }
+  p = Put16 (p, OPT_IF_TSRESOL);
+  p = Put16 (p, 1);
+  // resolution of 10^-6 or 10^-9 seconds, then padding
+  p[0] = nanosecMode ? 9 : 6;
+  std::memset (p + 1, 0, 3);
+  p += 4;
+  p = Put16 (p, OPT_ENDOFOPT);
+  p = Put16 (p, 0);
+  Put32 (p, size);
+  EndBlock (size);
+
+  return m_interfaces.size () - 1;
+}
+
+uint32_t
+PcapngFile::GetNInterfaces (void) const
+{
+  return m_interfaces.size ();
+}
+
+uint32_t
+PcapngFile::GetDataLinkType (uint32_t interface) const
+{
+  NS_ASSERT (interface < m_interfaces.size ());
+  return m_interfaces[interface].dataLinkType;
+}
+
+uint32_t
+PcapngFile::GetSnapLen (uint32_t interface) const
+{
+  NS_ASSERT (interface < m_interfaces.size ());
+  return m_interfaces[interface].snapLen;
+}
+
+bool
+PcapngFile::IsNanoSecMode (uint32_t interface) const
+{
+  NS_ASSERT (interface < m_interfaces.size ());
+  return m_interfaces[interface].nanosecMode;
+}
+
+std::string
+PcapngFile::GetInterfaceName (uint32_t interface) const
+{
+  NS_ASSERT (interface < m_interfaces.size ());
+  return m_interfaces[interface].name;
+}
+
+uint8_t *
+PcapngFile::BeginBlock (uint32_t size)
+{
+  if (m_buffer.IsAttached ())
+    {
+      return m_buffer.Reserve (size);
+    }
+  if (m_scratch.size () < size)
+    {
+      m_scratch.resize (size);
+    }
+  return m_scratch.data ();
+}
+
+void
+PcapngFile::EndBlock (uint32_t size)
+{
+  if (m_buffer.IsAttached ())
+    {
+      return;
+    }
+  NS_ASSERT (m_file.good ());
+  m_file.write ((const char *)m_scratch.data (), size);
+  NS_BUILD_DEBUG(m_file.flush());
+}
+
+uint8_t *
+PcapngFile::BeginPacketBlock (uint32_t interface, uint64_t timestamp,
+                              uint32_t inclLen, uint32_t origLen)
+{
+  uint32_t size = EPB_HEADER_SIZE + Pad32 (inclLen) + 4;
+  uint8_t *block = BeginBlock (size);
+  uint8_t *p = Put32 (block, EPB_TYPE);
+  p = Put32 (p, size);
+  p = Put32 (p, interface);
+  p = Put32 (p, timestamp >> 32);
+  p = Put32 (p, timestamp & 0xffffffff);
+  p = Put32 (p, inclLen);
+  Put32 (p, origLen);
+  return block;
+}
+
+void
+PcapngFile::EndPacketBlock (uint8_t *block, uint32_t inclLen)
+{
+  uint32_t size = EPB_HEADER_SIZE + Pad32 (inclLen) + 4;
+  std::memset (block + EPB_HEADER_SIZE + inclLen, 0, Pad32 (inclLen) - inclLen);
+  Put32 (block + size - 4, size);
+  EndBlock (size);
+}
+
+void
+PcapngFile::Write (uint32_t interface, uint64_t timestamp, uint8_t const *data, uint32_t totalLen)
+{
+  NS_LOG_FUNCTION (this << interface << timestamp << &data << totalLen);
+  NS_ASSERT (interface < m_interfaces.size ());
+  uint32_t inclLen = std::min (totalLen, m_interfaces[interface].snapLen);
+  uint8_t *block = BeginPacketBlock (interface, timestamp, inclLen, totalLen);
+  std::memcpy (block + EPB_HEADER_SIZE, data, inclLen);
+  EndPacketBlock (block, inclLen);
+}
+
+void
+PcapngFile::Write (uint32_t interface, uint64_t timestamp, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << interface << timestamp << p);
+  NS_ASSERT (interface < m_interfaces.size ());
+  Interface const &iface = m_interfaces[interface];
+  uint32_t inclLen = std::min (p->GetSize (), iface.snapLen);
+  if (iface.truncateVirtual && p->GetVirtualSize () > 0)
+    {
+      inclLen = std::min (inclLen, p->GetVirtualStart ());
+    }
+  uint8_t *block = BeginPacketBlock (interface, timestamp, inclLen, p->GetSize ());
+  p->CopyData (block + EPB_HEADER_SIZE, inclLen);
+  EndPacketBlock (block, inclLen);
+}
+
+void
+PcapngFile::Write (uint32_t interface, uint64_t timestamp, const Header &header, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << interface << timestamp << &header << p);
+  NS_ASSERT (interface < m_interfaces.size ());
+  Interface const &iface = m_interfaces[interface];
+  uint32_t headerSize = header.GetSerializedSize ();
+  uint32_t totalSize = headerSize + p->GetSize ();
+  uint32_t inclLen = std::min (totalSize, iface.snapLen);
+  if (iface.truncateVirtual && p->GetVirtualSize () > 0)
+    {
+      inclLen = std::min (inclLen, headerSize + p->GetVirtualStart ());
+    }
+
+  Buffer headerBuffer;
+  headerBuffer.AddAtStart (headerSize);
+  header.Serialize (headerBuffer.Begin ());
+  uint32_t toCopy = std::min (headerSize, inclLen);
+  uint8_t *block = BeginPacketBlock (interface, timestamp, inclLen, totalSize);
+  headerBuffer.CopyData (block + EPB_HEADER_SIZE, toCopy);
+  p->CopyData (block + EPB_HEADER_SIZE + toCopy, inclLen - toCopy);
+  EndPacketBlock (block, inclLen);
+}
+
+uint32_t
+PcapngFile::Get32 (uint8_t const *p) const
+{
+  uint32_t v;
+  std::memcpy (&v, p, 4);
+  return m_swapMode ? Swap32 (v) : v;
+}
+
+uint16_t
+PcapngFile::Get16 (uint8_t const *p) const
+{
+  uint16_t v;
+  std::memcpy (&v, p, 2);
+  return m_swapMode ? ((v & 0xff) << 8) | (v >> 8) : v;
+}
+
+bool
+PcapngFile::ReadBlock (uint32_t &type, std::vector<uint8_t> &body)
+{
+  NS_LOG_FUNCTION (this);
+  uint8_t head[8];
+  m_file.read ((char *)head, sizeof (head));
+  if (m_file.fail ())
+    {
+      return false;
+    }
+  type = Get32 (head);
+  if (type == SHB_TYPE)
+    {
+      // a new section, whose byte order is given by its magic number
+      uint32_t magic;
+      m_file.read ((char *)&magic, 4);
+      if (m_file.fail () || (magic != BYTE_ORDER_MAGIC && magic != Swap32 (BYTE_ORDER_MAGIC)))
+        {
+          m_file.setstate (std::ios::failbit);
+          return false;
+        }
+      m_swapMode = (magic != BYTE_ORDER_MAGIC);
+      m_interfaces.clear ();
+      m_file.seekg (-4, std::ios::cur);
+    }
+  uint32_t size = Get32 (head + 4);
+  if (size < 12 || size % 4 != 0 || size > MAX_BLOCK_SIZE)
+    {
+      m_file.setstate (std::ios::failbit);
+      return false;
+    }
+  body.resize (size - 8);
+  m_file.read ((char *)body.data (), body.size ());
+  if (m_file.fail () || Get32 (body.data () + body.size () - 4) != size)
+    {
+      m_file.setstate (std::ios::failbit);
+      return false;
+    }
+  body.resize (size - 12);
+  return true;
+}
+
+void
+PcapngFile::ReadInterface (std::vector<uint8_t> const &body)
+{
+  NS_LOG_FUNCTION (this);
+  if (body.size () < 8)
+    {
+      m_file.setstate (std::ios::failbit);
+      return;
+    }
+  Interface iface;
+  iface.dataLinkType = Get16 (body.data ());
+  iface.snapLen = Get32 (body.data () + 4);
+  iface.nanosecMode = false;
+  iface.truncateVirtual = false;
+  uint32_t offset = 8;
+  while (offset + 4 <= body.size ())
+    {
+      uint16_t code = Get16 (body.data () + offset);
+      uint16_t len = Get16 (body.data () + offset + 2);
+      offset += 4;
+      if (code == OPT_ENDOFOPT || offset + len > body.size ())
+        {
+          break;
+        }
+      if (code == OPT_IF_NAME)
+        {
+          iface.name.assign ((char const *)body.data () + offset, len);
+          // the name may be zero-terminated
+          iface.name = iface.name.c_str ();
+        }
+      else if (code == OPT_IF_TSRESOL && len >= 1)
+        {
+          iface.nanosecMode = (body[offset] == 9);
+        }
+      offset += Pad32 (len);
+    }
+  m_interfaces.push_back (iface);
+}
+
+void
+PcapngFile::Read (uint8_t * const data, uint32_t maxBytes,
+                  uint32_t &interface, uint64_t &timestamp,
+                  uint32_t &inclLen, uint32_t &origLen, uint32_t &readLen)
+{
+  NS_LOG_FUNCTION (this << &data << maxBytes);
+  NS_ASSERT (!m_writing);
+  uint32_t type;
+  std::vector<uint8_t> body;
+  while (ReadBlock (type, body))
+    {
+      if (type == IDB_TYPE)
+        {
+          ReadInterface (body);
+          continue;
+        }
+      if (type != EPB_TYPE)
+        {
+          continue;
+        }
+      if (body.size () < EPB_HEADER_SIZE - 8)
+        {
+          break;
+        }
+      interface = Get32 (body.data ());
+      timestamp = (uint64_t (Get32 (body.data () + 4)) << 32) | Get32 (body.data () + 8);
+      inclLen = Get32 (body.data () + 12);
+      origLen = Get32 (body.data () + 16);
+      if (interface >= m_interfaces.size () || inclLen > body.size () - (EPB_HEADER_SIZE - 8))
+        {
+          break;
+        }
+      readLen = std::min (inclLen, maxBytes);
+      std::memcpy (data, body.data () + EPB_HEADER_SIZE - 8, readLen);
+      return;
+    }
+  m_file.setstate (std::ios::failbit);
+}
+
+} // namespace ns3
@@ -0,0 +1,265 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAPNG_FILE_H
+#define PCAPNG_FILE_H
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <stdint.h>
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "trace-file-buffer.h"
+
+namespace ns3 {
+
+class Packet;
+class Header;
+
+/**
+ * \ingroup network
+ *
+ * \brief A class representing a pcapng file
+ *
+ * Unlike a pcap file, a pcapng file can hold the packets of several
+ * interfaces, each with its own data link type, snapshot length and
+ * timestamp resolution, so that a single file can trace all the devices
+ * of a node.  Each interface is described by an Interface Description
+ * Block, and each packet is stored in an Enhanced Packet Block which
+ * refers to its interface.  The blocks are written in the byte order of
+ * the writing system, which the readers detect from the Section Header
+ * Block.
+ *
+ * See https://github.com/pcapng/pcapng
+ */
+class PcapngFile : public SimpleRefCount<PcapngFile>
+{
+public:
+  PcapngFile ();
+  ~PcapngFile ();
+
+  /**
+   * \return true if the 'fail' bit is set in the underlying iostream, false otherwise.
+   */
+  bool Fail (void) const;
+  /**
+   * \return true if the 'eof' bit is set in the underlying iostream, false otherwise.
+   */
+  bool Eof (void) const;
+  /**
+   * Clear all state bits of the underlying iostream.
+   */
+  void Clear (void);
+
+  /**
+   * \brief Create a new pcapng file or open an existing pcapng file.
+   *
+   * When created for writing, the Section Header Block is written at once,
+   * and the file can be found with Lookup until it is closed.  When opened
+   * for reading, the fail bit is set if the file does not start with a
+   * Section Header Block.
+   *
+   * \param [in] filename The name of the file.
+   * \param [in] mode The access mode for the file, ored with fstream::binary.
+   */
+  void Open (std::string const &filename, std::ios::openmode mode);
+
+  /**
+   * Close the underlying file.
+   */
+  void Close (void);
+
+  /**
+   * \brief Buffer the blocks written to the file.
+   *
+   * \param [in] blockSize The size of the write blocks, in bytes, or zero
+   *        to write each block to the file stream directly.
+   * \param [in] async Whether the blocks are written from a background thread.
+   *
+   * \see PcapFile::SetWriteBuffer
+   */
+  void SetWriteBuffer (uint32_t blockSize, bool async);
+
+  /**
+   * \brief Add an interface to the file.
+   *
+   * \param [in] dataLinkType The data link type of the interface, as in
+   *        PcapFile::Init.
+   * \param [in] snapLen The maximum size of the packets written.
+   * \param [in] name The name of the interface, which may be empty.
+   * \param [in] nanosecMode Whether the timestamps of the interface are
+   *        in nanoseconds rather than microseconds.
+   * \param [in] truncateVirtual Whether packets are truncated at their
+   *        virtual payload (see PcapFile::SetTruncateVirtualPayload).
+   * \returns The index of the interface in the file.
+   */
+  uint32_t AddInterface (uint32_t dataLinkType, uint32_t snapLen,
+                         std::string const &name, bool nanosecMode = false,
+                         bool truncateVirtual = false);
+
+  /**
+   * \returns The number of interfaces added to, or read from, the file.
+   */
+  uint32_t GetNInterfaces (void) const;
+  /**
+   * \param [in] interface The index of an interface.
+   * \returns The data link type of the interface.
+   */
+  uint32_t GetDataLinkType (uint32_t interface) const;
+  /**
+   * \param [in] interface The index of an interface.
+   * \returns The snapshot length of the interface.
+   */
+  uint32_t GetSnapLen (uint32_t interface) const;
+  /**
+   * \param [in] interface The index of an interface.
+   * \returns true if the timestamps of the interface are in nanoseconds.
+   */
+  bool IsNanoSecMode (uint32_t interface) const;
+  /**
+   * \param [in] interface The index of an interface.
+   * \returns The name of the interface.
+   */
+  std::string GetInterfaceName (uint32_t interface) const;
+
+  /**
+   * \brief Write a packet.
+   *
+   * \param [in] interface The index of the interface.
+   * \param [in] timestamp The timestamp, in the units of the interface.
+   * \param [in] data The packet data.
+   * \param [in] totalLen The packet length.
+   */
+  void Write (uint32_t interface, uint64_t timestamp, uint8_t const *data, uint32_t totalLen);
+  /**
+   * \brief Write a packet.
+   *
+   * \param [in] interface The index of the interface.
+   * \param [in] timestamp The timestamp, in the units of the interface.
+   * \param [in] p The packet.
+   */
+  void Write (uint32_t interface, uint64_t timestamp, Ptr<const Packet> p);
+  /**
+   * \brief Write a packet.
+   *
+   * \param [in] interface The index of the interface.
+   * \param [in] timestamp The timestamp, in the units of the interface.
+   * \param [in] header The header to write in front of the packet.
+   * \param [in] p The packet.
+   */
+  void Write (uint32_t interface, uint64_t timestamp, const Header &header, Ptr<const Packet> p);
+
+  /**
+   * \brief Read the next packet.
+   *
+   * The interface descriptions found on the way are recorded, and the
+   * blocks of other types are skipped.
+   *
+   * \param [out] data The data buffer.
+   * \param [in] maxBytes The size of the data buffer.
+   * \param [out] interface The index of the interface.
+   * \param [out] timestamp The timestamp, in the units of the interface.
+   * \param [out] inclLen The length of the packet data in the file.
+   * \param [out] origLen The original length of the packet.
+   * \param [out] readLen The number of bytes read into the data buffer.
+   */
+  void Read (uint8_t * const data, uint32_t maxBytes,
+             uint32_t &interface, uint64_t &timestamp,
+             uint32_t &inclLen, uint32_t &origLen, uint32_t &readLen);
+
+  /**
+   * \brief Find a file open for writing.
+   *
+   * \param [in] filename The name the file was opened with.
+   * \returns The file, or 0 if no such file is open for writing.
+   */
+  static Ptr<PcapngFile> Lookup (std::string const &filename);
+
+private:
+  /** An interface of the file. */
+  struct Interface
+  {
+    uint32_t dataLinkType;      //!< Data link type.
+    uint32_t snapLen;           //!< Snapshot length.
+    std::string name;           //!< Interface name.
+    bool nanosecMode;           //!< Nanosecond timestamps.
+    bool truncateVirtual;       //!< Truncate packets at their virtual payload.
+  };
+
+  /**
+   * \brief Get room for a block.
+   * \param [in] size The size of the block.
+   * \returns The room, to be written with EndBlock.
+   */
+  uint8_t *BeginBlock (uint32_t size);
+  /**
+   * \brief Write a block obtained with BeginBlock.
+   * \param [in] size The size of the block.
+   */
+  void EndBlock (uint32_t size);
+  /**
+   * \brief Start an Enhanced Packet Block.
+   * \param [in] interface The index of the interface.
+   * \param [in] timestamp The timestamp.
+   * \param [in] inclLen The length of the packet data.
+   * \param [in] origLen The original length of the packet.
+   * \returns The block, whose packet data follows the first
+   *          EPB_HEADER_SIZE bytes.
+   */
+  uint8_t *BeginPacketBlock (uint32_t interface, uint64_t timestamp,
+                             uint32_t inclLen, uint32_t origLen);
+  /**
+   * \brief Finish an Enhanced Packet Block started with BeginPacketBlock.
+   * \param [in] block The block.
+   * \param [in] inclLen The length of the packet data.
+   */
+  void EndPacketBlock (uint8_t *block, uint32_t inclLen);
+  /**
+   * \brief Read a block.
+   * \param [out] type The block type.
+   * \param [out] body The block body, without the type and the lengths.
+   * \returns false if the block could not be read.
+   */
+  bool ReadBlock (uint32_t &type, std::vector<uint8_t> &body);
+  /**
+   * \brief Record the interface described by a block body.
+   * \param [in] body The body of an Interface Description Block.
+   */
+  void ReadInterface (std::vector<uint8_t> const &body);
+  /**
+   * \param [in] p Pointer to a value in the file byte order.
+   * \returns The 32-bit value in host byte order.
+   */
+  uint32_t Get32 (uint8_t const *p) const;
+  /**
+   * \param [in] p Pointer to a value in the file byte order.
+   * \returns The 16-bit value in host byte order.
+   */
+  uint16_t Get16 (uint8_t const *p) const;
+
+  std::string m_filename;                 //!< File name.
+  std::fstream m_file;                    //!< File stream.
+  bool m_writing;                         //!< Open for writing.
+  bool m_swapMode;                        //!< File read in foreign byte order.
+  std::vector<Interface> m_interfaces;    //!< The interfaces.
+  std::vector<uint8_t> m_scratch;         //!< Block being written, when not buffered.
+  mutable TraceFileBuffer m_buffer;       //!< Write buffer, if enabled.
+};
+
+} // namespace ns3
+
+#endif /* PCAPNG_FILE_H */
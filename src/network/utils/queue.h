@@ -31,6 +31,7 @@
 #include "ns3/log.h"
 #include "ns3/queue-size.h"
 #include "ns3/queue-item.h"
+#include "ns3/packet-census.h"
 #include <string>
 #include <sstream>
 #include <list>
@@ -491,6 +492,10 @@ Queue<Item>::DoEnqueue (ConstIterator pos, Ptr<Item> item)
     }
 
   m_packets.insert (pos, item);
+  if (PacketCensus::IsEnabled ())
+    {
+      PacketCensus::HoldItem<Item> (item, this->GetInstanceTypeId ());
+    }
 
   uint32_t size = item->GetSize ();
   m_nBytes += size;
@@ -519,6 +524,7 @@ Queue<Item>::DoDequeue (ConstIterator pos)
 
   Ptr<Item> item = *pos;
   m_packets.erase (pos);
+  PacketCensus::ReleaseItem<Item> (item);
 
   if (item != 0)
     {
@@ -548,6 +554,7 @@ Queue<Item>::DoRemove (ConstIterator pos)
 
   Ptr<Item> item = *pos;
   m_packets.erase (pos);
+  PacketCensus::ReleaseItem<Item> (item);
 
   if (item != 0)
     {
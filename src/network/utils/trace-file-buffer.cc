@@ -0,0 +1,360 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "trace-file-buffer.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/system-thread.h"
+
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TraceFileBuffer");
+
+namespace {
+
+/** Maximum number of blocks waiting for the I/O thread. */
+const uint32_t ASYNC_MAX_PENDING = 16;
+/** Maximum number of empty blocks kept for recycling. */
+const uint32_t ASYNC_MAX_FREE = 16;
+
+/**
+ * The background I/O thread, and the queue of the blocks it writes.
+ *
+ * SystemCondition resets its condition when a thread starts waiting,
+ * which loses the signals sent before, hence the standard condition
+ * variables.
+ */
+class AsyncWriter
+{
+public:
+  AsyncWriter ();
+  ~AsyncWriter ();
+
+  /**
+   * Queue a block, waiting if too many blocks are queued already.
+   * \param [in] owner The buffer the block comes from.
+   * \param [in] stream The stream to write the block to.
+   * \param [in,out] block The block, replaced by a recycled block,
+   *        or by an empty vector if none is available.
+   * \param [in] size The number of bytes to write.
+   */
+  void Submit (TraceFileBuffer const *owner, std::ostream *stream,
+               std::vector<uint8_t> &block, uint32_t size);
+  /**
+   * Wait until all the blocks of a buffer are written.
+   * \param [in] owner The buffer.
+   */
+  void Sync (TraceFileBuffer const *owner);
+
+private:
+  /** A queued block. */
+  struct Job
+  {
+    TraceFileBuffer const *owner;   //!< The buffer the block comes from.
+    std::ostream *stream;           //!< The stream to write to.
+    std::vector<uint8_t> block;     //!< The block.
+    uint32_t size;                  //!< The number of bytes to write.
+  };
+
+  /**
+   * \param [in] owner A buffer.
+   * \returns Whether blocks of the buffer are queued or being written.
+   */
+  bool IsPending (TraceFileBuffer const *owner) const;
+  /** The I/O thread. */
+  void Run (void);
+
+  std::mutex m_mutex;                         //!< Protects all the fields.
+  std::condition_variable m_work;             //!< Signals a queued block or the end.
+  std::condition_variable m_done;             //!< Signals a written block.
+  std::deque<Job> m_jobs;                     //!< The queued blocks.
+  std::vector<std::vector<uint8_t> > m_free;  //!< The blocks to recycle.
+  TraceFileBuffer const *m_writing;           //!< Owner of the block being written.
+  bool m_stop;                                //!< The thread must exit.
+  Ptr<SystemThread> m_thread;                 //!< The I/O thread.
+};
+
+AsyncWriter::AsyncWriter ()
+  : m_writing (0),
+    m_stop (false)
+{
+  NS_LOG_FUNCTION (this);
+  m_thread = Create<SystemThread> (MakeCallback (&AsyncWriter::Run, this));
+  m_thread->Start ();
+}
+
+AsyncWriter::~AsyncWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_stop = true;
+  }
+  m_work.notify_one ();
+  m_thread->Join ();
+}
+
+bool
+AsyncWriter::IsPending (TraceFileBuffer const *owner) const
+{
+  if (m_writing == owner)
+    {
+      return true;
+    }
+  for (std::deque<Job>::const_iterator i = m_jobs.begin (); i != m_jobs.end (); ++i)
+    {
+      if (i->owner == owner)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+AsyncWriter::Submit (TraceFileBuffer const *owner, std::ostream *stream,
+                     std::vector<uint8_t> &block, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << owner << stream << size);
+  {
+    std::unique_lock<std::mutex> lock (m_mutex);
+    while (m_jobs.size () >= ASYNC_MAX_PENDING)
+      {
+        m_done.wait (lock);
+      }
+    Job job;
+    job.owner = owner;
+    job.stream = stream;
+    job.block.swap (block);
+    job.size = size;
+    m_jobs.push_back (std::move (job));
+    if (!m_free.empty ())
+      {
+        block.swap (m_free.back ());
+        m_free.pop_back ();
+      }
+  }
+  m_work.notify_one ();
+}
+
+void
+AsyncWriter::Sync (TraceFileBuffer const *owner)
+{
+  NS_LOG_FUNCTION (this << owner);
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (IsPending (owner))
+    {
+      m_done.wait (lock);
+    }
+}
+
+void
+AsyncWriter::Run (void)
+{
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (true)
+    {
+      while (m_jobs.empty () && !m_stop)
+        {
+          m_work.wait (lock);
+        }
+      if (m_jobs.empty ())
+        {
+          return;
+        }
+      Job job = std::move (m_jobs.front ());
+      m_jobs.pop_front ();
+      m_writing = job.owner;
+      lock.unlock ();
+
+      job.stream->write (reinterpret_cast<char const *> (job.block.data ()), job.size);
+
+      lock.lock ();
+      m_writing = 0;
+      if (m_free.size () < ASYNC_MAX_FREE)
+        {
+          m_free.push_back (std::move (job.block));
+        }
+      m_done.notify_all ();
+    }
+}
+
+std::mutex g_asyncLock;           //!< Protects g_async and g_asyncUsers.
+AsyncWriter *g_async = 0;         //!< The I/O thread, while in use.
+uint32_t g_asyncUsers = 0;        //!< Number of buffers using the I/O thread.
+
+/**
+ * Get the I/O thread, starting it if needed.
+ * \returns The I/O thread.
+ */
+AsyncWriter *
+AcquireAsyncWriter (void)
+{
+  std::lock_guard<std::mutex> lock (g_asyncLock);
+  if (g_async == 0)
+    {
+      g_async = new AsyncWriter ();
+    }
+  ++g_asyncUsers;
+  return g_async;
+}
+
+/**
+ * Stop using the I/O thread, which exits when no buffer uses it.
+ */
+void
+ReleaseAsyncWriter (void)
+{
+  std::lock_guard<std::mutex> lock (g_asyncLock);
+  NS_ASSERT (g_asyncUsers > 0);
+  if (--g_asyncUsers == 0)
+    {
+      delete g_async;
+      g_async = 0;
+    }
+}
+
+} // unnamed namespace
+
+TraceFileBuffer::TraceFileBuffer ()
+  : m_stream (0),
+    m_used (0),
+    m_blockSize (0),
+    m_async (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TraceFileBuffer::~TraceFileBuffer ()
+{
+  NS_LOG_FUNCTION (this);
+  Detach ();
+}
+
+void
+TraceFileBuffer::Attach (std::ostream *stream, uint32_t blockSize, bool async)
+{
+  NS_LOG_FUNCTION (this << stream << blockSize << async);
+  NS_ASSERT (stream != 0 && blockSize > 0);
+  Detach ();
+
+  m_stream = stream;
+  m_blockSize = blockSize;
+  m_async = async;
+  m_used = 0;
+  if (m_async)
+    {
+      AcquireAsyncWriter ();
+    }
+  m_block.resize (m_blockSize);
+}
+
+void
+TraceFileBuffer::Detach (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_stream == 0)
+    {
+      return;
+    }
+  Sync ();
+  if (m_async)
+    {
+      ReleaseAsyncWriter ();
+    }
+  m_stream = 0;
+  std::vector<uint8_t> ().swap (m_block);
+}
+
+bool
+TraceFileBuffer::IsAttached (void) const
+{
+  return m_stream != 0;
+}
+
+uint8_t *
+TraceFileBuffer::Reserve (uint32_t size)
+{
+  NS_ASSERT (m_stream != 0);
+  if (m_used + size > m_block.size ())
+    {
+      HandOver ();
+      if (size > m_block.size ())
+        {
+          m_block.resize (size);
+        }
+    }
+  uint8_t *record = m_block.data () + m_used;
+  m_used += size;
+  return record;
+}
+
+void
+TraceFileBuffer::Write (void const *data, uint32_t size)
+{
+  std::memcpy (Reserve (size), data, size);
+}
+
+void
+TraceFileBuffer::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  HandOver ();
+}
+
+void
+TraceFileBuffer::Sync (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_stream == 0)
+    {
+      return;
+    }
+  HandOver ();
+  if (m_async)
+    {
+      g_async->Sync (this);
+    }
+}
+
+void
+TraceFileBuffer::HandOver (void)
+{
+  if (m_used == 0)
+    {
+      return;
+    }
+  if (m_async)
+    {
+      g_async->Submit (this, m_stream, m_block, m_used);
+      if (m_block.size () < m_blockSize)
+        {
+          m_block.resize (m_blockSize);
+        }
+    }
+  else
+    {
+      m_stream->write (reinterpret_cast<char const *> (m_block.data ()), m_used);
+    }
+  m_used = 0;
+}
+
+} // namespace ns3
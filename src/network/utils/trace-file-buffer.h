@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TRACE_FILE_BUFFER_H
+#define TRACE_FILE_BUFFER_H
+
+#include <ostream>
+#include <vector>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief Block buffer for the records of a binary trace file.
+ *
+ * The records are copied into a memory block, which is written to the
+ * stream in a single operation when it is full, instead of issuing a
+ * stream write per record field.  In asynchronous mode, the full blocks
+ * are handed to a background I/O thread, shared by all the trace files
+ * of the process, so that the thread producing the records only copies
+ * them into memory; empty blocks are recycled between the threads.  The
+ * number of blocks waiting to be written is bounded: when the I/O thread
+ * falls behind, the producers wait.
+ *
+ * While a stream is attached, it must only be accessed after a call to
+ * Sync, which waits for all the blocks of this buffer to be written.
+ * Blocks of a given buffer are written in order.  A buffer must be used
+ * by one thread at a time, but different buffers may be used by
+ * different threads.
+ */
+class TraceFileBuffer
+{
+public:
+  TraceFileBuffer ();
+  ~TraceFileBuffer ();
+
+  /**
+   * \brief Buffer the writes to a stream.
+   *
+   * If a stream is already attached, its pending blocks are written first.
+   *
+   * \param [in] stream The stream to write the blocks to.
+   * \param [in] blockSize The size of the blocks, in bytes.
+   * \param [in] async Whether the blocks are written by the background
+   *        I/O thread.
+   */
+  void Attach (std::ostream *stream, uint32_t blockSize, bool async);
+
+  /**
+   * \brief Write the buffered records and stop buffering.
+   *
+   * Does nothing if no stream is attached.
+   */
+  void Detach (void);
+
+  /**
+   * \returns Whether a stream is attached.
+   */
+  bool IsAttached (void) const;
+
+  /**
+   * \brief Reserve room for a record in the current block.
+   *
+   * The current block is handed over first if it cannot hold the record.
+   *
+   * \param [in] size The size of the record.
+   * \returns A pointer to the room for the record, valid until the next
+   *          call to any method of this buffer.
+   */
+  uint8_t *Reserve (uint32_t size);
+
+  /**
+   * \brief Copy a record into the current block.
+   *
+   * \param [in] data The record.
+   * \param [in] size The size of the record.
+   */
+  void Write (void const *data, uint32_t size);
+
+  /**
+   * \brief Hand the current block over to be written, even if not full.
+   */
+  void Flush (void);
+
+  /**
+   * \brief Write the current block and wait for all the blocks of this
+   *        buffer to be written, so that the stream can be accessed.
+   */
+  void Sync (void);
+
+private:
+  /**
+   * \brief Hand the current block over, and get an empty one.
+   */
+  void HandOver (void);
+
+  std::ostream *m_stream;         //!< The attached stream.
+  std::vector<uint8_t> m_block;   //!< The current block.
+  uint32_t m_used;                //!< Bytes used in the current block.
+  uint32_t m_blockSize;           //!< The size of the blocks.
+  bool m_async;                   //!< Blocks written by the I/O thread.
+};
+
+} // namespace ns3
+
+#endif /* TRACE_FILE_BUFFER_H */
@@ -157,13 +157,17 @@ main (int argc, char *argv[])
 
   int nCN = 2, nLANClients = 42;
   bool nix = true;
+  bool precompute = false;
 
   CommandLine cmd (__FILE__);
   cmd.AddValue ("CN", "Number of total CNs [2]", nCN);
   cmd.AddValue ("LAN", "Number of nodes per LAN [42]", nLANClients);
   cmd.AddValue ("NIX", "Toggle nix-vector routing", nix);
+  cmd.AddValue ("precompute", "Precompute the nix-vector routes of all the nodes", precompute);
   cmd.Parse (argc,argv);
 
+  Config::SetGlobal ("NixVectorPrecompute", BooleanValue (precompute));
+
   if (nCN < 2) 
     {
       std::cout << "Number of total CNs (" << nCN << ") lower than minimum of 2"
@@ -20,10 +20,18 @@
 
 #include <queue>
 #include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 #include "ns3/log.h"
 #include "ns3/abort.h"
 #include "ns3/names.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/global-value.h"
+#include "ns3/simulator.h"
+#include "ns3/system-thread.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/loopback-net-device.h"
 
@@ -38,6 +46,126 @@ NS_OBJECT_ENSURE_REGISTERED (Ipv4NixVectorRouting);
 bool Ipv4NixVectorRouting::g_isCacheDirty = false;
 Ipv4NixVectorRouting::Ipv4AddressToNodeMap Ipv4NixVectorRouting::g_ipv4AddressToNodeMap;
 
+static GlobalValue g_nixVectorPrecompute ("NixVectorPrecompute",
+                                          "Whether nix-vector routing computes the shortest path "
+                                          "trees of all the nodes at once.",
+                                          BooleanValue (false),
+                                          MakeBooleanChecker ());
+
+static GlobalValue g_nixVectorPrecomputeThreads ("NixVectorPrecomputeThreads",
+                                                 "The number of threads computing the shortest path trees "
+                                                 "of nix-vector routing (0 for one thread per hardware thread).",
+                                                 UintegerValue (1),
+                                                 MakeUintegerChecker<uint32_t> ());
+
+/**
+ * The shortest path trees of the nodes, and the graph they are computed
+ * from. The nodes are identified by their index in the NodeList, and a
+ * tree holds the parent of each node, so that the nix-vector to a node
+ * is built by walking up the tree.
+ */
+struct Ipv4NixVectorRouting::RouteStore
+{
+  /** The parent of the nodes which are not reachable. */
+  static const uint32_t NO_PARENT = 0xffffffff;
+
+  RouteStore ()
+    : graphBuilt (false)
+  {
+  }
+
+  /**
+   * \param [in] node A node.
+   * \param [in] neighbor A neighbor of the node.
+   * \returns The nix index of the neighbor.
+   */
+  uint32_t GetNixIndex (uint32_t node, uint32_t neighbor) const;
+
+  /**
+   * \param [in] tree A tree.
+   * \param [in] node A node reachable in the tree.
+   * \returns The depth of the node in the tree.
+   */
+  static uint32_t GetDepth (const std::vector<uint32_t> &tree, uint32_t node);
+
+  /**
+   * \brief Compute the shortest path tree of a node, by a breadth first
+   * search which visits the neighbors in the same order as BFS.
+   * \param [in] source The node.
+   */
+  void ComputeTree (uint32_t source);
+
+  bool graphBuilt;                        //!< Whether the graph is up to date.
+  std::vector<uint32_t> adjacencyStart;   //!< First neighbor of each node in adjacency, and the end.
+  std::vector<uint32_t> adjacency;        //!< Neighbors through the links which are up, in search order.
+  std::vector<uint32_t> nixStart;         //!< First neighbor of each node in nixIndices, and the end.
+  std::vector<std::pair<uint32_t, uint32_t> > nixIndices;  //!< Neighbors and their nix index, by neighbor.
+  std::vector<uint32_t> totalNeighbors;   //!< Number of neighbors of each node in its nix-vectors.
+  std::vector<std::vector<uint32_t> > trees;  //!< Parents in the tree of each node, empty until computed.
+  std::vector<std::unordered_map<uint32_t, Ptr<NixVector> > > nixVectors;  //!< Nix-vectors from each node, by destination.
+  EventId clearEvent;                     //!< Clears the store when the simulation is destroyed.
+};
+
+/**
+ * The trees computed by a batch of threads.
+ */
+struct Ipv4NixVectorRouting::TreeBatch
+{
+  RouteStore *store;               //!< The route store.
+  std::vector<uint32_t> sources;   //!< The nodes whose tree is computed.
+  std::atomic<uint32_t> next;      //!< The next source to take.
+};
+
+const uint32_t Ipv4NixVectorRouting::RouteStore::NO_PARENT;
+Ipv4NixVectorRouting::RouteStore Ipv4NixVectorRouting::g_routeStore;
+
+uint32_t
+Ipv4NixVectorRouting::RouteStore::GetNixIndex (uint32_t node, uint32_t neighbor) const
+{
+  std::vector<std::pair<uint32_t, uint32_t> >::const_iterator begin = nixIndices.begin () + nixStart[node];
+  std::vector<std::pair<uint32_t, uint32_t> >::const_iterator end = nixIndices.begin () + nixStart[node + 1];
+  std::vector<std::pair<uint32_t, uint32_t> >::const_iterator it =
+    std::lower_bound (begin, end, std::make_pair (neighbor, 0U));
+  // BuildNixVector uses index 0 for a neighbor found through a bridge
+  return it != end && it->first == neighbor ? it->second : 0;
+}
+
+uint32_t
+Ipv4NixVectorRouting::RouteStore::GetDepth (const std::vector<uint32_t> &tree, uint32_t node)
+{
+  uint32_t depth = 0;
+  for (; tree[node] != node; node = tree[node])
+    {
+      depth++;
+    }
+  return depth;
+}
+
+void
+Ipv4NixVectorRouting::RouteStore::ComputeTree (uint32_t source)
+{
+  std::vector<uint32_t> &tree = trees[source];
+  tree.assign (totalNeighbors.size (), NO_PARENT);
+  // the nodes in the order in which they are discovered
+  std::vector<uint32_t> queue;
+  queue.reserve (tree.size ());
+  tree[source] = source;
+  queue.push_back (source);
+  for (uint32_t head = 0; head < queue.size (); head++)
+    {
+      uint32_t node = queue[head];
+      for (uint32_t i = adjacencyStart[node]; i < adjacencyStart[node + 1]; i++)
+        {
+          uint32_t neighbor = adjacency[i];
+          if (tree[neighbor] == NO_PARENT)
+            {
+              tree[neighbor] = node;
+              queue.push_back (neighbor);
+            }
+        }
+    }
+}
+
 TypeId 
 Ipv4NixVectorRouting::GetTypeId (void)
 {
@@ -111,6 +239,8 @@ Ipv4NixVectorRouting::FlushGlobalNixRoutingCache (void) const
   // IPv4 address to node mapping is potentially invalid so clear it.
   // Will be repopulated in lazy evaluation when mapping is needed.
   g_ipv4AddressToNodeMap.clear ();
+
+  ClearRouteStore ();
 }
 
 void
@@ -152,6 +282,10 @@ Ipv4NixVectorRouting::GetNixVector (Ptr<Node> source, Ipv4Address dest, Ptr<NetD
       NS_LOG_DEBUG ("Do not process packets to self");
       return 0;
     }
+  else if (oif == 0 && IsPrecomputeEnabled ())
+    {
+      return GetPrecomputedNixVector (source, destNode);
+    }
   else
     {
       // otherwise proceed as normal 
@@ -797,12 +931,26 @@ Ipv4NixVectorRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::
 void
 Ipv4NixVectorRouting::NotifyInterfaceUp (uint32_t i)
 {
-  g_isCacheDirty = true;
+  if (g_routeStore.trees.empty () || g_isCacheDirty)
+    {
+      g_isCacheDirty = true;
+    }
+  else
+    {
+      InvalidateTrees (i, true);
+    }
 }
 void
 Ipv4NixVectorRouting::NotifyInterfaceDown (uint32_t i)
 {
-  g_isCacheDirty = true;
+  if (g_routeStore.trees.empty () || g_isCacheDirty)
+    {
+      g_isCacheDirty = true;
+    }
+  else
+    {
+      InvalidateTrees (i, false);
+    }
 }
 void
 Ipv4NixVectorRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
@@ -961,6 +1109,261 @@ Ipv4NixVectorRouting::BFS (uint32_t numberOfNodes, Ptr<Node> source,
   return false;
 }
 
+bool
+Ipv4NixVectorRouting::IsPrecomputeEnabled (void)
+{
+  BooleanValue value;
+  g_nixVectorPrecompute.GetValue (value);
+  return value.Get ();
+}
+
+Ptr<NixVector>
+Ipv4NixVectorRouting::GetPrecomputedNixVector (Ptr<Node> source, Ptr<Node> dest)
+{
+  NS_LOG_FUNCTION (source->GetId () << dest->GetId ());
+
+  RouteStore &store = g_routeStore;
+  uint32_t nNodes = NodeList::GetNNodes ();
+  if (store.trees.size () != nNodes)
+    {
+      // the store is empty, or nodes were added since it was filled
+      store.graphBuilt = false;
+      store.trees.assign (nNodes, std::vector<uint32_t> ());
+      store.nixVectors.assign (nNodes, std::unordered_map<uint32_t, Ptr<NixVector> > ());
+      if (store.clearEvent.IsExpired ())
+        {
+          store.clearEvent = Simulator::ScheduleDestroy (&Ipv4NixVectorRouting::ClearRouteStore);
+        }
+    }
+
+  uint32_t sourceId = source->GetId ();
+  uint32_t destId = dest->GetId ();
+  std::unordered_map<uint32_t, Ptr<NixVector> >::const_iterator it = store.nixVectors[sourceId].find (destId);
+  if (it != store.nixVectors[sourceId].end ())
+    {
+      return it->second;
+    }
+
+  if (store.trees[sourceId].empty ())
+    {
+      if (!store.graphBuilt)
+        {
+          BuildRouteStoreGraph ();
+        }
+      ComputeTrees ();
+    }
+
+  // walk up the tree from the destination, as BuildNixVector does
+  const std::vector<uint32_t> &tree = store.trees[sourceId];
+  Ptr<NixVector> nixVector;
+  if (tree[destId] != RouteStore::NO_PARENT)
+    {
+      nixVector = Create<NixVector> ();
+      for (uint32_t node = destId; node != sourceId; node = tree[node])
+        {
+          uint32_t parent = tree[node];
+          nixVector->AddNeighborIndex (store.GetNixIndex (parent, node),
+                                       nixVector->BitCount (store.totalNeighbors[parent]));
+        }
+    }
+  else
+    {
+      NS_LOG_ERROR ("No routing path exists");
+    }
+  // the nix-vector is shared by all the addresses of the destination
+  store.nixVectors[sourceId][destId] = nixVector;
+  return nixVector;
+}
+
+void
+Ipv4NixVectorRouting::BuildRouteStoreGraph (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  RouteStore &store = g_routeStore;
+  uint32_t nNodes = NodeList::GetNNodes ();
+  store.adjacencyStart.assign (1, 0);
+  store.adjacency.clear ();
+  store.nixStart.assign (1, 0);
+  store.nixIndices.clear ();
+  store.totalNeighbors.assign (nNodes, 0);
+  for (uint32_t id = 0; id < nNodes; id++)
+    {
+      Ptr<Node> node = NodeList::GetNode (id);
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      // the nix index of each neighbor, the last one if it is reached
+      // through several devices
+      std::map<uint32_t, uint32_t> indices;
+      uint32_t totalNeighbors = 0;
+      for (uint32_t i = 0; i < node->GetNDevices (); i++)
+        {
+          Ptr<NetDevice> localNetDevice = node->GetDevice (i);
+          Ptr<Channel> channel = localNetDevice->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+          NetDeviceContainer netDeviceContainer;
+          GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
+
+          // the neighbors which BFS visits
+          if ((!ipv4 || ipv4->IsUp (ipv4->GetInterfaceForDevice (localNetDevice)))
+              && localNetDevice->IsLinkUp ())
+            {
+              for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
+                {
+                  store.adjacency.push_back ((*iter)->GetNode ()->GetId ());
+                }
+            }
+
+          // the neighbor indices which BuildNixVector uses
+          if (!localNetDevice->IsBridge ())
+            {
+              for (uint32_t j = 0; j < netDeviceContainer.GetN (); j++)
+                {
+                  indices[netDeviceContainer.Get (j)->GetNode ()->GetId ()] = totalNeighbors + j;
+                }
+              totalNeighbors += netDeviceContainer.GetN ();
+            }
+        }
+      store.adjacencyStart.push_back (store.adjacency.size ());
+      store.nixIndices.insert (store.nixIndices.end (), indices.begin (), indices.end ());
+      store.nixStart.push_back (store.nixIndices.size ());
+      store.totalNeighbors[id] = totalNeighbors;
+    }
+  store.graphBuilt = true;
+}
+
+void
+Ipv4NixVectorRouting::ComputeTrees (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  TreeBatch batch;
+  batch.store = &g_routeStore;
+  for (uint32_t i = 0; i < g_routeStore.trees.size (); i++)
+    {
+      if (g_routeStore.trees[i].empty ())
+        {
+          batch.sources.push_back (i);
+        }
+    }
+  batch.next = 0;
+
+  UintegerValue value;
+  g_nixVectorPrecomputeThreads.GetValue (value);
+  uint32_t nThreads = value.Get ();
+  if (nThreads == 0)
+    {
+      nThreads = std::max (std::thread::hardware_concurrency (), 1U);
+    }
+  nThreads = std::min<uint32_t> (nThreads, batch.sources.size ());
+  NS_LOG_LOGIC ("Computing " << batch.sources.size () << " trees on " << nThreads << " threads");
+
+  if (nThreads <= 1)
+    {
+      ComputeTreesThread (&batch);
+      return;
+    }
+  // the threads only read the graph, and each tree is written by one thread
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < nThreads; i++)
+    {
+      threads.push_back (Create<SystemThread> (MakeBoundCallback (&Ipv4NixVectorRouting::ComputeTreesThread, &batch)));
+      threads.back ()->Start ();
+    }
+  for (uint32_t i = 0; i < nThreads; i++)
+    {
+      threads[i]->Join ();
+    }
+}
+
+void
+Ipv4NixVectorRouting::ComputeTreesThread (TreeBatch *batch)
+{
+  for (uint32_t i = batch->next++; i < batch->sources.size (); i = batch->next++)
+    {
+      batch->store->ComputeTree (batch->sources[i]);
+    }
+}
+
+void
+Ipv4NixVectorRouting::InvalidateTrees (uint32_t interface, bool up)
+{
+  NS_LOG_FUNCTION (interface << up);
+
+  RouteStore &store = g_routeStore;
+  store.graphBuilt = false;
+
+  NetDeviceContainer neighbors;
+  Ptr<NetDevice> device = m_ipv4->GetNetDevice (interface);
+  Ptr<Channel> channel = device->GetChannel ();
+  if (channel != 0)
+    {
+      GetAdjacentNetDevices (device, channel, neighbors);
+    }
+
+  // A link going down only changes the trees in which a neighbor is a
+  // child of this node. A link going up only changes the trees in which
+  // this node is reachable and a neighbor is not reachable, or is not
+  // closer than this node: the neighbor may then be visited from this
+  // node first.
+  uint32_t id = m_node->GetId ();
+  for (uint32_t source = 0; source < store.trees.size (); source++)
+    {
+      const std::vector<uint32_t> &tree = store.trees[source];
+      if (tree.empty () || (up && tree[id] == RouteStore::NO_PARENT))
+        {
+          continue;
+        }
+      uint32_t depth = up ? RouteStore::GetDepth (tree, id) : 0;
+      bool changed = false;
+      for (NetDeviceContainer::Iterator iter = neighbors.Begin (); !changed && iter != neighbors.End (); iter++)
+        {
+          uint32_t neighbor = (*iter)->GetNode ()->GetId ();
+          if (up)
+            {
+              changed = tree[neighbor] == RouteStore::NO_PARENT
+                || depth + 1 <= RouteStore::GetDepth (tree, neighbor);
+            }
+          else
+            {
+              changed = tree[neighbor] == id;
+            }
+        }
+      if (changed)
+        {
+          NS_LOG_LOGIC ("Removing the tree of node " << source);
+          store.trees[source].clear ();
+          store.nixVectors[source].clear ();
+          Ptr<Ipv4NixVectorRouting> rp = NodeList::GetNode (source)->GetObject<Ipv4NixVectorRouting> ();
+          if (rp)
+            {
+              rp->FlushNixCache ();
+            }
+        }
+    }
+
+  // the routes cached along the paths which changed are not known
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); i++)
+    {
+      Ptr<Ipv4NixVectorRouting> rp = (*i)->GetObject<Ipv4NixVectorRouting> ();
+      if (rp)
+        {
+          rp->FlushIpv4RouteCache ();
+        }
+    }
+}
+
+void
+Ipv4NixVectorRouting::ClearRouteStore (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_routeStore.graphBuilt = false;
+  g_routeStore.trees.clear ();
+  g_routeStore.nixVectors.clear ();
+}
+
 void 
 Ipv4NixVectorRouting::CheckCacheStateAndFlush (void) const
 {
@@ -57,6 +57,15 @@ typedef std::map<Ipv4Address, Ptr<Ipv4Route> > Ipv4RouteMap_t;
 /**
  * \ingroup nix-vector-routing
  * Nix-vector routing protocol
+ *
+ * By default, the nix-vector from a node to a destination is built by a
+ * breadth first search when the node first sends a packet to it. When
+ * the "NixVectorPrecompute" global value is set, the shortest path trees
+ * of all the nodes are instead computed at once, on the number of threads
+ * set by the "NixVectorPrecomputeThreads" global value, and kept in a
+ * store shared by all the nodes, which holds one node index per pair of
+ * nodes. An interface going up or down then only removes the trees which
+ * it may change, which are computed again when needed.
  */
 class Ipv4NixVectorRouting : public Ipv4RoutingProtocol
 {
@@ -80,7 +89,7 @@ public:
   /**
    * @brief Called when run-time link topology change occurs
    * which iterates through the node list and flushes any
-   * nix vector caches
+   * nix vector caches, and the precomputed routes
    *
    * \internal
    * \c const is used here due to need to potentially flush the cache
@@ -90,6 +99,10 @@ public:
   void FlushGlobalNixRoutingCache (void) const;
 
 private:
+  /// The shortest path trees of all the nodes
+  struct RouteStore;
+  /// A batch of shortest path trees computed by several threads
+  struct TreeBatch;
 
   /**
    * Flushes the cache which stores nix-vector based on
@@ -209,6 +222,56 @@ private:
             std::vector< Ptr<Node> > & parentVector,
             Ptr<NetDevice> oif);
 
+  /**
+   * \returns true if the "NixVectorPrecompute" global value is set.
+   */
+  static bool IsPrecomputeEnabled (void);
+
+  /**
+   * Takes the nix-vector from the source node to the destination node
+   * in the shortest path tree of the source, after computing the trees
+   * of all the nodes which are missing from the route store
+   *
+   * \param source Source node
+   * \param dest Destination node
+   * \returns The NixVector to be used in routing, or 0 if there is no path.
+   */
+  Ptr<NixVector> GetPrecomputedNixVector (Ptr<Node> source, Ptr<Node> dest);
+
+  /**
+   * Builds the graph of the nodes in the route store, that is, the
+   * nodes adjacent to each node through its links which are up, and
+   * the nix index of each neighbor of each node
+   */
+  void BuildRouteStoreGraph (void);
+
+  /**
+   * Computes the shortest path trees which are missing from the route
+   * store, on the number of threads set by the
+   * "NixVectorPrecomputeThreads" global value
+   */
+  static void ComputeTrees (void);
+
+  /**
+   * Computes the trees of a batch, until none is left
+   * \param [in] batch The batch.
+   */
+  static void ComputeTreesThread (TreeBatch *batch);
+
+  /**
+   * Removes from the route store the shortest path trees which an
+   * interface going up or down may change, and flushes the caches
+   * built from them
+   * \param [in] interface The interface of this node.
+   * \param [in] up Whether the interface goes up.
+   */
+  void InvalidateTrees (uint32_t interface, bool up);
+
+  /**
+   * Removes all the shortest path trees from the route store
+   */
+  static void ClearRouteStore (void);
+
   void DoDispose (void);
 
   /* From Ipv4RoutingProtocol */
@@ -277,6 +340,11 @@ private:
    **/
   typedef std::unordered_map<Ipv4Address, ns3::Ptr<ns3::Node>, Ipv4AddressHash > Ipv4AddressToNodeMap;
   static Ipv4AddressToNodeMap g_ipv4AddressToNodeMap;
+
+  /**
+   * Shortest path trees of the nodes, when the routes are precomputed.
+   */
+  static RouteStore g_routeStore;
 };
 } // namespace ns3
 
@@ -0,0 +1,205 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <sstream>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/config.h"
+#include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-nix-vector-helper.h"
+#include "ns3/ipv4-nix-vector-routing.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup nix-vector-routing
+ * \ingroup tests
+ *
+ * \brief Precomputed nix-vectors test against the nix-vectors built on
+ * demand, when interfaces go up and down.
+ */
+class Ipv4NixVectorPrecomputeTestCase : public TestCase
+{
+public:
+  Ipv4NixVectorPrecomputeTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \param [in] nodes The nodes.
+   * \param [in] interfaces The interfaces of the nodes.
+   * \param [in] precompute Whether the nix-vectors are precomputed.
+   * \returns The route and the nix-vector from each node to each interface.
+   */
+  static std::vector<std::string> GetRoutes (const NodeContainer &nodes,
+                                             const Ipv4InterfaceContainer &interfaces,
+                                             bool precompute);
+  /**
+   * \brief Check the precomputed routes against the routes built on demand.
+   * \param [in] nodes The nodes.
+   * \param [in] interfaces The interfaces of the nodes.
+   * \param [in] precomputed The precomputed routes.
+   * \param [in] change The last topology change.
+   */
+  void CheckRoutes (const NodeContainer &nodes, const Ipv4InterfaceContainer &interfaces,
+                    const std::vector<std::string> &precomputed, const std::string &change);
+};
+
+Ipv4NixVectorPrecomputeTestCase::Ipv4NixVectorPrecomputeTestCase ()
+  : TestCase ("Precomputed nix-vectors")
+{
+}
+
+std::vector<std::string>
+Ipv4NixVectorPrecomputeTestCase::GetRoutes (const NodeContainer &nodes,
+                                            const Ipv4InterfaceContainer &interfaces,
+                                            bool precompute)
+{
+  Config::SetGlobal ("NixVectorPrecompute", BooleanValue (precompute));
+  std::vector<std::string> routes;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4RoutingProtocol> routing = nodes.Get (i)->GetObject<Ipv4> ()->GetRoutingProtocol ();
+      std::ostringstream oss;
+      for (uint32_t j = 0; j < interfaces.GetN (); j++)
+        {
+          Ptr<Packet> p = Create<Packet> ();
+          Ipv4Header header;
+          header.SetDestination (interfaces.GetAddress (j));
+          Socket::SocketErrno sockerr;
+          Ptr<Ipv4Route> route = routing->RouteOutput (p, header, 0, sockerr);
+          oss << interfaces.GetAddress (j) << ": ";
+          if (route != 0)
+            {
+              oss << "gateway=" << route->GetGateway ()
+                  << ", out=" << route->GetOutputDevice ()->GetIfIndex ()
+                  << ", nix=" << *p->GetNixVector ();
+            }
+          oss << std::endl;
+        }
+      routes.push_back (oss.str ());
+    }
+  return routes;
+}
+
+void
+Ipv4NixVectorPrecomputeTestCase::CheckRoutes (const NodeContainer &nodes,
+                                              const Ipv4InterfaceContainer &interfaces,
+                                              const std::vector<std::string> &precomputed,
+                                              const std::string &change)
+{
+  nodes.Get (0)->GetObject<Ipv4NixVectorRouting> ()->FlushGlobalNixRoutingCache ();
+  std::vector<std::string> computed = GetRoutes (nodes, interfaces, false);
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (precomputed[i], computed[i], "Wrong routes of node " << i << " after " << change);
+    }
+}
+
+void
+Ipv4NixVectorPrecomputeTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  // a ring with chords, and a LAN
+  const uint32_t nNodes = 20;
+  NodeContainer nodes;
+  nodes.Create (nNodes);
+  InternetStackHelper internet;
+  Ipv4NixVectorHelper nixRouting;
+  internet.SetRoutingHelper (nixRouting);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.252");
+  Ipv4InterfaceContainer interfaces;
+  for (uint32_t i = 0; i < nNodes + 6; i++)
+    {
+      uint32_t a = i < nNodes ? i : rng->GetInteger (0, nNodes - 1);
+      uint32_t b = i < nNodes ? (i + 1) % nNodes : rng->GetInteger (0, nNodes - 1);
+      if (a == b)
+        {
+          continue;
+        }
+      NetDeviceContainer net = simpleHelper.Install (NodeContainer (nodes.Get (a), nodes.Get (b)),
+                                                     CreateObject<SimpleChannel> ());
+      interfaces.Add (ipv4.Assign (net));
+      ipv4.NewNetwork ();
+    }
+  SimpleNetDeviceHelper lanHelper;
+  NetDeviceContainer lan = lanHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (7), nodes.Get (14)),
+                                              CreateObject<SimpleChannel> ());
+  ipv4.SetBase ("10.2.0.0", "255.255.255.0");
+  interfaces.Add (ipv4.Assign (lan));
+
+  Config::SetGlobal ("NixVectorPrecomputeThreads", UintegerValue (4));
+  CheckRoutes (nodes, interfaces, GetRoutes (nodes, interfaces, true), "initialization");
+
+  for (uint32_t step = 0; step < 30; step++)
+    {
+      // fill the store, so that the change only removes some trees
+      nodes.Get (0)->GetObject<Ipv4NixVectorRouting> ()->FlushGlobalNixRoutingCache ();
+      GetRoutes (nodes, interfaces, true);
+
+      std::pair<Ptr<Ipv4>, uint32_t> interface = interfaces.Get (rng->GetInteger (0, interfaces.GetN () - 1));
+      bool up = !interface.first->IsUp (interface.second);
+      std::ostringstream change;
+      change << "step " << step << ": interface " << interface.second << " of node "
+             << interface.first->GetObject<Node> ()->GetId () << (up ? " up" : " down");
+      if (up)
+        {
+          interface.first->SetUp (interface.second);
+        }
+      else
+        {
+          interface.first->SetDown (interface.second);
+        }
+      CheckRoutes (nodes, interfaces, GetRoutes (nodes, interfaces, true), change.str ());
+    }
+
+  Config::SetGlobal ("NixVectorPrecompute", BooleanValue (false));
+  Config::SetGlobal ("NixVectorPrecomputeThreads", UintegerValue (1));
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup nix-vector-routing
+ * \ingroup tests
+ *
+ * \brief Nix-vector routing TestSuite
+ */
+class Ipv4NixVectorRoutingTestSuite : public TestSuite
+{
+public:
+  Ipv4NixVectorRoutingTestSuite ()
+    : TestSuite ("ipv4-nix-vector-routing", UNIT)
+  {
+    AddTestCase (new Ipv4NixVectorPrecomputeTestCase, TestCase::QUICK);
+  }
+};
+
+static Ipv4NixVectorRoutingTestSuite g_ipv4NixVectorRoutingTestSuite; //!< Static variable for test initialization
@@ -19,8 +19,10 @@
 #include "point-to-point-channel.h"
 #include "point-to-point-net-device.h"
 #include "ns3/trace-source-accessor.h"
+#include "ns3/boolean.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
+#include "ns3/abort.h"
 #include "ns3/log.h"
 
 namespace ns3 {
@@ -40,6 +42,16 @@ PointToPointChannel::GetTypeId (void)
                    TimeValue (Seconds (0)),
                    MakeTimeAccessor (&PointToPointChannel::m_delay),
                    MakeTimeChecker ())
+    .AddAttribute ("CrossPartition",
+                   "Whether the two devices run in different partitions of the "
+                   "MultithreadedSimulatorImpl, in which case the packets are "
+                   "serialized and the TxRxPointToPoint trace is not fired. "
+                   "Set by the MultithreadedSimulatorHelper once the devices "
+                   "are attached.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PointToPointChannel::SetCrossPartition,
+                                        &PointToPointChannel::GetCrossPartition),
+                   MakeBooleanChecker ())
     .AddTraceSource ("TxRxPointToPoint",
                      "Trace source indicating transmission of packet "
                      "from the PointToPointChannel, used by the Animation "
@@ -57,7 +69,8 @@ PointToPointChannel::PointToPointChannel()
   :
     Channel (),
     m_delay (Seconds (0.)),
-    m_nDevices (0)
+    m_nDevices (0),
+    m_crossPartition (false)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -97,6 +110,19 @@ PointToPointChannel::TransmitStart (
 
   uint32_t wire = src == m_link[0].m_src ? 0 : 1;
 
+  if (m_crossPartition)
+    {
+      // Neither the packet nor the destination device may be referenced
+      // from this thread: hand over a serialized copy of the packet.
+      std::vector<uint8_t> buffer (p->GetSerializedSize ());
+      NS_ABORT_MSG_IF (p->Serialize (buffer.data (), buffer.size ()) == 0,
+                       "Cannot serialize packet " << p->GetUid ());
+      Simulator::ScheduleWithContext (m_link[wire].m_dstContext,
+                                      txTime + m_delay, &PointToPointChannel::DeliverSerialized,
+                                      this, wire, buffer);
+      return true;
+    }
+
   Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
                                   txTime + m_delay, &PointToPointNetDevice::Receive,
                                   m_link[wire].m_dst, p->Copy ());
@@ -106,6 +132,44 @@ PointToPointChannel::TransmitStart (
   return true;
 }
 
+void
+PointToPointChannel::DeliverSerialized (uint32_t wire, std::vector<uint8_t> buffer)
+{
+  NS_LOG_FUNCTION (this << wire << buffer.size ());
+  Ptr<Packet> p = Create<Packet> (buffer.data (), buffer.size (), true);
+  m_link[wire].m_dst->Receive (p);
+}
+
+bool
+PointToPointChannel::SupportsCrossPartition (void) const
+{
+  return true;
+}
+
+void
+PointToPointChannel::SetCrossPartition (bool crossPartition)
+{
+  NS_LOG_FUNCTION (this << crossPartition);
+  if (crossPartition)
+    {
+      NS_ABORT_MSG_IF (m_nDevices != N_DEVICES,
+                       "Both devices must be attached before crossing partitions");
+      for (std::size_t i = 0; i < N_DEVICES; ++i)
+        {
+          NS_ABORT_MSG_IF (m_link[i].m_dst->GetNode () == 0,
+                           "The devices must be added to their nodes before crossing partitions");
+          m_link[i].m_dstContext = m_link[i].m_dst->GetNode ()->GetId ();
+        }
+    }
+  m_crossPartition = crossPartition;
+}
+
+bool
+PointToPointChannel::GetCrossPartition (void) const
+{
+  return m_crossPartition;
+}
+
 std::size_t
 PointToPointChannel::GetNDevices (void) const
 {
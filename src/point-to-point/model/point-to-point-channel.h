@@ -20,6 +20,7 @@
 #define POINT_TO_POINT_CHANNEL_H
 
 #include <list>
+#include <vector>
 #include "ns3/channel.h"
 #include "ns3/ptr.h"
 #include "ns3/nstime.h"
@@ -44,6 +45,13 @@ class Packet;
  * [0] wire to transmit on.  The second device gets the [1] wire.  There is a
  * state (IDLE, TRANSMITTING) associated with each wire.
  *
+ * When the two devices run in different partitions of the
+ * MultithreadedSimulatorImpl (the "CrossPartition" attribute, set by the
+ * MultithreadedSimulatorHelper), the packets are serialized by the
+ * sending thread and deserialized by the receiving one, so that the two
+ * partitions never share a packet or a reference count, and the
+ * "TxRxPointToPoint" trace source is not fired.
+ *
  * \see Attach
  * \see TransmitStart
  */
@@ -100,6 +108,22 @@ public:
    */
   virtual Ptr<NetDevice> GetDevice (std::size_t i) const;
 
+  /**
+   * \brief Check whether the channel can connect two partitions
+   * \returns true
+   */
+  virtual bool SupportsCrossPartition (void) const;
+
+  /**
+   * \brief Set whether the two devices run in different partitions
+   *
+   * The contexts of the devices are cached, so the devices must be
+   * attached and added to their nodes first.
+   *
+   * \param crossPartition true if the packets cross a partition boundary
+   */
+  virtual void SetCrossPartition (bool crossPartition);
+
 protected:
   /**
    * \brief Get the delay associated with this channel
@@ -146,11 +170,28 @@ protected:
      Time duration, Time lastBitTime);
                     
 private:
+  /**
+   * \brief Get whether the two devices run in different partitions
+   * \returns true if the packets cross a partition boundary
+   */
+  bool GetCrossPartition (void) const;
+
+  /**
+   * \brief Deliver a serialized packet to the destination of a wire
+   *
+   * Executed in the partition of the destination device.
+   *
+   * \param wire The wire the packet was sent on
+   * \param buffer The serialized packet
+   */
+  void DeliverSerialized (uint32_t wire, std::vector<uint8_t> buffer);
+
   /** Each point to point link has exactly two net devices. */
   static const std::size_t N_DEVICES = 2;
 
   Time          m_delay;    //!< Propagation delay
   std::size_t        m_nDevices; //!< Devices of this channel
+  bool          m_crossPartition; //!< Devices in different partitions
 
   /**
    * The trace source for the packet transmission animation events that the 
@@ -194,11 +235,12 @@ public:
     /** \brief Create the link, it will be in INITIALIZING state
      *
      */
-    Link() : m_state (INITIALIZING), m_src (0), m_dst (0) {}
+    Link() : m_state (INITIALIZING), m_src (0), m_dst (0), m_dstContext (0) {}
 
     WireState                  m_state; //!< State of the link
     Ptr<PointToPointNetDevice> m_src;   //!< First NetDevice
     Ptr<PointToPointNetDevice> m_dst;   //!< Second NetDevice
+    uint32_t                   m_dstContext; //!< Node id of the second NetDevice
   };
 
   Link    m_link[N_DEVICES]; //!< Link model
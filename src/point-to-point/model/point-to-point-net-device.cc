@@ -523,6 +523,42 @@ PointToPointNetDevice::Send (
       return false;
     }
 
+  return DoSend (packet, protocolNumber);
+}
+
+uint32_t
+PointToPointNetDevice::SendBatch (
+  const std::vector<Ptr<Packet> > &packets,
+  const Address &dest,
+  uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << packets.size () << dest << protocolNumber);
+
+  if (IsLinkUp () == false)
+    {
+      for (std::vector<Ptr<Packet> >::const_iterator i = packets.begin (); i != packets.end (); ++i)
+        {
+          m_macTxDropTrace (*i);
+        }
+      return 0;
+    }
+
+  uint32_t sent = 0;
+  for (std::vector<Ptr<Packet> >::const_iterator i = packets.begin (); i != packets.end (); ++i)
+    {
+      if (DoSend (*i, protocolNumber))
+        {
+          sent++;
+        }
+    }
+  return sent;
+}
+
+bool
+PointToPointNetDevice::DoSend (Ptr<Packet> packet, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << packet << protocolNumber);
+
   //
   // Stick a point to point protocol header on the packet in preparation for
   // shoving it out the door.
@@ -176,6 +176,7 @@ public:
   virtual bool IsBridge (void) const;
 
   virtual bool Send (Ptr<Packet> packet, const Address &dest, uint16_t protocolNumber);
+  virtual uint32_t SendBatch (const std::vector<Ptr<Packet> > &packets, const Address &dest, uint16_t protocolNumber);
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber);
 
   virtual Ptr<Node> GetNode (void) const;
@@ -250,6 +251,17 @@ private:
    */
   bool ProcessHeader (Ptr<Packet> p, uint16_t& param);
 
+  /**
+   * Add the point to point header to a packet, enqueue it and start
+   * transmitting it if the device is idle. The link must be up.
+   *
+   * \param [in] packet The packet to send.
+   * \param [in] protocolNumber The protocol number of the payload.
+   * \returns Whether the packet was enqueued (and transmitted, if the
+   *          device was idle) successfully.
+   */
+  bool DoSend (Ptr<Packet> packet, uint16_t protocolNumber);
+
   /**
    * Start Sending a Packet Down the Wire.
    *
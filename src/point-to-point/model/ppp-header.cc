@@ -85,6 +85,14 @@ PppHeader::Serialize (Buffer::Iterator start) const
   start.WriteHtonU16 (m_protocol);
 }
 
+uint32_t
+PppHeader::SerializeTo (uint8_t *buffer, uint32_t payloadSize) const
+{
+  buffer[0] = m_protocol >> 8;
+  buffer[1] = m_protocol & 0xff;
+  return 2;
+}
+
 uint32_t
 PppHeader::Deserialize (Buffer::Iterator start)
 {
@@ -78,6 +78,13 @@ public:
   virtual void Serialize (Buffer::Iterator start) const;
   virtual uint32_t Deserialize (Buffer::Iterator start);
   virtual uint32_t GetSerializedSize (void) const;
+  /**
+   * \brief Serialize the header in contiguous memory (see HeaderTraits).
+   * \param [out] buffer The buffer, of at least 2 bytes.
+   * \param [in] payloadSize The number of bytes which follow the header.
+   * \returns The number of bytes written.
+   */
+  uint32_t SerializeTo (uint8_t *buffer, uint32_t payloadSize) const;
 
   /**
    * \brief Set the protocol type carried by this PPP packet
@@ -105,6 +112,15 @@ private:
   uint16_t m_protocol;
 };
 
+/**
+ * \brief The PPP header can be added to a packet without virtual calls.
+ */
+template <>
+struct HeaderTraits<PppHeader>
+{
+  static constexpr uint32_t MAX_SIZE = 2; //!< The size of the header.
+};
+
 } // namespace ns3
 
 
@@ -0,0 +1,290 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/multithreaded-simulator-helper.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/point-to-point-channel.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup point-to-point-test
+ * \ingroup tests
+ *
+ * Send packets along a chain of nodes connected by point-to-point
+ * links and split in partitions of the MultithreadedSimulatorImpl.
+ * Every node sends packets to its neighbours, which forward them
+ * further; the payload of the packets received across partitions must
+ * be intact, and the receptions must not depend on the thread count or
+ * on the simulator implementation.  The uids of the received packets,
+ * allocated per partition, must not depend on the thread count either.
+ */
+class PointToPointMultithreadedTest : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] threads The number of threads to compare with the
+   * sequential simulator.
+   */
+  PointToPointMultithreadedTest (uint32_t threads);
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /**
+   * Run one simulation.
+   * \param [in] simulator The simulator implementation.
+   * \param [in] threads The maximum number of threads.
+   * \return The packets received by each node.
+   */
+  std::vector<std::vector<std::string> > RunOnce (std::string simulator, uint32_t threads);
+  /**
+   * Send a new packet.
+   * \param [in] device The sending device.
+   * \param [in] seq The sequence number of the packet.
+   */
+  void Send (Ptr<NetDevice> device, uint8_t seq);
+  /**
+   * Record a received packet and forward it on the other device of the
+   * node.
+   * \param [in] device The receiving device.
+   * \param [in] packet The packet.
+   * \param [in] protocol The protocol number.
+   * \param [in] from The address of the sender.
+   * \return true.
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+
+  uint32_t m_threads;                              //!< Threads of the compared run.
+  std::vector<std::vector<std::string> > m_log;    //!< Received packets, per node.
+  std::vector<std::vector<std::string> > m_uids;   //!< Received packets with their uid, per node.
+  uint64_t m_firstUid;                             //!< First packet uid of the run.
+  std::vector<uint32_t> m_errors;                  //!< Corrupted packets, per node.
+};
+
+/** Number of nodes of the chain. */
+static const uint32_t N_NODES = 8;
+/** Number of partitions. */
+static const uint32_t N_PARTITIONS = 4;
+/** Number of packets sent by each device. */
+static const uint8_t N_PACKETS = 10;
+/** Size of the packets. */
+static const uint32_t PACKET_SIZE = 200;
+/** Number of times a packet is forwarded. */
+static const uint8_t N_HOPS = 3;
+
+PointToPointMultithreadedTest::PointToPointMultithreadedTest (uint32_t threads)
+  : TestCase ("Check point-to-point links across partitions with " + std::to_string (threads) + " threads"),
+    m_threads (threads)
+{
+}
+
+void
+PointToPointMultithreadedTest::Send (Ptr<NetDevice> device, uint8_t seq)
+{
+  // origin, sequence number and hop count, then a pattern derived from them
+  uint8_t buffer[PACKET_SIZE];
+  buffer[0] = static_cast<uint8_t> (device->GetNode ()->GetId ());
+  buffer[1] = seq;
+  buffer[2] = 0;
+  for (uint32_t i = 3; i < PACKET_SIZE; ++i)
+    {
+      buffer[i] = static_cast<uint8_t> (buffer[0] * 31 + buffer[1] * 7 + i);
+    }
+  device->Send (Create<Packet> (buffer, PACKET_SIZE), device->GetBroadcast (), 0x800);
+}
+
+bool
+PointToPointMultithreadedTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                                        uint16_t protocol, const Address &from)
+{
+  Ptr<Node> node = device->GetNode ();
+  uint32_t id = node->GetId ();
+  uint8_t buffer[PACKET_SIZE];
+  if (packet->GetSize () != PACKET_SIZE || packet->CopyData (buffer, PACKET_SIZE) != PACKET_SIZE)
+    {
+      m_errors[id]++;
+      return true;
+    }
+  for (uint32_t i = 3; i < PACKET_SIZE; ++i)
+    {
+      if (buffer[i] != static_cast<uint8_t> (buffer[0] * 31 + buffer[1] * 7 + i))
+        {
+          m_errors[id]++;
+          return true;
+        }
+    }
+  std::ostringstream oss;
+  oss << Simulator::Now ().GetTimeStep () << " from " << +buffer[0] << " seq " << +buffer[1]
+      << " hops " << +buffer[2] << " protocol " << protocol;
+  m_log[id].push_back (oss.str ());
+  oss << " uid " << packet->GetUid () - m_firstUid;
+  m_uids[id].push_back (oss.str ());
+
+  if (++buffer[2] < N_HOPS)
+    {
+      for (uint32_t i = 0; i < node->GetNDevices (); ++i)
+        {
+          Ptr<NetDevice> other = node->GetDevice (i);
+          if (other != device && DynamicCast<PointToPointNetDevice> (other) != 0)
+            {
+              other->Send (Create<Packet> (buffer, PACKET_SIZE), other->GetBroadcast (), 0x800);
+            }
+        }
+    }
+  return true;
+}
+
+std::vector<std::vector<std::string> >
+PointToPointMultithreadedTest::RunOnce (std::string simulator, uint32_t threads)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue (simulator));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::MaxThreads", UintegerValue (threads));
+
+  m_log.assign (N_NODES, std::vector<std::string> ());
+  m_uids.assign (N_NODES, std::vector<std::string> ());
+  // the packet uids keep growing across the runs of the process
+  m_firstUid = Create<Packet> ()->GetUid ();
+  m_errors.assign (N_NODES, 0);
+
+  NodeContainer nodes;
+  nodes.Create (N_NODES);
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("2ms"));
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i + 1 < N_NODES; ++i)
+    {
+      devices.Add (p2p.Install (nodes.Get (i), nodes.Get (i + 1)));
+    }
+  for (NetDeviceContainer::Iterator i = devices.Begin (); i != devices.End (); ++i)
+    {
+      (*i)->SetReceiveCallback (MakeCallback (&PointToPointMultithreadedTest::Receive, this));
+      for (uint8_t seq = 0; seq < N_PACKETS; ++seq)
+        {
+          Simulator::ScheduleWithContext ((*i)->GetNode ()->GetId (),
+                                          MilliSeconds (1) + MicroSeconds (300 * seq + 10 * (*i)->GetNode ()->GetId ()),
+                                          &PointToPointMultithreadedTest::Send, this, *i, seq);
+        }
+    }
+
+  if (simulator == "ns3::MultithreadedSimulatorImpl")
+    {
+      MultithreadedSimulatorHelper partitions;
+      partitions.AssignBlocks (nodes, N_PARTITIONS);
+      NS_TEST_EXPECT_MSG_EQ (partitions.GetPartition (nodes.Get (2)), 1, "Wrong partition");
+      Time lookAhead = partitions.Install ();
+      NS_TEST_EXPECT_MSG_EQ (lookAhead, MilliSeconds (2), "Wrong lookahead");
+      for (uint32_t i = 0; i + 1 < N_NODES; ++i)
+        {
+          // the blocks are pairs of nodes: every other link crosses
+          bool expected = (i % 2 == 1);
+          BooleanValue crossPartition;
+          devices.Get (2 * i)->GetChannel ()->GetAttribute ("CrossPartition", crossPartition);
+          NS_TEST_EXPECT_MSG_EQ (crossPartition.Get (), expected,
+                                 "Wrong CrossPartition attribute of the link " << i);
+        }
+    }
+
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  for (uint32_t i = 0; i < N_NODES; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_errors[i], 0, "Node " << i << " received corrupted packets");
+      // the simultaneous receptions of a node may be ordered differently
+      // by the two simulator implementations
+      std::sort (m_log[i].begin (), m_log[i].end ());
+      std::sort (m_uids[i].begin (), m_uids[i].end ());
+    }
+  return m_log;
+}
+
+void
+PointToPointMultithreadedTest::DoRun (void)
+{
+  std::vector<std::vector<std::string> > reference = RunOnce ("ns3::DefaultSimulatorImpl", 1);
+  std::vector<std::vector<std::string> > log = RunOnce ("ns3::MultithreadedSimulatorImpl", 1);
+  std::vector<std::vector<std::string> > uids = m_uids;
+  if (m_threads != 1)
+    {
+      log = RunOnce ("ns3::MultithreadedSimulatorImpl", m_threads);
+    }
+
+  for (uint32_t i = 0; i < N_NODES; ++i)
+    {
+      // every device receives the packets of its peer and the packets
+      // forwarded by its peer
+      uint32_t expected = 0;
+      for (uint32_t hops = 0; hops < N_HOPS; ++hops)
+        {
+          expected += (i >= hops + 1 ? N_PACKETS : 0) + (i + hops + 1 < N_NODES ? N_PACKETS : 0);
+        }
+      NS_TEST_EXPECT_MSG_EQ (reference[i].size (), expected, "Node " << i << " lost packets");
+      NS_TEST_ASSERT_MSG_EQ (log[i].size (), reference[i].size (), "Results depend on the simulator");
+      for (uint32_t j = 0; j < log[i].size (); ++j)
+        {
+          NS_TEST_EXPECT_MSG_EQ (log[i][j], reference[i][j], "Results depend on the simulator");
+          NS_TEST_EXPECT_MSG_EQ (m_uids[i][j], uids[i][j], "Packet uids depend on the thread count");
+        }
+    }
+}
+
+void
+PointToPointMultithreadedTest::DoTeardown (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  Config::Reset ();
+}
+
+/**
+ * \ingroup point-to-point-test
+ * \ingroup tests
+ *
+ * \brief Point-to-point links across the partitions of the
+ * MultithreadedSimulatorImpl TestSuite
+ */
+class PointToPointMultithreadedTestSuite : public TestSuite
+{
+public:
+  PointToPointMultithreadedTestSuite ();
+};
+
+PointToPointMultithreadedTestSuite::PointToPointMultithreadedTestSuite ()
+  : TestSuite ("devices-point-to-point-multithreaded", UNIT)
+{
+  AddTestCase (new PointToPointMultithreadedTest (1), TestCase::QUICK);
+  AddTestCase (new PointToPointMultithreadedTest (4), TestCase::QUICK);
+}
+
+static PointToPointMultithreadedTestSuite g_pointToPointMultithreadedTestSuite; //!< Static variable for test initialization
@@ -2087,6 +2087,7 @@ SixLowPanNetDevice::Fragments::Fragments ()
 {
   NS_LOG_FUNCTION (this);
   m_packetSize = 0;
+  m_receivedSize = 0;
 }
 
 SixLowPanNetDevice::Fragments::~Fragments ()
@@ -2098,25 +2099,30 @@ void SixLowPanNetDevice::Fragments::AddFragment (Ptr<Packet> fragment, uint16_t
 {
   NS_LOG_FUNCTION (this << fragmentOffset << *fragment);
 
-  std::list<std::pair<Ptr<Packet>, uint16_t> >::iterator it;
+  std::list<std::pair<Ptr<Packet>, uint16_t> >::iterator it = m_fragments.end ();
   bool duplicate = false;
 
-  for (it = m_fragments.begin (); it != m_fragments.end (); it++)
+  // fragments mostly arrive in order: look for their place from the end
+  while (it != m_fragments.begin ())
     {
-      if (it->second > fragmentOffset)
+      std::list<std::pair<Ptr<Packet>, uint16_t> >::iterator prev = it;
+      prev--;
+      if (prev->second < fragmentOffset)
         {
           break;
         }
-      if (it->second == fragmentOffset)
+      if (prev->second == fragmentOffset)
         {
           duplicate = true;
-          NS_ASSERT_MSG (fragment->GetSize () == it->first->GetSize (), "Duplicate fragment size differs. Aborting.");
+          NS_ASSERT_MSG (fragment->GetSize () == prev->first->GetSize (), "Duplicate fragment size differs. Aborting.");
           break;
         }
+      it = prev;
     }
   if (!duplicate)
     {
       m_fragments.insert (it, std::make_pair (fragment, fragmentOffset));
+      m_receivedSize += fragment->GetSize ();
     }
 }
 
@@ -2131,7 +2137,8 @@ bool SixLowPanNetDevice::Fragments::IsEntire () const
 {
   NS_LOG_FUNCTION (this);
 
-  bool ret = m_fragments.size () > 0;
+  // the fragments cannot cover the packet until they are as large
+  bool ret = m_fragments.size () > 0 && m_receivedSize >= m_packetSize;
   uint16_t lastEndOffset = 0;
 
   if (ret)
@@ -450,6 +450,11 @@ private:
      */
     uint32_t m_packetSize;
 
+    /**
+     * \brief The total size of the current fragments (bytes).
+     */
+    uint32_t m_receivedSize;
+
     /**
      * \brief The current fragments.
      */
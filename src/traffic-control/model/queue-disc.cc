@@ -29,6 +29,8 @@
 #include "queue-disc.h"
 #include "ns3/net-device-queue-interface.h"
 #include "ns3/queue.h"
+#include "ns3/queue-limits.h"
+#include <algorithm>
 
 namespace ns3 {
 
@@ -270,6 +272,12 @@ TypeId QueueDisc::GetTypeId (void)
                    MakeUintegerAccessor (&QueueDisc::SetQuota,
                                          &QueueDisc::GetQuota),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("BatchSize",
+                   "The maximum number of packets dequeued at once and sent to "
+                   "the device in a single call (1 disables bulk dequeuing)",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&QueueDisc::m_batchSize),
+                   MakeUintegerChecker<uint32_t> (1))
     .AddAttribute ("InternalQueueList", "The list of internal queues.",
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&QueueDisc::m_queues),
@@ -388,6 +396,8 @@ QueueDisc::DoDispose (void)
   m_classes.clear ();
   m_devQueueIface = 0;
   m_send = nullptr;
+  m_sendBatch = nullptr;
+  m_batch.clear ();
   m_requeued = 0;
   m_internalQueueDbeFunctor = nullptr;
   m_internalQueueDadFunctor = nullptr;
@@ -563,6 +573,20 @@ QueueDisc::GetSendCallback (void) const
   return m_send;
 }
 
+void
+QueueDisc::SetSendBatchCallback (SendBatchCallback func)
+{
+  NS_LOG_FUNCTION (this);
+  m_sendBatch = func;
+}
+
+QueueDisc::SendBatchCallback
+QueueDisc::GetSendBatchCallback (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_sendBatch;
+}
+
 void
 QueueDisc::SetQuota (const uint32_t quota)
 {
@@ -958,10 +982,13 @@ QueueDisc::Run (void)
 
   if (RunBegin ())
     {
-      uint32_t quota = m_quota;
-      while (Restart ())
+      // the quota is expressed in packets, hence it is decreased by the
+      // number of packets sent to the device in each restart
+      int64_t quota = m_quota;
+      uint32_t packets;
+      while (Restart (packets))
         {
-          quota -= 1;
+          quota -= packets;
           if (quota <= 0)
             {
               /// \todo netif_schedule (q);
@@ -993,9 +1020,10 @@ QueueDisc::RunEnd (void)
 }
 
 bool
-QueueDisc::Restart (void)
+QueueDisc::Restart (uint32_t &packets)
 {
   NS_LOG_FUNCTION (this);
+  packets = 0;
   Ptr<QueueDiscItem> item = DequeuePacket();
   if (item == 0)
     {
@@ -1003,6 +1031,24 @@ QueueDisc::Restart (void)
       return false;
     }
 
+  packets = 1;
+
+  if (m_batchSize > 1 && m_sendBatch)
+    {
+      // the vector is a member so that its storage is reused across restarts
+      m_batch.push_back (item);
+      BulkDequeue (m_batch);
+
+      if (m_batch.size () > 1)
+        {
+          packets = m_batch.size ();
+          bool ret = TransmitBatch (m_batch);
+          m_batch.clear ();
+          return ret;
+        }
+      m_batch.clear ();
+    }
+
   return Transmit (item);
 }
 
@@ -1055,6 +1101,53 @@ QueueDisc::DequeuePacket ()
   return item;
 }
 
+void
+QueueDisc::BulkDequeue (std::vector<Ptr<QueueDiscItem> > &items)
+{
+  NS_LOG_FUNCTION (this << items.size ());
+
+  uint32_t limit = m_batchSize;
+  int64_t bytes = 0;
+  Ptr<QueueLimits> queueLimits;
+
+  if (m_devQueueIface)
+    {
+      // Multi-queue devices and stopped queues are excluded, so that all the
+      // dequeued packets can be sent to the same (non-stopped) device queue
+      if (m_devQueueIface->GetNTxQueues () > 1 || m_devQueueIface->GetTxQueue (0)->IsStopped ())
+        {
+          return;
+        }
+
+      Ptr<NetDeviceQueue> txq = m_devQueueIface->GetTxQueue (0);
+      limit = std::min (limit, txq->GetRoom ());
+      queueLimits = txq->GetQueueLimits ();
+
+      if (queueLimits)
+        {
+          bytes = queueLimits->Available ();
+          for (auto& item : items)
+            {
+              bytes -= item->GetSize ();
+            }
+        }
+    }
+
+  while (items.size () < limit && GetNPackets () > 0 && (!queueLimits || bytes > 0))
+    {
+      Ptr<QueueDiscItem> item = Dequeue ();
+      if (item == 0)
+        {
+          break;
+        }
+      item->AddHeader ();
+      bytes -= item->GetSize ();
+      items.push_back (item);
+    }
+
+  NS_LOG_LOGIC (items.size () << " packets dequeued in bulk");
+}
+
 void
 QueueDisc::Requeue (Ptr<QueueDiscItem> item)
 {
@@ -1118,4 +1211,34 @@ QueueDisc::Transmit (Ptr<QueueDiscItem> item)
   return true;
 }
 
+bool
+QueueDisc::TransmitBatch (const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  NS_LOG_FUNCTION (this << items.size ());
+
+  NS_ASSERT_MSG (!m_devQueueIface || (m_devQueueIface->GetNTxQueues () == 1
+                                      && !m_devQueueIface->GetTxQueue (0)->IsStopped ()),
+                 "Packets can only be sent in bulk to a non-stopped single queue device");
+
+  // a single queue device makes no use of the priority tag (see Transmit)
+  SocketPriorityTag priorityTag;
+  for (auto& item : items)
+    {
+      item->GetPacket ()->RemovePacketTag (priorityTag);
+    }
+
+  NS_ASSERT_MSG (m_sendBatch, "Send batch callback not set");
+  m_sendBatch (items);
+
+  // as in Transmit, the packets are assumed to be consumed by the netdevice
+
+  if (GetNPackets () == 0 ||
+      (m_devQueueIface && m_devQueueIface->GetTxQueue (0)->IsStopped ()))
+    {
+      return false;
+    }
+
+  return true;
+}
+
 } // namespace ns3
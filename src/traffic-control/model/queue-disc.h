@@ -372,6 +372,27 @@ public:
    */
   SendCallback GetSendCallback (void) const;
 
+  /// Callback invoked to send several packets to the receiving object when Run is called
+  typedef std::function<void (const std::vector<Ptr<QueueDiscItem> > &)> SendBatchCallback;
+
+  /**
+   * \param func the callback to send several packets to the receiving object.
+   *
+   * Set the callback used by the TransmitBatch method (called eventually by the
+   * Run method, if the BatchSize attribute is greater than one) to send several
+   * packets to the receiving object at once.
+   */
+  void SetSendBatchCallback (SendBatchCallback func);
+
+  /**
+   * \return the callback to send several packets to the receiving object.
+   *
+   * Get the callback used by the TransmitBatch method (called eventually by the
+   * Run method, if the BatchSize attribute is greater than one) to send several
+   * packets to the receiving object at once.
+   */
+  SendBatchCallback GetSendBatchCallback (void) const;
+
   /**
    * \brief Set the maximum number of dequeue operations following a packet enqueue
    * \param quota the maximum number of dequeue operations following a packet enqueue.
@@ -651,9 +672,12 @@ private:
   /**
    * Modelled after the Linux function qdisc_restart (net/sched/sch_generic.c)
    * Dequeue a packet (by calling DequeuePacket) and send it to the device (by calling Transmit).
+   * If bulk dequeuing is enabled, further packets may be dequeued (by calling BulkDequeue)
+   * and sent to the device along with the first one (by calling TransmitBatch).
+   * \param packets the number of packets sent to the device
    * \return true if a packet is successfully sent to the device.
    */
-  bool Restart (void);
+  bool Restart (uint32_t &packets);
 
   /**
    * Modelled after the Linux function dequeue_skb (net/sched/sch_generic.c)
@@ -661,6 +685,17 @@ private:
    */
   Ptr<QueueDiscItem> DequeuePacket (void);
 
+  /**
+   * Modelled after the Linux function try_bulk_dequeue_skb (net/sched/sch_generic.c)
+   * Dequeue further packets to be sent along with those already in the given
+   * vector. No more than BatchSize packets are collected, and no more than the
+   * device transmission queue is able to store (in terms of MTU-sized packets
+   * and of bytes allowed by its queue limits, if any). Packets are only
+   * dequeued in bulk for devices having a single transmission queue.
+   * \param items the packets to send; dequeued packets are appended to it
+   */
+  void BulkDequeue (std::vector<Ptr<QueueDiscItem> > &items);
+
   /**
    * Modelled after the Linux function dev_requeue_skb (net/sched/sch_generic.c)
    * Requeues a packet whose transmission failed.
@@ -677,6 +712,16 @@ private:
    */
   bool Transmit (Ptr<QueueDiscItem> item);
 
+  /**
+   * Send several packets to the device at once. This is the same as calling
+   * Transmit for each packet, except that the send batch callback is invoked
+   * only once. The packets must have been dequeued by BulkDequeue, which
+   * ensures that the device queue is not stopped.
+   * \param items the packets to transmit
+   * \return true if the device queue is not stopped and the queue disc is not empty
+   */
+  bool TransmitBatch (const std::vector<Ptr<QueueDiscItem> > &items);
+
   /**
    *  \brief Perform the actions required when the queue disc is notified of
    *         a packet enqueue
@@ -706,6 +751,9 @@ private:
   uint32_t m_quota;                 //!< Maximum number of packets dequeued in a qdisc run
   Ptr<NetDeviceQueueInterface> m_devQueueIface;   //!< NetDevice queue interface
   SendCallback m_send;              //!< Callback used to send a packet to the receiving object
+  SendBatchCallback m_sendBatch;    //!< Callback used to send several packets to the receiving object
+  uint32_t m_batchSize;             //!< Maximum number of packets sent to the device at once
+  std::vector<Ptr<QueueDiscItem> > m_batch;  //!< Packets being sent to the device at once
   bool m_running;                   //!< The queue disc is performing multiple dequeue operations
   Ptr<QueueDiscItem> m_requeued;    //!< The last packet that failed to be transmitted
   bool m_peeked;                    //!< A packet was dequeued because Peek was called
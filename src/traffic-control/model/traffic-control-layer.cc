@@ -193,6 +193,28 @@ TrafficControlLayer::ScanDevices (void)
               q->SetNetDeviceQueueInterface (ndqi);
               q->SetSendCallback ([dev] (Ptr<QueueDiscItem> item)
                                   { dev->Send (item->GetPacket (), item->GetAddress (), item->GetProtocol ()); });
+              // consecutive items with the same destination and protocol are passed
+              // to the device in a single call. The vector of packets is reused
+              std::vector<Ptr<Packet> > packets;
+              q->SetSendBatchCallback ([dev, packets] (const std::vector<Ptr<QueueDiscItem> > &items) mutable
+                                       {
+                                         auto first = items.begin ();
+                                         while (first != items.end ())
+                                           {
+                                             auto last = first;
+                                             packets.clear ();
+                                             while (last != items.end ()
+                                                    && (*last)->GetProtocol () == (*first)->GetProtocol ()
+                                                    && (*last)->GetAddress () == (*first)->GetAddress ())
+                                               {
+                                                 packets.push_back ((*last)->GetPacket ());
+                                                 ++last;
+                                               }
+                                             dev->SendBatch (packets, (*first)->GetAddress (), (*first)->GetProtocol ());
+                                             first = last;
+                                           }
+                                         packets.clear ();
+                                       });
             }
         }
     }
@@ -257,6 +279,7 @@ TrafficControlLayer::DeleteRootQueueDiscOnDevice (Ptr<NetDevice> device)
     {
       q->SetNetDeviceQueueInterface (nullptr);
       q->SetSendCallback (nullptr);
+      q->SetSendBatchCallback (nullptr);
     }
   ndi->second.m_queueDiscsToWake.clear ();
 
@@ -364,6 +364,171 @@ TcFlowControlTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Traffic Control Bulk Dequeue Test Case
+ *
+ * The device queue is stopped while packets are enqueued in the queue disc,
+ * then it is woken up. Check that the backlogged packets are sent to the device
+ * in batches of at most BatchSize packets and that all of them are received in
+ * the order they were sent.
+ */
+class TcBulkDequeueTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param batchSize the value of the BatchSize attribute of the queue disc
+   * \param nPackets the number of packets backlogged in the queue disc
+   */
+  TcBulkDequeueTestCase (uint32_t batchSize, uint32_t nPackets);
+  virtual ~TcBulkDequeueTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Enqueue packets in the queue disc
+   * \param dev the device
+   * \param nPackets the number of packets to send
+   * \param stop whether to stop the device queue first
+   */
+  void SendPackets (Ptr<NetDevice> dev, uint32_t nPackets, bool stop);
+  /**
+   * Wrap the send batch callback of the root queue disc to record the size
+   * of the batches
+   * \param dev the device
+   */
+  void RecordBatches (Ptr<NetDevice> dev);
+  /**
+   * Receive a packet (the test items are not addressed to the receiving device)
+   * \param dev the receiving device
+   * \param p the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \param to the destination address
+   * \param type the packet type
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol, const Address &from,
+                const Address &to, NetDevice::PacketType type);
+  uint32_t m_batchSize;                //!< the BatchSize attribute of the queue disc
+  uint32_t m_nPackets;                 //!< the number of backlogged packets
+  std::vector<uint32_t> m_batches;     //!< the size of the batches sent to the device
+  std::vector<uint64_t> m_received;    //!< the uids of the received packets
+  std::vector<uint64_t> m_sent;        //!< the uids of the sent packets
+};
+
+TcBulkDequeueTestCase::TcBulkDequeueTestCase (uint32_t batchSize, uint32_t nPackets)
+  : TestCase ("Test dequeuing packets in bulk with BatchSize " + std::to_string (batchSize)),
+    m_batchSize (batchSize),
+    m_nPackets (nPackets)
+{
+}
+
+TcBulkDequeueTestCase::~TcBulkDequeueTestCase ()
+{
+}
+
+void
+TcBulkDequeueTestCase::SendPackets (Ptr<NetDevice> dev, uint32_t nPackets, bool stop)
+{
+  if (stop)
+    {
+      dev->GetObject<NetDeviceQueueInterface> ()->GetTxQueue (0)->Stop ();
+    }
+
+  Ptr<TrafficControlLayer> tc = dev->GetNode ()->GetObject<TrafficControlLayer> ();
+  for (uint32_t i = 0; i < nPackets; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (1000);
+      m_sent.push_back (p->GetUid ());
+      tc->Send (dev, Create<QueueDiscTestItem> (p));
+    }
+}
+
+void
+TcBulkDequeueTestCase::RecordBatches (Ptr<NetDevice> dev)
+{
+  Ptr<TrafficControlLayer> tc = dev->GetNode ()->GetObject<TrafficControlLayer> ();
+  Ptr<QueueDisc> qdisc = tc->GetRootQueueDiscOnDevice (dev);
+  QueueDisc::SendBatchCallback send = qdisc->GetSendBatchCallback ();
+  NS_TEST_ASSERT_MSG_EQ (bool (send), true, "The send batch callback has not been set");
+  qdisc->SetSendBatchCallback ([this, send] (const std::vector<Ptr<QueueDiscItem> > &items)
+                               {
+                                 m_batches.push_back (items.size ());
+                                 send (items);
+                               });
+}
+
+bool
+TcBulkDequeueTestCase::Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol, const Address &from,
+                                const Address &to, NetDevice::PacketType type)
+{
+  m_received.push_back (p->GetUid ());
+  return true;
+}
+
+void
+TcBulkDequeueTestCase::DoRun (void)
+{
+  NodeContainer n;
+  n.Create (2);
+
+  n.Get (0)->AggregateObject (CreateObject<TrafficControlLayer> ());
+  n.Get (1)->AggregateObject (CreateObject<TrafficControlLayer> ());
+
+  SimpleNetDeviceHelper simple;
+
+  Ptr<NetDevice> rxDev = simple.Install (n.Get (1)).Get (0);
+  rxDev->SetPromiscReceiveCallback (MakeCallback (&TcBulkDequeueTestCase::Receive, this));
+
+  simple.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("1Mb/s")));
+  simple.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue ("100p"));
+
+  Ptr<NetDevice> txDev;
+  txDev = simple.Install (n.Get (0), DynamicCast<SimpleChannel> (rxDev->GetChannel ())).Get (0);
+
+  TrafficControlHelper tch;
+  tch.SetRootQueueDisc ("ns3::FifoQueueDisc", "BatchSize", UintegerValue (m_batchSize));
+  tch.Install (txDev);
+
+  // the device queue knows how much room it has before the first packet
+  NS_TEST_EXPECT_MSG_EQ (txDev->GetObject<NetDeviceQueueInterface> ()->GetTxQueue (0)->GetRoom (), 100,
+                         "The room of the device queue is not initialized from its limits");
+
+  // the transmission of each packet takes 1000B/1Mbps = 8ms, hence the other
+  // packets are sent to the device queue while the first one is transmitted
+  Simulator::Schedule (Seconds (0), &TcBulkDequeueTestCase::RecordBatches, this, txDev);
+  Simulator::Schedule (Seconds (0), &TcBulkDequeueTestCase::SendPackets, this, txDev, 1, false);
+  Simulator::Schedule (MilliSeconds (1), &TcBulkDequeueTestCase::SendPackets, this, txDev, m_nPackets, true);
+  Simulator::Schedule (MilliSeconds (2), &NetDeviceQueue::Wake,
+                       txDev->GetObject<NetDeviceQueueInterface> ()->GetTxQueue (0));
+
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_received.size (), m_nPackets + 1, "Not all the packets have been received");
+  NS_TEST_EXPECT_MSG_EQ ((m_received == m_sent), true, "The packets have not been received in order");
+
+  uint32_t nBatched = 0;
+  for (auto& size : m_batches)
+    {
+      NS_TEST_EXPECT_MSG_GT (size, 1, "A batch must contain more than one packet");
+      NS_TEST_EXPECT_MSG_LT_OR_EQ (size, m_batchSize, "A batch must not exceed BatchSize");
+      nBatched += size;
+    }
+  // all the backlogged packets but the last one (if it remains alone) are sent in bulk
+  uint32_t expected = (m_batchSize > 1 ? m_nPackets - (m_nPackets % m_batchSize == 1 ? 1 : 0) : 0);
+  NS_TEST_EXPECT_MSG_EQ (nBatched, expected, "Unexpected number of packets sent in bulk");
+
+  Ptr<QueueDisc> qdisc = n.Get (0)->GetObject<TrafficControlLayer> ()->GetRootQueueDiscOnDevice (txDev);
+  NS_TEST_EXPECT_MSG_EQ (qdisc->GetStats ().nTotalSentPackets, m_nPackets + 1,
+                         "Unexpected number of packets sent by the queue disc");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup traffic-control-test
  * \ingroup tests
@@ -389,5 +554,11 @@ public:
     // TODO: Right now, this test only works for 5000B and 10 packets (it's hard coded). Should
     // also be made parametric.
     AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::BYTES, 5000, 10), TestCase::QUICK);
+
+    AddTestCase (new TcBulkDequeueTestCase (1, 10), TestCase::QUICK);
+    AddTestCase (new TcBulkDequeueTestCase (3, 10), TestCase::QUICK);
+    AddTestCase (new TcBulkDequeueTestCase (4, 10), TestCase::QUICK);
+    AddTestCase (new TcBulkDequeueTestCase (5, 10), TestCase::QUICK);
+    AddTestCase (new TcBulkDequeueTestCase (64, 10), TestCase::QUICK);
   }
 } g_tcFlowControlTestSuite; ///< the test suite
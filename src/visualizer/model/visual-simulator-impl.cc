@@ -230,6 +230,18 @@ VisualSimulatorImpl::GetEventCount (void) const
   return m_simulator->GetEventCount ();
 }
 
+uint64_t
+VisualSimulatorImpl::GetLiveEventCount (void) const
+{
+  return m_simulator->GetLiveEventCount ();
+}
+
+uint64_t
+VisualSimulatorImpl::GetCancelledEventCount (void) const
+{
+  return m_simulator->GetCancelledEventCount ();
+}
+
 void
 VisualSimulatorImpl::RunRealSimulator (void)
 {
@@ -147,6 +147,7 @@ YansWavePhyHelper::EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, bo
   NS_ABORT_MSG_IF (phys.size () == 0, "EnablePcapInternal(): Phy layer in WaveNetDevice must be set");
 
   PcapHelper pcapHelper;
+  pcapHelper.SetFileFormat (GetPcapFileFormat ());
 
   std::string filename;
   if (explicitFilename)
@@ -158,7 +159,9 @@ YansWavePhyHelper::EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, bo
       filename = pcapHelper.GetFilenameFromDevice (prefix, device);
     }
 
-  Ptr<PcapFileWrapper> file = pcapHelper.CreateFile (filename, std::ios::out, GetPcapDataLinkType ());
+  Ptr<PcapFileWrapper> file = pcapHelper.CreateFile (filename, std::ios::out, GetPcapDataLinkType (),
+                                                     std::numeric_limits<uint32_t>::max (), 0,
+                                                     pcapHelper.GetInterfaceNameFromDevice (device));
 
   std::vector<Ptr<WifiPhy> >::iterator i;
   for (i = phys.begin (); i != phys.end (); ++i)
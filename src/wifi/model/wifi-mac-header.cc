@@ -1110,18 +1110,54 @@ WifiMacHeader::GetSerializedSize (void) const
   return GetSize ();
 }
 
+namespace {
+
+/**
+ * Write a 16-bit field, least significant byte first.
+ * \param [in,out] i The position of the field, advanced past it.
+ * \param [in] data The value of the field.
+ */
+void
+WriteHtolsbU16 (uint8_t *&i, uint16_t data)
+{
+  *i++ = data & 0xff;
+  *i++ = data >> 8;
+}
+
+/**
+ * Write an address.
+ * \param [in,out] i The position of the address, advanced past it.
+ * \param [in] ad The address.
+ */
+void
+WriteAddress (uint8_t *&i, Mac48Address ad)
+{
+  ad.CopyTo (i);
+  i += 6;
+}
+
+} // unnamed namespace
+
 void
 WifiMacHeader::Serialize (Buffer::Iterator i) const
 {
-  i.WriteHtolsbU16 (GetFrameControl ());
-  i.WriteHtolsbU16 (m_duration);
-  WriteTo (i, m_addr1);
+  uint8_t buffer[32];
+  i.Write (buffer, SerializeTo (buffer, 0));
+}
+
+uint32_t
+WifiMacHeader::SerializeTo (uint8_t *buffer, uint32_t payloadSize) const
+{
+  uint8_t *i = buffer;
+  WriteHtolsbU16 (i, GetFrameControl ());
+  WriteHtolsbU16 (i, m_duration);
+  WriteAddress (i, m_addr1);
   switch (m_ctrlType)
     {
     case TYPE_MGT:
-      WriteTo (i, m_addr2);
-      WriteTo (i, m_addr3);
-      i.WriteHtolsbU16 (GetSequenceControl ());
+      WriteAddress (i, m_addr2);
+      WriteAddress (i, m_addr3);
+      WriteHtolsbU16 (i, GetSequenceControl ());
       break;
     case TYPE_CTL:
       switch (m_ctrlSubtype)
@@ -1131,7 +1167,7 @@ WifiMacHeader::Serialize (Buffer::Iterator i) const
         case SUBTYPE_CTL_BACKRESP:
         case SUBTYPE_CTL_END:
         case SUBTYPE_CTL_END_ACK:
-          WriteTo (i, m_addr2);
+          WriteAddress (i, m_addr2);
           break;
         case SUBTYPE_CTL_CTS:
         case SUBTYPE_CTL_ACK:
@@ -1144,16 +1180,16 @@ WifiMacHeader::Serialize (Buffer::Iterator i) const
       break;
     case TYPE_DATA:
       {
-        WriteTo (i, m_addr2);
-        WriteTo (i, m_addr3);
-        i.WriteHtolsbU16 (GetSequenceControl ());
+        WriteAddress (i, m_addr2);
+        WriteAddress (i, m_addr3);
+        WriteHtolsbU16 (i, GetSequenceControl ());
         if (m_ctrlToDs && m_ctrlFromDs)
           {
-            WriteTo (i, m_addr4);
+            WriteAddress (i, m_addr4);
           }
         if (m_ctrlSubtype & 0x08)
           {
-            i.WriteHtolsbU16 (GetQosControl ());
+            WriteHtolsbU16 (i, GetQosControl ());
           }
       } break;
     default:
@@ -1161,6 +1197,7 @@ WifiMacHeader::Serialize (Buffer::Iterator i) const
       NS_ASSERT (false);
       break;
     }
+  return i - buffer;
 }
 
 uint32_t
@@ -118,6 +118,13 @@ public:
   uint32_t GetSerializedSize (void) const;
   void Serialize (Buffer::Iterator start) const;
   uint32_t Deserialize (Buffer::Iterator start);
+  /**
+   * \brief Serialize the header in contiguous memory (see HeaderTraits).
+   * \param [out] buffer The buffer, of at least 32 bytes.
+   * \param [in] payloadSize The number of bytes which follow the header.
+   * \returns The number of bytes written.
+   */
+  uint32_t SerializeTo (uint8_t *buffer, uint32_t payloadSize) const;
 
   /**
    * Set the From DS bit in the Frame Control field.
@@ -627,6 +634,15 @@ private:
   uint8_t m_qosStuff;     ///< QoS stuff
 };
 
+/**
+ * \brief The Wifi MAC header can be added to a packet without virtual calls.
+ */
+template <>
+struct HeaderTraits<WifiMacHeader>
+{
+  static constexpr uint32_t MAX_SIZE = 32; //!< The size of the largest header (QoS data with four addresses).
+};
+
 } //namespace ns3
 
 #endif /* WIFI_MAC_HEADER_H */
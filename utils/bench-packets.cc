@@ -21,17 +21,23 @@
 // This program can be used to benchmark packet serialization/deserialization
 // operations using Headers and Tags, for various numbers of packets 'n'
 // Sample usage:  ./waf --run 'bench-packets --n=10000'
+// With --threads=N, each benchmark runs concurrently in N threads, which
+// each process 'n' packets, to measure the scalability of the allocator.
 
 #include "ns3/command-line.h"
 #include "ns3/system-wall-clock-ms.h"
 #include "ns3/packet.h"
 #include "ns3/packet-metadata.h"
+#include "ns3/packet-allocator.h"
+#include "ns3/simulator.h"
 #include <iostream>
 #include <sstream>
 #include <string>
 #include <stdlib.h> // for exit ()
 #include <limits>
 #include <algorithm>
+#include <thread>
+#include <vector>
 
 using namespace ns3;
 
@@ -329,26 +335,44 @@ benchByteTags (uint32_t n)
 }
 
 static uint64_t
-runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
+runBenchOneIteration (void (*bench) (uint32_t), uint32_t n, uint32_t threads)
 {
   SystemWallClockMs time;
   time.Start ();
-  (*bench) (n);
+  if (threads <= 1)
+    {
+      (*bench) (n);
+    }
+  else
+    {
+      std::vector<std::thread> workers;
+      for (uint32_t i = 0; i < threads; i++)
+        {
+          workers.push_back (std::thread (bench, n));
+        }
+      for (uint32_t i = 0; i < threads; i++)
+        {
+          workers[i].join ();
+        }
+    }
   uint64_t deltaMs = time.End ();
   return deltaMs;
 }
 
 
 static void
-runBench (void (*bench) (uint32_t), uint32_t n, uint32_t minIterations, char const *name)
+runBench (void (*bench) (uint32_t), uint32_t n, uint32_t threads,
+          uint32_t minIterations, char const *name)
 {
   uint64_t minDelay = std::numeric_limits<uint64_t>::max();
   for (uint32_t i = 0; i < minIterations; i++)
     {
-      uint64_t delay = runBenchOneIteration(bench, n);
+      uint64_t delay = runBenchOneIteration(bench, n, threads);
       minDelay = std::min(minDelay, delay);
     }
+  minDelay = std::max<uint64_t> (minDelay, 1);
   double ps = n;
+  ps *= std::max<uint32_t> (threads, 1);
   ps *= 1000;
   ps /= minDelay;
   std::cout << ps << " packets/s"
@@ -361,13 +385,17 @@ int main (int argc, char *argv[])
 {
   uint32_t n = 0;
   uint32_t minIterations = 1;
+  uint32_t threads = 1;
   bool enablePrinting = false;
+  bool noPool = false;
 
   CommandLine cmd (__FILE__);
   cmd.Usage ("Benchmark Packet class");
   cmd.AddValue ("n", "number of iterations", n);
   cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
   cmd.AddValue ("enable-printing", "enable packet printing", enablePrinting);
+  cmd.AddValue ("threads", "number of threads running each benchmark concurrently", threads);
+  cmd.AddValue ("nopool", "allocate packet memory with the global allocator", noPool);
   cmd.Parse (argc, argv);
 
   if (n == 0)
@@ -376,15 +404,31 @@ int main (int argc, char *argv[])
         "by command-line argument --n=(number of packets)" << std::endl;
       exit (1);
     }
-  std::cout << "Running bench-packets with n=" << n << std::endl;
+  if (noPool)
+    {
+      PacketAllocator::Disable ();
+    }
+  // The packet constructors query the simulator: create it beforehand.
+  Simulator::GetSystemId ();
+
+  std::cout << "Running bench-packets with n=" << n
+            << (threads > 1 ? " per thread, threads=" : "")
+            << (threads > 1 ? std::to_string (threads) : "") << std::endl;
   std::cout << "All tests begin by adding UDP and IPv4 headers." << std::endl;
 
-  runBench (&benchA, n, minIterations, "Copy packet, remove headers");
-  runBench (&benchB, n, minIterations, "Just add headers");
-  runBench (&benchC, n, minIterations, "Remove by func call");
-  runBench (&benchD, n, minIterations, "Intermixed add/remove headers and tags");
-  runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
-  runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
+  runBench (&benchA, n, threads, minIterations, "Copy packet, remove headers");
+  runBench (&benchB, n, threads, minIterations, "Just add headers");
+  runBench (&benchC, n, threads, minIterations, "Remove by func call");
+  runBench (&benchD, n, threads, minIterations, "Intermixed add/remove headers and tags");
+  runBench (&benchFragment, n, threads, minIterations, "Fragmentation and concatenation");
+  runBench (&benchByteTags, n, threads, minIterations, "Benchmark byte tags");
+
+  PacketAllocator::Stats stats = PacketAllocator::GetStats ();
+  std::cout << "Allocator: " << stats.hits << " hits, "
+            << stats.refills << " refills, "
+            << stats.misses << " misses, "
+            << stats.bytesRetained << " bytes retained" << std::endl;
 
+  Simulator::Destroy ();
   return 0;
 }
@@ -145,18 +145,72 @@ Bench::Cb (void)
 }
 
 
+/**
+ * Make the random stream of the event intervals.
+ * \param filename The file of relative event times, or "" to use
+ *        one of the hold model distributions.
+ * \param dist The hold model distribution, all with a mean of 100 ns.
+ * \return The random stream.
+ */
 Ptr<RandomVariableStream>
-GetRandomStream (std::string filename)
+GetRandomStream (std::string filename, std::string dist)
 {
   Ptr<RandomVariableStream> stream = 0;
 
-  if (filename == "")
+  if (filename == "" && dist == "exp")
     {
       LOGME ("using default exponential distribution");
       Ptr<ExponentialRandomVariable> erv = CreateObject<ExponentialRandomVariable> ();
       erv->SetAttribute ("Mean", DoubleValue (100));
       stream = erv;
     }
+  else if (filename == "" && dist == "uniform")
+    {
+      LOGME ("using uniform distribution over [0, 200] ns");
+      Ptr<UniformRandomVariable> urv = CreateObject<UniformRandomVariable> ();
+      urv->SetAttribute ("Min", DoubleValue (0));
+      urv->SetAttribute ("Max", DoubleValue (200));
+      stream = urv;
+    }
+  else if (filename == "" && dist == "biased")
+    {
+      LOGME ("using biased distribution, uniform over [90, 110] ns");
+      Ptr<UniformRandomVariable> urv = CreateObject<UniformRandomVariable> ();
+      urv->SetAttribute ("Min", DoubleValue (90));
+      urv->SetAttribute ("Max", DoubleValue (110));
+      stream = urv;
+    }
+  else if (filename == "" && dist == "bimodal")
+    {
+      LOGME ("using bimodal distribution, 90% over [0, 2] ns and 10% over [0, 1982] ns");
+      Ptr<EmpiricalRandomVariable> erv = CreateObject<EmpiricalRandomVariable> ();
+      erv->SetInterpolate (true);
+      erv->CDF (0, 0);
+      erv->CDF (2, 0.9);
+      erv->CDF (1982, 1);
+      stream = erv;
+    }
+  else if (filename == "" && dist == "triangular")
+    {
+      LOGME ("using triangular distribution over [0, 150] ns");
+      Ptr<TriangularRandomVariable> trv = CreateObject<TriangularRandomVariable> ();
+      trv->SetAttribute ("Min", DoubleValue (0));
+      trv->SetAttribute ("Max", DoubleValue (150));
+      trv->SetAttribute ("Mean", DoubleValue (100));
+      stream = trv;
+    }
+  else if (filename == "" && dist == "pareto")
+    {
+      LOGME ("using heavy-tailed Pareto distribution, shape 1.5");
+      Ptr<ParetoRandomVariable> prv = CreateObject<ParetoRandomVariable> ();
+      prv->SetAttribute ("Shape", DoubleValue (1.5));
+      prv->SetAttribute ("Scale", DoubleValue (100.0 / 3));
+      stream = prv;
+    }
+  else if (filename == "")
+    {
+      NS_FATAL_ERROR ("unknown distribution " << dist);
+    }
   else
     {
       std::istream *input;
@@ -208,18 +262,24 @@ int main (int argc, char *argv[])
   bool schedList          = false;
   bool schedMap           = true;
   bool schedPriorityQueue = false;
+  bool schedLadder        = false;
+  bool schedDary          = false;
 
   uint32_t pop   =  100000;
   uint32_t total = 1000000;
   uint32_t runs  =       1;
   std::string filename = "";
+  std::string dist = "exp";
   bool calRev = false;
+  bool noPool = false;
 
   CommandLine cmd (__FILE__);
   cmd.Usage ("Benchmark the simulator scheduler.\n"
              "\n"
              "Event intervals are taken from one of:\n"
-             "  an exponential distribution, with mean 100 ns,\n"
+             "  a hold model distribution, with mean 100 ns, given by the\n"
+             "    --dist argument: exp (default), uniform, biased, bimodal,\n"
+             "    triangular or pareto,\n"
              "  an ascii file, given by the --file=\"<filename>\" argument,\n"
              "  or standard input, by the argument --file=\"-\"\n"
              "In the case of either --file form, the input is expected\n"
@@ -230,11 +290,15 @@ int main (int argc, char *argv[])
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
   cmd.AddValue ("pri",   "use PriorityQueue",             schedPriorityQueue);
+  cmd.AddValue ("ladder", "use LadderScheduler",          schedLadder);
+  cmd.AddValue ("dary",  "use DaryHeapScheduler",         schedDary);
+  cmd.AddValue ("nopool", "allocate events with the global allocator", noPool);
   cmd.AddValue ("debug", "enable debugging output",       g_debug);
   cmd.AddValue ("pop",   "event population size (default 1E5)",         pop);
   cmd.AddValue ("total", "total number of events to run (default 1E6)", total);
   cmd.AddValue ("runs",  "number of runs (default 1)",    runs);
   cmd.AddValue ("file",  "file of relative event times",  filename);
+  cmd.AddValue ("dist",  "hold model distribution of the event times", dist);
   cmd.AddValue ("prec",  "printed output precision",      g_fwidth);
   cmd.Parse (argc, argv);
   g_me = cmd.GetName () + ": ";
@@ -258,8 +322,20 @@ int main (int argc, char *argv[])
     {
       factory.SetTypeId ("ns3::PriorityQueueScheduler");
     }
+  if (schedLadder)
+    {
+      factory.SetTypeId ("ns3::LadderScheduler");
+    }
+  if (schedDary)
+    {
+      factory.SetTypeId ("ns3::DaryHeapScheduler");
+    }
       
   Simulator::SetScheduler (factory);
+  if (noPool)
+    {
+      EventImpl::DisablePool ();
+    }
 
   LOGME (std::setprecision (g_fwidth - 6));
   DEB ("debugging is ON");
@@ -270,12 +346,13 @@ int main (int argc, char *argv[])
       order = ": insertion order: " + std::string (calRev ? "reverse" : "normal");
     }
   LOGME ("scheduler: " << factory.GetTypeId ().GetName () << order);
+  LOGME ("event pool: " << (noPool ? "disabled" : "enabled"));
   LOGME ("population: " << pop);
   LOGME ("total events: " << total);
   LOGME ("runs: " << runs);
 
   Bench *bench = new Bench (pop, total);
-  bench->SetRandomStream (GetRandomStream (filename));
+  bench->SetRandomStream (GetRandomStream (filename, dist));
 
   // table header
   LOG ("");
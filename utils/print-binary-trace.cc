@@ -0,0 +1,86 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program converts a binary trace file written by BinaryTraceWriter
+// (e.g., through BinaryTraceHelper) to CSV, one line per record, or
+// prints a summary of the events by kind with --summary.
+// Sample usage:  ./waf --run 'print-binary-trace --file=trace.bin'
+
+#include "ns3/command-line.h"
+#include "ns3/binary-trace-file.h"
+#include <iostream>
+#include <map>
+#include <string>
+
+using namespace ns3;
+
+int
+main (int argc, char *argv[])
+{
+  std::string filename;
+  bool summary = false;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Convert a binary trace file to CSV");
+  cmd.AddValue ("file", "binary trace file to read", filename);
+  cmd.AddValue ("summary", "only print the number of events of each kind", summary);
+  cmd.Parse (argc, argv);
+
+  BinaryTraceReader reader;
+  if (filename.empty () || !reader.Open (filename))
+    {
+      std::cerr << "Unable to read binary trace file \"" << filename << "\"" << std::endl;
+      return 1;
+    }
+
+  if (summary)
+    {
+      std::map<char, uint64_t> events;
+      BinaryTraceReader::Chunk chunk;
+      while (reader.ReadChunk (chunk))
+        {
+          for (uint32_t i = 0; i < chunk.kind.size (); ++i)
+            {
+              ++events[chunk.kind[i]];
+            }
+        }
+      for (std::map<char, uint64_t>::const_iterator i = events.begin (); i != events.end (); ++i)
+        {
+          std::cout << i->first << " " << i->second << std::endl;
+        }
+      return 0;
+    }
+
+  std::cout << "kind,time_ns,node,device,uid,size";
+  for (uint32_t i = 0; i < reader.GetNFields (); ++i)
+    {
+      std::cout << "," << reader.GetFieldName (i);
+    }
+  std::cout << "\n";
+
+  BinaryTraceReader::Record record;
+  while (reader.Read (record))
+    {
+      std::cout << record.kind << "," << record.time << "," << record.node << ","
+                << record.device << "," << record.uid << "," << record.size;
+      for (uint32_t i = 0; i < record.fields.size (); ++i)
+        {
+          std::cout << "," << record.fields[i];
+        }
+      std::cout << "\n";
+    }
+  return 0;
+}